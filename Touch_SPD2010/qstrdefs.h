@@ -1,29 +1,29 @@
-// modules/spd2010_touch/qstrdefs.h
-Q(spd2010_touch)
-Q(SPD2010_ADDR)
-Q(TOUCH_INT_PIN)
-Q(MAX_TOUCH_POINTS)
-Q(Touch_Init)
-Q(SPD2010_Touch_Reset)
-Q(write_tp_point_mode_cmd)
-Q(write_tp_start_cmd)
-Q(write_tp_cpu_start_cmd)
-Q(write_tp_clear_int_cmd)
-Q(read_tp_status_length)
-Q(tp_read_data)
-Q(Touch_Read_Data)
-Q(Touch_Get_xy)
-Q(pt_exist)
-Q(gesture)
-Q(aux)
-Q(tic_busy)
-Q(tic_in_bios)
-Q(tic_in_cpu)
-Q(tint_low)
-Q(cpu_run)
-Q(read_len)
-Q(pressed)
-Q(points)
-Q(x)
-Q(y)
+// modules/spd2010_touch/qstrdefs.h
+Q(spd2010_touch)
+Q(SPD2010_ADDR)
+Q(TOUCH_INT_PIN)
+Q(MAX_TOUCH_POINTS)
+Q(Touch_Init)
+Q(SPD2010_Touch_Reset)
+Q(write_tp_point_mode_cmd)
+Q(write_tp_start_cmd)
+Q(write_tp_cpu_start_cmd)
+Q(write_tp_clear_int_cmd)
+Q(read_tp_status_length)
+Q(tp_read_data)
+Q(Touch_Read_Data)
+Q(Touch_Get_xy)
+Q(pt_exist)
+Q(gesture)
+Q(aux)
+Q(tic_busy)
+Q(tic_in_bios)
+Q(tic_in_cpu)
+Q(tint_low)
+Q(cpu_run)
+Q(read_len)
+Q(pressed)
+Q(points)
+Q(x)
+Q(y)
 Q(weight)
\ No newline at end of file
@@ -1,467 +1,510 @@
-/*
- * SPD2010 Touch Driver implementation for MicroPython
- * Adapted from Touch_SPD2010.cpp/.h from Arduino implementation
- */
-
- #include "py/obj.h"
- #include "py/runtime.h"
- #include "py/mphal.h"
- #include "driver/gpio.h"
- #include "esp_log.h"
- 
- #define SPD2010_ADDR                0x53
- #define EXAMPLE_PIN_NUM_TOUCH_INT   4
- #define EXAMPLE_PIN_NUM_TOUCH_RST   (-1)
- #define CONFIG_ESP_LCD_TOUCH_MAX_POINTS 5
- 
- // Structures for touch data
- typedef struct {
-     uint8_t id;
-     uint16_t x;
-     uint16_t y;
-     uint8_t weight;
- } tp_report_t;
- 
- typedef struct {
-     tp_report_t rpt[10];
-     uint8_t touch_num;
-     uint8_t pack_code;
-     uint8_t down;
-     uint8_t up;
-     uint8_t gesture;
-     uint16_t down_x;
-     uint16_t down_y;
-     uint16_t up_x;
-     uint16_t up_y;
- } SPD2010_Touch;
- 
- typedef struct {
-     uint8_t none0:1;
-     uint8_t none1:1;
-     uint8_t none2:1;
-     uint8_t cpu_run:1;
-     uint8_t tint_low:1;
-     uint8_t tic_in_cpu:1;
-     uint8_t tic_in_bios:1;
-     uint8_t tic_busy:1;
- } tp_status_high_t;
- 
- typedef struct {
-     uint8_t pt_exist:1;
-     uint8_t gesture:1;
-     uint8_t key:1;
-     uint8_t aux:1;
-     uint8_t keep:1;
-     uint8_t raw_or_pt:1;
-     uint8_t none6:1;
-     uint8_t none7:1;
- } tp_status_low_t;
- 
- typedef struct {
-     tp_status_low_t status_low;
-     tp_status_high_t status_high;
-     uint16_t read_len;
- } tp_status_t;
- 
- typedef struct {
-     uint8_t status;
-     uint16_t next_packet_len;
- } tp_hdp_status_t;
- 
- // Global variables
- static SPD2010_Touch touch_data = {0};
- static uint8_t Touch_interrupts = 0;
- 
- // External function references
- extern mp_obj_t tca9554_set_exio(mp_obj_t pin_obj, mp_obj_t state_obj);
- extern mp_obj_t i2c_driver_read(mp_obj_t addr_obj, mp_obj_t reg_obj, mp_obj_t data_obj, mp_obj_t len_obj);
- extern mp_obj_t i2c_driver_write(mp_obj_t addr_obj, mp_obj_t reg_obj, mp_obj_t data_obj, mp_obj_t len_obj);
- 
- // Special I2C read for touch (16-bit register address)
- STATIC mp_obj_t spd2010_touch_read(mp_obj_t addr_obj, mp_obj_t reg_obj, mp_obj_t len_obj) {
-     uint8_t addr = mp_obj_get_int(addr_obj);
-     uint16_t reg = mp_obj_get_int(reg_obj);
-     uint32_t len = mp_obj_get_int(len_obj);
-     
-     // Prepare register address bytes
-     uint8_t reg_data[2] = {(uint8_t)(reg >> 8), (uint8_t)reg};
-     mp_obj_t reg_buf = mp_obj_new_bytearray(2, reg_data);
-     
-     // Prepare data buffer
-     uint8_t *data_buf_ptr = m_new(uint8_t, len);
-     mp_obj_t data_buf = mp_obj_new_bytearray(len, data_buf_ptr);
-     
-     // I2C write to set register address
-     mp_obj_t write_args[] = {
-         addr_obj,
-         mp_obj_new_int(0), // Dummy register, as we're sending the register in the data
-         reg_buf,
-         mp_obj_new_int(2)
-     };
-     mp_obj_t write_result = i2c_driver_write(write_args[0], write_args[1], write_args[2], write_args[3]);
-     
-     if (!mp_obj_is_true(write_result)) {
-         printf("The I2C transmission fails. - I2C Read Touch\r\n");
-         m_del(uint8_t, data_buf_ptr, len);
-         return mp_const_none;
-     }
-     
-     // I2C read to get data
-     mp_obj_t read_args[] = {
-         addr_obj,
-         mp_obj_new_int(0), // Dummy register, as we already set it
-         data_buf,
-         len_obj
-     };
-     mp_obj_t read_result = i2c_driver_read(read_args[0], read_args[1], read_args[2], read_args[3]);
-     
-     if (!mp_obj_is_true(read_result)) {
-         printf("The I2C transmission fails. - I2C Read Touch Data\r\n");
-         m_del(uint8_t, data_buf_ptr, len);
-         return mp_const_none;
-     }
-     
-     return data_buf;
- }
- 
- // Special I2C write for touch (16-bit register address)
- STATIC mp_obj_t spd2010_touch_write(mp_obj_t addr_obj, mp_obj_t reg_obj, mp_obj_t data_obj, mp_obj_t len_obj) {
-     uint8_t addr = mp_obj_get_int(addr_obj);
-     uint16_t reg = mp_obj_get_int(reg_obj);
-     uint32_t len = mp_obj_get_int(len_obj);
-     
-     // Get data buffer info
-     mp_buffer_info_t data_info;
-     mp_get_buffer_raise(data_obj, &data_info, MP_BUFFER_READ);
-     
-     // Create combined buffer: reg high byte, reg low byte, data...
-     uint8_t *combined_buf_ptr = m_new(uint8_t, 2 + len);
-     combined_buf_ptr[0] = (uint8_t)(reg >> 8);
-     combined_buf_ptr[1] = (uint8_t)reg;
-     memcpy(&combined_buf_ptr[2], data_info.buf, len);
-     
-     mp_obj_t combined_buf = mp_obj_new_bytearray(2 + len, combined_buf_ptr);
-     
-     // I2C write
-     mp_obj_t write_args[] = {
-         addr_obj,
-         mp_obj_new_int(0), // Dummy register, as we're sending the register in the data
-         combined_buf,
-         mp_obj_new_int(2 + len)
-     };
-     mp_obj_t write_result = i2c_driver_write(write_args[0], write_args[1], write_args[2], write_args[3]);
-     
-     m_del(uint8_t, combined_buf_ptr, 2 + len);
-     
-     if (!mp_obj_is_true(write_result)) {
-         printf("The I2C transmission fails. - I2C Write Touch\r\n");
-         return mp_obj_new_bool(false);
-     }
-     
-     return mp_obj_new_bool(true);
- }
- 
- // ISR for touch interrupt
- static void touch_isr_handler(void *arg) {
-     Touch_interrupts = true;
- }
- 
- // Initialize touch controller
- STATIC mp_obj_t spd2010_touch_init(void) {
-     // Reset touch controller
-     mp_obj_t reset_result = mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_touch_reset_obj));
-     
-     // Configure GPIO for touch interrupt
-     gpio_config_t io_conf = {
-         .mode = GPIO_MODE_INPUT,
-         .pull_up_en = GPIO_PULLUP_ENABLE,
-         .intr_type = GPIO_INTR_NEGEDGE,
-         .pin_bit_mask = (1ULL << EXAMPLE_PIN_NUM_TOUCH_INT),
-     };
-     gpio_config(&io_conf);
-     
-     // Install GPIO ISR service and add ISR handler
-     gpio_install_isr_service(0);
-     gpio_isr_handler_add(EXAMPLE_PIN_NUM_TOUCH_INT, touch_isr_handler, NULL);
-     
-     // Read touch configuration
-     // In a real implementation, you'd want to add the read_fw_version function here
-     
-     return mp_obj_new_int(1);
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_init_obj, spd2010_touch_init);
- 
- // Reset touch controller
- STATIC mp_obj_t spd2010_touch_reset(void) {
-     mp_obj_t args[] = {
-         mp_obj_new_int(1), // EXIO_PIN1
-         mp_obj_new_int(0)  // Low
-     };
-     tca9554_set_exio(args[0], args[1]);
-     mp_hal_delay_ms(50);
-     
-     args[1] = mp_obj_new_int(1); // High
-     tca9554_set_exio(args[0], args[1]);
-     mp_hal_delay_ms(50);
-     
-     return mp_obj_new_int(1);
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_reset_obj, spd2010_touch_reset);
- 
- // Write touch point mode command
- STATIC mp_obj_t spd2010_write_tp_point_mode_cmd(void) {
-     uint8_t data[2] = {0x00, 0x00};
-     mp_obj_t data_obj = mp_obj_new_bytearray(2, data);
-     
-     mp_obj_t args[] = {
-         mp_obj_new_int(SPD2010_ADDR),
-         mp_obj_new_int(0x5000),  // Command register
-         data_obj,
-         mp_obj_new_int(2)
-     };
-     
-     mp_obj_t result = spd2010_touch_write(args[0], args[1], args[2], args[3]);
-     mp_hal_delay_us(200);
-     
-     return result;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_point_mode_cmd_obj, spd2010_write_tp_point_mode_cmd);
- 
- // Write touch start command
- STATIC mp_obj_t spd2010_write_tp_start_cmd(void) {
-     uint8_t data[2] = {0x00, 0x00};
-     mp_obj_t data_obj = mp_obj_new_bytearray(2, data);
-     
-     mp_obj_t args[] = {
-         mp_obj_new_int(SPD2010_ADDR),
-         mp_obj_new_int(0x4600),  // Command register
-         data_obj,
-         mp_obj_new_int(2)
-     };
-     
-     mp_obj_t result = spd2010_touch_write(args[0], args[1], args[2], args[3]);
-     mp_hal_delay_us(200);
-     
-     return result;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_start_cmd_obj, spd2010_write_tp_start_cmd);
- 
- // Write touch CPU start command
- STATIC mp_obj_t spd2010_write_tp_cpu_start_cmd(void) {
-     uint8_t data[2] = {0x01, 0x00};
-     mp_obj_t data_obj = mp_obj_new_bytearray(2, data);
-     
-     mp_obj_t args[] = {
-         mp_obj_new_int(SPD2010_ADDR),
-         mp_obj_new_int(0x0400),  // Command register
-         data_obj,
-         mp_obj_new_int(2)
-     };
-     
-     mp_obj_t result = spd2010_touch_write(args[0], args[1], args[2], args[3]);
-     mp_hal_delay_us(200);
-     
-     return result;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_cpu_start_cmd_obj, spd2010_write_tp_cpu_start_cmd);
- 
- // Write touch clear interrupt command
- STATIC mp_obj_t spd2010_write_tp_clear_int_cmd(void) {
-     uint8_t data[2] = {0x01, 0x00};
-     mp_obj_t data_obj = mp_obj_new_bytearray(2, data);
-     
-     mp_obj_t args[] = {
-         mp_obj_new_int(SPD2010_ADDR),
-         mp_obj_new_int(0x0200),  // Command register
-         data_obj,
-         mp_obj_new_int(2)
-     };
-     
-     mp_obj_t result = spd2010_touch_write(args[0], args[1], args[2], args[3]);
-     mp_hal_delay_us(200);
-     
-     return result;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_clear_int_cmd_obj, spd2010_write_tp_clear_int_cmd);
- 
- // Read touch status length
- STATIC mp_obj_t spd2010_read_tp_status_length(void) {
-     mp_obj_t args[] = {
-         mp_obj_new_int(SPD2010_ADDR),
-         mp_obj_new_int(0x2000),  // Status register
-         mp_obj_new_int(4)        // Read 4 bytes
-     };
-     
-     mp_obj_t data = spd2010_touch_read(args[0], args[1], args[2]);
-     if (data == mp_const_none) {
-         return mp_const_none;
-     }
-     
-     // Extract data from buffer
-     mp_buffer_info_t buf_info;
-     mp_get_buffer_raise(data, &buf_info, MP_BUFFER_READ);
-     uint8_t *sample_data = (uint8_t *)buf_info.buf;
-     
-     // Create a status dictionary to return
-     mp_obj_t status_dict = mp_obj_new_dict(3);
-     
-     // Status low byte
-     uint8_t status_low = sample_data[0];
-     mp_obj_dict_store(status_dict, mp_obj_new_str("pt_exist", 8), 
-                      mp_obj_new_bool(status_low & 0x01));
-     mp_obj_dict_store(status_dict, mp_obj_new_str("gesture", 7), 
-                      mp_obj_new_bool(status_low & 0x02));
-     mp_obj_dict_store(status_dict, mp_obj_new_str("aux", 3), 
-                      mp_obj_new_bool(status_low & 0x08));
-     
-     // Status high byte
-     uint8_t status_high = sample_data[1];
-     mp_obj_dict_store(status_dict, mp_obj_new_str("tic_busy", 8), 
-                      mp_obj_new_bool(status_high & 0x80));
-     mp_obj_dict_store(status_dict, mp_obj_new_str("tic_in_bios", 11), 
-                      mp_obj_new_bool(status_high & 0x40));
-     mp_obj_dict_store(status_dict, mp_obj_new_str("tic_in_cpu", 10), 
-                      mp_obj_new_bool(status_high & 0x20));
-     mp_obj_dict_store(status_dict, mp_obj_new_str("tint_low", 8), 
-                      mp_obj_new_bool(status_high & 0x10));
-     mp_obj_dict_store(status_dict, mp_obj_new_str("cpu_run", 7), 
-                      mp_obj_new_bool(status_high & 0x08));
-     
-     // Read length
-     uint16_t read_len = (sample_data[3] << 8) | sample_data[2];
-     mp_obj_dict_store(status_dict, mp_obj_new_str("read_len", 8), 
-                      mp_obj_new_int(read_len));
-     
-     return status_dict;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_read_tp_status_length_obj, spd2010_read_tp_status_length);
- 
- // Read touch data
- STATIC mp_obj_t spd2010_tp_read_data(void) {
-     // Get touch status
-     mp_obj_t status_dict = mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_read_tp_status_length_obj));
-     
-     if (status_dict == mp_const_none) {
-         return mp_const_none;
-     }
-     
-     // Extract status information
-     mp_obj_t tic_in_bios = mp_obj_dict_get(status_dict, mp_obj_new_str("tic_in_bios", 11));
-     mp_obj_t tic_in_cpu = mp_obj_dict_get(status_dict, mp_obj_new_str("tic_in_cpu", 10));
-     mp_obj_t cpu_run = mp_obj_dict_get(status_dict, mp_obj_new_str("cpu_run", 7));
-     mp_obj_t read_len = mp_obj_dict_get(status_dict, mp_obj_new_str("read_len", 8));
-     mp_obj_t pt_exist = mp_obj_dict_get(status_dict, mp_obj_new_str("pt_exist", 8));
-     mp_obj_t gesture = mp_obj_dict_get(status_dict, mp_obj_new_str("gesture", 7));
-     mp_obj_t aux = mp_obj_dict_get(status_dict, mp_obj_new_str("aux", 3));
-     
-     // Process based on status
-     if (mp_obj_is_true(tic_in_bios)) {
-         // Clear interrupt
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_clear_int_cmd_obj));
-         // Start CPU
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_cpu_start_cmd_obj));
-     } 
-     else if (mp_obj_is_true(tic_in_cpu)) {
-         // Set point mode
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_point_mode_cmd_obj));
-         // Start touch
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_start_cmd_obj));
-         // Clear interrupt
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_clear_int_cmd_obj));
-     } 
-     else if (mp_obj_is_true(cpu_run) && mp_obj_get_int(read_len) == 0) {
-         // Just clear interrupt
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_clear_int_cmd_obj));
-     } 
-     else if (mp_obj_is_true(pt_exist) || mp_obj_is_true(gesture)) {
-         // Read touch point data - here we would parse the touch data
-         // This is complex and would need a more detailed implementation
-         
-         // For now, just clear interrupt
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_clear_int_cmd_obj));
-     } 
-     else if (mp_obj_is_true(cpu_run) && mp_obj_is_true(aux)) {
-         // Just clear interrupt
-         mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_write_tp_clear_int_cmd_obj));
-     }
-     
-     return mp_const_none;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_tp_read_data_obj, spd2010_tp_read_data);
- 
- // Read and process touch data
- STATIC mp_obj_t spd2010_touch_read_data(void) {
-     // Process touch data based on interrupts/status
-     mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_tp_read_data_obj));
-     
-     // In a full implementation, this would update the touch_data structure
-     
-     return mp_const_none;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_read_data_obj, spd2010_touch_read_data);
- 
- // Get touch coordinates
- STATIC mp_obj_t spd2010_touch_get_xy(void) {
-     // Read touch data
-     mp_call_function_0(MP_OBJ_FROM_PTR(&spd2010_touch_read_data_obj));
-     
-     // Prepare return dictionary
-     mp_obj_t dict = mp_obj_new_dict(3);
-     
-     // Get number of touch points (clipped to max supported)
-     uint8_t point_num = (touch_data.touch_num > CONFIG_ESP_LCD_TOUCH_MAX_POINTS) ? 
-                           CONFIG_ESP_LCD_TOUCH_MAX_POINTS : touch_data.touch_num;
-     
-     // Add data to dictionary
-     mp_obj_dict_store(dict, mp_obj_new_str("pressed", 7), mp_obj_new_bool(point_num > 0));
-     mp_obj_dict_store(dict, mp_obj_new_str("points", 6), mp_obj_new_int(point_num));
-     
-     // If we have touch points, add first point coordinates
-     if (point_num > 0) {
-         mp_obj_dict_store(dict, mp_obj_new_str("x", 1), mp_obj_new_int(touch_data.rpt[0].x));
-         mp_obj_dict_store(dict, mp_obj_new_str("y", 1), mp_obj_new_int(touch_data.rpt[0].y));
-         mp_obj_dict_store(dict, mp_obj_new_str("weight", 6), mp_obj_new_int(touch_data.rpt[0].weight));
-     } else {
-         mp_obj_dict_store(dict, mp_obj_new_str("x", 1), mp_obj_new_int(0));
-         mp_obj_dict_store(dict, mp_obj_new_str("y", 1), mp_obj_new_int(0));
-         mp_obj_dict_store(dict, mp_obj_new_str("weight", 6), mp_obj_new_int(0));
-     }
-     
-     // Clear available touch points count
-     touch_data.touch_num = 0;
-     
-     return dict;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_get_xy_obj, spd2010_touch_get_xy);
- 
- // Module globals table
- STATIC const mp_rom_map_elem_t spd2010_touch_module_globals_table[] = {
-     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_spd2010_touch) },
-     
-     // Constants
-     { MP_ROM_QSTR(MP_QSTR_SPD2010_ADDR), MP_ROM_INT(SPD2010_ADDR) },
-     { MP_ROM_QSTR(MP_QSTR_TOUCH_INT_PIN), MP_ROM_INT(EXAMPLE_PIN_NUM_TOUCH_INT) },
-     { MP_ROM_QSTR(MP_QSTR_MAX_TOUCH_POINTS), MP_ROM_INT(CONFIG_ESP_LCD_TOUCH_MAX_POINTS) },
-     
-     // Functions
-     { MP_ROM_QSTR(MP_QSTR_Touch_Init), MP_ROM_PTR(&spd2010_touch_init_obj) },
-     { MP_ROM_QSTR(MP_QSTR_SPD2010_Touch_Reset), MP_ROM_PTR(&spd2010_touch_reset_obj) },
-     { MP_ROM_QSTR(MP_QSTR_write_tp_point_mode_cmd), MP_ROM_PTR(&spd2010_write_tp_point_mode_cmd_obj) },
-     { MP_ROM_QSTR(MP_QSTR_write_tp_start_cmd), MP_ROM_PTR(&spd2010_write_tp_start_cmd_obj) },
-     { MP_ROM_QSTR(MP_QSTR_write_tp_cpu_start_cmd), MP_ROM_PTR(&spd2010_write_tp_cpu_start_cmd_obj) },
-     { MP_ROM_QSTR(MP_QSTR_write_tp_clear_int_cmd), MP_ROM_PTR(&spd2010_write_tp_clear_int_cmd_obj) },
-     { MP_ROM_QSTR(MP_QSTR_read_tp_status_length), MP_ROM_PTR(&spd2010_read_tp_status_length_obj) },
-     { MP_ROM_QSTR(MP_QSTR_tp_read_data), MP_ROM_PTR(&spd2010_tp_read_data_obj) },
-     { MP_ROM_QSTR(MP_QSTR_Touch_Read_Data), MP_ROM_PTR(&spd2010_touch_read_data_obj) },
-     { MP_ROM_QSTR(MP_QSTR_Touch_Get_xy), MP_ROM_PTR(&spd2010_touch_get_xy_obj) },
- };
- STATIC MP_DEFINE_CONST_DICT(spd2010_touch_module_globals, spd2010_touch_module_globals_table);
- 
- // Module definition
- const mp_obj_module_t spd2010_touch_user_cmodule = {
-     .base = { &mp_type_module },
-     .globals = (mp_obj_dict_t *)&spd2010_touch_module_globals,
- };
- 
- // Register the module
+/*
+ * SPD2010 Touch Driver implementation for MicroPython
+ * Adapted from Touch_SPD2010.cpp/.h from Arduino implementation
+ */
+
+ #include <string.h>
+ #include "py/obj.h"
+ #include "py/runtime.h"
+ #include "py/mphal.h"
+ #include "driver/gpio.h"
+ #include "esp_log.h"
+ #include "esp_rom_sys.h"
+ #include "esp_timer.h"
+ #include "freertos/FreeRTOS.h"
+ #include "freertos/semphr.h"
+ 
+ #define SPD2010_ADDR                0x53
+ #define EXAMPLE_PIN_NUM_TOUCH_INT   4
+ #define EXAMPLE_PIN_NUM_TOUCH_RST   (-1)
+ #define CONFIG_ESP_LCD_TOUCH_MAX_POINTS 5
+ 
+ // 16-bit registers, sent high byte first
+ #define SPD2010_REG_CLEAR_INT       0x0200
+ #define SPD2010_REG_CPU_START       0x0400
+ #define SPD2010_REG_TOUCH_START     0x4600
+ #define SPD2010_REG_POINT_MODE      0x5000
+ #define SPD2010_REG_STATUS          0x2000
+ #define SPD2010_REG_HDP             0x0003
+ #define SPD2010_REG_HDP_STATUS      0xFC02
+ 
+ // Longest HDP packet read: the header and 10 points
+ #define SPD2010_HDP_MAX_LEN         (4 + 6 * 10)
+ 
+ // Structures for touch data
+ typedef struct {
+     uint8_t id;
+     uint16_t x;
+     uint16_t y;
+     uint8_t weight;
+ } tp_report_t;
+ 
+ typedef struct {
+     tp_report_t rpt[10];
+     uint8_t touch_num;
+     uint8_t pack_code;
+     uint8_t down;
+     uint8_t up;
+     uint8_t gesture;
+     uint16_t down_x;
+     uint16_t down_y;
+     uint16_t up_x;
+     uint16_t up_y;
+ } SPD2010_Touch;
+ 
+ typedef struct {
+     uint8_t none0:1;
+     uint8_t none1:1;
+     uint8_t none2:1;
+     uint8_t cpu_run:1;
+     uint8_t tint_low:1;
+     uint8_t tic_in_cpu:1;
+     uint8_t tic_in_bios:1;
+     uint8_t tic_busy:1;
+ } tp_status_high_t;
+ 
+ typedef struct {
+     uint8_t pt_exist:1;
+     uint8_t gesture:1;
+     uint8_t key:1;
+     uint8_t aux:1;
+     uint8_t keep:1;
+     uint8_t raw_or_pt:1;
+     uint8_t none6:1;
+     uint8_t none7:1;
+ } tp_status_low_t;
+ 
+ typedef struct {
+     tp_status_low_t status_low;
+     tp_status_high_t status_high;
+     uint16_t read_len;
+ } tp_status_t;
+ 
+ typedef struct {
+     uint8_t status;
+     uint16_t next_packet_len;
+ } tp_hdp_status_t;
+ 
+ // Global variables
+ static SPD2010_Touch touch_data = {0};
+ static volatile uint8_t Touch_interrupts = 0;
+ static volatile int64_t Touch_irq_us = 0;     // esp_timer time of the last interrupt
+ static bool touch_initialized = false;
+ 
+ // Held over the register reads of one step, see touch_lock
+ static SemaphoreHandle_t touch_mutex = NULL;
+ 
+ // Touch of the last report, kept until the next one
+ static bool touch_pressed = false;
+ static uint16_t touch_x = 0;
+ static uint16_t touch_y = 0;
+ 
+ // Called from the touch ISR, e.g. to wake the LVGL loop
+ static void (*touch_isr_callback)(void *arg) = NULL;
+ static void *touch_isr_callback_arg = NULL;
+ 
+ // External function references
+ extern mp_obj_t tca9554_set_exio(mp_obj_t pin_obj, mp_obj_t state_obj);
+ extern bool i2c_driver_write_bytes(uint8_t driver_addr, const uint8_t *data, size_t length);
+ extern bool i2c_driver_read_bytes(uint8_t driver_addr, uint8_t *data, size_t length);
+ 
+ // Write a 16-bit register: its address and the data in one transfer
+ static bool touch_write_reg(uint16_t reg, const uint8_t *data, size_t len) {
+     uint8_t frame[2 + 2];
+     if (len > sizeof(frame) - 2) {
+         return false;
+     }
+     frame[0] = (uint8_t)(reg >> 8);
+     frame[1] = (uint8_t)reg;
+     memcpy(&frame[2], data, len);
+     
+     if (!i2c_driver_write_bytes(SPD2010_ADDR, frame, 2 + len)) {
+         printf("The I2C transmission fails. - I2C Write Touch\r\n");
+         return false;
+     }
+     return true;
+ }
+ 
+ // Read a 16-bit register: its address alone sets the pointer, then the read
+ static bool touch_read_reg(uint16_t reg, uint8_t *buf, size_t len) {
+     uint8_t addr[2] = {(uint8_t)(reg >> 8), (uint8_t)reg};
+     
+     if (!i2c_driver_write_bytes(SPD2010_ADDR, addr, 2)) {
+         printf("The I2C transmission fails. - I2C Read Touch\r\n");
+         return false;
+     }
+     if (!i2c_driver_read_bytes(SPD2010_ADDR, buf, len)) {
+         printf("The I2C transmission fails. - I2C Read Touch Data\r\n");
+         return false;
+     }
+     return true;
+ }
+ 
+ // Command: the register and two data bytes, then the 200 us the controller needs
+ static bool touch_command(uint16_t reg, uint8_t arg) {
+     uint8_t data[2] = {arg, 0x00};
+     bool ok = touch_write_reg(reg, data, 2);
+     esp_rom_delay_us(200);
+     return ok;
+ }
+ 
+ static bool touch_read_status(tp_status_t *status) {
+     uint8_t sample_data[4];
+     if (!touch_read_reg(SPD2010_REG_STATUS, sample_data, 4)) {
+         return false;
+     }
+     memcpy(&status->status_low, &sample_data[0], 1);
+     memcpy(&status->status_high, &sample_data[1], 1);
+     status->read_len = (sample_data[3] << 8) | sample_data[2];
+     return true;
+ }
+ 
+ static bool touch_read_hdp_status(tp_hdp_status_t *hdp_status) {
+     uint8_t sample_data[8];
+     if (!touch_read_reg(SPD2010_REG_HDP_STATUS, sample_data, 8)) {
+         return false;
+     }
+     hdp_status->status = sample_data[5];
+     hdp_status->next_packet_len = sample_data[2] | (sample_data[3] << 8);
+     return true;
+ }
+ 
+ // Read an HDP packet of len bytes into touch_data: 4 header bytes, then 6
+ // bytes a point, or a gesture
+ static bool touch_read_hdp(uint16_t len) {
+     uint8_t sample_data[SPD2010_HDP_MAX_LEN];
+     if (len < 4 || len > sizeof(sample_data)) {
+         return false;
+     }
+     if (!touch_read_reg(SPD2010_REG_HDP, sample_data, len)) {
+         return false;
+     }
+     
+     touch_data.touch_num = 0x00;
+     touch_data.gesture = 0x00;
+     if (len > 4) {
+         uint8_t check_id = sample_data[4];
+         if (check_id <= 0x0A) {
+             touch_data.touch_num = (len - 4) / 6;
+             for (int i = 0; i < touch_data.touch_num; i++) {
+                 uint8_t *point = &sample_data[4 + 6 * i];
+                 touch_data.rpt[i].id = point[0];
+                 touch_data.rpt[i].x = ((point[3] & 0xF0) << 4) | point[1];
+                 touch_data.rpt[i].y = ((point[3] & 0x0F) << 8) | point[2];
+                 touch_data.rpt[i].weight = point[4];
+             }
+         } else if (check_id == 0xF6) {
+             touch_data.gesture = sample_data[6] & 0x07;
+         }
+     }
+     
+     // A report without points is the release
+     touch_pressed = touch_data.touch_num > 0;
+     if (touch_pressed) {
+         touch_x = touch_data.rpt[0].x;
+         touch_y = touch_data.rpt[0].y;
+     }
+     return true;
+ }
+ 
+ // A register read is two transfers, the address and then the data. The
+ // lvgl_driver input device reads from its native task, without the GIL, so
+ // Python callers take the mutex too or could move the register pointer in
+ // between. Created by Touch_Init, before that no task reads
+ static void touch_lock(void) {
+     if (touch_mutex != NULL) {
+         xSemaphoreTake(touch_mutex, portMAX_DELAY);
+     }
+ }
+ 
+ static void touch_unlock(void) {
+     if (touch_mutex != NULL) {
+         xSemaphoreGive(touch_mutex);
+     }
+ }
+ 
+ // One step of the controller's protocol, chosen from its status: the start
+ // up from BIOS to point mode, or reading a report, then clearing the interrupt.
+ // Called with the touch lock held
+ static bool touch_step(void) {
+     tp_status_t status;
+     if (!touch_read_status(&status)) {
+         return false;
+     }
+     
+     if (status.status_high.tic_in_bios) {
+         touch_command(SPD2010_REG_CLEAR_INT, 0x01);
+         touch_command(SPD2010_REG_CPU_START, 0x01);
+     } else if (status.status_high.tic_in_cpu) {
+         touch_command(SPD2010_REG_POINT_MODE, 0x00);
+         touch_command(SPD2010_REG_TOUCH_START, 0x00);
+         touch_command(SPD2010_REG_CLEAR_INT, 0x01);
+     } else if (status.status_high.cpu_run && status.read_len == 0) {
+         touch_command(SPD2010_REG_CLEAR_INT, 0x01);
+     } else if (status.status_low.pt_exist || status.status_low.gesture) {
+         if (!touch_read_hdp(status.read_len)) {
+             return false;
+         }
+         // Packets still to come are read and dropped until the controller is done
+         for (int i = 0; i < 4; i++) {
+             tp_hdp_status_t hdp_status;
+             if (!touch_read_hdp_status(&hdp_status)) {
+                 return false;
+             }
+             if (hdp_status.status == 0x82) {
+                 touch_command(SPD2010_REG_CLEAR_INT, 0x01);
+                 break;
+             }
+             if (hdp_status.status != 0x00 || hdp_status.next_packet_len == 0 ||
+                 hdp_status.next_packet_len > SPD2010_HDP_MAX_LEN) {
+                 break;
+             }
+             uint8_t remain[SPD2010_HDP_MAX_LEN];
+             touch_read_reg(SPD2010_REG_HDP, remain, hdp_status.next_packet_len);
+         }
+     } else if (status.status_high.cpu_run && status.status_low.aux) {
+         touch_command(SPD2010_REG_CLEAR_INT, 0x01);
+     }
+     return true;
+ }
+ 
+ static bool touch_process(void) {
+     touch_lock();
+     bool ok = touch_step();
+     touch_unlock();
+     return ok;
+ }
+ 
+ // Latest touch, true while pressed. The controller is read only when it
+ // asks for it, by its interrupt or the line still low. Plain C without
+ // MicroPython objects: the lvgl_driver input device calls it, also from its
+ // native task
+ bool spd2010_touch_read_xy(uint16_t *x, uint16_t *y) {
+     touch_lock();
+     if (touch_initialized && (Touch_interrupts || gpio_get_level(EXAMPLE_PIN_NUM_TOUCH_INT) == 0)) {
+         Touch_interrupts = false;
+         touch_step();
+     }
+     *x = touch_x;
+     *y = touch_y;
+     bool pressed = touch_pressed;
+     touch_unlock();
+     return pressed;
+ }
+ 
+ // ISR for touch interrupt
+ static void touch_isr_handler(void *arg) {
+     Touch_interrupts = true;
+     Touch_irq_us = esp_timer_get_time();
+     if (touch_isr_callback != NULL) {
+         touch_isr_callback(touch_isr_callback_arg);
+     }
+ }
+ 
+ // Set a function for the touch ISR to call, NULL removes it. It runs in interrupt context
+ void spd2010_touch_set_isr_callback(void (*callback)(void *arg), void *arg) {
+     // Cleared first so the ISR never calls the old function with the new argument
+     touch_isr_callback = NULL;
+     touch_isr_callback_arg = arg;
+     touch_isr_callback = callback;
+ }
+ 
+ // Time of the last touch interrupt, 0 before the first one. Tags the samples
+ // of the lvgl_driver latency histogram
+ int64_t spd2010_touch_irq_us(void) {
+     return Touch_irq_us;
+ }
+ 
+ STATIC mp_obj_t spd2010_touch_reset(void);
+ 
+ // Initialize touch controller
+ STATIC mp_obj_t spd2010_touch_init(void) {
+     if (touch_mutex == NULL) {
+         touch_mutex = xSemaphoreCreateMutex();
+         if (touch_mutex == NULL) {
+             printf("Failed to create the touch lock\r\n");
+             return mp_obj_new_int(0);
+         }
+     }
+     
+     // Reset touch controller
+     spd2010_touch_reset();
+     
+     // Configure GPIO for touch interrupt
+     gpio_config_t io_conf = {
+         .mode = GPIO_MODE_INPUT,
+         .pull_up_en = GPIO_PULLUP_ENABLE,
+         .intr_type = GPIO_INTR_NEGEDGE,
+         .pin_bit_mask = (1ULL << EXAMPLE_PIN_NUM_TOUCH_INT),
+     };
+     gpio_config(&io_conf);
+     
+     // Install GPIO ISR service and add ISR handler
+     gpio_install_isr_service(0);
+     gpio_isr_handler_add(EXAMPLE_PIN_NUM_TOUCH_INT, touch_isr_handler, NULL);
+     
+     touch_pressed = false;
+     touch_initialized = true;
+     
+     // Read touch configuration
+     // In a real implementation, you'd want to add the read_fw_version function here
+     
+     return mp_obj_new_int(1);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_init_obj, spd2010_touch_init);
+ 
+ // Reset touch controller
+ STATIC mp_obj_t spd2010_touch_reset(void) {
+     mp_obj_t args[] = {
+         mp_obj_new_int(1), // EXIO_PIN1
+         mp_obj_new_int(0)  // Low
+     };
+     tca9554_set_exio(args[0], args[1]);
+     mp_hal_delay_ms(50);
+     
+     args[1] = mp_obj_new_int(1); // High
+     tca9554_set_exio(args[0], args[1]);
+     mp_hal_delay_ms(50);
+     
+     return mp_obj_new_int(1);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_reset_obj, spd2010_touch_reset);
+ 
+ // Write touch point mode command
+ STATIC mp_obj_t spd2010_write_tp_point_mode_cmd(void) {
+     return mp_obj_new_bool(touch_command(SPD2010_REG_POINT_MODE, 0x00));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_point_mode_cmd_obj, spd2010_write_tp_point_mode_cmd);
+ 
+ // Write touch start command
+ STATIC mp_obj_t spd2010_write_tp_start_cmd(void) {
+     return mp_obj_new_bool(touch_command(SPD2010_REG_TOUCH_START, 0x00));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_start_cmd_obj, spd2010_write_tp_start_cmd);
+ 
+ // Write touch CPU start command
+ STATIC mp_obj_t spd2010_write_tp_cpu_start_cmd(void) {
+     return mp_obj_new_bool(touch_command(SPD2010_REG_CPU_START, 0x01));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_cpu_start_cmd_obj, spd2010_write_tp_cpu_start_cmd);
+ 
+ // Write touch clear interrupt command
+ STATIC mp_obj_t spd2010_write_tp_clear_int_cmd(void) {
+     return mp_obj_new_bool(touch_command(SPD2010_REG_CLEAR_INT, 0x01));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_write_tp_clear_int_cmd_obj, spd2010_write_tp_clear_int_cmd);
+ 
+ // Read touch status length
+ STATIC mp_obj_t spd2010_read_tp_status_length(void) {
+     tp_status_t status;
+     touch_lock();
+     bool ok = touch_read_status(&status);
+     touch_unlock();
+     if (!ok) {
+         return mp_const_none;
+     }
+     
+     // Create a status dictionary to return
+     mp_obj_t status_dict = mp_obj_new_dict(9);
+     
+     // Status low byte
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_pt_exist), mp_obj_new_bool(status.status_low.pt_exist));
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_gesture), mp_obj_new_bool(status.status_low.gesture));
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_aux), mp_obj_new_bool(status.status_low.aux));
+     
+     // Status high byte
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_tic_busy), mp_obj_new_bool(status.status_high.tic_busy));
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_tic_in_bios), mp_obj_new_bool(status.status_high.tic_in_bios));
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_tic_in_cpu), mp_obj_new_bool(status.status_high.tic_in_cpu));
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_tint_low), mp_obj_new_bool(status.status_high.tint_low));
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_cpu_run), mp_obj_new_bool(status.status_high.cpu_run));
+     
+     // Read length
+     mp_obj_dict_store(status_dict, MP_OBJ_NEW_QSTR(MP_QSTR_read_len), mp_obj_new_int(status.read_len));
+     
+     return status_dict;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_read_tp_status_length_obj, spd2010_read_tp_status_length);
+ 
+ // Read touch data: one step of the start up or one report, see touch_process
+ STATIC mp_obj_t spd2010_tp_read_data(void) {
+     touch_process();
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_tp_read_data_obj, spd2010_tp_read_data);
+ 
+ // Read and process touch data
+ STATIC mp_obj_t spd2010_touch_read_data(void) {
+     Touch_interrupts = false;
+     touch_process();
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_read_data_obj, spd2010_touch_read_data);
+ 
+ // Get touch coordinates of the last report, read first
+ STATIC mp_obj_t spd2010_touch_get_xy(void) {
+     // The report is copied with the lock still held, the native task may read the next
+     touch_lock();
+     Touch_interrupts = false;
+     touch_step();
+     bool pressed = touch_pressed;
+     tp_report_t first = touch_data.rpt[0];
+     
+     // Get number of touch points (clipped to max supported)
+     uint8_t point_num = (touch_data.touch_num > CONFIG_ESP_LCD_TOUCH_MAX_POINTS) ? 
+                           CONFIG_ESP_LCD_TOUCH_MAX_POINTS : touch_data.touch_num;
+     touch_unlock();
+     
+     // Prepare return dictionary
+     mp_obj_t dict = mp_obj_new_dict(5);
+     
+     // Add data to dictionary
+     mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_pressed), mp_obj_new_bool(pressed));
+     mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_points), mp_obj_new_int(point_num));
+     
+     // If we have touch points, add first point coordinates
+     if (point_num > 0) {
+         mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_x), mp_obj_new_int(first.x));
+         mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_y), mp_obj_new_int(first.y));
+         mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_weight), mp_obj_new_int(first.weight));
+     } else {
+         mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_x), mp_obj_new_int(0));
+         mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_y), mp_obj_new_int(0));
+         mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_weight), mp_obj_new_int(0));
+     }
+     
+     return dict;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_touch_get_xy_obj, spd2010_touch_get_xy);
+ 
+ // Module globals table
+ STATIC const mp_rom_map_elem_t spd2010_touch_module_globals_table[] = {
+     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_spd2010_touch) },
+     
+     // Constants
+     { MP_ROM_QSTR(MP_QSTR_SPD2010_ADDR), MP_ROM_INT(SPD2010_ADDR) },
+     { MP_ROM_QSTR(MP_QSTR_TOUCH_INT_PIN), MP_ROM_INT(EXAMPLE_PIN_NUM_TOUCH_INT) },
+     { MP_ROM_QSTR(MP_QSTR_MAX_TOUCH_POINTS), MP_ROM_INT(CONFIG_ESP_LCD_TOUCH_MAX_POINTS) },
+     
+     // Functions
+     { MP_ROM_QSTR(MP_QSTR_Touch_Init), MP_ROM_PTR(&spd2010_touch_init_obj) },
+     { MP_ROM_QSTR(MP_QSTR_SPD2010_Touch_Reset), MP_ROM_PTR(&spd2010_touch_reset_obj) },
+     { MP_ROM_QSTR(MP_QSTR_write_tp_point_mode_cmd), MP_ROM_PTR(&spd2010_write_tp_point_mode_cmd_obj) },
+     { MP_ROM_QSTR(MP_QSTR_write_tp_start_cmd), MP_ROM_PTR(&spd2010_write_tp_start_cmd_obj) },
+     { MP_ROM_QSTR(MP_QSTR_write_tp_cpu_start_cmd), MP_ROM_PTR(&spd2010_write_tp_cpu_start_cmd_obj) },
+     { MP_ROM_QSTR(MP_QSTR_write_tp_clear_int_cmd), MP_ROM_PTR(&spd2010_write_tp_clear_int_cmd_obj) },
+     { MP_ROM_QSTR(MP_QSTR_read_tp_status_length), MP_ROM_PTR(&spd2010_read_tp_status_length_obj) },
+     { MP_ROM_QSTR(MP_QSTR_tp_read_data), MP_ROM_PTR(&spd2010_tp_read_data_obj) },
+     { MP_ROM_QSTR(MP_QSTR_Touch_Read_Data), MP_ROM_PTR(&spd2010_touch_read_data_obj) },
+     { MP_ROM_QSTR(MP_QSTR_Touch_Get_xy), MP_ROM_PTR(&spd2010_touch_get_xy_obj) },
+ };
+ STATIC MP_DEFINE_CONST_DICT(spd2010_touch_module_globals, spd2010_touch_module_globals_table);
+ 
+ // Module definition
+ const mp_obj_module_t spd2010_touch_user_cmodule = {
+     .base = { &mp_type_module },
+     .globals = (mp_obj_dict_t *)&spd2010_touch_module_globals,
+ };
+ 
+ // Register the module
  MP_REGISTER_MODULE(MP_QSTR_spd2010_touch, spd2010_touch_user_cmodule);
\ No newline at end of file
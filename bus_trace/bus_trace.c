@@ -0,0 +1,237 @@
+/*
+ * Bus transaction tracer for MicroPython
+ * Records the panel (QSPI) and I2C transactions of the other modules and
+ * exports them as a Chrome trace, which Perfetto and chrome://tracing open.
+ * Only built with the BUS_TRACE option, the hooks compile to nothing without
+ */
+
+#include <stdio.h>
+#include "py/obj.h"
+#include "py/runtime.h"
+#include "py/stream.h"
+#include "py/mperrno.h"
+#include "esp_heap_caps.h"
+#include "bus_trace_ring.h"
+
+#define TRACE_DEFAULT_EVENTS    1024
+#define TRACE_MAX_EVENTS        65536
+#define TRACE_PID               1
+#define TRACE_TID_PANEL         1
+#define TRACE_TID_I2C           2
+
+// Written by the done interrupt too, so in internal RAM. Kept after stop
+// until the next start, transfers in flight may still complete into it
+static bus_trace_event_t *ring_buf = NULL;
+static uint32_t ring_events = 0;
+
+typedef struct {
+    uint8_t cmd;
+    const char *name;
+} cmd_name_t;
+
+STATIC const cmd_name_t panel_cmd_names[] = {
+    { 0x00, "NOP" },
+    { 0x01, "SWRESET" },
+    { 0x10, "SLPIN" },
+    { 0x11, "SLPOUT" },
+    { 0x20, "INVOFF" },
+    { 0x21, "INVON" },
+    { 0x28, "DISPOFF" },
+    { 0x29, "DISPON" },
+    { 0x2A, "CASET" },
+    { 0x2B, "RASET" },
+    { 0x2C, "RAMWR" },
+    { 0x33, "VSCRDEF" },
+    { 0x35, "TEON" },
+    { 0x36, "MADCTL" },
+    { 0x37, "VSCSAD" },
+    { 0x3A, "COLMOD" },
+    { 0x3C, "RAMWRC" },
+    { 0xFF, "PAGE" },
+};
+
+STATIC const char *panel_cmd_name(uint8_t cmd) {
+    for (size_t i = 0; i < MP_ARRAY_SIZE(panel_cmd_names); i++) {
+        if (panel_cmd_names[i].cmd == cmd) {
+            return panel_cmd_names[i].name;
+        }
+    }
+    return NULL;
+}
+
+STATIC uint32_t round_up_pow2(uint32_t n) {
+    uint32_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+// Start recording, the previous trace is dropped: start(capacity=1024, wrap=True)
+// capacity is rounded up to a power of two. wrap keeps the newest events,
+// without it recording stops when the ring is full
+STATIC mp_obj_t bus_trace_start_(size_t n_args, const mp_obj_t *args) {
+    mp_int_t capacity = (n_args > 0) ? mp_obj_get_int(args[0]) : TRACE_DEFAULT_EVENTS;
+    bool wrap = (n_args > 1) ? mp_obj_is_true(args[1]) : true;
+    if (capacity < 1 || capacity > TRACE_MAX_EVENTS) {
+        mp_raise_ValueError(MP_ERROR_TEXT("capacity out of range"));
+    }
+    uint32_t events = round_up_pow2(capacity);
+
+    bus_trace_event_t *old = NULL;
+    if (events != ring_events) {
+        bus_trace_event_t *buf = heap_caps_malloc(events * sizeof(bus_trace_event_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (buf == NULL) {
+            printf("Failed to allocate %d trace events\r\n", (int)events);
+            return mp_const_false;
+        }
+        old = ring_buf;
+        ring_buf = buf;
+        ring_events = events;
+    }
+    bool ok = bus_trace_start(ring_buf, ring_events, wrap);
+    heap_caps_free(old);
+    return mp_obj_new_bool(ok);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bus_trace_start_obj, 0, 2, bus_trace_start_);
+
+// Stop recording, the events stay for export: stop()
+STATIC mp_obj_t bus_trace_stop_(void) {
+    bus_trace_stop();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bus_trace_stop_obj, bus_trace_stop_);
+
+// Counters of the current trace: stats() -> dict
+STATIC mp_obj_t bus_trace_stats_(void) {
+    bus_trace_stats_t s;
+    bus_trace_get_stats(&s);
+
+    mp_obj_t stats = mp_obj_new_dict(0);
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_active), mp_obj_new_bool(s.active));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_wrap), mp_obj_new_bool(s.wrap));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_capacity), mp_obj_new_int_from_uint(s.capacity));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_recorded), mp_obj_new_int_from_uint(s.recorded));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_dropped), mp_obj_new_int_from_uint(s.dropped));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_panel_param), mp_obj_new_int_from_uint(s.ops[BUS_TRACE_PANEL_PARAM]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_panel_color), mp_obj_new_int_from_uint(s.ops[BUS_TRACE_PANEL_COLOR]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_i2c_write), mp_obj_new_int_from_uint(s.ops[BUS_TRACE_I2C_WRITE]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_i2c_read), mp_obj_new_int_from_uint(s.ops[BUS_TRACE_I2C_READ]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_panel_bytes),
+        mp_obj_new_int_from_ull(s.bytes[BUS_TRACE_PANEL_PARAM] + s.bytes[BUS_TRACE_PANEL_COLOR]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_i2c_bytes),
+        mp_obj_new_int_from_ull(s.bytes[BUS_TRACE_I2C_WRITE] + s.bytes[BUS_TRACE_I2C_READ]));
+    return stats;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(bus_trace_stats_obj, bus_trace_stats_);
+
+// mp_stream_write raises on errors itself, None is a stream that would block
+STATIC void write_str(mp_obj_t stream, const char *buf, size_t len) {
+    if (mp_stream_write(stream, buf, len, MP_STREAM_RW_WRITE) == mp_const_none) {
+        mp_raise_OSError(MP_EIO);
+    }
+}
+
+// One complete ("X") event. Color transfers still in flight have no end, they
+// are written with zero duration and marked open
+STATIC int format_event(char *buf, size_t size, const bus_trace_event_t *e) {
+    uint32_t dur = (e->end_us >= e->start_us) ? e->end_us - e->start_us : 0;
+
+    if (e->op == BUS_TRACE_I2C_WRITE || e->op == BUS_TRACE_I2C_READ) {
+        const char *dir = (e->op == BUS_TRACE_I2C_WRITE) ? "write" : "read";
+        return snprintf(buf, size,
+            "{\"name\":\"%s 0x%02X\",\"cat\":\"i2c\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"pid\":%d,\"tid\":%d,"
+            "\"args\":{\"addr\":\"0x%02X\",\"reg\":\"0x%02X\",\"len\":%u}}",
+            dir, (unsigned)(e->cmd >> 8), (unsigned)e->start_us, (unsigned)dur, TRACE_PID, TRACE_TID_I2C,
+            (unsigned)(e->cmd >> 8), (unsigned)(e->cmd & 0xFF), (unsigned)e->len);
+    }
+
+    // QSPI command words carry the opcode in the top byte and the command in the second
+    uint8_t opcode = e->cmd >> 24;
+    uint8_t cmd = opcode ? (e->cmd >> 8) & 0xFF : e->cmd & 0xFF;
+    const char *name = panel_cmd_name(cmd);
+    char unknown[8];
+    if (name == NULL) {
+        snprintf(unknown, sizeof(unknown), "0x%02X", cmd);
+        name = unknown;
+    }
+    bool color = (e->op == BUS_TRACE_PANEL_COLOR);
+    return snprintf(buf, size,
+        "{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%u,\"dur\":%u,\"pid\":%d,\"tid\":%d,"
+        "\"args\":{\"opcode\":\"0x%02X\",\"cmd\":\"0x%02X\",\"len\":%u,\"queued_us\":%u%s}}",
+        name, color ? "color" : "param", (unsigned)e->start_us, (unsigned)dur, TRACE_PID, TRACE_TID_PANEL,
+        opcode, cmd, (unsigned)e->len, (unsigned)e->queued_us, (color && e->end_us == 0) ? ",\"open\":true" : "");
+}
+
+// Write the trace as Chrome trace JSON: export(stream) -> events written
+// Stop first for a complete trace, a running one is exported as far as it got
+STATIC mp_obj_t bus_trace_export(mp_obj_t stream_obj) {
+    static const char header[] =
+        "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"buses\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"QSPI panel\"}},\n"
+        "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"I2C\"}}";
+    static const char footer[] = "\n]}\n";
+    char line[256];
+
+    write_str(stream_obj, header, sizeof(header) - 1);
+    uint32_t pos = 0;
+    uint32_t count = 0;
+    bus_trace_event_t e;
+    while (bus_trace_next(&pos, &e)) {
+        line[0] = ',';
+        line[1] = '\n';
+        int len = format_event(line + 2, sizeof(line) - 2, &e);
+        if (len > (int)sizeof(line) - 3) {
+            len = sizeof(line) - 3;
+        }
+        write_str(stream_obj, line, len + 2);
+        count++;
+    }
+    write_str(stream_obj, footer, sizeof(footer) - 1);
+    return mp_obj_new_int_from_uint(count);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(bus_trace_export_obj, bus_trace_export);
+
+// Cost of a hook while tracing, in ns per transaction: overhead(count=1024)
+// Not while tracing, the current trace is dropped
+STATIC mp_obj_t bus_trace_overhead(size_t n_args, const mp_obj_t *args) {
+    mp_int_t count = (n_args > 0) ? mp_obj_get_int(args[0]) : TRACE_DEFAULT_EVENTS;
+    if (count < 1 || count > TRACE_MAX_EVENTS) {
+        mp_raise_ValueError(MP_ERROR_TEXT("count out of range"));
+    }
+    if (bus_trace_active()) {
+        printf("Stop the trace first\r\n");
+        return mp_const_none;
+    }
+    uint32_t events = round_up_pow2(count);
+    bus_trace_event_t *scratch = heap_caps_malloc(events * sizeof(bus_trace_event_t), MALLOC_CAP_8BIT);
+    if (scratch == NULL) {
+        printf("Failed to allocate %d trace events\r\n", (int)events);
+        return mp_const_none;
+    }
+    uint32_t ns = bus_trace_measure_overhead(scratch, events);
+    heap_caps_free(scratch);
+    return mp_obj_new_int_from_uint(ns);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(bus_trace_overhead_obj, 0, 1, bus_trace_overhead);
+
+// Module globals table
+STATIC const mp_rom_map_elem_t bus_trace_module_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_bus_trace) },
+    { MP_ROM_QSTR(MP_QSTR_start), MP_ROM_PTR(&bus_trace_start_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stop), MP_ROM_PTR(&bus_trace_stop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stats), MP_ROM_PTR(&bus_trace_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_export), MP_ROM_PTR(&bus_trace_export_obj) },
+    { MP_ROM_QSTR(MP_QSTR_overhead), MP_ROM_PTR(&bus_trace_overhead_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(bus_trace_module_globals, bus_trace_module_globals_table);
+
+// Module definition
+const mp_obj_module_t bus_trace_user_cmodule = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t *)&bus_trace_module_globals,
+};
+
+// Register module
+MP_REGISTER_MODULE(MP_QSTR_bus_trace, bus_trace_user_cmodule);
@@ -0,0 +1,43 @@
+/*
+ * Bus transaction recorder, platform layer
+ * The clock and the placement of the interrupt path. On ESP-IDF esp_timer and
+ * IRAM; elsewhere a monotonic clock, or the one set with bus_trace_set_clock
+ */
+
+#ifndef BUS_TRACE_PORT_H
+#define BUS_TRACE_PORT_H
+
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+
+#include "esp_attr.h"
+#include "esp_timer.h"
+
+// Called from the transfer done interrupt, which runs with the cache disabled
+#define BUS_TRACE_IRAM_ATTR     IRAM_ATTR
+#define BUS_TRACE_TIME_US()     esp_timer_get_time()
+
+#else
+
+#include <time.h>
+
+#define BUS_TRACE_IRAM_ATTR
+
+// Microseconds from a monotonic clock, NULL restores CLOCK_MONOTONIC
+typedef int64_t (*bus_trace_clock_t)(void);
+void bus_trace_set_clock(bus_trace_clock_t clock);
+
+extern bus_trace_clock_t bus_trace_clock;
+
+static inline int64_t bus_trace_monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#define BUS_TRACE_TIME_US()     (bus_trace_clock ? bus_trace_clock() : bus_trace_monotonic_us())
+
+#endif // ESP_PLATFORM
+
+#endif // BUS_TRACE_PORT_H
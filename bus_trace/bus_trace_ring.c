@@ -0,0 +1,273 @@
+/*
+ * Bus transaction recorder
+ *
+ * Writers claim a slot with an atomic increment of the head and publish it by
+ * storing its sequence number last, so the panel tasks, the I2C callers and
+ * the transfer done interrupt record without a lock. A reader takes an event
+ * only when its sequence number is the expected one before and after the
+ * copy; slots overwritten in between are skipped.
+ *
+ * Times are those on the wire as far as the CPU can tell. Parameters are sent
+ * blocking once the queued color transfers are out, so they start at the
+ * later of the call and the end of the last color transfer. Color transfers
+ * are queued and sent one after the other: each starts at the later of its
+ * queueing and the end of the one before and ends in the done interrupt.
+ * Every color transfer is counted, traced or not, to pair the interrupts with
+ * the transfers they belong to. The panel driver is called from one task at a
+ * time, the begin/failed hooks rely on that.
+ */
+
+#include <string.h>
+#include "bus_trace_ring.h"
+#include "bus_trace_port.h"
+
+// Color transfers in flight, more than the panel IO queue depth
+#define PENDING_LEN         32
+
+typedef struct {
+    uint32_t index;         // color transfer number
+    uint32_t claim;         // event claim number + 1, 0: not traced
+    uint32_t queued_us;
+    uint32_t gen;           // trace the event belongs to
+} pending_t;
+
+static bus_trace_event_t *ring = NULL;
+static uint32_t mask = 0;
+static bool wrap = true;
+static volatile bool active = false;
+static volatile uint32_t gen = 0;
+static int64_t base_us = 0;
+static uint32_t head = 0;               // claims since start
+static uint32_t refused = 0;
+static uint32_t ops[BUS_TRACE_OP_COUNT];
+static uint64_t bytes[BUS_TRACE_OP_COUNT];
+
+static pending_t pending[PENDING_LEN];
+static uint32_t pending_head = 0;       // written by the panel task
+static uint32_t pending_tail = 0;       // written by the done interrupt
+static uint32_t color_queued = 0;
+static uint32_t color_done = 0;
+static volatile uint32_t last_color_end = 0;
+
+#ifndef ESP_PLATFORM
+bus_trace_clock_t bus_trace_clock = NULL;
+
+void bus_trace_set_clock(bus_trace_clock_t clock) {
+    bus_trace_clock = clock;
+}
+#endif
+
+uint32_t BUS_TRACE_IRAM_ATTR bus_trace_now(void) {
+    if (!active) {
+        return 0;
+    }
+    return (uint32_t)(BUS_TRACE_TIME_US() - base_us);
+}
+
+bool bus_trace_active(void) {
+    return active;
+}
+
+bool bus_trace_start(bus_trace_event_t *events, uint32_t capacity, bool wrap_around) {
+    if (events == NULL || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return false;
+    }
+    active = false;
+    gen++;
+    memset(events, 0, capacity * sizeof(bus_trace_event_t));
+    ring = events;
+    mask = capacity - 1;
+    wrap = wrap_around;
+    head = 0;
+    refused = 0;
+    memset(ops, 0, sizeof(ops));
+    memset(bytes, 0, sizeof(bytes));
+    last_color_end = 0;
+    // Time 0 marks a missing timestamp, the trace starts at 1 us
+    base_us = BUS_TRACE_TIME_US() - 1;
+    __atomic_store_n(&active, true, __ATOMIC_RELEASE);
+    return true;
+}
+
+void bus_trace_stop(void) {
+    active = false;
+}
+
+// NULL when the ring is full and does not wrap
+static bus_trace_event_t *claim_slot(uint32_t *claim) {
+    uint32_t n = __atomic_fetch_add(&head, 1, __ATOMIC_RELAXED);
+    if (!wrap && n > mask) {
+        __atomic_fetch_add(&refused, 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    bus_trace_event_t *e = &ring[n & mask];
+    __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+    *claim = n;
+    return e;
+}
+
+static void publish(bus_trace_event_t *e, uint32_t claim) {
+    __atomic_fetch_add(&ops[e->op], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&bytes[e->op], e->len, __ATOMIC_RELAXED);
+    __atomic_store_n(&e->seq, claim + 1, __ATOMIC_RELEASE);
+}
+
+void bus_trace_record(bus_trace_op_t op, uint32_t cmd, size_t len, uint32_t start_us) {
+    if (!active) {
+        return;
+    }
+    uint32_t end = bus_trace_now();
+    if (start_us == 0 || start_us > end) {
+        start_us = end;
+    }
+    if (op == BUS_TRACE_PANEL_PARAM && start_us < last_color_end && last_color_end <= end) {
+        start_us = last_color_end;
+    }
+
+    uint32_t claim;
+    bus_trace_event_t *e = claim_slot(&claim);
+    if (e == NULL) {
+        return;
+    }
+    e->start_us = start_us;
+    e->end_us = end;
+    e->cmd = cmd;
+    e->len = len;
+    e->queued_us = 0;
+    e->op = op;
+    publish(e, claim);
+}
+
+void bus_trace_color_begin(uint32_t cmd, size_t len) {
+    uint32_t index = color_queued++;
+    if (!active) {
+        return;
+    }
+    uint32_t claim;
+    bus_trace_event_t *e = claim_slot(&claim);
+    if (e == NULL) {
+        return;
+    }
+    uint32_t now = bus_trace_now();
+    e->start_us = now;
+    e->end_us = 0;
+    e->cmd = cmd;
+    e->len = len;
+    e->queued_us = 0;
+    e->op = BUS_TRACE_PANEL_COLOR;
+    publish(e, claim);
+
+    // Published first, the interrupt only closes complete events. A full
+    // pending queue leaves the event open
+    uint32_t h = pending_head;
+    if (h - __atomic_load_n(&pending_tail, __ATOMIC_ACQUIRE) < PENDING_LEN) {
+        pending[h % PENDING_LEN] = (pending_t) { index, claim + 1, now, gen };
+        __atomic_store_n(&pending_head, h + 1, __ATOMIC_RELEASE);
+    }
+}
+
+// The transfer was not queued: take back its number and its pending entry.
+// Its event stays with a zero length duration
+void bus_trace_color_failed(void) {
+    uint32_t index = --color_queued;
+    uint32_t h = pending_head;
+    if (h != __atomic_load_n(&pending_tail, __ATOMIC_ACQUIRE) && pending[(h - 1) % PENDING_LEN].index == index) {
+        pending_t *p = &pending[(h - 1) % PENDING_LEN];
+        if (p->claim && p->gen == gen) {
+            bus_trace_event_t *e = &ring[(p->claim - 1) & mask];
+            if (e->seq == p->claim) {
+                e->end_us = e->start_us;
+            }
+        }
+        __atomic_store_n(&pending_head, h - 1, __ATOMIC_RELEASE);
+    }
+}
+
+void BUS_TRACE_IRAM_ATTR bus_trace_color_done(void) {
+    uint32_t index = color_done++;
+    uint32_t now = bus_trace_now();
+    uint32_t t = pending_tail;
+
+    while (t != __atomic_load_n(&pending_head, __ATOMIC_ACQUIRE)) {
+        pending_t *p = &pending[t % PENDING_LEN];
+        if ((int32_t)(p->index - index) > 0) {
+            break;      // a later transfer, this one was not traced
+        }
+        t++;
+        if (p->index != index || !active || p->gen != gen) {
+            continue;   // lost its interrupt or from an earlier trace
+        }
+        bus_trace_event_t *e = &ring[(p->claim - 1) & mask];
+        if (e->seq != p->claim) {
+            break;      // overwritten by newer events
+        }
+        uint32_t start = (p->queued_us > last_color_end) ? p->queued_us : last_color_end;
+        if (start > now) {
+            start = now;
+        }
+        uint32_t queued = start - p->queued_us;
+        e->start_us = start;
+        e->queued_us = (queued > UINT16_MAX) ? UINT16_MAX : queued;
+        e->end_us = now;
+        break;
+    }
+    __atomic_store_n(&pending_tail, t, __ATOMIC_RELEASE);
+    if (active) {
+        last_color_end = now;
+    }
+}
+
+bool bus_trace_next(uint32_t *pos, bus_trace_event_t *event) {
+    if (ring == NULL) {
+        return false;
+    }
+    uint32_t end = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    uint32_t capacity = mask + 1;
+    if (!wrap && end > capacity) {
+        end = capacity;
+    }
+    if (end > capacity && *pos < end - capacity) {
+        *pos = end - capacity;
+    }
+
+    while (*pos < end) {
+        uint32_t n = (*pos)++;
+        const bus_trace_event_t *e = &ring[n & mask];
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) != n + 1) {
+            continue;
+        }
+        *event = *e;
+        if (__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) == n + 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void bus_trace_get_stats(bus_trace_stats_t *stats) {
+    uint32_t claimed = head;
+    stats->capacity = ring ? mask + 1 : 0;
+    stats->recorded = claimed - refused;
+    stats->dropped = wrap ? (claimed > stats->capacity ? claimed - stats->capacity : 0) : refused;
+    memcpy(stats->ops, ops, sizeof(ops));
+    memcpy(stats->bytes, bytes, sizeof(bytes));
+    stats->active = active;
+    stats->wrap = wrap;
+}
+
+uint32_t bus_trace_measure_overhead(bus_trace_event_t *scratch, uint32_t count) {
+    if (active || !bus_trace_start(scratch, count, true)) {
+        return 0;
+    }
+    int64_t start = BUS_TRACE_TIME_US();
+    for (uint32_t i = 0; i < count; i++) {
+        // What a hook does: a timestamp before and the record after the transaction
+        uint32_t t = bus_trace_now();
+        bus_trace_record(BUS_TRACE_I2C_WRITE, i, 1, t);
+    }
+    int64_t elapsed = BUS_TRACE_TIME_US() - start;
+    bus_trace_stop();
+    ring = NULL;
+    head = 0;
+    return (uint32_t)(elapsed * 1000 / count);
+}
@@ -0,0 +1,100 @@
+/*
+ * Bus transaction recorder
+ * Panel and I2C transactions with their wire times in a lock-free ring.
+ * The hooks are macros that compile to nothing without BUS_TRACE
+ */
+
+#ifndef BUS_TRACE_RING_H
+#define BUS_TRACE_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef BUS_TRACE
+#define BUS_TRACE 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    BUS_TRACE_PANEL_PARAM,      // command with parameters, blocking
+    BUS_TRACE_PANEL_COLOR,      // pixel data, queued and sent by DMA
+    BUS_TRACE_I2C_WRITE,
+    BUS_TRACE_I2C_READ,
+    BUS_TRACE_OP_COUNT,
+} bus_trace_op_t;
+
+typedef struct {
+    uint32_t seq;           // claim number + 1 once complete, 0 while written
+    uint32_t start_us;      // on the wire, from the start of the trace
+    uint32_t end_us;        // 0 while a color transfer is in flight
+    uint32_t cmd;           // panel: framed command word, I2C: address << 8 | register
+    uint32_t len;           // data bytes
+    uint16_t queued_us;     // color: time between queueing and the wire, saturated
+    uint8_t op;             // bus_trace_op_t
+    uint8_t reserved;
+} bus_trace_event_t;
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t recorded;      // events claimed since start
+    uint32_t dropped;       // overwritten, or refused when not wrapping
+    uint32_t ops[BUS_TRACE_OP_COUNT];
+    uint64_t bytes[BUS_TRACE_OP_COUNT];
+    bool active;
+    bool wrap;
+} bus_trace_stats_t;
+
+// ring holds capacity events, a power of two. With wrap the newest events are
+// kept, without it recording stops when the ring is full. The ring is written
+// until the next start, also by transfers still in flight after a stop
+bool bus_trace_start(bus_trace_event_t *ring, uint32_t capacity, bool wrap);
+void bus_trace_stop(void);
+bool bus_trace_active(void);
+
+// Microseconds since the start of the trace, 0 when not tracing
+uint32_t bus_trace_now(void);
+
+// A finished transaction that started at start_us
+void bus_trace_record(bus_trace_op_t op, uint32_t cmd, size_t len, uint32_t start_us);
+
+// Color transfers: begin before queueing, failed when it could not be queued,
+// done from the transfer done interrupt. Transfers finish in queue order
+void bus_trace_color_begin(uint32_t cmd, size_t len);
+void bus_trace_color_failed(void);
+void bus_trace_color_done(void);
+
+// Events still in the ring, oldest first. Returns false when there is none
+// left; *pos starts at 0. Complete when tracing is stopped
+bool bus_trace_next(uint32_t *pos, bus_trace_event_t *event);
+
+void bus_trace_get_stats(bus_trace_stats_t *stats);
+
+// Nanoseconds a hook takes to record one event, measured with count events in
+// scratch (a power of two) while not tracing. Clears the trace
+uint32_t bus_trace_measure_overhead(bus_trace_event_t *scratch, uint32_t count);
+
+#if BUS_TRACE
+#define BUS_TRACE_NOW()                                 bus_trace_now()
+#define BUS_TRACE_PARAM(cmd, len, start)                bus_trace_record(BUS_TRACE_PANEL_PARAM, (cmd), (len), (start))
+#define BUS_TRACE_COLOR_BEGIN(cmd, len)                 bus_trace_color_begin((cmd), (len))
+#define BUS_TRACE_COLOR_FAILED()                        bus_trace_color_failed()
+#define BUS_TRACE_COLOR_DONE()                          bus_trace_color_done()
+#define BUS_TRACE_I2C(op, addr, reg, len, start)        bus_trace_record((op), ((addr) << 8) | (reg), (len), (start))
+#else
+#define BUS_TRACE_NOW()                                 0
+#define BUS_TRACE_PARAM(cmd, len, start)                ((void)(start))
+#define BUS_TRACE_COLOR_BEGIN(cmd, len)                 ((void)0)
+#define BUS_TRACE_COLOR_FAILED()                        ((void)0)
+#define BUS_TRACE_COLOR_DONE()                          ((void)0)
+#define BUS_TRACE_I2C(op, addr, reg, len, start)        ((void)(start))
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BUS_TRACE_RING_H
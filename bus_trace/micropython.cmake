@@ -0,0 +1,28 @@
+# modules/bus_trace/micropython.cmake
+add_library(usermod_bus_trace INTERFACE)
+
+# Record the panel and I2C transactions of the other modules. Without it the
+# hooks in spd2010_display and i2c_driver compile to nothing and there is no
+# bus_trace module
+option(BUS_TRACE "Bus transaction tracer" OFF)
+
+target_include_directories(usermod_bus_trace INTERFACE
+    ${CMAKE_CURRENT_LIST_DIR}
+)
+
+if(BUS_TRACE)
+    target_sources(usermod_bus_trace INTERFACE
+        ${CMAKE_CURRENT_LIST_DIR}/bus_trace.c
+        ${CMAKE_CURRENT_LIST_DIR}/bus_trace_ring.c
+    )
+    set(BUS_TRACE_VALUE 1)
+else()
+    set(BUS_TRACE_VALUE 0)
+endif()
+
+# Seen by every user module, the hooks are in spd2010_display and i2c_driver
+target_compile_definitions(usermod_bus_trace INTERFACE
+    BUS_TRACE=${BUS_TRACE_VALUE}
+)
+
+target_link_libraries(usermod INTERFACE usermod_bus_trace)
\ No newline at end of file
@@ -0,0 +1,18 @@
+// modules/bus_trace/qstrdefs.h
+Q(bus_trace)
+Q(start)
+Q(stop)
+Q(stats)
+Q(export)
+Q(overhead)
+Q(active)
+Q(wrap)
+Q(capacity)
+Q(recorded)
+Q(dropped)
+Q(panel_param)
+Q(panel_color)
+Q(i2c_write)
+Q(i2c_read)
+Q(panel_bytes)
+Q(i2c_bytes)
\ No newline at end of file
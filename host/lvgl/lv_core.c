@@ -0,0 +1,946 @@
+/*
+ * LVGL 8.3 core for the host build: memory, lists, tick, timers, displays,
+ * the refresh and input devices, following lv_mem.c, lv_ll.c, lv_timer.c,
+ * lv_hal_disp.c, lv_refr.c and lv_indev.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lvgl.h"
+#include "lv_host_private.h"
+#include "src/misc/lv_gc.h"
+#include LV_TICK_CUSTOM_INCLUDE
+#if LV_MEM_CUSTOM
+#include LV_MEM_CUSTOM_INCLUDE
+#endif
+
+lv_ll_t _lv_timer_ll;
+lv_ll_t _lv_disp_ll;
+lv_ll_t _lv_indev_ll;
+lv_ll_t _lv_img_decoder_ll;
+_lv_img_cache_entry_t *_lv_img_cache_array;
+
+static bool lv_initialized = false;
+static lv_disp_t *disp_def = NULL;
+static lv_disp_t *disp_refr = NULL;
+static uint32_t px_num = 0;
+
+void _lv_gc_clear_roots(void) {
+    memset(&_lv_timer_ll, 0, sizeof(_lv_timer_ll));
+    memset(&_lv_disp_ll, 0, sizeof(_lv_disp_ll));
+    memset(&_lv_indev_ll, 0, sizeof(_lv_indev_ll));
+    memset(&_lv_img_decoder_ll, 0, sizeof(_lv_img_decoder_ll));
+    _lv_img_cache_array = NULL;
+}
+
+// Memory
+
+#if LV_MEM_CUSTOM == 0
+// The LV_MEM_SIZE work area: blocks are kept on a list so lv_mem_deinit can
+// drop them all, as resetting the TLSF pool does upstream
+typedef struct mem_block {
+    struct mem_block *next;
+    struct mem_block *prev;
+    size_t size;
+    size_t pad;
+} mem_block_t;
+
+static mem_block_t *mem_blocks = NULL;
+static size_t mem_used = 0;
+static size_t mem_max_used = 0;
+static uint32_t mem_used_cnt = 0;
+#endif
+
+void lv_mem_init(void) {
+}
+
+void lv_mem_deinit(void) {
+#if LV_MEM_CUSTOM == 0
+    while (mem_blocks != NULL) {
+        mem_block_t *next = mem_blocks->next;
+        free(mem_blocks);
+        mem_blocks = next;
+    }
+    mem_used = 0;
+    mem_max_used = 0;
+    mem_used_cnt = 0;
+#endif
+}
+
+void *lv_mem_alloc(size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+#if LV_MEM_CUSTOM == 0
+    if (mem_used + size > LV_MEM_SIZE) {
+        return NULL;
+    }
+    mem_block_t *block = malloc(sizeof(mem_block_t) + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->size = size;
+    block->prev = NULL;
+    block->next = mem_blocks;
+    if (mem_blocks != NULL) {
+        mem_blocks->prev = block;
+    }
+    mem_blocks = block;
+    mem_used += size;
+    mem_used_cnt++;
+    if (mem_used > mem_max_used) {
+        mem_max_used = mem_used;
+    }
+    return block + 1;
+#else
+    return LV_MEM_CUSTOM_ALLOC(size);
+#endif
+}
+
+void lv_mem_free(void *data) {
+    if (data == NULL) {
+        return;
+    }
+#if LV_MEM_CUSTOM == 0
+    mem_block_t *block = (mem_block_t *)data - 1;
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        mem_blocks = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    }
+    mem_used -= block->size;
+    mem_used_cnt--;
+    free(block);
+#else
+    LV_MEM_CUSTOM_FREE(data);
+#endif
+}
+
+void *lv_mem_realloc(void *data_p, size_t new_size) {
+#if LV_MEM_CUSTOM == 0
+    if (data_p == NULL) {
+        return lv_mem_alloc(new_size);
+    }
+    if (new_size == 0) {
+        lv_mem_free(data_p);
+        return NULL;
+    }
+    size_t old_size = ((mem_block_t *)data_p - 1)->size;
+    void *new_p = lv_mem_alloc(new_size);
+    if (new_p == NULL) {
+        return NULL;
+    }
+    memcpy(new_p, data_p, LV_MIN(old_size, new_size));
+    lv_mem_free(data_p);
+    return new_p;
+#else
+    return LV_MEM_CUSTOM_REALLOC(data_p, new_size);
+#endif
+}
+
+void lv_mem_monitor(lv_mem_monitor_t *mon_p) {
+    memset(mon_p, 0, sizeof(*mon_p));
+#if LV_MEM_CUSTOM == 0
+    mon_p->total_size = LV_MEM_SIZE;
+    mon_p->free_size = LV_MEM_SIZE - mem_used;
+    mon_p->free_biggest_size = mon_p->free_size;
+    mon_p->free_cnt = 1;
+    mon_p->used_cnt = mem_used_cnt;
+    mon_p->max_used = mem_max_used;
+    mon_p->used_pct = (uint8_t)(mem_used * 100 / LV_MEM_SIZE);
+    mon_p->frag_pct = 0;
+#endif
+}
+
+int lv_vsnprintf(char *buffer, size_t count, const char *format, va_list va) {
+    return vsnprintf(buffer, count, format, va);
+}
+
+int lv_snprintf(char *buffer, size_t count, const char *format, ...) {
+    va_list va;
+    va_start(va, format);
+    int ret = vsnprintf(buffer, count, format, va);
+    va_end(va);
+    return ret;
+}
+
+// Linked lists: [data n_size][prev][next]
+
+#define LL_PREV_P_OFFSET(ll_p) ((ll_p)->n_size)
+#define LL_NEXT_P_OFFSET(ll_p) ((ll_p)->n_size + sizeof(lv_ll_node_t *))
+#define LL_NODE_META_SIZE (sizeof(lv_ll_node_t *) + sizeof(lv_ll_node_t *))
+
+static lv_ll_node_t **node_prev(const lv_ll_t *ll_p, const void *n) {
+    return (lv_ll_node_t **)((uint8_t *)n + LL_PREV_P_OFFSET(ll_p));
+}
+
+static lv_ll_node_t **node_next(const lv_ll_t *ll_p, const void *n) {
+    return (lv_ll_node_t **)((uint8_t *)n + LL_NEXT_P_OFFSET(ll_p));
+}
+
+void _lv_ll_init(lv_ll_t *ll_p, uint32_t node_size) {
+    ll_p->head = NULL;
+    ll_p->tail = NULL;
+    // Keep the links aligned
+    node_size = (node_size + 7) & ~7u;
+    ll_p->n_size = node_size;
+}
+
+void *_lv_ll_ins_head(lv_ll_t *ll_p) {
+    lv_ll_node_t *n_new = lv_mem_alloc(ll_p->n_size + LL_NODE_META_SIZE);
+    if (n_new == NULL) {
+        return NULL;
+    }
+    *node_prev(ll_p, n_new) = NULL;
+    *node_next(ll_p, n_new) = ll_p->head;
+    if (ll_p->head != NULL) {
+        *node_prev(ll_p, ll_p->head) = n_new;
+    }
+    ll_p->head = n_new;
+    if (ll_p->tail == NULL) {
+        ll_p->tail = n_new;
+    }
+    return n_new;
+}
+
+void *_lv_ll_ins_tail(lv_ll_t *ll_p) {
+    lv_ll_node_t *n_new = lv_mem_alloc(ll_p->n_size + LL_NODE_META_SIZE);
+    if (n_new == NULL) {
+        return NULL;
+    }
+    *node_next(ll_p, n_new) = NULL;
+    *node_prev(ll_p, n_new) = ll_p->tail;
+    if (ll_p->tail != NULL) {
+        *node_next(ll_p, ll_p->tail) = n_new;
+    }
+    ll_p->tail = n_new;
+    if (ll_p->head == NULL) {
+        ll_p->head = n_new;
+    }
+    return n_new;
+}
+
+void _lv_ll_remove(lv_ll_t *ll_p, void *node_p) {
+    lv_ll_node_t *prev = *node_prev(ll_p, node_p);
+    lv_ll_node_t *next = *node_next(ll_p, node_p);
+    if (prev != NULL) {
+        *node_next(ll_p, prev) = next;
+    } else {
+        ll_p->head = next;
+    }
+    if (next != NULL) {
+        *node_prev(ll_p, next) = prev;
+    } else {
+        ll_p->tail = prev;
+    }
+}
+
+void _lv_ll_clear(lv_ll_t *ll_p) {
+    void *i = _lv_ll_get_head(ll_p);
+    while (i != NULL) {
+        void *next = _lv_ll_get_next(ll_p, i);
+        _lv_ll_remove(ll_p, i);
+        lv_mem_free(i);
+        i = next;
+    }
+}
+
+void *_lv_ll_get_head(const lv_ll_t *ll_p) {
+    return ll_p != NULL ? ll_p->head : NULL;
+}
+
+void *_lv_ll_get_next(const lv_ll_t *ll_p, const void *n_act) {
+    return *node_next(ll_p, n_act);
+}
+
+// Areas
+
+bool _lv_area_intersect(lv_area_t *res, const lv_area_t *a1, const lv_area_t *a2) {
+    res->x1 = LV_MAX(a1->x1, a2->x1);
+    res->y1 = LV_MAX(a1->y1, a2->y1);
+    res->x2 = LV_MIN(a1->x2, a2->x2);
+    res->y2 = LV_MIN(a1->y2, a2->y2);
+    return res->x1 <= res->x2 && res->y1 <= res->y2;
+}
+
+bool _lv_area_is_in(const lv_area_t *ain, const lv_area_t *aholder, lv_coord_t radius) {
+    LV_UNUSED(radius);
+    return ain->x1 >= aholder->x1 && ain->y1 >= aholder->y1 && ain->x2 <= aholder->x2 && ain->y2 <= aholder->y2;
+}
+
+static bool area_is_on(const lv_area_t *a1, const lv_area_t *a2) {
+    return a1->x1 <= a2->x2 && a1->x2 >= a2->x1 && a1->y1 <= a2->y2 && a1->y2 >= a2->y1;
+}
+
+static void area_join(lv_area_t *res, const lv_area_t *a1, const lv_area_t *a2) {
+    res->x1 = LV_MIN(a1->x1, a2->x1);
+    res->y1 = LV_MIN(a1->y1, a2->y1);
+    res->x2 = LV_MAX(a1->x2, a2->x2);
+    res->y2 = LV_MAX(a1->y2, a2->y2);
+}
+
+// Tick
+
+uint32_t lv_tick_get(void) {
+    return LV_TICK_CUSTOM_SYS_TIME_EXPR;
+}
+
+uint32_t lv_tick_elaps(uint32_t prev_tick) {
+    return lv_tick_get() - prev_tick;
+}
+
+// Timers
+
+static bool timer_deleted = false;
+static bool timer_created = false;
+
+lv_timer_t *lv_timer_create(lv_timer_cb_t timer_xcb, uint32_t period, void *user_data) {
+    lv_timer_t *timer = _lv_ll_ins_head(&LV_GC_ROOT(_lv_timer_ll));
+    if (timer == NULL) {
+        return NULL;
+    }
+    timer->period = period;
+    timer->timer_cb = timer_xcb;
+    timer->repeat_count = -1;
+    timer->paused = 0;
+    timer->last_run = lv_tick_get();
+    timer->user_data = user_data;
+    timer_created = true;
+    return timer;
+}
+
+void lv_timer_del(lv_timer_t *timer) {
+    _lv_ll_remove(&LV_GC_ROOT(_lv_timer_ll), timer);
+    timer_deleted = true;
+    lv_mem_free(timer);
+}
+
+void lv_timer_pause(lv_timer_t *timer) {
+    timer->paused = true;
+}
+
+void lv_timer_resume(lv_timer_t *timer) {
+    timer->paused = false;
+}
+
+void lv_timer_set_cb(lv_timer_t *timer, lv_timer_cb_t timer_cb) {
+    timer->timer_cb = timer_cb;
+}
+
+void lv_timer_set_period(lv_timer_t *timer, uint32_t period) {
+    timer->period = period;
+}
+
+void lv_timer_ready(lv_timer_t *timer) {
+    timer->last_run = lv_tick_get() - timer->period - 1;
+}
+
+lv_timer_t *lv_timer_get_next(lv_timer_t *timer) {
+    if (timer == NULL) {
+        return _lv_ll_get_head(&LV_GC_ROOT(_lv_timer_ll));
+    }
+    return _lv_ll_get_next(&LV_GC_ROOT(_lv_timer_ll), timer);
+}
+
+static uint32_t timer_time_remaining(lv_timer_t *timer) {
+    uint32_t elp = lv_tick_elaps(timer->last_run);
+    return (elp >= timer->period) ? 0 : timer->period - elp;
+}
+
+static bool timer_exec(lv_timer_t *timer) {
+    if (timer->paused || timer_time_remaining(timer) != 0) {
+        return false;
+    }
+    int32_t original_repeat_count = timer->repeat_count;
+    if (timer->repeat_count > 0) {
+        timer->repeat_count--;
+    }
+    timer->last_run = lv_tick_get();
+    if (timer->timer_cb && original_repeat_count != 0) {
+        timer->timer_cb(timer);
+    }
+    if (timer->repeat_count == 0 && !timer_deleted) {
+        lv_timer_del(timer);
+    }
+    return true;
+}
+
+uint32_t lv_timer_handler(void) {
+    static bool already_running = false;
+    if (already_running) {
+        return 1;
+    }
+    already_running = true;
+
+    lv_timer_t *act;
+    do {
+        timer_deleted = false;
+        timer_created = false;
+        act = _lv_ll_get_head(&LV_GC_ROOT(_lv_timer_ll));
+        while (act != NULL) {
+            lv_timer_t *next = _lv_ll_get_next(&LV_GC_ROOT(_lv_timer_ll), act);
+            if (timer_exec(act) && (timer_created || timer_deleted)) {
+                // The list changed, start over
+                break;
+            }
+            act = next;
+        }
+    } while (act != NULL);
+
+    uint32_t time_till_next = LV_NO_TIMER_READY;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_timer_ll), act) {
+        if (!act->paused) {
+            uint32_t delay = timer_time_remaining(act);
+            if (delay < time_till_next) {
+                time_till_next = delay;
+            }
+        }
+    }
+    already_running = false;
+    return time_till_next;
+}
+
+// Displays
+
+void lv_disp_drv_init(lv_disp_drv_t *driver) {
+    memset(driver, 0, sizeof(*driver));
+    driver->hor_res = 320;
+    driver->ver_res = 240;
+    driver->antialiasing = 1;
+    driver->dpi = LV_DPI_DEF;
+}
+
+void lv_disp_draw_buf_init(lv_disp_draw_buf_t *draw_buf, void *buf1, void *buf2, uint32_t size_in_px_cnt) {
+    memset(draw_buf, 0, sizeof(*draw_buf));
+    draw_buf->buf1 = buf1;
+    draw_buf->buf2 = buf2;
+    draw_buf->buf_act = draw_buf->buf1;
+    draw_buf->size = size_in_px_cnt;
+}
+
+lv_disp_t *lv_disp_drv_register(lv_disp_drv_t *driver) {
+    lv_disp_t *disp = _lv_ll_ins_head(&LV_GC_ROOT(_lv_disp_ll));
+    if (disp == NULL) {
+        return NULL;
+    }
+    memset(disp, 0, sizeof(*disp));
+
+    lv_draw_ctx_t *draw_ctx = lv_mem_alloc(sizeof(lv_draw_ctx_t));
+    if (draw_ctx == NULL) {
+        _lv_ll_remove(&LV_GC_ROOT(_lv_disp_ll), disp);
+        lv_mem_free(disp);
+        return NULL;
+    }
+    lv_draw_sw_init_ctx(driver, draw_ctx);
+    driver->draw_ctx = draw_ctx;
+
+    disp->driver = driver;
+    disp->inv_en_cnt = 1;
+    disp->bg_color = lv_color_white();
+    disp->refr_timer = lv_timer_create(_lv_disp_refr_timer, LV_DISP_DEF_REFR_PERIOD, disp);
+    if (disp_def == NULL) {
+        disp_def = disp;
+    }
+
+    disp->act_scr = _lv_obj_create_screen(disp);
+    disp->last_activity_time = lv_tick_get();
+    lv_obj_invalidate(disp->act_scr);
+    return disp;
+}
+
+void lv_disp_remove(lv_disp_t *disp) {
+    if (disp_def == disp) {
+        disp_def = NULL;
+    }
+    while (disp->screen_cnt > 0) {
+        lv_obj_del(disp->screens[0]);
+    }
+    if (disp->refr_timer != NULL) {
+        lv_timer_del(disp->refr_timer);
+    }
+    lv_mem_free(disp->driver->draw_ctx);
+    disp->driver->draw_ctx = NULL;
+    _lv_ll_remove(&LV_GC_ROOT(_lv_disp_ll), disp);
+    lv_mem_free(disp);
+}
+
+void lv_disp_set_default(lv_disp_t *disp) {
+    disp_def = disp;
+}
+
+lv_disp_t *lv_disp_get_default(void) {
+    return disp_def;
+}
+
+lv_disp_t *lv_disp_get_next(lv_disp_t *disp) {
+    if (disp == NULL) {
+        return _lv_ll_get_head(&LV_GC_ROOT(_lv_disp_ll));
+    }
+    return _lv_ll_get_next(&LV_GC_ROOT(_lv_disp_ll), disp);
+}
+
+lv_coord_t lv_disp_get_hor_res(lv_disp_t *disp) {
+    if (disp == NULL) {
+        disp = lv_disp_get_default();
+    }
+    return disp != NULL ? disp->driver->hor_res : 0;
+}
+
+lv_coord_t lv_disp_get_ver_res(lv_disp_t *disp) {
+    if (disp == NULL) {
+        disp = lv_disp_get_default();
+    }
+    return disp != NULL ? disp->driver->ver_res : 0;
+}
+
+void lv_disp_flush_ready(lv_disp_drv_t *disp_drv) {
+    disp_drv->draw_buf->flushing = 0;
+    disp_drv->draw_buf->flushing_last = 0;
+}
+
+bool lv_disp_flush_is_last(lv_disp_drv_t *disp_drv) {
+    return disp_drv->draw_buf->flushing_last;
+}
+
+void lv_disp_trig_activity(lv_disp_t *disp) {
+    if (disp == NULL) {
+        disp = lv_disp_get_default();
+    }
+    if (disp != NULL) {
+        disp->last_activity_time = lv_tick_get();
+    }
+}
+
+uint32_t lv_disp_get_inactive_time(const lv_disp_t *disp) {
+    if (disp != NULL) {
+        return lv_tick_elaps(disp->last_activity_time);
+    }
+    uint32_t t = UINT32_MAX;
+    lv_disp_t *d;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_disp_ll), d) {
+        uint32_t elaps = lv_tick_elaps(d->last_activity_time);
+        t = LV_MIN(t, elaps);
+    }
+    return t;
+}
+
+void lv_disp_enable_invalidation(lv_disp_t *disp, bool en) {
+    if (disp == NULL) {
+        disp = lv_disp_get_default();
+    }
+    if (disp != NULL) {
+        disp->inv_en_cnt += en ? 1 : -1;
+    }
+}
+
+bool lv_disp_is_invalidation_enabled(lv_disp_t *disp) {
+    if (disp == NULL) {
+        disp = lv_disp_get_default();
+    }
+    return disp != NULL && disp->inv_en_cnt > 0;
+}
+
+lv_obj_t *lv_disp_get_scr_act(lv_disp_t *disp) {
+    if (disp == NULL) {
+        disp = lv_disp_get_default();
+    }
+    return disp != NULL ? disp->act_scr : NULL;
+}
+
+void lv_disp_load_scr(lv_obj_t *scr) {
+    lv_disp_t *disp = lv_obj_get_disp(scr);
+    if (disp == NULL) {
+        return;
+    }
+    disp->act_scr = scr;
+    lv_obj_invalidate(scr);
+}
+
+// Refresh
+
+void _lv_inv_area(lv_disp_t *disp, const lv_area_t *area_p) {
+    if (disp == NULL) {
+        disp = lv_disp_get_default();
+    }
+    if (disp == NULL || !lv_disp_is_invalidation_enabled(disp)) {
+        return;
+    }
+    if (disp->rendering_in_progress) {
+        fprintf(stderr, "lvgl: detected modifying dirty areas in render\n");
+        return;
+    }
+    if (area_p == NULL) {
+        disp->inv_p = 0;
+        return;
+    }
+
+    lv_area_t scr_area = { 0, 0, (lv_coord_t)(disp->driver->hor_res - 1), (lv_coord_t)(disp->driver->ver_res - 1) };
+    lv_area_t com_area;
+    if (!_lv_area_intersect(&com_area, area_p, &scr_area)) {
+        return;
+    }
+
+    // In full refresh mode any invalid area redraws the whole screen
+    if (disp->driver->full_refresh) {
+        disp->inv_areas[0] = scr_area;
+        disp->inv_p = 1;
+        return;
+    }
+
+    if (disp->driver->rounder_cb) {
+        disp->driver->rounder_cb(disp->driver, &com_area);
+    }
+
+    for (uint16_t i = 0; i < disp->inv_p; i++) {
+        if (_lv_area_is_in(&com_area, &disp->inv_areas[i], 0)) {
+            return;
+        }
+    }
+
+    if (disp->inv_p < LV_INV_BUF_SIZE) {
+        disp->inv_areas[disp->inv_p] = com_area;
+    } else {
+        disp->inv_p = 0;
+        disp->inv_areas[disp->inv_p] = scr_area;
+    }
+    disp->inv_p++;
+}
+
+static void refr_join_area(void) {
+    for (uint32_t join_in = 0; join_in < disp_refr->inv_p; join_in++) {
+        if (disp_refr->inv_area_joined[join_in]) {
+            continue;
+        }
+        for (uint32_t join_from = 0; join_from < disp_refr->inv_p; join_from++) {
+            if (disp_refr->inv_area_joined[join_from] || join_in == join_from) {
+                continue;
+            }
+            if (!area_is_on(&disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from])) {
+                continue;
+            }
+            lv_area_t joined;
+            area_join(&joined, &disp_refr->inv_areas[join_in], &disp_refr->inv_areas[join_from]);
+            if (lv_area_get_size(&joined) < lv_area_get_size(&disp_refr->inv_areas[join_in]) +
+                lv_area_get_size(&disp_refr->inv_areas[join_from])) {
+                disp_refr->inv_areas[join_in] = joined;
+                disp_refr->inv_area_joined[join_from] = 1;
+            }
+        }
+    }
+}
+
+static void wait_flushing(lv_disp_draw_buf_t *draw_buf) {
+    while (draw_buf->flushing) {
+        if (disp_refr->driver->wait_cb) {
+            disp_refr->driver->wait_cb(disp_refr->driver);
+        }
+    }
+}
+
+static void draw_buf_flush(lv_disp_t *disp) {
+    lv_disp_draw_buf_t *draw_buf = disp->driver->draw_buf;
+    lv_draw_ctx_t *draw_ctx = disp->driver->draw_ctx;
+    if (draw_ctx->wait_for_finish) {
+        draw_ctx->wait_for_finish(draw_ctx);
+    }
+
+    // In partial double buffered mode wait until the other buffer is freed
+    bool full_sized = draw_buf->size == (uint32_t)disp->driver->hor_res * disp->driver->ver_res;
+    if (draw_buf->buf1 && draw_buf->buf2 && !full_sized) {
+        wait_flushing(draw_buf);
+    }
+
+    draw_buf->flushing = 1;
+    draw_buf->flushing_last = (draw_buf->last_area && draw_buf->last_part) ? 1 : 0;
+    bool flushing_last = draw_buf->flushing_last;
+
+    if (disp->driver->flush_cb) {
+        disp->driver->flush_cb(disp->driver, draw_ctx->buf_area, draw_ctx->buf);
+    }
+
+    if (draw_buf->buf1 && draw_buf->buf2 && (!disp->driver->direct_mode || flushing_last)) {
+        draw_buf->buf_act = (draw_buf->buf_act == draw_buf->buf1) ? draw_buf->buf2 : draw_buf->buf1;
+    }
+}
+
+static void refr_area_part(lv_draw_ctx_t *draw_ctx) {
+    lv_disp_draw_buf_t *draw_buf = disp_refr->driver->draw_buf;
+
+    // In single buffered mode wait here until the buffer is freed, in full
+    // double buffered mode until a buffer becomes available
+    bool full_sized = draw_buf->size == (uint32_t)disp_refr->driver->hor_res * disp_refr->driver->ver_res;
+    if ((draw_buf->buf1 && !draw_buf->buf2) || (draw_buf->buf1 && draw_buf->buf2 && full_sized)) {
+        wait_flushing(draw_buf);
+    }
+    draw_ctx->buf = draw_buf->buf_act;
+
+    _lv_obj_render(disp_refr->act_scr, draw_ctx);
+
+    if (!disp_refr->driver->full_refresh) {
+        draw_buf_flush(disp_refr);
+    }
+}
+
+static int32_t get_max_row(lv_disp_t *disp, lv_coord_t area_w, lv_coord_t area_h) {
+    int32_t max_row = (int32_t)(disp->driver->draw_buf->size / area_w);
+    if (max_row > area_h) {
+        max_row = area_h;
+    }
+    // Round down the lines of the buffer if the rounder would grow them
+    if (disp->driver->rounder_cb) {
+        lv_area_t tmp = { 0, 0, 0, 0 };
+        lv_coord_t h_tmp = max_row;
+        do {
+            tmp.y2 = h_tmp - 1;
+            disp->driver->rounder_cb(disp->driver, &tmp);
+            if (lv_area_get_height(&tmp) <= max_row) {
+                break;
+            }
+            h_tmp--;
+        } while (h_tmp > 0);
+        if (h_tmp <= 0) {
+            return 0;
+        }
+        max_row = tmp.y2 + 1;
+    }
+    return max_row;
+}
+
+static void refr_area(const lv_area_t *area_p) {
+    lv_draw_ctx_t *draw_ctx = disp_refr->driver->draw_ctx;
+    lv_disp_draw_buf_t *draw_buf = disp_refr->driver->draw_buf;
+
+    if (disp_refr->driver->full_refresh) {
+        static lv_area_t disp_area;
+        disp_area = (lv_area_t){ 0, 0, (lv_coord_t)(disp_refr->driver->hor_res - 1), (lv_coord_t)(disp_refr->driver->ver_res - 1) };
+        draw_ctx->buf_area = &disp_area;
+        draw_ctx->clip_area = &disp_area;
+        draw_buf->last_part = 1;
+        refr_area_part(draw_ctx);
+        return;
+    }
+
+    lv_coord_t w = lv_area_get_width(area_p);
+    lv_coord_t h = lv_area_get_height(area_p);
+    lv_coord_t y2 = (area_p->y2 >= disp_refr->driver->ver_res) ? disp_refr->driver->ver_res - 1 : area_p->y2;
+    int32_t max_row = get_max_row(disp_refr, w, h);
+    if (max_row <= 0) {
+        return;
+    }
+
+    static lv_area_t sub_area;
+    lv_coord_t row;
+    lv_coord_t row_last = 0;
+    for (row = area_p->y1; row + max_row - 1 <= y2; row += max_row) {
+        sub_area.x1 = area_p->x1;
+        sub_area.x2 = area_p->x2;
+        sub_area.y1 = row;
+        sub_area.y2 = row + max_row - 1;
+        draw_ctx->buf_area = &sub_area;
+        draw_ctx->clip_area = &sub_area;
+        if (sub_area.y2 > y2) {
+            sub_area.y2 = y2;
+        }
+        row_last = sub_area.y2;
+        if (y2 == row_last) {
+            draw_buf->last_part = 1;
+        }
+        refr_area_part(draw_ctx);
+    }
+    if (y2 != row_last) {
+        sub_area.x1 = area_p->x1;
+        sub_area.x2 = area_p->x2;
+        sub_area.y1 = row;
+        sub_area.y2 = y2;
+        draw_ctx->buf_area = &sub_area;
+        draw_ctx->clip_area = &sub_area;
+        draw_buf->last_part = 1;
+        refr_area_part(draw_ctx);
+    }
+}
+
+static void refr_invalid_areas(void) {
+    px_num = 0;
+    if (disp_refr->inv_p == 0) {
+        return;
+    }
+
+    int32_t last_i = 0;
+    for (int32_t i = disp_refr->inv_p - 1; i >= 0; i--) {
+        if (disp_refr->inv_area_joined[i] == 0) {
+            last_i = i;
+            break;
+        }
+    }
+
+    if (disp_refr->driver->render_start_cb) {
+        disp_refr->driver->render_start_cb(disp_refr->driver);
+    }
+    disp_refr->driver->draw_buf->last_area = 0;
+    disp_refr->driver->draw_buf->last_part = 0;
+    disp_refr->rendering_in_progress = true;
+
+    for (int32_t i = 0; i < disp_refr->inv_p; i++) {
+        if (disp_refr->inv_area_joined[i] == 0) {
+            if (i == last_i) {
+                disp_refr->driver->draw_buf->last_area = 1;
+            }
+            disp_refr->driver->draw_buf->last_part = 0;
+            refr_area(&disp_refr->inv_areas[i]);
+            px_num += lv_area_get_size(&disp_refr->inv_areas[i]);
+        }
+    }
+    disp_refr->rendering_in_progress = false;
+}
+
+void _lv_disp_refr_timer(lv_timer_t *tmr) {
+    uint32_t start = lv_tick_get();
+    disp_refr = tmr->user_data;
+
+    if (disp_refr->act_scr == NULL) {
+        disp_refr->inv_p = 0;
+        disp_refr = NULL;
+        return;
+    }
+
+    refr_join_area();
+    refr_invalid_areas();
+
+    if (disp_refr->inv_p != 0) {
+        if (disp_refr->driver->full_refresh) {
+            static lv_area_t disp_area;
+            disp_area = (lv_area_t){ 0, 0, (lv_coord_t)(disp_refr->driver->hor_res - 1), (lv_coord_t)(disp_refr->driver->ver_res - 1) };
+            disp_refr->driver->draw_ctx->buf_area = &disp_area;
+            draw_buf_flush(disp_refr);
+        }
+        memset(disp_refr->inv_areas, 0, sizeof(disp_refr->inv_areas));
+        memset(disp_refr->inv_area_joined, 0, sizeof(disp_refr->inv_area_joined));
+        disp_refr->inv_p = 0;
+
+        uint32_t elaps = lv_tick_elaps(start);
+        if (disp_refr->driver->monitor_cb) {
+            disp_refr->driver->monitor_cb(disp_refr->driver, elaps, px_num);
+        }
+    }
+    disp_refr = NULL;
+}
+
+void lv_refr_now(lv_disp_t *disp) {
+    if (disp != NULL) {
+        if (disp->refr_timer != NULL) {
+            _lv_disp_refr_timer(disp->refr_timer);
+        }
+        return;
+    }
+    lv_disp_t *d;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_disp_ll), d) {
+        if (d->refr_timer != NULL) {
+            _lv_disp_refr_timer(d->refr_timer);
+        }
+    }
+}
+
+// Input devices
+
+void lv_indev_drv_init(lv_indev_drv_t *driver) {
+    memset(driver, 0, sizeof(*driver));
+    driver->type = LV_INDEV_TYPE_NONE;
+}
+
+lv_indev_t *lv_indev_drv_register(lv_indev_drv_t *driver) {
+    if (driver->disp == NULL) {
+        driver->disp = lv_disp_get_default();
+    }
+    if (driver->disp == NULL) {
+        return NULL;
+    }
+    lv_indev_t *indev = _lv_ll_ins_head(&LV_GC_ROOT(_lv_indev_ll));
+    if (indev == NULL) {
+        return NULL;
+    }
+    memset(indev, 0, sizeof(*indev));
+    indev->driver = driver;
+    indev->proc.state = LV_INDEV_STATE_RELEASED;
+    driver->read_timer = lv_timer_create(lv_indev_read_timer_cb, LV_INDEV_DEF_READ_PERIOD, indev);
+    return indev;
+}
+
+lv_indev_t *lv_indev_get_next(lv_indev_t *indev) {
+    if (indev == NULL) {
+        return _lv_ll_get_head(&LV_GC_ROOT(_lv_indev_ll));
+    }
+    return _lv_ll_get_next(&LV_GC_ROOT(_lv_indev_ll), indev);
+}
+
+// Pressing and releasing an object changes its state, which redraws it
+static void pointer_proc(lv_indev_t *indev, const lv_indev_data_t *data) {
+    indev->proc.pointer.act_point = data->point;
+    if (data->state == LV_INDEV_STATE_PRESSED && indev->proc.state == LV_INDEV_STATE_RELEASED) {
+        lv_obj_t *scr = lv_disp_get_scr_act(indev->driver->disp);
+        indev->proc.pointer.act_obj = (scr != NULL) ? _lv_obj_hit(scr, &data->point) : NULL;
+        if (indev->proc.pointer.act_obj != NULL) {
+            lv_obj_add_state(indev->proc.pointer.act_obj, LV_STATE_PRESSED);
+        }
+    } else if (data->state == LV_INDEV_STATE_RELEASED && indev->proc.state == LV_INDEV_STATE_PRESSED) {
+        if (indev->proc.pointer.act_obj != NULL) {
+            lv_obj_clear_state(indev->proc.pointer.act_obj, LV_STATE_PRESSED);
+            indev->proc.pointer.act_obj = NULL;
+        }
+    }
+    indev->proc.pointer.last_point = data->point;
+    indev->proc.state = data->state;
+}
+
+void lv_indev_read_timer_cb(lv_timer_t *timer) {
+    lv_indev_t *indev = timer->user_data;
+    if (indev == NULL || indev->driver->read_cb == NULL) {
+        return;
+    }
+    lv_indev_data_t data;
+    do {
+        memset(&data, 0, sizeof(data));
+        data.point = indev->proc.pointer.last_point;
+        indev->driver->read_cb(indev->driver, &data);
+        if (data.state == LV_INDEV_STATE_PRESSED) {
+            indev->driver->disp->last_activity_time = lv_tick_get();
+        }
+        if (indev->driver->type == LV_INDEV_TYPE_POINTER) {
+            pointer_proc(indev, &data);
+        } else {
+            indev->proc.state = data.state;
+        }
+    } while (data.continue_reading);
+}
+
+// Library
+
+void lv_init(void) {
+    if (lv_initialized) {
+        return;
+    }
+    lv_mem_init();
+    _lv_ll_init(&LV_GC_ROOT(_lv_timer_ll), sizeof(lv_timer_t));
+    _lv_ll_init(&LV_GC_ROOT(_lv_disp_ll), sizeof(lv_disp_t));
+    _lv_ll_init(&LV_GC_ROOT(_lv_indev_ll), sizeof(lv_indev_t));
+    _lv_img_decoder_init();
+    _lv_img_cache_reset();
+    lv_img_cache_set_size(LV_IMG_CACHE_DEF_SIZE);
+    disp_def = NULL;
+    lv_initialized = true;
+}
+
+bool lv_is_initialized(void) {
+    return lv_initialized;
+}
+
+#if LV_ENABLE_GC || !LV_MEM_CUSTOM
+void lv_deinit(void) {
+    _lv_gc_clear_roots();
+    lv_disp_set_default(NULL);
+    lv_mem_deinit();
+    lv_initialized = false;
+}
+#endif
@@ -0,0 +1,58 @@
+/*
+ * Internals shared by the host LVGL sources
+ */
+
+#ifndef HOST_LV_HOST_PRIVATE_H
+#define HOST_LV_HOST_PRIVATE_H
+
+#include "lvgl.h"
+
+typedef enum {
+    LV_HOST_OBJ,
+    LV_HOST_LABEL,
+    LV_HOST_BTN,
+    LV_HOST_SWITCH,
+    LV_HOST_SLIDER,
+    LV_HOST_ARC,
+    LV_HOST_LIST,
+    LV_HOST_IMG,
+} lv_host_class_t;
+
+struct _lv_obj_t {
+    struct _lv_obj_t *parent;
+    struct _lv_obj_t **children;
+    uint32_t child_cnt;
+    lv_disp_t *disp;                // screens only
+    lv_host_class_t cls;
+    lv_area_t coords;
+    lv_coord_t x;                   // set position, relative to the parent's content
+    lv_coord_t y;
+    lv_coord_t w;                   // set size, may be lv_pct or LV_SIZE_CONTENT
+    lv_coord_t h;
+    lv_align_t align;
+    lv_coord_t scroll_y;
+    lv_state_t state;
+    lv_color_t bg_color;
+    lv_color_t grad_color;
+    lv_opa_t bg_opa;
+    uint8_t grad_dir;
+    char *text;                     // labels
+    const void *src;                // images
+    int32_t value;                  // slider value, arc start angle
+    int32_t value2;                 // arc end angle
+};
+
+// Render obj and its children into the draw buffer, clipped to the clip area
+void _lv_obj_render(lv_obj_t *obj, lv_draw_ctx_t *draw_ctx);
+
+// Topmost clickable object under point on the screen, NULL if none
+lv_obj_t *_lv_obj_hit(lv_obj_t *scr, const lv_point_t *point);
+
+// A new screen of disp
+lv_obj_t *_lv_obj_create_screen(lv_disp_t *disp);
+
+void lv_draw_sw_init_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx);
+void _lv_img_decoder_init(void);
+void _lv_img_cache_reset(void);
+
+#endif // HOST_LV_HOST_PRIVATE_H
@@ -0,0 +1,258 @@
+/*
+ * LVGL 8.3 image decoders and image cache for the host build
+ *
+ * Kept in its own translation unit as upstream, so a link time wrap of
+ * _lv_img_cache_open sees every call made by lv_draw_img. The built-in decoder
+ * only opens true color variables, which it hands out in place.
+ */
+
+#include <limits.h>
+#include "lvgl.h"
+#include "lv_host_private.h"
+#include "src/misc/lv_gc.h"
+
+#define LV_IMG_CACHE_AGING      1
+#define LV_IMG_CACHE_LIFE_GAIN  1
+#define LV_IMG_CACHE_LIFE_LIMIT 1000
+
+static uint16_t entry_cnt;
+
+// Sources
+
+lv_img_src_t lv_img_src_get_type(const void *src) {
+    if (src == NULL) {
+        return LV_IMG_SRC_UNKNOWN;
+    }
+    const uint8_t *u8_p = src;
+    if (u8_p[0] >= 0x20 && u8_p[0] <= 0x7F) {
+        return LV_IMG_SRC_FILE;
+    }
+    if (u8_p[0] >= 0x80) {
+        return LV_IMG_SRC_SYMBOL;
+    }
+    return LV_IMG_SRC_VARIABLE;
+}
+
+uint32_t lv_img_buf_get_img_size(lv_coord_t w, lv_coord_t h, lv_img_cf_t cf) {
+    switch (cf) {
+        case LV_IMG_CF_TRUE_COLOR:
+        case LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED:
+            return (uint32_t)w * h * LV_COLOR_SIZE / 8;
+        case LV_IMG_CF_TRUE_COLOR_ALPHA:
+            return (uint32_t)w * h * LV_IMG_PX_SIZE_ALPHA_BYTE;
+        default:
+            return 0;
+    }
+}
+
+// Built-in decoder
+
+static lv_res_t built_in_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header) {
+    LV_UNUSED(decoder);
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE) {
+        return LV_RES_INV;
+    }
+    const lv_img_dsc_t *img = src;
+    if (img->header.cf < LV_IMG_CF_TRUE_COLOR || img->header.cf > LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED) {
+        return LV_RES_INV;
+    }
+    *header = img->header;
+    return LV_RES_OK;
+}
+
+static lv_res_t built_in_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    if (dsc->src_type != LV_IMG_SRC_VARIABLE) {
+        return LV_RES_INV;
+    }
+    dsc->img_data = ((const lv_img_dsc_t *)dsc->src)->data;
+    return LV_RES_OK;
+}
+
+static void built_in_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    LV_UNUSED(decoder);
+    LV_UNUSED(dsc);
+}
+
+void _lv_img_decoder_init(void) {
+    _lv_ll_init(&LV_GC_ROOT(_lv_img_decoder_ll), sizeof(lv_img_decoder_t));
+    lv_img_decoder_t *decoder = lv_img_decoder_create();
+    if (decoder == NULL) {
+        return;
+    }
+    decoder->info_cb = built_in_info;
+    decoder->open_cb = built_in_open;
+    decoder->close_cb = built_in_close;
+}
+
+// Decoders
+
+lv_img_decoder_t *lv_img_decoder_create(void) {
+    lv_img_decoder_t *decoder = _lv_ll_ins_head(&LV_GC_ROOT(_lv_img_decoder_ll));
+    if (decoder != NULL) {
+        lv_memset_00(decoder, sizeof(*decoder));
+    }
+    return decoder;
+}
+
+void lv_img_decoder_delete(lv_img_decoder_t *decoder) {
+    _lv_ll_remove(&LV_GC_ROOT(_lv_img_decoder_ll), decoder);
+    lv_mem_free(decoder);
+}
+
+lv_res_t lv_img_decoder_get_info(const void *src, lv_img_header_t *header) {
+    lv_memset_00(header, sizeof(*header));
+    if (src == NULL) {
+        return LV_RES_INV;
+    }
+    lv_res_t res = LV_RES_INV;
+    lv_img_decoder_t *decoder;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_img_decoder_ll), decoder) {
+        if (decoder->info_cb) {
+            res = decoder->info_cb(decoder, src, header);
+            if (res == LV_RES_OK) {
+                break;
+            }
+        }
+    }
+    return res;
+}
+
+lv_res_t lv_img_decoder_open(lv_img_decoder_dsc_t *dsc, const void *src, lv_color_t color, int32_t frame_id) {
+    lv_memset_00(dsc, sizeof(*dsc));
+    lv_img_src_t src_type = lv_img_src_get_type(src);
+    if (src_type == LV_IMG_SRC_UNKNOWN) {
+        return LV_RES_INV;
+    }
+    dsc->color = color;
+    dsc->src_type = src_type;
+    dsc->frame_id = frame_id;
+    dsc->src = src;
+
+    lv_res_t res = LV_RES_INV;
+    lv_img_decoder_t *decoder;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_img_decoder_ll), decoder) {
+        if (decoder->info_cb == NULL || decoder->open_cb == NULL) {
+            continue;
+        }
+        res = decoder->info_cb(decoder, src, &dsc->header);
+        if (res != LV_RES_OK) {
+            continue;
+        }
+        dsc->decoder = decoder;
+        res = decoder->open_cb(decoder, dsc);
+        if (res == LV_RES_OK) {
+            return res;
+        }
+        lv_memset_00(&dsc->header, sizeof(dsc->header));
+        dsc->error_msg = NULL;
+        dsc->img_data = NULL;
+        dsc->user_data = NULL;
+        dsc->time_to_open = 0;
+    }
+    return res;
+}
+
+void lv_img_decoder_close(lv_img_decoder_dsc_t *dsc) {
+    if (dsc->decoder && dsc->decoder->close_cb) {
+        dsc->decoder->close_cb(dsc->decoder, dsc);
+    }
+}
+
+// Cache
+
+static bool cache_match(const void *src1, const void *src2) {
+    if (src1 == src2) {
+        return true;
+    }
+    if (lv_img_src_get_type(src1) != LV_IMG_SRC_FILE || lv_img_src_get_type(src2) != LV_IMG_SRC_FILE) {
+        return false;
+    }
+    return strcmp(src1, src2) == 0;
+}
+
+_lv_img_cache_entry_t *_lv_img_cache_open(const void *src, lv_color_t color, int32_t frame_id) {
+    if (entry_cnt == 0) {
+        return NULL;
+    }
+    _lv_img_cache_entry_t *cache = LV_GC_ROOT(_lv_img_cache_array);
+
+    // Make every entry older
+    for (uint16_t i = 0; i < entry_cnt; i++) {
+        if (cache[i].life > INT32_MIN + LV_IMG_CACHE_AGING) {
+            cache[i].life -= LV_IMG_CACHE_AGING;
+        }
+    }
+
+    // Hard to open images live longer
+    for (uint16_t i = 0; i < entry_cnt; i++) {
+        if (color.full == cache[i].dec_dsc.color.full && frame_id == cache[i].dec_dsc.frame_id &&
+            cache_match(src, cache[i].dec_dsc.src)) {
+            _lv_img_cache_entry_t *cached_src = &cache[i];
+            cached_src->life += cached_src->dec_dsc.time_to_open * LV_IMG_CACHE_LIFE_GAIN;
+            if (cached_src->life > LV_IMG_CACHE_LIFE_LIMIT) {
+                cached_src->life = LV_IMG_CACHE_LIFE_LIMIT;
+            }
+            return cached_src;
+        }
+    }
+
+    // Reuse the entry with the least life
+    _lv_img_cache_entry_t *cached_src = &cache[0];
+    for (uint16_t i = 1; i < entry_cnt; i++) {
+        if (cache[i].life < cached_src->life) {
+            cached_src = &cache[i];
+        }
+    }
+    if (cached_src->dec_dsc.src) {
+        lv_img_decoder_close(&cached_src->dec_dsc);
+    }
+
+    uint32_t t_start = lv_tick_get();
+    if (lv_img_decoder_open(&cached_src->dec_dsc, src, color, frame_id) == LV_RES_INV) {
+        lv_memset_00(cached_src, sizeof(*cached_src));
+        cached_src->life = INT32_MIN;
+        return NULL;
+    }
+    cached_src->life = 0;
+    if (cached_src->dec_dsc.time_to_open == 0) {
+        cached_src->dec_dsc.time_to_open = lv_tick_elaps(t_start);
+    }
+    if (cached_src->dec_dsc.time_to_open == 0) {
+        cached_src->dec_dsc.time_to_open = 1;
+    }
+    return cached_src;
+}
+
+void lv_img_cache_set_size(uint16_t new_entry_cnt) {
+    if (LV_GC_ROOT(_lv_img_cache_array) != NULL) {
+        lv_img_cache_invalidate_src(NULL);
+        lv_mem_free(LV_GC_ROOT(_lv_img_cache_array));
+    }
+    LV_GC_ROOT(_lv_img_cache_array) = lv_mem_alloc(sizeof(_lv_img_cache_entry_t) * new_entry_cnt);
+    if (LV_GC_ROOT(_lv_img_cache_array) == NULL) {
+        entry_cnt = 0;
+        return;
+    }
+    entry_cnt = new_entry_cnt;
+    lv_memset_00(LV_GC_ROOT(_lv_img_cache_array), entry_cnt * sizeof(_lv_img_cache_entry_t));
+}
+
+void lv_img_cache_invalidate_src(const void *src) {
+    _lv_img_cache_entry_t *cache = LV_GC_ROOT(_lv_img_cache_array);
+    for (uint16_t i = 0; i < entry_cnt; i++) {
+        if (src == NULL || cache_match(src, cache[i].dec_dsc.src)) {
+            if (cache[i].dec_dsc.src != NULL) {
+                lv_img_decoder_close(&cache[i].dec_dsc);
+            }
+            lv_memset_00(&cache[i], sizeof(_lv_img_cache_entry_t));
+        }
+    }
+}
+
+// The roots were cleared by lv_deinit: nothing is cached any more
+void _lv_img_cache_reset(void) {
+    if (LV_GC_ROOT(_lv_img_cache_array) == NULL) {
+        entry_cnt = 0;
+    }
+}
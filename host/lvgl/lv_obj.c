@@ -0,0 +1,845 @@
+/*
+ * LVGL 8.3 objects and drawing for the host build
+ *
+ * Widgets are rectangles: a background, optionally a vertical gradient, and
+ * per class content drawn from its state (label characters as bit patterns,
+ * the slider and arc value as a bar, images through the decoders and their
+ * cache). Changing anything invalidates the old and the new area as LVGL does.
+ */
+
+#include <stdio.h>
+#include "lvgl.h"
+#include "lv_host_private.h"
+#include "src/misc/lv_gc.h"
+#include "src/draw/sw/lv_draw_sw_gradient.h"
+
+#define GLYPH_W             8
+#define GLYPH_H             16
+#define LIST_BTN_H          40
+
+static size_t grad_cache_size = LV_GRAD_CACHE_DEF_SIZE;
+
+// Colors
+
+lv_color_t lv_color_mix(lv_color_t c1, lv_color_t c2, uint8_t mix) {
+    lv_color_t ret;
+#if LV_COLOR_DEPTH == 32
+    ret.ch.red = (uint8_t)((c1.ch.red * mix + c2.ch.red * (255 - mix) + 127) / 255);
+    ret.ch.green = (uint8_t)((c1.ch.green * mix + c2.ch.green * (255 - mix) + 127) / 255);
+    ret.ch.blue = (uint8_t)((c1.ch.blue * mix + c2.ch.blue * (255 - mix) + 127) / 255);
+    ret.ch.alpha = 0xFF;
+#else
+    ret.full = 0;
+    ret.ch.red = (c1.ch.red * mix + c2.ch.red * (255 - mix) + 127) / 255;
+    ret.ch.green = (c1.ch.green * mix + c2.ch.green * (255 - mix) + 127) / 255;
+    ret.ch.blue = (c1.ch.blue * mix + c2.ch.blue * (255 - mix) + 127) / 255;
+#endif
+    return ret;
+}
+
+lv_color_t lv_color_hsv_to_rgb(uint16_t h, uint8_t s, uint8_t v) {
+    h = (uint32_t)((uint32_t)h * 255) / 360;
+    s = (uint16_t)((uint16_t)s * 255) / 100;
+    v = (uint16_t)((uint16_t)v * 255) / 100;
+
+    if (s == 0) {
+        return lv_color_make(v, v, v);
+    }
+    uint8_t region = h / 43;
+    uint8_t remainder = (h - (region * 43)) * 6;
+    uint8_t p = (v * (255 - s)) >> 8;
+    uint8_t q = (v * (255 - ((s * remainder) >> 8))) >> 8;
+    uint8_t t = (v * (255 - ((s * (255 - remainder)) >> 8))) >> 8;
+
+    switch (region) {
+        case 0: return lv_color_make(v, t, p);
+        case 1: return lv_color_make(q, v, p);
+        case 2: return lv_color_make(p, v, t);
+        case 3: return lv_color_make(p, q, v);
+        case 4: return lv_color_make(t, p, v);
+        default: return lv_color_make(v, p, q);
+    }
+}
+
+void lv_gradient_set_cache_size(size_t max_bytes) {
+    grad_cache_size = max_bytes;
+}
+
+size_t lv_gradient_get_cache_size(void) {
+    return grad_cache_size;
+}
+
+// Layout
+
+static lv_coord_t resolve(lv_coord_t v, lv_coord_t parent_size, lv_coord_t content) {
+    if (v == LV_SIZE_CONTENT) {
+        return content;
+    }
+    if (LV_COORD_IS_PCT(v)) {
+        return (lv_coord_t)((int32_t)parent_size * LV_COORD_GET_PCT(v) / 100);
+    }
+    return v;
+}
+
+static lv_coord_t content_w(const lv_obj_t *obj) {
+    if (obj->cls == LV_HOST_LABEL) {
+        return (lv_coord_t)(obj->text ? strlen(obj->text) * GLYPH_W : 0);
+    }
+    lv_coord_t w = 0;
+    for (uint32_t i = 0; i < obj->child_cnt; i++) {
+        w = LV_MAX(w, lv_area_get_width(&obj->children[i]->coords));
+    }
+    return w;
+}
+
+static lv_coord_t content_h(const lv_obj_t *obj) {
+    if (obj->cls == LV_HOST_LABEL) {
+        return GLYPH_H;
+    }
+    lv_coord_t h = 0;
+    for (uint32_t i = 0; i < obj->child_cnt; i++) {
+        h = LV_MAX(h, lv_area_get_height(&obj->children[i]->coords));
+    }
+    return h;
+}
+
+static void update_coords(lv_obj_t *obj) {
+    if (obj->parent == NULL) {
+        obj->coords = (lv_area_t){ 0, 0, (lv_coord_t)(obj->disp->driver->hor_res - 1), (lv_coord_t)(obj->disp->driver->ver_res - 1) };
+    } else {
+        const lv_area_t *pa = &obj->parent->coords;
+        lv_coord_t pw = lv_area_get_width(pa);
+        lv_coord_t ph = lv_area_get_height(pa);
+        lv_coord_t w = resolve(obj->w, pw, content_w(obj));
+        lv_coord_t h = resolve(obj->h, ph, content_h(obj));
+        lv_coord_t x = obj->x;
+        lv_coord_t y = obj->y;
+
+        switch (obj->align) {
+            case LV_ALIGN_TOP_MID: x += (pw - w) / 2; break;
+            case LV_ALIGN_TOP_RIGHT: x += pw - w; break;
+            case LV_ALIGN_BOTTOM_LEFT: y += ph - h; break;
+            case LV_ALIGN_BOTTOM_MID: x += (pw - w) / 2; y += ph - h; break;
+            case LV_ALIGN_BOTTOM_RIGHT: x += pw - w; y += ph - h; break;
+            case LV_ALIGN_LEFT_MID: y += (ph - h) / 2; break;
+            case LV_ALIGN_RIGHT_MID: x += pw - w; y += (ph - h) / 2; break;
+            case LV_ALIGN_CENTER: x += (pw - w) / 2; y += (ph - h) / 2; break;
+            default: break;
+        }
+        obj->coords.x1 = pa->x1 + x;
+        obj->coords.y1 = pa->y1 + y - obj->parent->scroll_y;
+        obj->coords.x2 = obj->coords.x1 + w - 1;
+        obj->coords.y2 = obj->coords.y1 + h - 1;
+    }
+    for (uint32_t i = 0; i < obj->child_cnt; i++) {
+        update_coords(obj->children[i]);
+    }
+}
+
+lv_obj_t *lv_obj_get_screen(const lv_obj_t *obj) {
+    while (obj->parent != NULL) {
+        obj = obj->parent;
+    }
+    return (lv_obj_t *)obj;
+}
+
+lv_disp_t *lv_obj_get_disp(const lv_obj_t *obj) {
+    return lv_obj_get_screen(obj)->disp;
+}
+
+lv_obj_t *lv_obj_get_parent(const lv_obj_t *obj) {
+    return obj->parent;
+}
+
+uint32_t lv_obj_get_child_cnt(const lv_obj_t *obj) {
+    return obj->child_cnt;
+}
+
+lv_obj_t *lv_obj_get_child(const lv_obj_t *obj, int32_t id) {
+    if (id < 0) {
+        id += (int32_t)obj->child_cnt;
+    }
+    return (id >= 0 && (uint32_t)id < obj->child_cnt) ? obj->children[id] : NULL;
+}
+
+void lv_obj_get_coords(const lv_obj_t *obj, lv_area_t *coords) {
+    *coords = obj->coords;
+}
+
+// Invalidation: the visible part of the area, on the active screen only
+
+void lv_obj_invalidate_area(const lv_obj_t *obj, const lv_area_t *area) {
+    lv_obj_t *scr = lv_obj_get_screen(obj);
+    lv_disp_t *disp = scr->disp;
+    if (disp == NULL || disp->act_scr != scr) {
+        return;
+    }
+    lv_area_t visible;
+    if (!_lv_area_intersect(&visible, area, &obj->coords)) {
+        return;
+    }
+    for (const lv_obj_t *p = obj->parent; p != NULL; p = p->parent) {
+        if (!_lv_area_intersect(&visible, &visible, &p->coords)) {
+            return;
+        }
+    }
+    _lv_inv_area(disp, &visible);
+}
+
+void lv_obj_invalidate(const lv_obj_t *obj) {
+    lv_obj_invalidate_area(obj, &obj->coords);
+}
+
+// Move or resize: the old and the new area are redrawn
+static void relayout(lv_obj_t *obj) {
+    lv_obj_invalidate(obj);
+    update_coords(obj);
+    lv_obj_invalidate(obj);
+    // Content sized parents follow their children
+    if (obj->parent != NULL && (obj->parent->w == LV_SIZE_CONTENT || obj->parent->h == LV_SIZE_CONTENT)) {
+        relayout(obj->parent);
+    }
+}
+
+// Creation and deletion
+
+static lv_obj_t *obj_create(lv_obj_t *parent, lv_host_class_t cls) {
+    lv_obj_t *obj = lv_mem_alloc(sizeof(lv_obj_t));
+    if (obj == NULL) {
+        return NULL;
+    }
+    memset(obj, 0, sizeof(*obj));
+    obj->cls = cls;
+    obj->parent = parent;
+    obj->bg_color = lv_color_white();
+    obj->grad_color = lv_color_black();
+    obj->bg_opa = LV_OPA_COVER;
+    obj->w = 100;
+    obj->h = 50;
+
+    if (parent != NULL) {
+        lv_obj_t **children = lv_mem_realloc(parent->children, (parent->child_cnt + 1) * sizeof(lv_obj_t *));
+        if (children == NULL) {
+            lv_mem_free(obj);
+            return NULL;
+        }
+        parent->children = children;
+        parent->children[parent->child_cnt++] = obj;
+    }
+    return obj;
+}
+
+static lv_obj_t *obj_finish(lv_obj_t *obj) {
+    if (obj != NULL) {
+        relayout(obj);
+    }
+    return obj;
+}
+
+static lv_obj_t *screen_create(lv_disp_t *disp) {
+    if (disp == NULL) {
+        return NULL;
+    }
+    lv_obj_t **screens = lv_mem_realloc(disp->screens, (disp->screen_cnt + 1) * sizeof(lv_obj_t *));
+    if (screens == NULL) {
+        return NULL;
+    }
+    disp->screens = screens;
+    lv_obj_t *scr = obj_create(NULL, LV_HOST_OBJ);
+    if (scr == NULL) {
+        return NULL;
+    }
+    scr->disp = disp;
+    disp->screens[disp->screen_cnt++] = scr;
+    update_coords(scr);
+    return scr;
+}
+
+lv_obj_t *_lv_obj_create_screen(lv_disp_t *disp) {
+    return screen_create(disp);
+}
+
+lv_obj_t *lv_obj_create(lv_obj_t *parent) {
+    if (parent == NULL) {
+        return screen_create(lv_disp_get_default());
+    }
+    return obj_finish(obj_create(parent, LV_HOST_OBJ));
+}
+
+static void obj_del(lv_obj_t *obj) {
+    while (obj->child_cnt > 0) {
+        obj_del(obj->children[obj->child_cnt - 1]);
+    }
+    lv_mem_free(obj->children);
+
+    lv_obj_t *parent = obj->parent;
+    if (parent != NULL) {
+        for (uint32_t i = 0; i < parent->child_cnt; i++) {
+            if (parent->children[i] == obj) {
+                memmove(&parent->children[i], &parent->children[i + 1], (parent->child_cnt - i - 1) * sizeof(lv_obj_t *));
+                parent->child_cnt--;
+                break;
+            }
+        }
+    } else if (obj->disp != NULL) {
+        lv_disp_t *disp = obj->disp;
+        for (uint32_t i = 0; i < disp->screen_cnt; i++) {
+            if (disp->screens[i] == obj) {
+                memmove(&disp->screens[i], &disp->screens[i + 1], (disp->screen_cnt - i - 1) * sizeof(lv_obj_t *));
+                disp->screen_cnt--;
+                break;
+            }
+        }
+        if (disp->act_scr == obj) {
+            disp->act_scr = NULL;
+        }
+    }
+
+    lv_indev_t *indev = NULL;
+    while ((indev = lv_indev_get_next(indev)) != NULL) {
+        if (indev->proc.pointer.act_obj == obj) {
+            indev->proc.pointer.act_obj = NULL;
+        }
+    }
+    lv_mem_free(obj->text);
+    lv_mem_free(obj);
+}
+
+void lv_obj_del(lv_obj_t *obj) {
+    lv_obj_invalidate(obj);
+    lv_obj_t *parent = obj->parent;
+    obj_del(obj);
+    if (parent != NULL && (parent->w == LV_SIZE_CONTENT || parent->h == LV_SIZE_CONTENT)) {
+        relayout(parent);
+    }
+}
+
+void lv_obj_clean(lv_obj_t *obj) {
+    lv_obj_invalidate(obj);
+    while (obj->child_cnt > 0) {
+        obj_del(obj->children[obj->child_cnt - 1]);
+    }
+}
+
+// Position and size
+
+void lv_obj_set_pos(lv_obj_t *obj, lv_coord_t x, lv_coord_t y) {
+    obj->x = x;
+    obj->y = y;
+    obj->align = LV_ALIGN_DEFAULT;
+    relayout(obj);
+}
+
+void lv_obj_set_x(lv_obj_t *obj, lv_coord_t x) {
+    obj->x = x;
+    relayout(obj);
+}
+
+void lv_obj_set_y(lv_obj_t *obj, lv_coord_t y) {
+    obj->y = y;
+    relayout(obj);
+}
+
+void lv_obj_set_size(lv_obj_t *obj, lv_coord_t w, lv_coord_t h) {
+    obj->w = w;
+    obj->h = h;
+    relayout(obj);
+}
+
+void lv_obj_set_width(lv_obj_t *obj, lv_coord_t w) {
+    obj->w = w;
+    relayout(obj);
+}
+
+void lv_obj_set_height(lv_obj_t *obj, lv_coord_t h) {
+    obj->h = h;
+    relayout(obj);
+}
+
+lv_coord_t lv_obj_get_width(const lv_obj_t *obj) {
+    return lv_area_get_width(&obj->coords);
+}
+
+lv_coord_t lv_obj_get_height(const lv_obj_t *obj) {
+    return lv_area_get_height(&obj->coords);
+}
+
+void lv_obj_align(lv_obj_t *obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs) {
+    obj->align = align;
+    obj->x = x_ofs;
+    obj->y = y_ofs;
+    relayout(obj);
+}
+
+void lv_obj_center(lv_obj_t *obj) {
+    lv_obj_align(obj, LV_ALIGN_CENTER, 0, 0);
+}
+
+void lv_obj_update_layout(const lv_obj_t *obj) {
+    LV_UNUSED(obj);
+}
+
+// State and styles
+
+void lv_obj_add_state(lv_obj_t *obj, lv_state_t state) {
+    if ((obj->state | state) != obj->state) {
+        obj->state |= state;
+        lv_obj_invalidate(obj);
+    }
+}
+
+void lv_obj_clear_state(lv_obj_t *obj, lv_state_t state) {
+    if ((obj->state & ~state) != obj->state) {
+        obj->state &= ~state;
+        lv_obj_invalidate(obj);
+    }
+}
+
+bool lv_obj_has_state(const lv_obj_t *obj, lv_state_t state) {
+    return (obj->state & state) == state;
+}
+
+void lv_obj_remove_style(lv_obj_t *obj, lv_style_t *style, lv_style_selector_t selector) {
+    LV_UNUSED(style);
+    if ((selector & 0xFF0000) == LV_PART_MAIN) {
+        obj->bg_opa = LV_OPA_TRANSP;
+        obj->grad_dir = LV_GRAD_DIR_NONE;
+    }
+    lv_obj_invalidate(obj);
+}
+
+void lv_obj_remove_style_all(lv_obj_t *obj) {
+    obj->bg_opa = LV_OPA_TRANSP;
+    obj->grad_dir = LV_GRAD_DIR_NONE;
+    lv_obj_invalidate(obj);
+}
+
+void lv_obj_set_style_bg_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector) {
+    LV_UNUSED(selector);
+    obj->bg_color = value;
+    lv_obj_invalidate(obj);
+}
+
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector) {
+    LV_UNUSED(selector);
+    obj->bg_opa = value;
+    lv_obj_invalidate(obj);
+}
+
+void lv_obj_set_style_bg_grad_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector) {
+    LV_UNUSED(selector);
+    obj->grad_color = value;
+    lv_obj_invalidate(obj);
+}
+
+void lv_obj_set_style_bg_grad_dir(lv_obj_t *obj, lv_grad_dir_t value, lv_style_selector_t selector) {
+    LV_UNUSED(selector);
+    obj->grad_dir = value;
+    lv_obj_invalidate(obj);
+}
+
+// Scrolling
+
+lv_coord_t lv_obj_get_scroll_y(const lv_obj_t *obj) {
+    return obj->scroll_y;
+}
+
+lv_coord_t lv_obj_get_scroll_bottom(lv_obj_t *obj) {
+    lv_coord_t bottom = obj->coords.y2;
+    for (uint32_t i = 0; i < obj->child_cnt; i++) {
+        bottom = LV_MAX(bottom, obj->children[i]->coords.y2);
+    }
+    return bottom - obj->coords.y2;
+}
+
+void lv_obj_scroll_to_y(lv_obj_t *obj, lv_coord_t y, lv_anim_enable_t anim_en) {
+    LV_UNUSED(anim_en);
+    if (y == obj->scroll_y) {
+        return;
+    }
+    obj->scroll_y = y;
+    update_coords(obj);
+    lv_obj_invalidate(obj);
+}
+
+// Widgets
+
+lv_obj_t *lv_label_create(lv_obj_t *parent) {
+    lv_obj_t *obj = obj_create(parent, LV_HOST_LABEL);
+    if (obj == NULL) {
+        return NULL;
+    }
+    obj->bg_opa = LV_OPA_TRANSP;
+    obj->w = LV_SIZE_CONTENT;
+    obj->h = LV_SIZE_CONTENT;
+    obj->text = lv_mem_alloc(6);
+    if (obj->text != NULL) {
+        strcpy(obj->text, "Text");
+    }
+    return obj_finish(obj);
+}
+
+void lv_label_set_text(lv_obj_t *obj, const char *text) {
+    size_t len = strlen(text);
+    char *copy = lv_mem_alloc(len + 1);
+    if (copy == NULL) {
+        return;
+    }
+    memcpy(copy, text, len + 1);
+    lv_mem_free(obj->text);
+    obj->text = copy;
+    relayout(obj);
+}
+
+void lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...) {
+    char text[128];
+    va_list va;
+    va_start(va, fmt);
+    lv_vsnprintf(text, sizeof(text), fmt, va);
+    va_end(va);
+    lv_label_set_text(obj, text);
+}
+
+const char *lv_label_get_text(const lv_obj_t *obj) {
+    return obj->text;
+}
+
+lv_obj_t *lv_btn_create(lv_obj_t *parent) {
+    lv_obj_t *obj = obj_create(parent, LV_HOST_BTN);
+    if (obj == NULL) {
+        return NULL;
+    }
+    obj->bg_color = lv_color_hex(0x2196F3);
+    obj->w = 100;
+    obj->h = 40;
+    return obj_finish(obj);
+}
+
+lv_obj_t *lv_switch_create(lv_obj_t *parent) {
+    lv_obj_t *obj = obj_create(parent, LV_HOST_SWITCH);
+    if (obj == NULL) {
+        return NULL;
+    }
+    obj->bg_color = lv_color_hex(0xBDBDBD);
+    obj->w = 50;
+    obj->h = 26;
+    return obj_finish(obj);
+}
+
+lv_obj_t *lv_slider_create(lv_obj_t *parent) {
+    lv_obj_t *obj = obj_create(parent, LV_HOST_SLIDER);
+    if (obj == NULL) {
+        return NULL;
+    }
+    obj->bg_color = lv_color_hex(0xBDBDBD);
+    obj->w = 150;
+    obj->h = 10;
+    return obj_finish(obj);
+}
+
+void lv_slider_set_value(lv_obj_t *obj, int32_t value, lv_anim_enable_t anim) {
+    LV_UNUSED(anim);
+    obj->value = LV_MAX(0, LV_MIN(100, value));
+    lv_obj_invalidate(obj);
+}
+
+lv_obj_t *lv_arc_create(lv_obj_t *parent) {
+    lv_obj_t *obj = obj_create(parent, LV_HOST_ARC);
+    if (obj == NULL) {
+        return NULL;
+    }
+    obj->bg_opa = LV_OPA_TRANSP;
+    obj->w = 100;
+    obj->h = 100;
+    obj->value2 = 270;
+    return obj_finish(obj);
+}
+
+void lv_arc_set_angles(lv_obj_t *obj, uint16_t start, uint16_t end) {
+    obj->value = start % 360;
+    obj->value2 = end % 360;
+    lv_obj_invalidate(obj);
+}
+
+void lv_arc_set_bg_angles(lv_obj_t *obj, uint16_t start, uint16_t end) {
+    LV_UNUSED(start);
+    LV_UNUSED(end);
+    lv_obj_invalidate(obj);
+}
+
+lv_obj_t *lv_list_create(lv_obj_t *parent) {
+    lv_obj_t *obj = obj_create(parent, LV_HOST_LIST);
+    if (obj == NULL) {
+        return NULL;
+    }
+    obj->w = 200;
+    obj->h = 300;
+    return obj_finish(obj);
+}
+
+lv_obj_t *lv_list_add_btn(lv_obj_t *list, const void *icon, const char *txt) {
+    LV_UNUSED(icon);
+    uint32_t index = list->child_cnt;
+    lv_obj_t *btn = obj_create(list, LV_HOST_BTN);
+    if (btn == NULL) {
+        return NULL;
+    }
+    btn->bg_color = (index & 1) ? lv_color_hex(0xEEEEEE) : lv_color_white();
+    btn->w = lv_pct(100);
+    btn->h = LIST_BTN_H;
+    btn->y = (lv_coord_t)(index * LIST_BTN_H);
+    obj_finish(btn);
+    if (txt != NULL) {
+        lv_obj_t *label = lv_label_create(btn);
+        if (label != NULL) {
+            lv_label_set_text(label, txt);
+            lv_obj_align(label, LV_ALIGN_LEFT_MID, 8, 0);
+        }
+    }
+    return btn;
+}
+
+lv_obj_t *lv_img_create(lv_obj_t *parent) {
+    lv_obj_t *obj = obj_create(parent, LV_HOST_IMG);
+    if (obj == NULL) {
+        return NULL;
+    }
+    obj->bg_opa = LV_OPA_TRANSP;
+    obj->w = 0;
+    obj->h = 0;
+    return obj_finish(obj);
+}
+
+void lv_img_set_src(lv_obj_t *obj, const void *src) {
+    lv_img_header_t header;
+    obj->src = src;
+    if (src != NULL && lv_img_decoder_get_info(src, &header) == LV_RES_OK) {
+        obj->w = header.w;
+        obj->h = header.h;
+    }
+    relayout(obj);
+}
+
+// Hit test: children on top of their parents, later siblings on top
+
+static bool clickable(const lv_obj_t *obj) {
+    return obj->parent != NULL && obj->cls != LV_HOST_LABEL && obj->cls != LV_HOST_IMG;
+}
+
+static lv_obj_t *hit(lv_obj_t *obj, const lv_point_t *p) {
+    if (p->x < obj->coords.x1 || p->x > obj->coords.x2 || p->y < obj->coords.y1 || p->y > obj->coords.y2) {
+        return NULL;
+    }
+    for (uint32_t i = obj->child_cnt; i > 0; i--) {
+        lv_obj_t *found = hit(obj->children[i - 1], p);
+        if (found != NULL) {
+            return found;
+        }
+    }
+    return clickable(obj) ? obj : NULL;
+}
+
+lv_obj_t *_lv_obj_hit(lv_obj_t *scr, const lv_point_t *point) {
+    return hit(scr, point);
+}
+
+// Drawing
+
+static lv_color_t *px_ptr(lv_draw_ctx_t *draw_ctx, lv_coord_t x, lv_coord_t y) {
+    const lv_area_t *ba = draw_ctx->buf_area;
+    return (lv_color_t *)draw_ctx->buf + (int32_t)(y - ba->y1) * lv_area_get_width(ba) + (x - ba->x1);
+}
+
+static void fill(lv_draw_ctx_t *draw_ctx, const lv_area_t *area, lv_color_t color, lv_opa_t opa) {
+    lv_area_t a;
+    if (!_lv_area_intersect(&a, area, draw_ctx->clip_area)) {
+        return;
+    }
+    for (lv_coord_t y = a.y1; y <= a.y2; y++) {
+        lv_color_t *px = px_ptr(draw_ctx, a.x1, y);
+        for (lv_coord_t x = a.x1; x <= a.x2; x++, px++) {
+            *px = (opa >= LV_OPA_COVER) ? color : lv_color_mix(color, *px, opa);
+        }
+    }
+}
+
+static void draw_bg(lv_draw_ctx_t *draw_ctx, const lv_obj_t *obj) {
+    if (obj->bg_opa == LV_OPA_TRANSP) {
+        return;
+    }
+    lv_color_t color = obj->bg_color;
+    if (obj->state & LV_STATE_PRESSED) {
+        color = lv_color_mix(lv_color_black(), color, 51);
+    } else if ((obj->state & LV_STATE_CHECKED) && obj->cls == LV_HOST_SWITCH) {
+        color = lv_color_hex(0x2196F3);
+    }
+    if (obj->grad_dir != LV_GRAD_DIR_VER) {
+        fill(draw_ctx, &obj->coords, color, obj->bg_opa);
+        return;
+    }
+    lv_coord_t h = lv_area_get_height(&obj->coords);
+    for (lv_coord_t y = obj->coords.y1; y <= obj->coords.y2; y++) {
+        lv_area_t row = { obj->coords.x1, y, obj->coords.x2, y };
+        uint8_t mix = (uint8_t)(255 - (int32_t)(y - obj->coords.y1) * 255 / LV_MAX(h - 1, 1));
+        fill(draw_ctx, &row, lv_color_mix(color, obj->grad_color, mix), obj->bg_opa);
+    }
+}
+
+// Characters as an 6 x 12 bit pattern of their code, one glyph per 8 x 16 cell
+static void draw_text(lv_draw_ctx_t *draw_ctx, const lv_obj_t *obj) {
+    if (obj->text == NULL) {
+        return;
+    }
+    lv_color_t color = lv_color_black();
+    for (size_t i = 0; obj->text[i] != '\0'; i++) {
+        uint32_t bits = (uint8_t)obj->text[i] * 2654435761u;
+        lv_coord_t cx = (lv_coord_t)(obj->coords.x1 + i * GLYPH_W);
+        for (int gy = 0; gy < 12; gy++) {
+            for (int gx = 0; gx < 6; gx++) {
+                if ((bits >> ((gy / 2) * 5 + gx % 5)) & 1) {
+                    lv_area_t dot = { (lv_coord_t)(cx + 1 + gx), (lv_coord_t)(obj->coords.y1 + 2 + gy),
+                                      (lv_coord_t)(cx + 1 + gx), (lv_coord_t)(obj->coords.y1 + 2 + gy) };
+                    fill(draw_ctx, &dot, color, LV_OPA_COVER);
+                }
+            }
+        }
+    }
+}
+
+static void draw_bar(lv_draw_ctx_t *draw_ctx, const lv_obj_t *obj, int32_t from, int32_t to, int32_t range) {
+    lv_coord_t w = lv_area_get_width(&obj->coords);
+    lv_area_t bar = obj->coords;
+    if (obj->cls == LV_HOST_ARC) {
+        lv_coord_t mid = (obj->coords.y1 + obj->coords.y2) / 2;
+        bar.y1 = mid - 5;
+        bar.y2 = mid + 5;
+    }
+    if (to < from) {
+        lv_area_t head = bar;
+        head.x2 = (lv_coord_t)(bar.x1 + (int32_t)w * to / range - 1);
+        fill(draw_ctx, &head, lv_color_hex(0x2196F3), LV_OPA_COVER);
+        to = range;
+    }
+    bar.x2 = (lv_coord_t)(obj->coords.x1 + (int32_t)w * to / range - 1);
+    bar.x1 = (lv_coord_t)(obj->coords.x1 + (int32_t)w * from / range);
+    fill(draw_ctx, &bar, lv_color_hex(0x2196F3), LV_OPA_COVER);
+}
+
+void _lv_obj_render(lv_obj_t *obj, lv_draw_ctx_t *draw_ctx) {
+    const lv_area_t *clip_parent = draw_ctx->clip_area;
+    lv_area_t clip;
+    if (obj == NULL || !_lv_area_intersect(&clip, &obj->coords, clip_parent)) {
+        return;
+    }
+    draw_ctx->clip_area = &clip;
+
+    draw_bg(draw_ctx, obj);
+    switch (obj->cls) {
+        case LV_HOST_LABEL:
+            draw_text(draw_ctx, obj);
+            break;
+        case LV_HOST_SLIDER:
+            draw_bar(draw_ctx, obj, 0, obj->value, 100);
+            break;
+        case LV_HOST_ARC:
+            draw_bar(draw_ctx, obj, obj->value, obj->value2, 360);
+            break;
+        case LV_HOST_IMG:
+            if (obj->src != NULL) {
+                lv_draw_img_dsc_t dsc;
+                lv_draw_img_dsc_init(&dsc);
+                lv_draw_img(draw_ctx, &dsc, &obj->coords, obj->src);
+            }
+            break;
+        default:
+            break;
+    }
+    for (uint32_t i = 0; i < obj->child_cnt; i++) {
+        _lv_obj_render(obj->children[i], draw_ctx);
+    }
+    draw_ctx->clip_area = clip_parent;
+}
+
+void lv_draw_img_dsc_init(lv_draw_img_dsc_t *dsc) {
+    memset(dsc, 0, sizeof(*dsc));
+    dsc->recolor = lv_color_black();
+    dsc->opa = LV_OPA_COVER;
+    dsc->zoom = 256;
+    dsc->antialias = 1;
+}
+
+static void draw_img_decoded(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *draw_dsc,
+                             const lv_area_t *coords, const uint8_t *map_p, lv_img_cf_t cf) {
+    lv_area_t a;
+    if (!_lv_area_intersect(&a, coords, draw_ctx->clip_area)) {
+        return;
+    }
+    lv_coord_t w = lv_area_get_width(coords);
+    size_t px_size = (cf == LV_IMG_CF_TRUE_COLOR_ALPHA) ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t);
+    for (lv_coord_t y = a.y1; y <= a.y2; y++) {
+        lv_color_t *px = px_ptr(draw_ctx, a.x1, y);
+        const uint8_t *src = map_p + ((size_t)(y - coords->y1) * w + (a.x1 - coords->x1)) * px_size;
+        for (lv_coord_t x = a.x1; x <= a.x2; x++, px++, src += px_size) {
+            lv_color_t c;
+            memcpy(&c, src, sizeof(c));
+            lv_opa_t opa = draw_dsc->opa;
+            if (cf == LV_IMG_CF_TRUE_COLOR_ALPHA) {
+                opa = (lv_opa_t)(opa * src[px_size - 1] / 255);
+            }
+            *px = (opa >= LV_OPA_COVER) ? c : lv_color_mix(c, *px, opa);
+        }
+    }
+}
+
+// Through the image cache when the draw context does not draw the image itself
+void lv_draw_img(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_area_t *coords, const void *src) {
+    if (src == NULL || dsc->opa == LV_OPA_TRANSP) {
+        return;
+    }
+    lv_res_t res = LV_RES_INV;
+    if (draw_ctx->draw_img) {
+        res = draw_ctx->draw_img(draw_ctx, dsc, coords, src);
+    }
+    if (res == LV_RES_OK) {
+        return;
+    }
+
+    _lv_img_cache_entry_t *cdsc = _lv_img_cache_open(src, dsc->recolor, dsc->frame_id);
+    if (cdsc == NULL) {
+        return;
+    }
+    lv_img_cf_t cf = cdsc->dec_dsc.header.cf;
+    if (cdsc->dec_dsc.img_data != NULL) {
+        draw_ctx->draw_img_decoded(draw_ctx, dsc, coords, cdsc->dec_dsc.img_data, cf);
+        return;
+    }
+
+    // Line by line through the decoder
+    lv_img_decoder_t *decoder = cdsc->dec_dsc.decoder;
+    if (decoder == NULL || decoder->read_line_cb == NULL) {
+        return;
+    }
+    lv_coord_t w = lv_area_get_width(coords);
+    size_t px_size = (cf == LV_IMG_CF_TRUE_COLOR_ALPHA) ? LV_IMG_PX_SIZE_ALPHA_BYTE : sizeof(lv_color_t);
+    uint8_t *line = lv_mem_alloc(w * px_size);
+    if (line == NULL) {
+        return;
+    }
+    for (lv_coord_t y = coords->y1; y <= coords->y2; y++) {
+        if (y < draw_ctx->clip_area->y1 || y > draw_ctx->clip_area->y2) {
+            continue;
+        }
+        if (decoder->read_line_cb(decoder, &cdsc->dec_dsc, 0, y - coords->y1, w, line) != LV_RES_OK) {
+            break;
+        }
+        lv_area_t row = { coords->x1, y, coords->x2, y };
+        draw_ctx->draw_img_decoded(draw_ctx, dsc, &row, line, cf);
+    }
+    lv_mem_free(line);
+}
+
+void lv_draw_sw_init_ctx(lv_disp_drv_t *drv, lv_draw_ctx_t *draw_ctx) {
+    LV_UNUSED(drv);
+    memset(draw_ctx, 0, sizeof(*draw_ctx));
+    draw_ctx->draw_img_decoded = draw_img_decoded;
+}
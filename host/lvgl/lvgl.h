@@ -0,0 +1,606 @@
+/*
+ * LVGL 8.3 for the host build
+ *
+ * The part of the v8.3 API the modules use, with its types, names and
+ * semantics: lv_conf.h from lvgl_driver configures it, the display refresh
+ * splits the invalid areas into draw buffer sized parts and waits on
+ * draw_buf->flushing exactly where lv_refr.c does, timers, input devices, the
+ * image decoders and their cache behave as upstream. Widgets are plain
+ * rectangles with deterministic content (labels draw a bit pattern per
+ * character), enough to render, invalidate and scroll, not to look like LVGL.
+ */
+
+#ifndef HOST_LVGL_H
+#define HOST_LVGL_H
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "lv_conf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LVGL_VERSION_MAJOR 8
+#define LVGL_VERSION_MINOR 3
+#define LVGL_VERSION_PATCH 0
+
+#ifndef LV_INV_BUF_SIZE
+#define LV_INV_BUF_SIZE 32
+#endif
+
+#define LV_MIN(a, b) ((a) < (b) ? (a) : (b))
+#define LV_MAX(a, b) ((a) > (b) ? (a) : (b))
+#define LV_UNUSED(x) ((void)x)
+#define LV_NO_TIMER_READY 0xFFFFFFFF
+
+typedef int16_t lv_coord_t;
+typedef uint8_t lv_opa_t;
+
+typedef enum {
+    LV_RES_INV = 0,
+    LV_RES_OK,
+} lv_res_t;
+
+enum {
+    LV_OPA_TRANSP = 0,
+    LV_OPA_50 = 127,
+    LV_OPA_COVER = 255,
+};
+
+enum {
+    LV_ANIM_OFF,
+    LV_ANIM_ON,
+};
+typedef uint8_t lv_anim_enable_t;
+
+// Coordinates: percentages are tagged like upstream's LV_COORD_SET_SPEC
+#define _LV_COORD_TYPE_SPEC     (1 << 13)
+#define LV_COORD_IS_PCT(x)      (((x) & _LV_COORD_TYPE_SPEC) && ((x) & 0x1FFF) <= 1000)
+#define LV_COORD_GET_PCT(x)     ((x) & 0x1FFF)
+#define LV_SIZE_CONTENT         (_LV_COORD_TYPE_SPEC | 2001)
+
+static inline lv_coord_t lv_pct(lv_coord_t x) {
+    return (lv_coord_t)(_LV_COORD_TYPE_SPEC | x);
+}
+
+typedef struct {
+    lv_coord_t x;
+    lv_coord_t y;
+} lv_point_t;
+
+typedef struct {
+    lv_coord_t x1;
+    lv_coord_t y1;
+    lv_coord_t x2;
+    lv_coord_t y2;
+} lv_area_t;
+
+static inline lv_coord_t lv_area_get_width(const lv_area_t *a) {
+    return (lv_coord_t)(a->x2 - a->x1 + 1);
+}
+
+static inline lv_coord_t lv_area_get_height(const lv_area_t *a) {
+    return (lv_coord_t)(a->y2 - a->y1 + 1);
+}
+
+static inline uint32_t lv_area_get_size(const lv_area_t *a) {
+    return (uint32_t)lv_area_get_width(a) * (uint32_t)lv_area_get_height(a);
+}
+
+bool _lv_area_intersect(lv_area_t *res, const lv_area_t *a1, const lv_area_t *a2);
+bool _lv_area_is_in(const lv_area_t *ain, const lv_area_t *aholder, lv_coord_t radius);
+
+// Colors, LV_COLOR_16_SWAP 0
+
+#if LV_COLOR_DEPTH == 8
+typedef union {
+    struct {
+        uint8_t blue : 2;
+        uint8_t green : 3;
+        uint8_t red : 3;
+    } ch;
+    uint8_t full;
+} lv_color_t;
+#define LV_COLOR_SIZE 8
+#elif LV_COLOR_DEPTH == 16
+typedef union {
+    struct {
+        uint16_t blue : 5;
+        uint16_t green : 6;
+        uint16_t red : 5;
+    } ch;
+    uint16_t full;
+} lv_color_t;
+#define LV_COLOR_SIZE 16
+#elif LV_COLOR_DEPTH == 32
+typedef union {
+    struct {
+        uint8_t blue;
+        uint8_t green;
+        uint8_t red;
+        uint8_t alpha;
+    } ch;
+    uint32_t full;
+} lv_color_t;
+#define LV_COLOR_SIZE 32
+#else
+#error "LV_COLOR_DEPTH must be 8, 16 or 32"
+#endif
+
+static inline lv_color_t lv_color_make(uint8_t r, uint8_t g, uint8_t b) {
+    lv_color_t c;
+#if LV_COLOR_DEPTH == 8
+    c.full = (uint8_t)((r & 0xE0) | ((g >> 3) & 0x1C) | (b >> 6));
+#elif LV_COLOR_DEPTH == 16
+    c.full = (uint16_t)(((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3));
+#else
+    c.full = 0xFF000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+#endif
+    return c;
+}
+
+static inline lv_color_t lv_color_hex(uint32_t c) {
+    return lv_color_make((uint8_t)(c >> 16), (uint8_t)(c >> 8), (uint8_t)c);
+}
+
+static inline lv_color_t lv_color_white(void) {
+    return lv_color_make(0xFF, 0xFF, 0xFF);
+}
+
+static inline lv_color_t lv_color_black(void) {
+    return lv_color_make(0, 0, 0);
+}
+
+// mix: weight of c1, 0 to 255
+lv_color_t lv_color_mix(lv_color_t c1, lv_color_t c2, uint8_t mix);
+lv_color_t lv_color_hsv_to_rgb(uint16_t h, uint8_t s, uint8_t v);
+
+// Memory, LV_MEM_CUSTOM selects the allocator of lv_conf.h
+
+typedef struct {
+    uint32_t total_size;
+    uint32_t free_cnt;
+    uint32_t free_size;
+    uint32_t free_biggest_size;
+    uint32_t used_cnt;
+    uint32_t max_used;
+    uint8_t used_pct;
+    uint8_t frag_pct;
+} lv_mem_monitor_t;
+
+void lv_mem_init(void);
+void lv_mem_deinit(void);
+void *lv_mem_alloc(size_t size);
+void lv_mem_free(void *data);
+void *lv_mem_realloc(void *data_p, size_t new_size);
+void lv_mem_monitor(lv_mem_monitor_t *mon_p);
+
+static inline void lv_memset_00(void *dst, size_t len) {
+    memset(dst, 0, len);
+}
+
+static inline void *lv_memcpy(void *dst, const void *src, size_t len) {
+    return memcpy(dst, src, len);
+}
+
+int lv_snprintf(char *buffer, size_t count, const char *format, ...);
+int lv_vsnprintf(char *buffer, size_t count, const char *format, va_list va);
+
+// Linked lists, the node links follow the data as upstream
+
+typedef uint8_t lv_ll_node_t;
+
+typedef struct {
+    uint32_t n_size;
+    lv_ll_node_t *head;
+    lv_ll_node_t *tail;
+} lv_ll_t;
+
+void _lv_ll_init(lv_ll_t *ll_p, uint32_t node_size);
+void *_lv_ll_ins_head(lv_ll_t *ll_p);
+void *_lv_ll_ins_tail(lv_ll_t *ll_p);
+void _lv_ll_remove(lv_ll_t *ll_p, void *node_p);
+void _lv_ll_clear(lv_ll_t *ll_p);
+void *_lv_ll_get_head(const lv_ll_t *ll_p);
+void *_lv_ll_get_next(const lv_ll_t *ll_p, const void *n_act);
+
+#define _LV_LL_READ(list, i) for(i = _lv_ll_get_head(list); i != NULL; i = _lv_ll_get_next(list, i))
+
+// Tick, from LV_TICK_CUSTOM_SYS_TIME_EXPR
+
+uint32_t lv_tick_get(void);
+uint32_t lv_tick_elaps(uint32_t prev_tick);
+
+// Timers
+
+struct _lv_timer_t;
+typedef void (*lv_timer_cb_t)(struct _lv_timer_t *);
+
+typedef struct _lv_timer_t {
+    uint32_t period;
+    uint32_t last_run;
+    lv_timer_cb_t timer_cb;
+    void *user_data;
+    int32_t repeat_count;
+    uint32_t paused : 1;
+} lv_timer_t;
+
+lv_timer_t *lv_timer_create(lv_timer_cb_t timer_xcb, uint32_t period, void *user_data);
+void lv_timer_del(lv_timer_t *timer);
+void lv_timer_pause(lv_timer_t *timer);
+void lv_timer_resume(lv_timer_t *timer);
+void lv_timer_set_cb(lv_timer_t *timer, lv_timer_cb_t timer_cb);
+void lv_timer_set_period(lv_timer_t *timer, uint32_t period);
+void lv_timer_ready(lv_timer_t *timer);
+lv_timer_t *lv_timer_get_next(lv_timer_t *timer);
+uint32_t lv_timer_handler(void);
+
+static inline uint32_t lv_task_handler(void) {
+    return lv_timer_handler();
+}
+
+// Images
+
+enum {
+    LV_IMG_CF_UNKNOWN = 0,
+    LV_IMG_CF_RAW,
+    LV_IMG_CF_RAW_ALPHA,
+    LV_IMG_CF_RAW_CHROMA_KEYED,
+    LV_IMG_CF_TRUE_COLOR,
+    LV_IMG_CF_TRUE_COLOR_ALPHA,
+    LV_IMG_CF_TRUE_COLOR_CHROMA_KEYED,
+};
+typedef uint8_t lv_img_cf_t;
+
+#define LV_IMG_PX_SIZE_ALPHA_BYTE ((LV_COLOR_SIZE / 8) + 1)
+
+typedef struct {
+    uint32_t cf : 5;
+    uint32_t always_zero : 3;
+    uint32_t reserved : 2;
+    uint32_t w : 11;
+    uint32_t h : 11;
+} lv_img_header_t;
+
+typedef struct {
+    lv_img_header_t header;
+    uint32_t data_size;
+    const uint8_t *data;
+} lv_img_dsc_t;
+
+typedef enum {
+    LV_IMG_SRC_VARIABLE,
+    LV_IMG_SRC_FILE,
+    LV_IMG_SRC_SYMBOL,
+    LV_IMG_SRC_UNKNOWN,
+} lv_img_src_t;
+
+lv_img_src_t lv_img_src_get_type(const void *src);
+uint32_t lv_img_buf_get_img_size(lv_coord_t w, lv_coord_t h, lv_img_cf_t cf);
+
+struct _lv_img_decoder_t;
+struct _lv_img_decoder_dsc_t;
+
+typedef lv_res_t (*lv_img_decoder_info_f_t)(struct _lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header);
+typedef lv_res_t (*lv_img_decoder_open_f_t)(struct _lv_img_decoder_t *decoder, struct _lv_img_decoder_dsc_t *dsc);
+typedef lv_res_t (*lv_img_decoder_read_line_f_t)(struct _lv_img_decoder_t *decoder, struct _lv_img_decoder_dsc_t *dsc,
+                                                 lv_coord_t x, lv_coord_t y, lv_coord_t len, uint8_t *buf);
+typedef void (*lv_img_decoder_close_f_t)(struct _lv_img_decoder_t *decoder, struct _lv_img_decoder_dsc_t *dsc);
+
+typedef struct _lv_img_decoder_t {
+    lv_img_decoder_info_f_t info_cb;
+    lv_img_decoder_open_f_t open_cb;
+    lv_img_decoder_read_line_f_t read_line_cb;
+    lv_img_decoder_close_f_t close_cb;
+    void *user_data;
+} lv_img_decoder_t;
+
+typedef struct _lv_img_decoder_dsc_t {
+    lv_img_decoder_t *decoder;
+    const void *src;
+    lv_color_t color;
+    int32_t frame_id;
+    lv_img_src_t src_type;
+    lv_img_header_t header;
+    const uint8_t *img_data;
+    uint32_t time_to_open;
+    const char *error_msg;
+    void *user_data;
+} lv_img_decoder_dsc_t;
+
+lv_img_decoder_t *lv_img_decoder_create(void);
+void lv_img_decoder_delete(lv_img_decoder_t *decoder);
+lv_res_t lv_img_decoder_get_info(const void *src, lv_img_header_t *header);
+lv_res_t lv_img_decoder_open(lv_img_decoder_dsc_t *dsc, const void *src, lv_color_t color, int32_t frame_id);
+void lv_img_decoder_close(lv_img_decoder_dsc_t *dsc);
+
+typedef struct {
+    lv_img_decoder_dsc_t dec_dsc;
+    int32_t life;
+} _lv_img_cache_entry_t;
+
+_lv_img_cache_entry_t *_lv_img_cache_open(const void *src, lv_color_t color, int32_t frame_id);
+void lv_img_cache_set_size(uint16_t new_slot_num);
+void lv_img_cache_invalidate_src(const void *src);
+
+// Drawing
+
+typedef struct {
+    int16_t angle;
+    uint16_t zoom;
+    lv_point_t pivot;
+    lv_color_t recolor;
+    lv_opa_t recolor_opa;
+    lv_opa_t opa;
+    uint8_t blend_mode;
+    int32_t frame_id;
+    uint8_t antialias;
+} lv_draw_img_dsc_t;
+
+typedef struct _lv_draw_ctx_t {
+    void *buf;
+    lv_area_t *buf_area;
+    const lv_area_t *clip_area;
+    lv_res_t (*draw_img)(struct _lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *draw_dsc,
+                         const lv_area_t *coords, const void *src);
+    void (*draw_img_decoded)(struct _lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *draw_dsc,
+                             const lv_area_t *coords, const uint8_t *map_p, lv_img_cf_t color_format);
+    void (*wait_for_finish)(struct _lv_draw_ctx_t *draw_ctx);
+    void *user_data;
+} lv_draw_ctx_t;
+
+void lv_draw_img_dsc_init(lv_draw_img_dsc_t *dsc);
+void lv_draw_img(lv_draw_ctx_t *draw_ctx, const lv_draw_img_dsc_t *dsc, const lv_area_t *coords, const void *src);
+
+// Display
+
+struct _lv_disp_drv_t;
+struct _lv_disp_t;
+struct _lv_obj_t;
+
+typedef struct _lv_disp_draw_buf_t {
+    void *buf1;
+    void *buf2;
+    void *buf_act;
+    uint32_t size;                      // in pixels
+    volatile int flushing;
+    volatile int flushing_last;
+    volatile uint32_t last_area : 1;
+    volatile uint32_t last_part : 1;
+} lv_disp_draw_buf_t;
+
+typedef struct _lv_disp_drv_t {
+    lv_coord_t hor_res;
+    lv_coord_t ver_res;
+    lv_disp_draw_buf_t *draw_buf;
+    uint32_t direct_mode : 1;
+    uint32_t full_refresh : 1;
+    uint32_t sw_rotate : 1;
+    uint32_t antialiasing : 1;
+    uint32_t screen_transp : 1;
+    uint32_t dpi : 10;
+    void (*flush_cb)(struct _lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p);
+    void (*rounder_cb)(struct _lv_disp_drv_t *disp_drv, lv_area_t *area);
+    void (*monitor_cb)(struct _lv_disp_drv_t *disp_drv, uint32_t time, uint32_t px);
+    void (*wait_cb)(struct _lv_disp_drv_t *disp_drv);
+    void (*render_start_cb)(struct _lv_disp_drv_t *disp_drv);
+    lv_draw_ctx_t *draw_ctx;
+    void *user_data;
+} lv_disp_drv_t;
+
+typedef struct _lv_disp_t {
+    struct _lv_disp_drv_t *driver;
+    lv_timer_t *refr_timer;
+    struct _lv_obj_t **screens;
+    struct _lv_obj_t *act_scr;
+    struct _lv_obj_t *top_layer;
+    struct _lv_obj_t *sys_layer;
+    uint32_t screen_cnt;
+    uint8_t del_prev : 1;
+    uint8_t rendering_in_progress : 1;
+    lv_color_t bg_color;
+    lv_area_t inv_areas[LV_INV_BUF_SIZE];
+    uint8_t inv_area_joined[LV_INV_BUF_SIZE];
+    uint16_t inv_p;
+    int32_t inv_en_cnt;
+    uint32_t last_activity_time;
+} lv_disp_t;
+
+void lv_disp_drv_init(lv_disp_drv_t *driver);
+void lv_disp_draw_buf_init(lv_disp_draw_buf_t *draw_buf, void *buf1, void *buf2, uint32_t size_in_px_cnt);
+lv_disp_t *lv_disp_drv_register(lv_disp_drv_t *driver);
+void lv_disp_remove(lv_disp_t *disp);
+void lv_disp_set_default(lv_disp_t *disp);
+lv_disp_t *lv_disp_get_default(void);
+lv_disp_t *lv_disp_get_next(lv_disp_t *disp);
+lv_coord_t lv_disp_get_hor_res(lv_disp_t *disp);
+lv_coord_t lv_disp_get_ver_res(lv_disp_t *disp);
+void lv_disp_flush_ready(lv_disp_drv_t *disp_drv);
+bool lv_disp_flush_is_last(lv_disp_drv_t *disp_drv);
+void lv_disp_trig_activity(lv_disp_t *disp);
+uint32_t lv_disp_get_inactive_time(const lv_disp_t *disp);
+void lv_disp_enable_invalidation(lv_disp_t *disp, bool en);
+bool lv_disp_is_invalidation_enabled(lv_disp_t *disp);
+struct _lv_obj_t *lv_disp_get_scr_act(lv_disp_t *disp);
+void lv_disp_load_scr(struct _lv_obj_t *scr);
+
+void _lv_inv_area(lv_disp_t *disp, const lv_area_t *area_p);
+void _lv_disp_refr_timer(lv_timer_t *timer);
+void lv_refr_now(lv_disp_t *disp);
+
+// Input devices
+
+typedef enum {
+    LV_INDEV_TYPE_NONE,
+    LV_INDEV_TYPE_POINTER,
+    LV_INDEV_TYPE_KEYPAD,
+    LV_INDEV_TYPE_BUTTON,
+    LV_INDEV_TYPE_ENCODER,
+} lv_indev_type_t;
+
+typedef enum {
+    LV_INDEV_STATE_RELEASED = 0,
+    LV_INDEV_STATE_PRESSED
+} lv_indev_state_t;
+
+#define LV_INDEV_STATE_REL LV_INDEV_STATE_RELEASED
+#define LV_INDEV_STATE_PR LV_INDEV_STATE_PRESSED
+
+typedef struct {
+    lv_point_t point;
+    uint32_t key;
+    uint32_t btn_id;
+    int16_t enc_diff;
+    lv_indev_state_t state;
+    bool continue_reading;
+} lv_indev_data_t;
+
+typedef struct _lv_indev_drv_t {
+    lv_indev_type_t type;
+    void (*read_cb)(struct _lv_indev_drv_t *indev_drv, lv_indev_data_t *data);
+    void *user_data;
+    struct _lv_disp_t *disp;
+    lv_timer_t *read_timer;
+} lv_indev_drv_t;
+
+typedef struct {
+    lv_indev_state_t state;
+    struct {
+        lv_point_t act_point;
+        lv_point_t last_point;
+        struct _lv_obj_t *act_obj;
+    } pointer;
+} _lv_indev_proc_t;
+
+typedef struct _lv_indev_t {
+    struct _lv_indev_drv_t *driver;
+    _lv_indev_proc_t proc;
+} lv_indev_t;
+
+void lv_indev_drv_init(lv_indev_drv_t *driver);
+lv_indev_t *lv_indev_drv_register(lv_indev_drv_t *driver);
+lv_indev_t *lv_indev_get_next(lv_indev_t *indev);
+void lv_indev_read_timer_cb(lv_timer_t *timer);
+
+// Objects
+
+typedef uint32_t lv_part_t;
+typedef uint32_t lv_style_selector_t;
+typedef uint16_t lv_state_t;
+
+#define LV_PART_MAIN            0x000000
+#define LV_PART_SCROLLBAR       0x010000
+#define LV_PART_INDICATOR       0x020000
+#define LV_PART_KNOB            0x030000
+#define LV_PART_ITEMS           0x050000
+
+#define LV_STATE_DEFAULT        0x0000
+#define LV_STATE_CHECKED        0x0001
+#define LV_STATE_FOCUSED        0x0002
+#define LV_STATE_PRESSED        0x0020
+#define LV_STATE_DISABLED       0x0080
+
+typedef enum {
+    LV_ALIGN_DEFAULT = 0,
+    LV_ALIGN_TOP_LEFT,
+    LV_ALIGN_TOP_MID,
+    LV_ALIGN_TOP_RIGHT,
+    LV_ALIGN_BOTTOM_LEFT,
+    LV_ALIGN_BOTTOM_MID,
+    LV_ALIGN_BOTTOM_RIGHT,
+    LV_ALIGN_LEFT_MID,
+    LV_ALIGN_RIGHT_MID,
+    LV_ALIGN_CENTER,
+} lv_align_t;
+
+typedef enum {
+    LV_GRAD_DIR_NONE,
+    LV_GRAD_DIR_VER,
+    LV_GRAD_DIR_HOR,
+} lv_grad_dir_t;
+
+typedef struct lv_style_t lv_style_t;
+
+typedef struct _lv_obj_t lv_obj_t;
+
+lv_obj_t *lv_obj_create(lv_obj_t *parent);
+void lv_obj_del(lv_obj_t *obj);
+void lv_obj_clean(lv_obj_t *obj);
+lv_obj_t *lv_obj_get_parent(const lv_obj_t *obj);
+lv_obj_t *lv_obj_get_screen(const lv_obj_t *obj);
+lv_disp_t *lv_obj_get_disp(const lv_obj_t *obj);
+uint32_t lv_obj_get_child_cnt(const lv_obj_t *obj);
+lv_obj_t *lv_obj_get_child(const lv_obj_t *obj, int32_t id);
+void lv_obj_get_coords(const lv_obj_t *obj, lv_area_t *coords);
+
+void lv_obj_set_pos(lv_obj_t *obj, lv_coord_t x, lv_coord_t y);
+void lv_obj_set_x(lv_obj_t *obj, lv_coord_t x);
+void lv_obj_set_y(lv_obj_t *obj, lv_coord_t y);
+void lv_obj_set_size(lv_obj_t *obj, lv_coord_t w, lv_coord_t h);
+void lv_obj_set_width(lv_obj_t *obj, lv_coord_t w);
+void lv_obj_set_height(lv_obj_t *obj, lv_coord_t h);
+lv_coord_t lv_obj_get_width(const lv_obj_t *obj);
+lv_coord_t lv_obj_get_height(const lv_obj_t *obj);
+void lv_obj_align(lv_obj_t *obj, lv_align_t align, lv_coord_t x_ofs, lv_coord_t y_ofs);
+void lv_obj_center(lv_obj_t *obj);
+void lv_obj_update_layout(const lv_obj_t *obj);
+void lv_obj_invalidate(const lv_obj_t *obj);
+void lv_obj_invalidate_area(const lv_obj_t *obj, const lv_area_t *area);
+
+void lv_obj_add_state(lv_obj_t *obj, lv_state_t state);
+void lv_obj_clear_state(lv_obj_t *obj, lv_state_t state);
+bool lv_obj_has_state(const lv_obj_t *obj, lv_state_t state);
+
+void lv_obj_remove_style(lv_obj_t *obj, lv_style_t *style, lv_style_selector_t selector);
+void lv_obj_remove_style_all(lv_obj_t *obj);
+void lv_obj_set_style_bg_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_bg_opa(lv_obj_t *obj, lv_opa_t value, lv_style_selector_t selector);
+void lv_obj_set_style_bg_grad_color(lv_obj_t *obj, lv_color_t value, lv_style_selector_t selector);
+void lv_obj_set_style_bg_grad_dir(lv_obj_t *obj, lv_grad_dir_t value, lv_style_selector_t selector);
+
+lv_coord_t lv_obj_get_scroll_y(const lv_obj_t *obj);
+lv_coord_t lv_obj_get_scroll_bottom(lv_obj_t *obj);
+void lv_obj_scroll_to_y(lv_obj_t *obj, lv_coord_t y, lv_anim_enable_t anim_en);
+
+static inline lv_obj_t *lv_scr_act(void) {
+    return lv_disp_get_scr_act(lv_disp_get_default());
+}
+
+// Widgets
+
+#define LV_SYMBOL_FILE "\xef\x85\x9b"
+
+lv_obj_t *lv_label_create(lv_obj_t *parent);
+void lv_label_set_text(lv_obj_t *obj, const char *text);
+void lv_label_set_text_fmt(lv_obj_t *obj, const char *fmt, ...);
+const char *lv_label_get_text(const lv_obj_t *obj);
+
+lv_obj_t *lv_btn_create(lv_obj_t *parent);
+lv_obj_t *lv_switch_create(lv_obj_t *parent);
+lv_obj_t *lv_slider_create(lv_obj_t *parent);
+void lv_slider_set_value(lv_obj_t *obj, int32_t value, lv_anim_enable_t anim);
+lv_obj_t *lv_arc_create(lv_obj_t *parent);
+void lv_arc_set_angles(lv_obj_t *obj, uint16_t start, uint16_t end);
+void lv_arc_set_bg_angles(lv_obj_t *obj, uint16_t start, uint16_t end);
+lv_obj_t *lv_list_create(lv_obj_t *parent);
+lv_obj_t *lv_list_add_btn(lv_obj_t *list, const void *icon, const char *txt);
+lv_obj_t *lv_img_create(lv_obj_t *parent);
+void lv_img_set_src(lv_obj_t *obj, const void *src);
+
+// Library
+
+void lv_init(void);
+bool lv_is_initialized(void);
+#if LV_ENABLE_GC || !LV_MEM_CUSTOM
+void lv_deinit(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_LVGL_H
@@ -0,0 +1,16 @@
+/*
+ * LVGL 8.3 gradient cache for the host build, only its size is kept
+ */
+
+#ifndef HOST_LV_DRAW_SW_GRADIENT_H
+#define HOST_LV_DRAW_SW_GRADIENT_H
+
+#include <stddef.h>
+#include "lvgl.h"
+
+void lv_gradient_set_cache_size(size_t max_bytes);
+
+// Host only: the size last set
+size_t lv_gradient_get_cache_size(void);
+
+#endif // HOST_LV_DRAW_SW_GRADIENT_H
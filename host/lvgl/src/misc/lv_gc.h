@@ -0,0 +1,20 @@
+/*
+ * LVGL 8.3 roots for the host build, LV_ENABLE_GC 0: plain globals
+ */
+
+#ifndef HOST_LV_GC_H
+#define HOST_LV_GC_H
+
+#include "lvgl.h"
+
+#define LV_GC_ROOT(x) x
+
+extern lv_ll_t _lv_timer_ll;
+extern lv_ll_t _lv_disp_ll;
+extern lv_ll_t _lv_indev_ll;
+extern lv_ll_t _lv_img_decoder_ll;
+extern _lv_img_cache_entry_t *_lv_img_cache_array;
+
+void _lv_gc_clear_roots(void);
+
+#endif // HOST_LV_GC_H
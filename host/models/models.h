@@ -0,0 +1,142 @@
+/*
+ * Device models of the board behind the simulated buses
+ *
+ * panel: the SPD2010 display on the QSPI panel IO. Its frame memory is a
+ * spd2010_shadow_t fed with every transfer as the bus finishes it, and it
+ * answers the power mode, pixel format and frame memory reads.
+ * touch: the SPD2010 touch controller at 0x53, with its 16-bit register
+ * protocol and the BIOS -> CPU -> point mode start up, interrupt on GPIO4.
+ * tca: the TCA9554 I/O expander at 0x20. EXIO1 resets the touch controller,
+ * EXIO2 the panel.
+ */
+
+#ifndef HOST_MODELS_H
+#define HOST_MODELS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "sim.h"
+#include "spd2010_shadow.h"
+
+#define PANEL_WIDTH             412
+#define PANEL_HEIGHT            412
+
+// Panel
+
+typedef struct {
+    pthread_mutex_t lock;
+    spd2010_shadow_t shadow;
+    uint16_t fb[PANEL_WIDTH * PANEL_HEIGHT];
+    bool sleeping;
+    bool display_on;
+    uint8_t colmod;
+    uint8_t madctl;
+    uint32_t resets;            // hardware and SWRESET
+    uint32_t vendor_cmds;       // commands on the vendor pages, the init table
+    unsigned int max_read_hz;   // reads through a faster IO come back corrupted
+    uint32_t corrupted_reads;
+    sim_lcd_panel_t port;
+} panel_model_t;
+
+// Powered on: asleep, display off, frame memory black
+void panel_model_init(panel_model_t *panel);
+
+// Hardware reset, as the reset line does
+void panel_model_reset(panel_model_t *panel);
+
+// Shown image as a binary PPM
+bool panel_model_write_ppm(panel_model_t *panel, FILE *f);
+
+uint32_t panel_model_crc32(panel_model_t *panel);
+
+// Touch controller
+
+#define TOUCH_MODEL_ADDR        0x53
+#define TOUCH_MODEL_INT_PIN     4
+#define TOUCH_MODEL_MAX_POINTS  5
+
+typedef enum {
+    TOUCH_MODEL_BIOS,
+    TOUCH_MODEL_CPU,
+    TOUCH_MODEL_RUN,
+} touch_model_state_t;
+
+typedef struct {
+    pthread_mutex_t lock;
+    touch_model_state_t state;
+    bool held_in_reset;
+    bool int_low;
+    bool point_mode;
+    uint16_t reg;               // register pointer for reads
+    pthread_t reg_owner;        // thread that set it
+    bool reg_set;
+    uint8_t frame[16];          // bytes written in this transfer
+    size_t frame_len;
+    uint8_t reply[4 + 6 * TOUCH_MODEL_MAX_POINTS + 4];
+    size_t reply_len;
+    size_t reply_pos;
+    bool reading;
+    struct {
+        uint16_t x;
+        uint16_t y;
+        uint8_t weight;
+    } points[TOUCH_MODEL_MAX_POINTS];
+    int n_points;
+    bool report_pending;
+    uint32_t commands;
+    uint32_t reports_read;
+    uint32_t bad_frames;        // writes that are no register address or command
+    uint32_t crossed_reads;     // reads at a pointer another thread set
+    sim_i2c_device_t dev;
+} touch_model_t;
+
+// Powered on, in BIOS
+void touch_model_init(touch_model_t *touch);
+
+// Reset line: held low keeps the controller in reset, the release restarts it in BIOS
+void touch_model_set_reset(touch_model_t *touch, bool held);
+
+// A finger at x, y, reported when the controller runs in point mode
+void touch_model_press(touch_model_t *touch, int x, int y);
+void touch_model_release(touch_model_t *touch);
+
+// TCA9554
+
+#define TCA_MODEL_ADDR          0x20
+
+typedef struct {
+    pthread_mutex_t lock;
+    uint8_t regs[4];            // input, output, polarity, configuration
+    uint8_t inputs;             // levels on the pins configured as inputs
+    uint8_t pointer;
+    bool first_byte;
+    bool reading;
+    uint32_t writes;
+    void (*on_change)(void *ctx, uint8_t levels);
+    void *ctx;
+    sim_i2c_device_t dev;
+} tca_model_t;
+
+void tca_model_init(tca_model_t *tca);
+
+// Pin levels, outputs driven and inputs pulled up
+uint8_t tca_model_levels(tca_model_t *tca);
+
+// Board: the three models wired as on the Waveshare ESP32-S3 1.46" board
+
+typedef struct {
+    panel_model_t panel;
+    touch_model_t touch;
+    tca_model_t tca;
+    uint8_t levels;
+} board_t;
+
+// sim_reset, power on every model and attach them to the buses
+void board_init(board_t *board);
+
+// Detach from the buses
+void board_deinit(board_t *board);
+
+#endif // HOST_MODELS_H
@@ -0,0 +1,162 @@
+/*
+ * SPD2010 panel model
+ */
+
+#include <string.h>
+#include "models.h"
+
+#define CMD_SWRESET         0x01
+#define CMD_RDDPM           0x0A
+#define CMD_RDD_COLMOD      0x0C
+#define CMD_SLPIN           0x10
+#define CMD_SLPOUT          0x11
+#define CMD_DISPOFF         0x28
+#define CMD_DISPON          0x29
+#define CMD_RAMRD           0x2E
+#define CMD_MADCTL          0x36
+#define CMD_COLMOD          0x3A
+#define CMD_PAGE            0xFF
+#define PAGE_USER           0x00
+
+static uint8_t command_of(uint32_t lcd_cmd) {
+    return (lcd_cmd >> 24) ? (lcd_cmd >> 8) & 0xFF : lcd_cmd & 0xFF;
+}
+
+// Registers back to their reset values, frame memory black
+static void power_on(panel_model_t *panel) {
+    spd2010_shadow_init(&panel->shadow, panel->fb, PANEL_WIDTH, PANEL_HEIGHT);
+    panel->sleeping = true;
+    panel->display_on = false;
+    panel->colmod = 0x55;
+    panel->madctl = 0;
+}
+
+static void panel_tx(void *ctx, uint32_t lcd_cmd, bool color, const void *data, size_t len) {
+    panel_model_t *panel = ctx;
+    const uint8_t *p = data;
+    uint8_t cmd = command_of(lcd_cmd);
+
+    pthread_mutex_lock(&panel->lock);
+    spd2010_shadow_tx(&panel->shadow, lcd_cmd, color, data, len);
+    if (!color && cmd != CMD_PAGE && panel->shadow.page != PAGE_USER) {
+        panel->vendor_cmds++;
+    }
+    if (!color && cmd != CMD_PAGE && panel->shadow.page == PAGE_USER) {
+        switch (cmd) {
+            case CMD_SWRESET:
+                power_on(panel);
+                panel->resets++;
+                break;
+            case CMD_SLPIN:
+                panel->sleeping = true;
+                break;
+            case CMD_SLPOUT:
+                panel->sleeping = false;
+                break;
+            case CMD_DISPOFF:
+                panel->display_on = false;
+                break;
+            case CMD_DISPON:
+                panel->display_on = true;
+                break;
+            case CMD_MADCTL:
+                if (len >= 1) {
+                    panel->madctl = p[0];
+                }
+                break;
+            case CMD_COLMOD:
+                if (len >= 1) {
+                    panel->colmod = p[0];
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    pthread_mutex_unlock(&panel->lock);
+}
+
+// Frame memory of the window as RGB888, row by row from its top left corner
+static void read_ram(panel_model_t *panel, uint8_t *dst, size_t len) {
+    const spd2010_shadow_t *s = &panel->shadow;
+    int x = s->x0;
+    int y = s->y0;
+    for (size_t i = 0; i + 3 <= len; i += 3) {
+        uint16_t px = (x < PANEL_WIDTH && y < PANEL_HEIGHT) ? panel->fb[y * PANEL_WIDTH + x] : 0;
+        dst[i] = (px >> 8) & 0xF8;
+        dst[i + 1] = (px >> 3) & 0xFC;
+        dst[i + 2] = (px << 3) & 0xF8;
+        if (++x > s->x1) {
+            x = s->x0;
+            if (++y > s->y1) {
+                y = s->y0;
+            }
+        }
+    }
+}
+
+static esp_err_t panel_rx(void *ctx, uint32_t lcd_cmd, void *data, size_t len, unsigned int pclk_hz) {
+    panel_model_t *panel = ctx;
+    uint8_t *p = data;
+
+    pthread_mutex_lock(&panel->lock);
+    switch (command_of(lcd_cmd)) {
+        case CMD_RDDPM:
+            // Bit 7 booster on, bit 4 sleep out, bit 2 display on
+            p[0] = (panel->sleeping ? 0 : 0x90) | (panel->display_on ? 0x04 : 0);
+            break;
+        case CMD_RDD_COLMOD:
+            p[0] = panel->colmod;
+            break;
+        case CMD_RAMRD:
+            read_ram(panel, p, len);
+            // Too fast for the read path: some bits flip
+            if (panel->max_read_hz && pclk_hz > panel->max_read_hz) {
+                for (size_t i = 0; i < len; i += 7) {
+                    p[i] ^= 0x08;
+                }
+                panel->corrupted_reads++;
+            }
+            break;
+        default:
+            break;
+    }
+    pthread_mutex_unlock(&panel->lock);
+    return ESP_OK;
+}
+
+void panel_model_init(panel_model_t *panel) {
+    memset(panel, 0, sizeof(*panel));
+    pthread_mutex_init(&panel->lock, NULL);
+    power_on(panel);
+    panel->max_read_hz = 60 * 1000 * 1000;
+    panel->port.ctx = panel;
+    panel->port.tx = panel_tx;
+    panel->port.rx = panel_rx;
+}
+
+void panel_model_reset(panel_model_t *panel) {
+    pthread_mutex_lock(&panel->lock);
+    power_on(panel);
+    panel->resets++;
+    pthread_mutex_unlock(&panel->lock);
+}
+
+bool panel_model_write_ppm(panel_model_t *panel, FILE *f) {
+    uint8_t row[PANEL_WIDTH * 3];
+    bool ok = fprintf(f, "P6\n%d %d\n255\n", PANEL_WIDTH, PANEL_HEIGHT) > 0;
+    pthread_mutex_lock(&panel->lock);
+    for (int y = 0; y < PANEL_HEIGHT && ok; y++) {
+        spd2010_shadow_row_rgb888(&panel->shadow, y, row);
+        ok = fwrite(row, 1, sizeof(row), f) == sizeof(row);
+    }
+    pthread_mutex_unlock(&panel->lock);
+    return ok;
+}
+
+uint32_t panel_model_crc32(panel_model_t *panel) {
+    pthread_mutex_lock(&panel->lock);
+    uint32_t crc = spd2010_shadow_crc32(&panel->shadow);
+    pthread_mutex_unlock(&panel->lock);
+    return crc;
+}
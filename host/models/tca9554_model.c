@@ -0,0 +1,122 @@
+/*
+ * TCA9554 I/O expander model and the board wiring
+ *
+ * The first byte of a write selects the register, the next one writes it. A
+ * read returns the selected register. Outputs default high and every pin
+ * starts as an input, pulled up on the board.
+ */
+
+#include <string.h>
+#include "models.h"
+
+#define REG_INPUT           0
+#define REG_OUTPUT          1
+#define REG_POLARITY        2
+#define REG_CONFIG          3
+
+#define EXIO1_TOUCH_RESET   0x01
+#define EXIO2_PANEL_RESET   0x02
+
+uint8_t tca_model_levels(tca_model_t *tca) {
+    // Configuration bit set: input, pulled up unless something drives it
+    return (tca->regs[REG_OUTPUT] & ~tca->regs[REG_CONFIG]) | (tca->inputs & tca->regs[REG_CONFIG]);
+}
+
+static uint8_t read_reg(tca_model_t *tca, uint8_t reg) {
+    if (reg == REG_INPUT) {
+        return tca_model_levels(tca) ^ tca->regs[REG_POLARITY];
+    }
+    return tca->regs[reg & 3];
+}
+
+static void tca_start(void *ctx, bool read) {
+    tca_model_t *tca = ctx;
+    pthread_mutex_lock(&tca->lock);
+    tca->reading = read;
+    tca->first_byte = true;
+    pthread_mutex_unlock(&tca->lock);
+}
+
+static bool tca_write(void *ctx, uint8_t byte) {
+    tca_model_t *tca = ctx;
+    uint8_t before = 0;
+    uint8_t after = 0;
+
+    pthread_mutex_lock(&tca->lock);
+    if (tca->first_byte) {
+        tca->first_byte = false;
+        tca->pointer = byte & 3;
+    } else {
+        before = tca_model_levels(tca);
+        if (tca->pointer != REG_INPUT) {
+            tca->regs[tca->pointer] = byte;
+        }
+        after = tca_model_levels(tca);
+        tca->writes++;
+    }
+    void (*on_change)(void *, uint8_t) = tca->on_change;
+    void *cb_ctx = tca->ctx;
+    pthread_mutex_unlock(&tca->lock);
+
+    if (before != after && on_change != NULL) {
+        on_change(cb_ctx, after);
+    }
+    return true;
+}
+
+static uint8_t tca_read(void *ctx) {
+    tca_model_t *tca = ctx;
+    pthread_mutex_lock(&tca->lock);
+    uint8_t byte = read_reg(tca, tca->pointer);
+    pthread_mutex_unlock(&tca->lock);
+    return byte;
+}
+
+void tca_model_init(tca_model_t *tca) {
+    memset(tca, 0, sizeof(*tca));
+    pthread_mutex_init(&tca->lock, NULL);
+    tca->regs[REG_OUTPUT] = 0xFF;
+    tca->regs[REG_CONFIG] = 0xFF;
+    tca->inputs = 0xFF;
+    tca->dev.addr = TCA_MODEL_ADDR;
+    tca->dev.ctx = tca;
+    tca->dev.start = tca_start;
+    tca->dev.write = tca_write;
+    tca->dev.read = tca_read;
+}
+
+// Board
+
+static void board_levels(void *ctx, uint8_t levels) {
+    board_t *board = ctx;
+    uint8_t changed = levels ^ board->levels;
+    board->levels = levels;
+
+    if (changed & EXIO1_TOUCH_RESET) {
+        touch_model_set_reset(&board->touch, !(levels & EXIO1_TOUCH_RESET));
+    }
+    // The panel resets on the rising edge that ends the pulse
+    if ((changed & EXIO2_PANEL_RESET) && (levels & EXIO2_PANEL_RESET)) {
+        panel_model_reset(&board->panel);
+    }
+}
+
+void board_init(board_t *board) {
+    sim_reset();
+    panel_model_init(&board->panel);
+    touch_model_init(&board->touch);
+    tca_model_init(&board->tca);
+    board->levels = tca_model_levels(&board->tca);
+    board->tca.on_change = board_levels;
+    board->tca.ctx = board;
+    sim_lcd_attach(&board->panel.port);
+    sim_i2c_attach(0, &board->touch.dev);
+    sim_i2c_attach(0, &board->tca.dev);
+}
+
+void board_deinit(board_t *board) {
+    sim_lcd_drain();
+    sim_lcd_attach(NULL);
+    sim_i2c_detach(0, &board->touch.dev);
+    sim_i2c_detach(0, &board->tca.dev);
+}
@@ -0,0 +1,210 @@
+/*
+ * SPD2010 touch controller model
+ *
+ * A write is the 16-bit register address, high byte first, and for a command
+ * two data bytes. A read returns the register last addressed. The controller
+ * pulls the interrupt line low while it wants attention: after a reset in
+ * BIOS, after the CPU start, and with every touch report, until the host
+ * clears it. A read in another thread than the address that set the pointer
+ * is counted: two hosts took turns inside one register read.
+ */
+
+#include <string.h>
+#include "models.h"
+
+#define REG_CLEAR_INT       0x0200
+#define REG_CPU_START       0x0400
+#define REG_TOUCH_START     0x4600
+#define REG_POINT_MODE      0x5000
+#define REG_STATUS          0x2000
+#define REG_HDP             0x0003
+#define REG_HDP_STATUS      0xFC02
+
+#define STATUS_PT_EXIST     0x01
+#define STATUS_CPU_RUN      0x08
+#define STATUS_TINT_LOW     0x10
+#define STATUS_IN_CPU       0x20
+#define STATUS_IN_BIOS      0x40
+
+static void set_int(touch_model_t *touch, bool low) {
+    if (touch->int_low != low) {
+        touch->int_low = low;
+        sim_gpio_drive(TOUCH_MODEL_INT_PIN, low ? 0 : 1);
+    }
+}
+
+static size_t report_len(const touch_model_t *touch) {
+    return touch->report_pending ? 4 + 6 * (size_t)touch->n_points : 0;
+}
+
+// Reply of a read at the register pointer
+static void prepare_reply(touch_model_t *touch) {
+    uint8_t *r = touch->reply;
+    memset(r, 0, sizeof(touch->reply));
+    touch->reply_len = sizeof(touch->reply);
+    touch->reply_pos = 0;
+
+    switch (touch->reg) {
+        case REG_STATUS: {
+            size_t len = report_len(touch);
+            r[0] = (touch->state == TOUCH_MODEL_RUN && touch->report_pending) ? STATUS_PT_EXIST : 0;
+            r[1] = touch->state == TOUCH_MODEL_BIOS ? STATUS_IN_BIOS :
+                   touch->state == TOUCH_MODEL_CPU ? STATUS_IN_CPU : STATUS_CPU_RUN;
+            r[1] |= touch->int_low ? STATUS_TINT_LOW : 0;
+            r[2] = len & 0xFF;
+            r[3] = len >> 8;
+            break;
+        }
+        case REG_HDP:
+            // Four header bytes, then id, x low, y low, x/y high nibbles, weight, reserved
+            for (int i = 0; i < touch->n_points && touch->report_pending; i++) {
+                uint8_t *p = &r[4 + 6 * i];
+                p[0] = i;
+                p[1] = touch->points[i].x & 0xFF;
+                p[2] = touch->points[i].y & 0xFF;
+                p[3] = ((touch->points[i].x >> 4) & 0xF0) | ((touch->points[i].y >> 8) & 0x0F);
+                p[4] = touch->points[i].weight;
+            }
+            if (touch->report_pending) {
+                touch->report_pending = false;
+                touch->reports_read++;
+            }
+            break;
+        case REG_HDP_STATUS:
+            r[5] = 0x82;        // packet done
+            break;
+        default:
+            break;
+    }
+}
+
+static void command(touch_model_t *touch, uint16_t reg) {
+    touch->commands++;
+    switch (reg) {
+        case REG_CLEAR_INT:
+            set_int(touch, touch->report_pending);
+            break;
+        case REG_CPU_START:
+            if (touch->state == TOUCH_MODEL_BIOS) {
+                touch->state = TOUCH_MODEL_CPU;
+                set_int(touch, true);
+            }
+            break;
+        case REG_POINT_MODE:
+            touch->point_mode = true;
+            break;
+        case REG_TOUCH_START:
+            if (touch->state == TOUCH_MODEL_CPU && touch->point_mode) {
+                touch->state = TOUCH_MODEL_RUN;
+            }
+            break;
+        default:
+            touch->bad_frames++;
+            break;
+    }
+}
+
+static void touch_start(void *ctx, bool read) {
+    touch_model_t *touch = ctx;
+    pthread_mutex_lock(&touch->lock);
+    touch->reading = read;
+    touch->frame_len = 0;
+    if (read) {
+        if (touch->reg_set && !pthread_equal(touch->reg_owner, pthread_self())) {
+            touch->crossed_reads++;
+        }
+        prepare_reply(touch);
+    }
+    pthread_mutex_unlock(&touch->lock);
+}
+
+static bool touch_write(void *ctx, uint8_t byte) {
+    touch_model_t *touch = ctx;
+    pthread_mutex_lock(&touch->lock);
+    bool ack = !touch->held_in_reset && touch->frame_len < sizeof(touch->frame);
+    if (ack) {
+        touch->frame[touch->frame_len++] = byte;
+    }
+    pthread_mutex_unlock(&touch->lock);
+    return ack;
+}
+
+static uint8_t touch_read(void *ctx) {
+    touch_model_t *touch = ctx;
+    pthread_mutex_lock(&touch->lock);
+    uint8_t byte = touch->reply_pos < touch->reply_len ? touch->reply[touch->reply_pos++] : 0;
+    pthread_mutex_unlock(&touch->lock);
+    return byte;
+}
+
+static void touch_stop(void *ctx) {
+    touch_model_t *touch = ctx;
+    pthread_mutex_lock(&touch->lock);
+    if (!touch->reading && !touch->held_in_reset) {
+        uint16_t reg = (touch->frame[0] << 8) | touch->frame[1];
+        if (touch->frame_len == 2) {
+            touch->reg = reg;
+            touch->reg_owner = pthread_self();
+            touch->reg_set = true;
+        } else if (touch->frame_len == 4) {
+            command(touch, reg);
+        } else if (touch->frame_len > 0) {
+            touch->bad_frames++;
+        }
+    }
+    touch->frame_len = 0;
+    pthread_mutex_unlock(&touch->lock);
+}
+
+void touch_model_init(touch_model_t *touch) {
+    memset(touch, 0, sizeof(*touch));
+    pthread_mutex_init(&touch->lock, NULL);
+    touch->state = TOUCH_MODEL_BIOS;
+    touch->dev.addr = TOUCH_MODEL_ADDR;
+    touch->dev.ctx = touch;
+    touch->dev.start = touch_start;
+    touch->dev.write = touch_write;
+    touch->dev.read = touch_read;
+    touch->dev.stop = touch_stop;
+    sim_gpio_drive(TOUCH_MODEL_INT_PIN, 1);
+    set_int(touch, true);
+}
+
+void touch_model_set_reset(touch_model_t *touch, bool held) {
+    pthread_mutex_lock(&touch->lock);
+    if (held && !touch->held_in_reset) {
+        touch->held_in_reset = true;
+        touch->state = TOUCH_MODEL_BIOS;
+        touch->point_mode = false;
+        touch->report_pending = false;
+        touch->n_points = 0;
+        set_int(touch, false);
+    } else if (!held && touch->held_in_reset) {
+        touch->held_in_reset = false;
+        set_int(touch, true);
+    }
+    pthread_mutex_unlock(&touch->lock);
+}
+
+void touch_model_press(touch_model_t *touch, int x, int y) {
+    pthread_mutex_lock(&touch->lock);
+    if (touch->state == TOUCH_MODEL_RUN) {
+        touch->points[0].x = x;
+        touch->points[0].y = y;
+        touch->points[0].weight = 60;
+        touch->n_points = 1;
+        touch->report_pending = true;
+        set_int(touch, true);
+    }
+    pthread_mutex_unlock(&touch->lock);
+}
+
+void touch_model_release(touch_model_t *touch) {
+    pthread_mutex_lock(&touch->lock);
+    if (touch->state == TOUCH_MODEL_RUN) {
+        touch->n_points = 0;
+        touch->report_pending = true;
+        set_int(touch, true);
+    }
+    pthread_mutex_unlock(&touch->lock);
+}
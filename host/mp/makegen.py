@@ -0,0 +1,68 @@
+#!/usr/bin/env python3
+"""
+Generate the genhdr headers of the host build
+
+Usage: makegen.py OUTDIR SOURCE...
+
+Writes OUTDIR/genhdr/qstrdefs.generated.h with every MP_QSTR_ name used by the
+sources plus the ones the host runtime needs, and OUTDIR/genhdr/root_pointers.h
+with every MP_REGISTER_ROOT_POINTER declaration, as the upstream makeqstrdefs
+and make_root_pointers steps do. Files are only rewritten when they change.
+"""
+
+import os
+import re
+import sys
+
+# Names of the builtin types and exceptions of the host runtime
+RUNTIME_QSTRS = [
+    "type", "module", "dict", "function", "NoneType", "bool", "int", "float",
+    "str", "bytes", "bytearray", "list", "tuple", "set",
+    "BaseException", "Exception", "KeyboardInterrupt", "KeyError",
+    "MemoryError", "OSError", "RuntimeError", "TypeError", "ValueError",
+    "BytesIO", "ThreadSafeFlag",
+    "__init__", "__del__", "__name__", "__enter__", "__exit__",
+]
+
+QSTR_RE = re.compile(r"\bMP_QSTR_(\w+)")
+ROOT_RE = re.compile(r"^\s*MP_REGISTER_ROOT_POINTER\((.*)\);", re.M)
+
+
+def write_if_changed(path, text):
+    try:
+        with open(path) as f:
+            if f.read() == text:
+                return
+    except OSError:
+        pass
+    with open(path, "w") as f:
+        f.write(text)
+
+
+def main(argv):
+    if len(argv) < 2:
+        print(__doc__.strip().splitlines()[2], file=sys.stderr)
+        return 2
+    outdir = os.path.join(argv[1], "genhdr")
+    os.makedirs(outdir, exist_ok=True)
+
+    qstrs = dict.fromkeys(RUNTIME_QSTRS)
+    roots = []
+    for path in argv[2:]:
+        with open(path, encoding="utf-8", errors="replace") as f:
+            src = f.read()
+        qstrs.update(dict.fromkeys(QSTR_RE.findall(src)))
+        roots += [decl.strip() for decl in ROOT_RE.findall(src)]
+
+    lines = ["// Generated by host/mp/makegen.py"]
+    lines += ['QDEF(MP_QSTR_%s, "%s")' % (q, q) for q in sorted(qstrs)]
+    write_if_changed(os.path.join(outdir, "qstrdefs.generated.h"), "\n".join(lines) + "\n")
+
+    lines = ["// Generated by host/mp/makegen.py"]
+    lines += ["%s;" % decl for decl in roots]
+    write_if_changed(os.path.join(outdir, "root_pointers.h"), "\n".join(lines) + "\n")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
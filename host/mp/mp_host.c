@@ -0,0 +1,969 @@
+/*
+ * MicroPython shim for the host build
+ *
+ * Objects, the VM heap, exceptions, calls and the scheduler with upstream
+ * semantics, small enough to read in one go. The VM heap is a list of
+ * malloc'ed blocks: a soft reset runs the finalisers and frees all of them,
+ * which is what the GC heap reset does on the board. Interrupt handlers run
+ * on other threads here, the scheduler queue and the heap list are locked.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include "py/obj.h"
+#include "py/runtime.h"
+#include "py/mperrno.h"
+#include "py/mphal.h"
+#include "py/stream.h"
+#include "mphost.h"
+#include "sim.h"
+#include "sim_clock.h"
+
+mp_state_ctx_t mp_state_ctx;
+
+// qstrs
+
+static const char *const qstr_strings[] = {
+    "",
+#define QDEF(id, str) str,
+#include "genhdr/qstrdefs.generated.h"
+#undef QDEF
+};
+
+const char *qstr_str(qstr q) {
+    return (q < MP_QSTRnumber_of) ? qstr_strings[q] : "?";
+}
+
+qstr qstr_find_strn(const char *str, size_t len) {
+    for (qstr q = 1; q < MP_QSTRnumber_of; q++) {
+        if (strlen(qstr_strings[q]) == len && memcmp(qstr_strings[q], str, len) == 0) {
+            return q;
+        }
+    }
+    return MP_QSTRnull;
+}
+
+// VM heap
+
+typedef struct heap_block {
+    struct heap_block *prev;
+    struct heap_block *next;
+    size_t size;
+    bool finaliser;
+} __attribute__((aligned(16))) heap_block_t;
+
+static heap_block_t heap_head = { &heap_head, &heap_head, 0, false };
+static size_t heap_count = 0;
+static pthread_mutex_t heap_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void *heap_alloc(size_t size, bool finaliser) {
+    heap_block_t *b = calloc(1, sizeof(heap_block_t) + size);
+    if (b == NULL) {
+        mp_raise_msg(&mp_type_MemoryError, "memory allocation failed");
+    }
+    b->size = size;
+    b->finaliser = finaliser;
+    pthread_mutex_lock(&heap_mutex);
+    b->next = &heap_head;
+    b->prev = heap_head.prev;
+    heap_head.prev->next = b;
+    heap_head.prev = b;
+    heap_count++;
+    pthread_mutex_unlock(&heap_mutex);
+    return b + 1;
+}
+
+void *m_malloc(size_t num_bytes) {
+    return heap_alloc(num_bytes, false);
+}
+
+void *m_malloc0(size_t num_bytes) {
+    return heap_alloc(num_bytes, false);
+}
+
+void *m_malloc_with_finaliser(size_t num_bytes) {
+    return heap_alloc(num_bytes, true);
+}
+
+void m_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    heap_block_t *b = (heap_block_t *)ptr - 1;
+    pthread_mutex_lock(&heap_mutex);
+    b->prev->next = b->next;
+    b->next->prev = b->prev;
+    heap_count--;
+    pthread_mutex_unlock(&heap_mutex);
+    free(b);
+}
+
+size_t mp_host_heap_blocks(void) {
+    return heap_count;
+}
+
+// Constant objects and types
+
+const mp_obj_type_t mp_type_type = { { &mp_type_type }, .name = MP_QSTR_type };
+const mp_obj_type_t mp_type_module = { { &mp_type_type }, .name = MP_QSTR_module };
+const mp_obj_type_t mp_type_dict = { { &mp_type_type }, .name = MP_QSTR_dict };
+const mp_obj_type_t mp_type_fun_builtin = { { &mp_type_type }, .name = MP_QSTR_function };
+const mp_obj_type_t mp_type_NoneType = { { &mp_type_type }, .name = MP_QSTR_NoneType };
+const mp_obj_type_t mp_type_bool = { { &mp_type_type }, .name = MP_QSTR_bool };
+const mp_obj_type_t mp_type_int = { { &mp_type_type }, .name = MP_QSTR_int };
+const mp_obj_type_t mp_type_float = { { &mp_type_type }, .name = MP_QSTR_float };
+const mp_obj_type_t mp_type_list = { { &mp_type_type }, .name = MP_QSTR_list };
+const mp_obj_type_t mp_type_tuple = { { &mp_type_type }, .name = MP_QSTR_tuple };
+
+const mp_obj_none_t mp_const_none_obj = { { &mp_type_NoneType } };
+const mp_obj_bool_t mp_const_false_obj = { { &mp_type_bool }, false };
+const mp_obj_bool_t mp_const_true_obj = { { &mp_type_bool }, true };
+
+typedef struct {
+    mp_obj_base_t base;
+    size_t len;
+    uint8_t *data;
+} mp_obj_array_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    mp_float_t value;
+} mp_obj_float_t;
+
+typedef struct {
+    mp_obj_base_t base;
+    size_t len;
+    size_t alloc;
+    mp_obj_t *items;
+} mp_obj_list_t;
+
+static mp_int_t array_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    mp_obj_array_t *self = MP_OBJ_TO_PTR(self_in);
+    if ((flags & MP_BUFFER_WRITE) && self->base.type != &mp_type_bytearray) {
+        return 1;
+    }
+    bufinfo->buf = self->data;
+    bufinfo->len = self->len;
+    bufinfo->typecode = 'B';
+    return 0;
+}
+
+const mp_obj_type_t mp_type_str = { { &mp_type_type }, .name = MP_QSTR_str, .buffer = array_get_buffer };
+const mp_obj_type_t mp_type_bytes = { { &mp_type_type }, .name = MP_QSTR_bytes, .buffer = array_get_buffer };
+const mp_obj_type_t mp_type_bytearray = { { &mp_type_type }, .name = MP_QSTR_bytearray, .buffer = array_get_buffer };
+
+const mp_obj_type_t mp_type_BaseException = { { &mp_type_type }, .name = MP_QSTR_BaseException };
+const mp_obj_type_t mp_type_Exception = { { &mp_type_type }, .name = MP_QSTR_Exception, .parent = &mp_type_BaseException };
+const mp_obj_type_t mp_type_KeyboardInterrupt = { { &mp_type_type }, .name = MP_QSTR_KeyboardInterrupt, .parent = &mp_type_BaseException };
+const mp_obj_type_t mp_type_KeyError = { { &mp_type_type }, .name = MP_QSTR_KeyError, .parent = &mp_type_Exception };
+const mp_obj_type_t mp_type_MemoryError = { { &mp_type_type }, .name = MP_QSTR_MemoryError, .parent = &mp_type_Exception };
+const mp_obj_type_t mp_type_OSError = { { &mp_type_type }, .name = MP_QSTR_OSError, .parent = &mp_type_Exception };
+const mp_obj_type_t mp_type_RuntimeError = { { &mp_type_type }, .name = MP_QSTR_RuntimeError, .parent = &mp_type_Exception };
+const mp_obj_type_t mp_type_TypeError = { { &mp_type_type }, .name = MP_QSTR_TypeError, .parent = &mp_type_Exception };
+const mp_obj_type_t mp_type_ValueError = { { &mp_type_type }, .name = MP_QSTR_ValueError, .parent = &mp_type_Exception };
+
+const mp_obj_type_t *mp_obj_get_type(mp_const_obj_t o) {
+    if (mp_obj_is_small_int(o)) {
+        return &mp_type_int;
+    }
+    if (mp_obj_is_qstr(o)) {
+        return &mp_type_str;
+    }
+    return ((const mp_obj_base_t *)o)->type;
+}
+
+bool mp_obj_is_type(mp_const_obj_t o, const mp_obj_type_t *type) {
+    return mp_obj_get_type(o) == type;
+}
+
+bool mp_obj_is_subclass(const mp_obj_type_t *type, const mp_obj_type_t *base) {
+    for (; type != NULL; type = type->parent) {
+        if (type == base) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Constructors
+
+mp_obj_t mp_obj_new_bool(mp_int_t value) {
+    return value ? mp_const_true : mp_const_false;
+}
+
+mp_obj_t mp_obj_new_int(mp_int_t value) {
+    return MP_OBJ_NEW_SMALL_INT(value);
+}
+
+mp_obj_t mp_obj_new_int_from_uint(mp_uint_t value) {
+    return MP_OBJ_NEW_SMALL_INT((mp_int_t)value);
+}
+
+mp_obj_t mp_obj_new_int_from_ull(unsigned long long value) {
+    return MP_OBJ_NEW_SMALL_INT((mp_int_t)value);
+}
+
+mp_obj_t mp_obj_new_float(mp_float_t value) {
+    mp_obj_float_t *o = m_new_obj(mp_obj_float_t);
+    o->base.type = &mp_type_float;
+    o->value = value;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+static mp_obj_t new_array(const mp_obj_type_t *type, const void *data, size_t len) {
+    mp_obj_array_t *o = m_new_obj(mp_obj_array_t);
+    o->base.type = type;
+    o->len = len;
+    o->data = m_new(uint8_t, len + 1);
+    if (data != NULL) {
+        memcpy(o->data, data, len);
+    } else {
+        memset(o->data, 0, len);
+    }
+    o->data[len] = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+mp_obj_t mp_obj_new_str(const char *data, size_t len) {
+    return new_array(&mp_type_str, data, len);
+}
+
+mp_obj_t mp_obj_new_bytes(const uint8_t *data, size_t len) {
+    return new_array(&mp_type_bytes, data, len);
+}
+
+// Copies items, as upstream does
+mp_obj_t mp_obj_new_bytearray(size_t n, const void *items) {
+    return new_array(&mp_type_bytearray, items, n);
+}
+
+static mp_obj_t new_seq(const mp_obj_type_t *type, size_t n, const mp_obj_t *items) {
+    mp_obj_list_t *o = m_new_obj(mp_obj_list_t);
+    o->base.type = type;
+    o->len = n;
+    o->alloc = n < 4 ? 4 : n;
+    o->items = m_new(mp_obj_t, o->alloc);
+    for (size_t i = 0; i < n; i++) {
+        o->items[i] = items ? items[i] : MP_OBJ_NULL;
+    }
+    return MP_OBJ_FROM_PTR(o);
+}
+
+mp_obj_t mp_obj_new_list(size_t n, mp_obj_t *items) {
+    return new_seq(&mp_type_list, n, items);
+}
+
+mp_obj_t mp_obj_new_tuple(size_t n, const mp_obj_t *items) {
+    return new_seq(&mp_type_tuple, n, items);
+}
+
+void mp_obj_list_append(mp_obj_t self_in, mp_obj_t arg) {
+    mp_obj_list_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->len == self->alloc) {
+        mp_obj_t *items = m_new(mp_obj_t, self->alloc * 2);
+        memcpy(items, self->items, self->len * sizeof(mp_obj_t));
+        m_free(self->items);
+        self->items = items;
+        self->alloc *= 2;
+    }
+    self->items[self->len++] = arg;
+}
+
+void mp_obj_get_array(mp_obj_t o, size_t *len, mp_obj_t **items) {
+    const mp_obj_type_t *type = mp_obj_get_type(o);
+    if (type != &mp_type_list && type != &mp_type_tuple) {
+        mp_raise_TypeError("object isn't a tuple or list");
+    }
+    mp_obj_list_t *seq = MP_OBJ_TO_PTR(o);
+    *len = seq->len;
+    *items = seq->items;
+}
+
+mp_obj_t mp_obj_new_dict(size_t n_args) {
+    mp_obj_dict_t *o = m_new_obj(mp_obj_dict_t);
+    o->base.type = &mp_type_dict;
+    o->used = 0;
+    o->alloc = n_args < 4 ? 4 : n_args;
+    o->table = m_new(mp_map_elem_t, o->alloc);
+    return MP_OBJ_FROM_PTR(o);
+}
+
+// Conversions
+
+mp_int_t mp_obj_get_int(mp_const_obj_t arg) {
+    if (mp_obj_is_small_int(arg)) {
+        return MP_OBJ_SMALL_INT_VALUE(arg);
+    }
+    if (arg == mp_const_false || arg == mp_const_true) {
+        return arg == mp_const_true;
+    }
+    mp_raise_TypeError("can't convert to int");
+}
+
+mp_float_t mp_obj_get_float(mp_obj_t self_in) {
+    if (mp_obj_is_type(self_in, &mp_type_float)) {
+        return ((mp_obj_float_t *)MP_OBJ_TO_PTR(self_in))->value;
+    }
+    return (mp_float_t)mp_obj_get_int(self_in);
+}
+
+const char *mp_obj_str_get_data(mp_obj_t self_in, size_t *len) {
+    if (mp_obj_is_qstr(self_in)) {
+        const char *s = qstr_str(MP_OBJ_QSTR_VALUE(self_in));
+        *len = strlen(s);
+        return s;
+    }
+    const mp_obj_type_t *type = mp_obj_get_type(self_in);
+    if (type != &mp_type_str && type != &mp_type_bytes) {
+        mp_raise_TypeError("can't convert to str implicitly");
+    }
+    mp_obj_array_t *s = MP_OBJ_TO_PTR(self_in);
+    *len = s->len;
+    return (const char *)s->data;
+}
+
+const char *mp_obj_str_get_str(mp_obj_t self_in) {
+    size_t len;
+    return mp_obj_str_get_data(self_in, &len);
+}
+
+bool mp_obj_is_true(mp_obj_t arg) {
+    if (arg == mp_const_false || arg == mp_const_none) {
+        return false;
+    }
+    if (arg == mp_const_true) {
+        return true;
+    }
+    if (mp_obj_is_small_int(arg)) {
+        return MP_OBJ_SMALL_INT_VALUE(arg) != 0;
+    }
+    if (mp_obj_is_qstr(arg)) {
+        return qstr_str(MP_OBJ_QSTR_VALUE(arg))[0] != 0;
+    }
+    const mp_obj_type_t *type = mp_obj_get_type(arg);
+    if (type == &mp_type_str || type == &mp_type_bytes || type == &mp_type_bytearray) {
+        return ((mp_obj_array_t *)MP_OBJ_TO_PTR(arg))->len != 0;
+    }
+    if (type == &mp_type_list || type == &mp_type_tuple) {
+        return ((mp_obj_list_t *)MP_OBJ_TO_PTR(arg))->len != 0;
+    }
+    if (type == &mp_type_dict) {
+        return ((mp_obj_dict_t *)MP_OBJ_TO_PTR(arg))->used != 0;
+    }
+    if (type == &mp_type_float) {
+        return ((mp_obj_float_t *)MP_OBJ_TO_PTR(arg))->value != 0;
+    }
+    return true;
+}
+
+static bool is_str(mp_obj_t o) {
+    return mp_obj_is_qstr(o) || mp_obj_is_type(o, &mp_type_str);
+}
+
+bool mp_obj_equal(mp_obj_t a, mp_obj_t b) {
+    if (a == b) {
+        return true;
+    }
+    if (is_str(a) && is_str(b)) {
+        size_t la, lb;
+        const char *sa = mp_obj_str_get_data(a, &la);
+        const char *sb = mp_obj_str_get_data(b, &lb);
+        return la == lb && memcmp(sa, sb, la) == 0;
+    }
+    bool ia = mp_obj_is_small_int(a) || a == mp_const_true || a == mp_const_false;
+    bool ib = mp_obj_is_small_int(b) || b == mp_const_true || b == mp_const_false;
+    if (ia && ib) {
+        return mp_obj_get_int(a) == mp_obj_get_int(b);
+    }
+    return false;
+}
+
+// Dicts
+
+static mp_map_elem_t *dict_find(const mp_obj_dict_t *d, mp_obj_t key) {
+    for (size_t i = 0; i < d->used; i++) {
+        if (mp_obj_equal(d->table[i].key, key)) {
+            return &d->table[i];
+        }
+    }
+    return NULL;
+}
+
+mp_obj_t mp_obj_dict_store(mp_obj_t self_in, mp_obj_t key, mp_obj_t value) {
+    mp_obj_dict_t *self = MP_OBJ_TO_PTR(self_in);
+    mp_map_elem_t *e = dict_find(self, key);
+    if (e == NULL) {
+        if (self->alloc == 0) {
+            mp_raise_TypeError("'dict' object doesn't support item assignment");
+        }
+        if (self->used == self->alloc) {
+            mp_map_elem_t *table = m_new(mp_map_elem_t, self->alloc * 2);
+            memcpy(table, self->table, self->used * sizeof(mp_map_elem_t));
+            m_free(self->table);
+            self->table = table;
+            self->alloc *= 2;
+        }
+        e = &self->table[self->used++];
+        e->key = key;
+    }
+    e->value = value;
+    return self_in;
+}
+
+mp_obj_t mp_obj_dict_get(mp_obj_t self_in, mp_obj_t index) {
+    mp_map_elem_t *e = dict_find(MP_OBJ_TO_PTR(self_in), index);
+    if (e == NULL) {
+        mp_raise_msg(&mp_type_KeyError, "key not found");
+    }
+    return e->value;
+}
+
+mp_obj_t mp_host_dict_lookup(mp_obj_t dict, const char *key) {
+    mp_map_elem_t *e = dict_find(MP_OBJ_TO_PTR(dict), mp_obj_new_str(key, strlen(key)));
+    return e ? e->value : MP_OBJ_NULL;
+}
+
+mp_int_t mp_host_dict_int(mp_obj_t dict, const char *key) {
+    mp_obj_t value = mp_host_dict_lookup(dict, key);
+    if (value == MP_OBJ_NULL) {
+        fprintf(stderr, "missing key %s\n", key);
+        abort();
+    }
+    return mp_obj_get_int(value);
+}
+
+// Buffers
+
+bool mp_get_buffer(mp_obj_t obj, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    if (!mp_obj_is_obj(obj) && !mp_obj_is_qstr(obj)) {
+        return false;
+    }
+    if (mp_obj_is_qstr(obj)) {
+        if (flags & MP_BUFFER_WRITE) {
+            return false;
+        }
+        size_t len;
+        bufinfo->buf = (void *)mp_obj_str_get_data(obj, &len);
+        bufinfo->len = len;
+        bufinfo->typecode = 'B';
+        return true;
+    }
+    const mp_obj_type_t *type = mp_obj_get_type(obj);
+    if (type->buffer == NULL) {
+        return false;
+    }
+    return type->buffer(obj, bufinfo, flags) == 0;
+}
+
+void mp_get_buffer_raise(mp_obj_t obj, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+    if (!mp_get_buffer(obj, bufinfo, flags)) {
+        mp_raise_TypeError("object with buffer protocol required");
+    }
+}
+
+// Exceptions
+
+typedef struct _nlr_state_t {
+    nlr_buf_t *top;
+} nlr_state_t;
+
+static __thread nlr_state_t nlr_state;
+
+void nlr_push_tail(nlr_buf_t *nlr) {
+    nlr->prev = nlr_state.top;
+    nlr_state.top = nlr;
+}
+
+void nlr_pop(void) {
+    nlr_state.top = nlr_state.top->prev;
+}
+
+void nlr_jump(void *val) {
+    nlr_buf_t *top = nlr_state.top;
+    if (top == NULL) {
+        mp_host_uncaught(val);
+    }
+    top->ret_val = val;
+    nlr_state.top = top->prev;
+    longjmp(top->jmpbuf, 1);
+}
+
+void nlr_raise(mp_obj_t exc) {
+    nlr_jump(exc);
+}
+
+mp_obj_t mp_obj_new_exception_msg(const mp_obj_type_t *exc_type, const char *msg) {
+    mp_obj_exception_t *o = m_new_obj(mp_obj_exception_t);
+    o->base.type = exc_type;
+    o->msg = msg;
+    o->errno_ = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+void mp_raise_msg(const mp_obj_type_t *exc_type, const char *msg) {
+    nlr_raise(mp_obj_new_exception_msg(exc_type, msg));
+}
+
+void mp_raise_ValueError(const char *msg) {
+    mp_raise_msg(&mp_type_ValueError, msg);
+}
+
+void mp_raise_TypeError(const char *msg) {
+    mp_raise_msg(&mp_type_TypeError, msg);
+}
+
+void mp_raise_OSError(int errno_) {
+    mp_obj_exception_t *o = MP_OBJ_TO_PTR(mp_obj_new_exception_msg(&mp_type_OSError, strerror(errno_)));
+    o->errno_ = errno_;
+    nlr_raise(MP_OBJ_FROM_PTR(o));
+}
+
+void mp_host_uncaught(mp_obj_t exc) {
+    mp_obj_exception_t *e = MP_OBJ_TO_PTR(exc);
+    fprintf(stderr, "Uncaught %s: %s\n", qstr_str(e->base.type->name), e->msg ? e->msg : "");
+    abort();
+}
+
+// Calls
+
+void mp_arg_check_num(size_t n_args, size_t n_kw, size_t n_args_min, size_t n_args_max, bool takes_kw) {
+    if (n_kw > 0 && !takes_kw) {
+        mp_raise_TypeError("function doesn't take keyword arguments");
+    }
+    if (n_args < n_args_min || n_args > n_args_max) {
+        mp_raise_TypeError("function takes a different number of arguments");
+    }
+}
+
+mp_obj_t mp_call_function_n_kw(mp_obj_t fun, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    if (mp_obj_is_type(fun, &mp_type_type)) {
+        const mp_obj_type_t *type = MP_OBJ_TO_PTR(fun);
+        if (type->make_new == NULL) {
+            mp_raise_TypeError("cannot create instance");
+        }
+        return type->make_new(type, n_args, n_kw, args);
+    }
+    if (!mp_obj_is_type(fun, &mp_type_fun_builtin)) {
+        const mp_obj_type_t *type = mp_obj_get_type(fun);
+        if (type->call == NULL) {
+            mp_raise_TypeError("object isn't callable");
+        }
+        return type->call(fun, n_args, n_kw, args);
+    }
+    const mp_obj_fun_builtin_t *f = MP_OBJ_TO_PTR(fun);
+    mp_arg_check_num(n_args, n_kw, f->n_args_min, f->n_args_max, false);
+    switch (f->kind) {
+        case MP_FUN_0:
+            return f->fun._0();
+        case MP_FUN_1:
+            return f->fun._1(args[0]);
+        case MP_FUN_2:
+            return f->fun._2(args[0], args[1]);
+        case MP_FUN_3:
+            return f->fun._3(args[0], args[1], args[2]);
+        default:
+            return f->fun.var(n_args, args);
+    }
+}
+
+mp_obj_t mp_call_function_0(mp_obj_t fun) {
+    return mp_call_function_n_kw(fun, 0, 0, NULL);
+}
+
+mp_obj_t mp_call_function_1(mp_obj_t fun, mp_obj_t arg) {
+    return mp_call_function_n_kw(fun, 1, 0, &arg);
+}
+
+// args: method, self or MP_OBJ_NULL, then the arguments
+mp_obj_t mp_call_method_n_kw(size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    if (args[1] == MP_OBJ_NULL) {
+        return mp_call_function_n_kw(args[0], n_args, n_kw, args + 2);
+    }
+    return mp_call_function_n_kw(args[0], n_args + 1, n_kw, args + 1);
+}
+
+static mp_map_elem_t *lookup_attr(mp_obj_t base, qstr attr, bool *bound) {
+    mp_obj_t key = MP_OBJ_NEW_QSTR(attr);
+    *bound = false;
+    if (mp_obj_is_type(base, &mp_type_module)) {
+        const mp_obj_module_t *module = MP_OBJ_TO_PTR(base);
+        return dict_find(module->globals, key);
+    }
+    if (mp_obj_is_type(base, &mp_type_type)) {
+        const mp_obj_type_t *type = MP_OBJ_TO_PTR(base);
+        return type->locals_dict ? dict_find(type->locals_dict, key) : NULL;
+    }
+    for (const mp_obj_type_t *type = mp_obj_get_type(base); type != NULL; type = type->parent) {
+        if (type->locals_dict != NULL) {
+            mp_map_elem_t *e = dict_find(type->locals_dict, key);
+            if (e != NULL) {
+                *bound = mp_obj_is_type(e->value, &mp_type_fun_builtin);
+                return e;
+            }
+        }
+    }
+    return NULL;
+}
+
+void mp_load_method_maybe(mp_obj_t base, qstr attr, mp_obj_t *dest) {
+    bool bound;
+    mp_map_elem_t *e = lookup_attr(base, attr, &bound);
+    dest[0] = e ? e->value : MP_OBJ_NULL;
+    dest[1] = (e && bound) ? base : MP_OBJ_NULL;
+}
+
+void mp_load_method(mp_obj_t base, qstr attr, mp_obj_t *dest) {
+    mp_load_method_maybe(base, attr, dest);
+    if (dest[0] == MP_OBJ_NULL) {
+        mp_raise_msg(&mp_type_RuntimeError, "AttributeError: no such attribute");
+    }
+}
+
+mp_obj_t mp_load_attr(mp_obj_t base, qstr attr) {
+    mp_obj_t dest[2];
+    mp_load_method(base, attr, dest);
+    if (dest[1] != MP_OBJ_NULL) {
+        mp_raise_msg(&mp_type_RuntimeError, "bound methods are not objects here, call them");
+    }
+    return dest[0];
+}
+
+// Scheduler
+
+typedef struct {
+    mp_obj_t fun;
+    mp_obj_t arg;
+} sched_item_t;
+
+static sched_item_t sched_queue[MICROPY_SCHEDULER_DEPTH];
+static size_t sched_idx = 0;
+static size_t sched_len = 0;
+static pthread_mutex_t sched_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread bool sched_running = false;
+
+bool mp_sched_schedule(mp_obj_t function, mp_obj_t arg) {
+    bool ok = false;
+    pthread_mutex_lock(&sched_mutex);
+    if (sched_len < MICROPY_SCHEDULER_DEPTH) {
+        sched_queue[(sched_idx + sched_len) % MICROPY_SCHEDULER_DEPTH] = (sched_item_t) { function, arg };
+        sched_len++;
+        ok = true;
+    }
+    pthread_mutex_unlock(&sched_mutex);
+    return ok;
+}
+
+void mp_handle_pending(bool raise_exc) {
+    // Callbacks do not nest, as upstream with the scheduler locked
+    if (sched_running) {
+        return;
+    }
+    sched_running = true;
+    for (;;) {
+        pthread_mutex_lock(&sched_mutex);
+        if (sched_len == 0) {
+            pthread_mutex_unlock(&sched_mutex);
+            break;
+        }
+        sched_item_t item = sched_queue[sched_idx];
+        sched_idx = (sched_idx + 1) % MICROPY_SCHEDULER_DEPTH;
+        sched_len--;
+        pthread_mutex_unlock(&sched_mutex);
+
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            mp_call_function_1(item.fun, item.arg);
+            nlr_pop();
+        } else {
+            sched_running = false;
+            if (raise_exc) {
+                nlr_jump(nlr.ret_val);
+            }
+            mp_obj_exception_t *e = nlr.ret_val;
+            fprintf(stderr, "Uncaught exception in scheduled callback: %s\n", e->msg ? e->msg : "");
+            sched_running = true;
+        }
+    }
+    sched_running = false;
+}
+
+size_t mp_host_sched_pending(void) {
+    return sched_len;
+}
+
+// The poll hook: a tick of the virtual clock for the other threads to run
+void mp_host_poll_yield(void) {
+    sim_sleep_us(1000);
+}
+
+// HAL
+
+void mp_hal_delay_ms(mp_uint_t ms) {
+    sim_sleep_us((uint64_t)ms * 1000);
+}
+
+void mp_hal_delay_us(mp_uint_t us) {
+    sim_sleep_us(us);
+}
+
+mp_uint_t mp_hal_ticks_ms(void) {
+    return sim_clock_now() / 1000;
+}
+
+mp_uint_t mp_hal_ticks_us(void) {
+    return sim_clock_now();
+}
+
+// Streams
+
+mp_uint_t mp_stream_rw(mp_obj_t stream, void *buf, mp_uint_t size, int *errcode, uint8_t flags) {
+    const mp_stream_p_t *p = mp_obj_get_type(stream)->protocol;
+    if (p == NULL) {
+        *errcode = MP_EBADF;
+        return MP_STREAM_ERROR;
+    }
+    if (flags & MP_STREAM_RW_WRITE) {
+        return p->write(stream, buf, size, errcode);
+    }
+    return p->read(stream, buf, size, errcode);
+}
+
+mp_obj_t mp_stream_write(mp_obj_t self_in, const void *buf, size_t len, uint8_t flags) {
+    int errcode;
+    mp_uint_t out = mp_stream_rw(self_in, (void *)buf, len, &errcode, flags | MP_STREAM_RW_WRITE);
+    if (out == MP_STREAM_ERROR) {
+        if (errcode == MP_EAGAIN) {
+            return mp_const_none;
+        }
+        mp_raise_OSError(errcode);
+    }
+    return mp_obj_new_int_from_uint(out);
+}
+
+typedef struct {
+    mp_obj_base_t base;
+    uint8_t *data;
+    size_t len;
+    size_t alloc;
+} bytesio_obj_t;
+
+static mp_uint_t bytesio_write(mp_obj_t self_in, const void *buf, mp_uint_t size, int *errcode) {
+    bytesio_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->len + size > self->alloc) {
+        size_t alloc = (self->len + size) * 2;
+        uint8_t *data = m_new(uint8_t, alloc);
+        memcpy(data, self->data, self->len);
+        m_free(self->data);
+        self->data = data;
+        self->alloc = alloc;
+    }
+    memcpy(self->data + self->len, buf, size);
+    self->len += size;
+    return size;
+}
+
+static const mp_stream_p_t bytesio_stream_p = {
+    .write = bytesio_write,
+};
+
+static const mp_obj_type_t bytesio_type = { { &mp_type_type }, .name = MP_QSTR_BytesIO, .protocol = &bytesio_stream_p };
+
+mp_obj_t mp_host_new_bytesio(void) {
+    bytesio_obj_t *o = m_new_obj(bytesio_obj_t);
+    o->base.type = &bytesio_type;
+    o->data = NULL;
+    o->len = 0;
+    o->alloc = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+const uint8_t *mp_host_bytesio_data(mp_obj_t self_in, size_t *len) {
+    bytesio_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    *len = self->len;
+    return self->data;
+}
+
+// ThreadSafeFlag
+
+typedef struct {
+    mp_obj_base_t base;
+    uint32_t count;
+} flag_obj_t;
+
+static mp_obj_t flag_set(mp_obj_t self_in) {
+    flag_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    self->count++;
+    return mp_const_none;
+}
+static MP_DEFINE_CONST_FUN_OBJ_1(flag_set_obj, flag_set);
+
+static const mp_rom_map_elem_t flag_locals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR_set), MP_ROM_PTR(&flag_set_obj) },
+};
+static MP_DEFINE_CONST_DICT(flag_locals, flag_locals_table);
+
+static MP_DEFINE_CONST_OBJ_TYPE(
+    flag_type,
+    MP_QSTR_ThreadSafeFlag,
+    MP_TYPE_FLAG_NONE,
+    locals_dict, &flag_locals
+);
+
+mp_obj_t mp_host_new_flag(void) {
+    flag_obj_t *o = m_new_obj(flag_obj_t);
+    o->base.type = &flag_type;
+    o->count = 0;
+    return MP_OBJ_FROM_PTR(o);
+}
+
+uint32_t mp_host_flag_count(mp_obj_t self_in) {
+    return ((flag_obj_t *)MP_OBJ_TO_PTR(self_in))->count;
+}
+
+// Modules
+
+#define MAX_MODULES 16
+
+typedef struct {
+    qstr name;
+    const mp_obj_module_t *module;
+    bool loaded;
+} module_entry_t;
+
+static module_entry_t modules[MAX_MODULES];
+static size_t module_count = 0;
+
+void mp_host_register_module(qstr name, const mp_obj_module_t *module) {
+    if (module_count < MAX_MODULES) {
+        modules[module_count++] = (module_entry_t) { name, module, false };
+    }
+}
+
+void mp_host_init(void) {
+    sim_clock_init();
+    sim_reset();
+}
+
+mp_obj_t mp_host_import(const char *name) {
+    for (size_t i = 0; i < module_count; i++) {
+        if (strcmp(qstr_str(modules[i].name), name) != 0) {
+            continue;
+        }
+        mp_obj_t module = MP_OBJ_FROM_PTR((void *)modules[i].module);
+        if (!modules[i].loaded) {
+            modules[i].loaded = true;
+            // MICROPY_MODULE_BUILTIN_INIT: __init__ on the first import
+            mp_obj_t dest[2];
+            mp_load_method_maybe(module, MP_QSTR___init__, dest);
+            if (dest[0] != MP_OBJ_NULL) {
+                mp_call_function_0(dest[0]);
+            }
+        }
+        return module;
+    }
+    fprintf(stderr, "no module named '%s'\n", name);
+    abort();
+}
+
+void mp_host_soft_reset(void) {
+    // Finalisers first, while every object is still there
+    for (heap_block_t *b = heap_head.next; b != &heap_head; b = b->next) {
+        if (!b->finaliser) {
+            continue;
+        }
+        mp_obj_t obj = MP_OBJ_FROM_PTR(b + 1);
+        mp_obj_t dest[2];
+        mp_load_method_maybe(obj, MP_QSTR___del__, dest);
+        if (dest[0] != MP_OBJ_NULL) {
+            nlr_buf_t nlr;
+            if (nlr_push(&nlr) == 0) {
+                mp_call_method_n_kw(0, 0, dest);
+                nlr_pop();
+            }
+        }
+        b->finaliser = false;
+    }
+    while (heap_head.next != &heap_head) {
+        m_free(heap_head.next + 1);
+    }
+    pthread_mutex_lock(&sched_mutex);
+    sched_len = 0;
+    pthread_mutex_unlock(&sched_mutex);
+    for (size_t i = 0; i < module_count; i++) {
+        modules[i].loaded = false;
+    }
+}
+
+// Test helpers
+
+static qstr qstr_of(const char *name) {
+    qstr q = qstr_find_strn(name, strlen(name));
+    if (q == MP_QSTRnull) {
+        fprintf(stderr, "'%s' is not a qstr\n", name);
+        abort();
+    }
+    return q;
+}
+
+mp_obj_t mp_host_attr(mp_obj_t obj, const char *name) {
+    return mp_load_attr(obj, qstr_of(name));
+}
+
+bool mp_host_has_attr(mp_obj_t obj, const char *name) {
+    qstr q = qstr_find_strn(name, strlen(name));
+    if (q == MP_QSTRnull) {
+        return false;
+    }
+    mp_obj_t dest[2];
+    mp_load_method_maybe(obj, q, dest);
+    return dest[0] != MP_OBJ_NULL;
+}
+
+mp_obj_t mp_host_call_v(mp_obj_t obj, const char *name, size_t n_args, const mp_obj_t *args) {
+    mp_obj_t call[2 + 8];
+    if (n_args > 8) {
+        abort();
+    }
+    mp_load_method(obj, qstr_of(name), call);
+    for (size_t i = 0; i < n_args; i++) {
+        call[2 + i] = args[i];
+    }
+    return mp_call_method_n_kw(n_args, 0, call);
+}
+
+mp_obj_t mp_host_call(mp_obj_t obj, const char *name, size_t n_args, ...) {
+    mp_obj_t args[8];
+    va_list ap;
+    va_start(ap, n_args);
+    for (size_t i = 0; i < n_args && i < 8; i++) {
+        args[i] = va_arg(ap, mp_obj_t);
+    }
+    va_end(ap);
+    return mp_host_call_v(obj, name, n_args, args);
+}
+
+mp_obj_exception_t *mp_host_call_catch(mp_obj_t *ret, mp_obj_t obj, const char *name, size_t n_args, ...) {
+    mp_obj_t args[8];
+    va_list ap;
+    va_start(ap, n_args);
+    for (size_t i = 0; i < n_args && i < 8; i++) {
+        args[i] = va_arg(ap, mp_obj_t);
+    }
+    va_end(ap);
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t r = mp_host_call_v(obj, name, n_args, args);
+        nlr_pop();
+        if (ret != NULL) {
+            *ret = r;
+        }
+        return NULL;
+    }
+    return nlr.ret_val;
+}
+
+mp_obj_t mp_host_new(mp_obj_t type, size_t n_args, const mp_obj_t *args) {
+    return mp_call_function_n_kw(type, n_args, 0, args);
+}
@@ -0,0 +1,19 @@
+/*
+ * Port configuration of the host build, modelled on ports/esp32
+ */
+
+#ifndef HOST_MP_MPCONFIGPORT_H
+#define HOST_MP_MPCONFIGPORT_H
+
+#include <stdbool.h>
+
+// As on the ESP32: run pending callbacks, then give the CPU away for a tick
+#define MICROPY_EVENT_POLL_HOOK \
+    do { \
+        extern void mp_handle_pending(bool); \
+        extern void mp_host_poll_yield(void); \
+        mp_handle_pending(true); \
+        mp_host_poll_yield(); \
+    } while (0);
+
+#endif // HOST_MP_MPCONFIGPORT_H
@@ -0,0 +1,64 @@
+/*
+ * Host side of the MicroPython shim: what a test does from the REPL
+ */
+
+#ifndef HOST_MP_MPHOST_H
+#define HOST_MP_MPHOST_H
+
+#include <stdarg.h>
+#include "py/obj.h"
+#include "py/runtime.h"
+
+// Exception objects, the message is kept for the test output
+typedef struct _mp_obj_exception_t {
+    mp_obj_base_t base;
+    const char *msg;
+    int errno_;
+} mp_obj_exception_t;
+
+// VM start, also done on the first import
+void mp_host_init(void);
+
+// Ctrl-D: runs the finalisers, frees the VM heap and forgets the imports, the
+// modules' static C state and the root pointers stay, as on the board
+void mp_host_soft_reset(void);
+
+// import name, runs the module's __init__ the first time after a soft reset
+mp_obj_t mp_host_import(const char *name);
+
+// getattr(obj, name), raises AttributeError as a RuntimeError
+mp_obj_t mp_host_attr(mp_obj_t obj, const char *name);
+bool mp_host_has_attr(mp_obj_t obj, const char *name);
+
+// obj.name(*args), args are mp_obj_t
+mp_obj_t mp_host_call(mp_obj_t obj, const char *name, size_t n_args, ...);
+mp_obj_t mp_host_call_v(mp_obj_t obj, const char *name, size_t n_args, const mp_obj_t *args);
+
+// Like mp_host_call, returns the exception instead of raising it, NULL on success
+mp_obj_exception_t *mp_host_call_catch(mp_obj_t *ret, mp_obj_t obj, const char *name, size_t n_args, ...);
+
+// type(*args)
+mp_obj_t mp_host_new(mp_obj_t type, size_t n_args, const mp_obj_t *args);
+
+// d[key] with a str key, MP_OBJ_NULL when missing
+mp_obj_t mp_host_dict_lookup(mp_obj_t dict, const char *key);
+mp_int_t mp_host_dict_int(mp_obj_t dict, const char *key);
+
+// Blocks on the VM heap, to tell leaks of the modules from the VM's own
+size_t mp_host_heap_blocks(void);
+
+// io.BytesIO() for the stream writers, its contents
+mp_obj_t mp_host_new_bytesio(void);
+const uint8_t *mp_host_bytesio_data(mp_obj_t self_in, size_t *len);
+
+// asyncio.ThreadSafeFlag: set() from a scheduled callback, counted
+mp_obj_t mp_host_new_flag(void);
+uint32_t mp_host_flag_count(mp_obj_t self_in);
+
+// Callbacks still queued in the scheduler
+size_t mp_host_sched_pending(void);
+
+// Uncaught exception: print it and fail the test
+__attribute__((noreturn)) void mp_host_uncaught(mp_obj_t exc);
+
+#endif // HOST_MP_MPHOST_H
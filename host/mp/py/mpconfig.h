@@ -0,0 +1,19 @@
+/*
+ * MicroPython configuration for the host build
+ */
+
+#ifndef HOST_MP_PY_MPCONFIG_H
+#define HOST_MP_PY_MPCONFIG_H
+
+// The modules are written against the releases that still had STATIC
+#define STATIC static
+
+#define MICROPY_PY_THREAD               (1)
+#define MICROPY_PY_THREAD_GIL           (1)
+#define MICROPY_SCHEDULER_DEPTH         (4)
+#define MICROPY_MODULE_BUILTIN_INIT     (1)
+#define MICROPY_ENABLE_FINALISER        (1)
+
+#include "mpconfigport.h"
+
+#endif // HOST_MP_PY_MPCONFIG_H
@@ -0,0 +1,18 @@
+/*
+ * Error numbers, as MICROPY_USE_INTERNAL_ERRNO upstream
+ */
+
+#ifndef HOST_MP_PY_MPERRNO_H
+#define HOST_MP_PY_MPERRNO_H
+
+#define MP_EPERM        (1)
+#define MP_ENOENT       (2)
+#define MP_EIO          (5)
+#define MP_EBADF        (9)
+#define MP_EAGAIN       (11)
+#define MP_ENOMEM       (12)
+#define MP_EBUSY        (16)
+#define MP_EINVAL       (22)
+#define MP_ETIMEDOUT    (110)
+
+#endif // HOST_MP_PY_MPERRNO_H
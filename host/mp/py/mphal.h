@@ -0,0 +1,15 @@
+/*
+ * Hardware abstraction of the host build, on the virtual clock
+ */
+
+#ifndef HOST_MP_PY_MPHAL_H
+#define HOST_MP_PY_MPHAL_H
+
+#include "py/obj.h"
+
+void mp_hal_delay_ms(mp_uint_t ms);
+void mp_hal_delay_us(mp_uint_t us);
+mp_uint_t mp_hal_ticks_ms(void);
+mp_uint_t mp_hal_ticks_us(void);
+
+#endif // HOST_MP_PY_MPHAL_H
@@ -0,0 +1,29 @@
+/*
+ * VM state for the host build
+ * Holds the root pointers the modules register with MP_REGISTER_ROOT_POINTER,
+ * declared as written, as in upstream's genhdr/root_pointers.h
+ */
+
+#ifndef HOST_MP_PY_MPSTATE_H
+#define HOST_MP_PY_MPSTATE_H
+
+#include "py/obj.h"
+
+typedef struct _mp_state_vm_t {
+#include "genhdr/root_pointers.h"
+    char dummy;
+} mp_state_vm_t;
+
+typedef struct _mp_state_ctx_t {
+    mp_state_vm_t vm;
+} mp_state_ctx_t;
+
+extern mp_state_ctx_t mp_state_ctx;
+
+#define MP_STATE_VM(x) (mp_state_ctx.vm.x)
+
+// The modules release the GIL around blocking waits; the host VM has none
+#define MP_THREAD_GIL_ENTER()
+#define MP_THREAD_GIL_EXIT()
+
+#endif // HOST_MP_PY_MPSTATE_H
@@ -0,0 +1,23 @@
+/*
+ * Non-local return for the host build, on setjmp/longjmp
+ * One handler chain per thread, as with MICROPY_PY_THREAD upstream
+ */
+
+#ifndef HOST_MP_PY_NLR_H
+#define HOST_MP_PY_NLR_H
+
+#include <setjmp.h>
+
+typedef struct _nlr_buf_t {
+    struct _nlr_buf_t *prev;
+    void *ret_val;
+    jmp_buf jmpbuf;
+} nlr_buf_t;
+
+void nlr_push_tail(nlr_buf_t *nlr);
+void nlr_pop(void);
+__attribute__((noreturn)) void nlr_jump(void *val);
+
+#define nlr_push(buf) (nlr_push_tail(buf), setjmp((buf)->jmpbuf))
+
+#endif // HOST_MP_PY_NLR_H
@@ -0,0 +1,269 @@
+/*
+ * MicroPython object model for the host build
+ *
+ * Just what the user modules use, with the upstream names and semantics:
+ * tagged small ints and qstrs, heap objects starting with mp_obj_base_t,
+ * ROM dicts and types built by the same macros. Only the fixed arity
+ * builtins upstream has (0 to 3 arguments, VAR and VAR_BETWEEN) exist, so a
+ * module that would not build in the firmware does not build here either.
+ */
+
+#ifndef HOST_MP_PY_OBJ_H
+#define HOST_MP_PY_OBJ_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "py/mpconfig.h"
+#include "py/qstr.h"
+
+typedef void *mp_obj_t;
+typedef const void *mp_const_obj_t;
+typedef intptr_t mp_int_t;
+typedef uintptr_t mp_uint_t;
+typedef double mp_float_t;
+
+#define MP_OBJ_NULL             ((mp_obj_t)NULL)
+#define MP_OBJ_TO_PTR(o)        ((void *)(o))
+#define MP_OBJ_FROM_PTR(p)      ((mp_obj_t)(p))
+
+// Small ints have bit 0 set, qstrs end in 0b10
+#define MP_OBJ_NEW_SMALL_INT(i) ((mp_obj_t)(((uintptr_t)(mp_int_t)(i) << 1) | 1))
+#define MP_OBJ_SMALL_INT_VALUE(o) (((mp_int_t)(o)) >> 1)
+#define MP_OBJ_NEW_QSTR(q)      ((mp_obj_t)((((uintptr_t)(q)) << 3) | 2))
+#define MP_OBJ_QSTR_VALUE(o)    (((uintptr_t)(o)) >> 3)
+
+static inline bool mp_obj_is_small_int(mp_const_obj_t o) {
+    return ((uintptr_t)o & 1) != 0;
+}
+
+static inline bool mp_obj_is_qstr(mp_const_obj_t o) {
+    return ((uintptr_t)o & 7) == 2;
+}
+
+static inline bool mp_obj_is_obj(mp_const_obj_t o) {
+    return o != NULL && ((uintptr_t)o & 3) == 0;
+}
+
+#define MP_ROM_INT(i)           MP_OBJ_NEW_SMALL_INT(i)
+#define MP_ROM_QSTR(q)          MP_OBJ_NEW_QSTR(q)
+#define MP_ROM_PTR(p)           ((mp_obj_t)(p))
+#define MP_ROM_NONE             MP_ROM_PTR(&mp_const_none_obj)
+
+#define MP_ARRAY_SIZE(a)        (sizeof(a) / sizeof((a)[0]))
+#define MP_ERROR_TEXT(s)        (s)
+
+struct _mp_obj_type_t;
+typedef struct _mp_obj_base_t {
+    const struct _mp_obj_type_t *type;
+} mp_obj_base_t;
+
+// Buffer protocol
+#define MP_BUFFER_READ          (1)
+#define MP_BUFFER_WRITE         (2)
+#define MP_BUFFER_RW            (MP_BUFFER_READ | MP_BUFFER_WRITE)
+
+typedef struct _mp_buffer_info_t {
+    void *buf;
+    size_t len;
+    int typecode;
+} mp_buffer_info_t;
+
+typedef mp_obj_t (*mp_make_new_fun_t)(const struct _mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args);
+typedef mp_int_t (*mp_buffer_fun_t)(mp_obj_t obj, mp_buffer_info_t *bufinfo, mp_uint_t flags);
+typedef mp_obj_t (*mp_call_fun_t)(mp_obj_t fun, size_t n_args, size_t n_kw, const mp_obj_t *args);
+
+// Maps: ROM tables and heap dicts share the element layout
+typedef struct _mp_map_elem_t {
+    mp_obj_t key;
+    mp_obj_t value;
+} mp_map_elem_t;
+typedef mp_map_elem_t mp_rom_map_elem_t;
+
+typedef struct _mp_obj_dict_t {
+    mp_obj_base_t base;
+    size_t used;
+    size_t alloc;
+    mp_map_elem_t *table;
+} mp_obj_dict_t;
+
+#define MP_TYPE_FLAG_NONE       (0x0000)
+
+typedef struct _mp_obj_type_t {
+    mp_obj_base_t base;
+    uint16_t flags;
+    uint16_t name;
+    mp_make_new_fun_t make_new;
+    mp_call_fun_t call;
+    mp_buffer_fun_t buffer;
+    const void *protocol;
+    const mp_obj_dict_t *locals_dict;
+    const struct _mp_obj_type_t *parent;
+} mp_obj_type_t;
+
+// MP_DEFINE_CONST_OBJ_TYPE(name, qstr, flags, slot, value, ...)
+#define MP_TYPE_SLOT2(s, v) .s = v
+#define MP_TYPE_SLOT4(s, v, ...) .s = v, MP_TYPE_SLOT2(__VA_ARGS__)
+#define MP_TYPE_SLOT6(s, v, ...) .s = v, MP_TYPE_SLOT4(__VA_ARGS__)
+#define MP_TYPE_SLOT8(s, v, ...) .s = v, MP_TYPE_SLOT6(__VA_ARGS__)
+#define MP_TYPE_SLOT10(s, v, ...) .s = v, MP_TYPE_SLOT8(__VA_ARGS__)
+#define MP_TYPE_NARG_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, n, ...) n
+#define MP_TYPE_NARG(...) MP_TYPE_NARG_(__VA_ARGS__, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define MP_TYPE_CAT_(a, b) a##b
+#define MP_TYPE_CAT(a, b) MP_TYPE_CAT_(a, b)
+#define MP_TYPE_SLOTS(...) MP_TYPE_CAT(MP_TYPE_SLOT, MP_TYPE_NARG(__VA_ARGS__))(__VA_ARGS__)
+
+#define MP_DEFINE_CONST_OBJ_TYPE(_typename, _name, _flags, ...) \
+    const mp_obj_type_t _typename = { \
+        .base = { &mp_type_type }, \
+        .flags = _flags, \
+        .name = _name, \
+        MP_TYPE_SLOTS(__VA_ARGS__) \
+    }
+
+#define MP_DEFINE_CONST_DICT(dict_name, table_name) \
+    const mp_obj_dict_t dict_name = { \
+        .base = { &mp_type_dict }, \
+        .used = MP_ARRAY_SIZE(table_name), \
+        .alloc = 0, \
+        .table = (mp_map_elem_t *)(mp_rom_map_elem_t *)table_name, \
+    }
+
+// Builtin functions
+typedef enum {
+    MP_FUN_0,
+    MP_FUN_1,
+    MP_FUN_2,
+    MP_FUN_3,
+    MP_FUN_VAR,
+} mp_fun_kind_t;
+
+typedef struct _mp_obj_fun_builtin_t {
+    mp_obj_base_t base;
+    uint8_t kind;
+    uint16_t n_args_min;
+    uint16_t n_args_max;
+    union {
+        mp_obj_t (*_0)(void);
+        mp_obj_t (*_1)(mp_obj_t);
+        mp_obj_t (*_2)(mp_obj_t, mp_obj_t);
+        mp_obj_t (*_3)(mp_obj_t, mp_obj_t, mp_obj_t);
+        mp_obj_t (*var)(size_t, const mp_obj_t *);
+    } fun;
+} mp_obj_fun_builtin_t;
+
+#define MP_DEFINE_CONST_FUN_OBJ_0(obj_name, fun_name) \
+    const mp_obj_fun_builtin_t obj_name = { { &mp_type_fun_builtin }, MP_FUN_0, 0, 0, .fun._0 = fun_name }
+#define MP_DEFINE_CONST_FUN_OBJ_1(obj_name, fun_name) \
+    const mp_obj_fun_builtin_t obj_name = { { &mp_type_fun_builtin }, MP_FUN_1, 1, 1, .fun._1 = fun_name }
+#define MP_DEFINE_CONST_FUN_OBJ_2(obj_name, fun_name) \
+    const mp_obj_fun_builtin_t obj_name = { { &mp_type_fun_builtin }, MP_FUN_2, 2, 2, .fun._2 = fun_name }
+#define MP_DEFINE_CONST_FUN_OBJ_3(obj_name, fun_name) \
+    const mp_obj_fun_builtin_t obj_name = { { &mp_type_fun_builtin }, MP_FUN_3, 3, 3, .fun._3 = fun_name }
+#define MP_DEFINE_CONST_FUN_OBJ_VAR(obj_name, n_args_min, fun_name) \
+    const mp_obj_fun_builtin_t obj_name = { { &mp_type_fun_builtin }, MP_FUN_VAR, n_args_min, 0xffff, .fun.var = fun_name }
+#define MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(obj_name, n_args_min, n_args_max, fun_name) \
+    const mp_obj_fun_builtin_t obj_name = { { &mp_type_fun_builtin }, MP_FUN_VAR, n_args_min, n_args_max, .fun.var = fun_name }
+
+// Modules
+typedef struct _mp_obj_module_t {
+    mp_obj_base_t base;
+    mp_obj_dict_t *globals;
+} mp_obj_module_t;
+
+// Upstream collects these with a script, here a constructor registers the module
+void mp_host_register_module(qstr name, const mp_obj_module_t *module);
+#define MP_REGISTER_MODULE(module_name, obj_module) \
+    __attribute__((constructor)) static void mp_host_register_##obj_module(void) { \
+        mp_host_register_module(module_name, &obj_module); \
+    }
+
+// Collected by host/mp/makegen.py into the VM state, see py/mpstate.h
+#define MP_REGISTER_ROOT_POINTER(...)
+
+// Constant objects
+typedef struct _mp_obj_none_t {
+    mp_obj_base_t base;
+} mp_obj_none_t;
+
+typedef struct _mp_obj_bool_t {
+    mp_obj_base_t base;
+    bool value;
+} mp_obj_bool_t;
+
+extern const mp_obj_none_t mp_const_none_obj;
+extern const mp_obj_bool_t mp_const_false_obj;
+extern const mp_obj_bool_t mp_const_true_obj;
+#define mp_const_none           (MP_OBJ_FROM_PTR((void *)&mp_const_none_obj))
+#define mp_const_false          (MP_OBJ_FROM_PTR((void *)&mp_const_false_obj))
+#define mp_const_true           (MP_OBJ_FROM_PTR((void *)&mp_const_true_obj))
+
+extern const mp_obj_type_t mp_type_type;
+extern const mp_obj_type_t mp_type_module;
+extern const mp_obj_type_t mp_type_dict;
+extern const mp_obj_type_t mp_type_fun_builtin;
+extern const mp_obj_type_t mp_type_NoneType;
+extern const mp_obj_type_t mp_type_bool;
+extern const mp_obj_type_t mp_type_int;
+extern const mp_obj_type_t mp_type_float;
+extern const mp_obj_type_t mp_type_str;
+extern const mp_obj_type_t mp_type_bytes;
+extern const mp_obj_type_t mp_type_bytearray;
+extern const mp_obj_type_t mp_type_list;
+extern const mp_obj_type_t mp_type_tuple;
+extern const mp_obj_type_t mp_type_BaseException;
+extern const mp_obj_type_t mp_type_Exception;
+extern const mp_obj_type_t mp_type_KeyboardInterrupt;
+extern const mp_obj_type_t mp_type_KeyError;
+extern const mp_obj_type_t mp_type_MemoryError;
+extern const mp_obj_type_t mp_type_OSError;
+extern const mp_obj_type_t mp_type_RuntimeError;
+extern const mp_obj_type_t mp_type_TypeError;
+extern const mp_obj_type_t mp_type_ValueError;
+
+const mp_obj_type_t *mp_obj_get_type(mp_const_obj_t o);
+bool mp_obj_is_type(mp_const_obj_t o, const mp_obj_type_t *type);
+bool mp_obj_is_subclass(const mp_obj_type_t *type, const mp_obj_type_t *base);
+
+mp_obj_t mp_obj_new_bool(mp_int_t value);
+mp_obj_t mp_obj_new_int(mp_int_t value);
+mp_obj_t mp_obj_new_int_from_uint(mp_uint_t value);
+mp_obj_t mp_obj_new_int_from_ull(unsigned long long value);
+mp_obj_t mp_obj_new_float(mp_float_t value);
+mp_obj_t mp_obj_new_str(const char *data, size_t len);
+mp_obj_t mp_obj_new_bytes(const uint8_t *data, size_t len);
+mp_obj_t mp_obj_new_bytearray(size_t n, const void *items);
+mp_obj_t mp_obj_new_list(size_t n, mp_obj_t *items);
+mp_obj_t mp_obj_new_tuple(size_t n, const mp_obj_t *items);
+mp_obj_t mp_obj_new_dict(size_t n_args);
+
+mp_int_t mp_obj_get_int(mp_const_obj_t arg);
+mp_float_t mp_obj_get_float(mp_obj_t self_in);
+bool mp_obj_is_true(mp_obj_t arg);
+bool mp_obj_equal(mp_obj_t a, mp_obj_t b);
+const char *mp_obj_str_get_str(mp_obj_t self_in);
+const char *mp_obj_str_get_data(mp_obj_t self_in, size_t *len);
+void mp_obj_get_array(mp_obj_t o, size_t *len, mp_obj_t **items);
+
+void mp_obj_list_append(mp_obj_t self_in, mp_obj_t arg);
+mp_obj_t mp_obj_dict_store(mp_obj_t self_in, mp_obj_t key, mp_obj_t value);
+mp_obj_t mp_obj_dict_get(mp_obj_t self_in, mp_obj_t index);
+
+bool mp_get_buffer(mp_obj_t obj, mp_buffer_info_t *bufinfo, mp_uint_t flags);
+void mp_get_buffer_raise(mp_obj_t obj, mp_buffer_info_t *bufinfo, mp_uint_t flags);
+
+// Memory: every block is on the VM heap list, a soft reset frees them all
+void *m_malloc(size_t num_bytes);
+void *m_malloc0(size_t num_bytes);
+void *m_malloc_with_finaliser(size_t num_bytes);
+void m_free(void *ptr);
+#define m_new(type, num)            ((type *)(m_malloc(sizeof(type) * (num))))
+#define m_new0(type, num)           ((type *)(m_malloc0(sizeof(type) * (num))))
+#define m_new_obj(type)             (m_new(type, 1))
+#define m_new_obj_with_finaliser(type) ((type *)(m_malloc_with_finaliser(sizeof(type))))
+#define m_del(type, ptr, num)       ((void)(num), m_free(ptr))
+#define m_del_obj(type, ptr)        (m_del(type, ptr, 1))
+
+#endif // HOST_MP_PY_OBJ_H
@@ -0,0 +1,26 @@
+/*
+ * Interned strings for the host build
+ * The MP_QSTR_ names are collected from the sources by host/mp/makegen.py
+ */
+
+#ifndef HOST_MP_PY_QSTR_H
+#define HOST_MP_PY_QSTR_H
+
+#include <stddef.h>
+
+typedef size_t qstr;
+
+enum {
+    MP_QSTRnull,
+#define QDEF(id, str) id,
+#include "genhdr/qstrdefs.generated.h"
+#undef QDEF
+    MP_QSTRnumber_of,
+};
+
+const char *qstr_str(qstr q);
+
+// MP_QSTRnull when the string is not interned
+qstr qstr_find_strn(const char *str, size_t len);
+
+#endif // HOST_MP_PY_QSTR_H
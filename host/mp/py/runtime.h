@@ -0,0 +1,33 @@
+/*
+ * MicroPython runtime for the host build
+ */
+
+#ifndef HOST_MP_PY_RUNTIME_H
+#define HOST_MP_PY_RUNTIME_H
+
+#include "py/obj.h"
+#include "py/mpstate.h"
+#include "py/nlr.h"
+
+void mp_arg_check_num(size_t n_args, size_t n_kw, size_t n_args_min, size_t n_args_max, bool takes_kw);
+
+mp_obj_t mp_call_function_0(mp_obj_t fun);
+mp_obj_t mp_call_function_1(mp_obj_t fun, mp_obj_t arg);
+mp_obj_t mp_call_function_n_kw(mp_obj_t fun, size_t n_args, size_t n_kw, const mp_obj_t *args);
+mp_obj_t mp_call_method_n_kw(size_t n_args, size_t n_kw, const mp_obj_t *args);
+void mp_load_method(mp_obj_t base, qstr attr, mp_obj_t *dest);
+void mp_load_method_maybe(mp_obj_t base, qstr attr, mp_obj_t *dest);
+mp_obj_t mp_load_attr(mp_obj_t base, qstr attr);
+
+// Scheduler, callable from interrupts and other threads
+bool mp_sched_schedule(mp_obj_t function, mp_obj_t arg);
+void mp_handle_pending(bool raise_exc);
+
+mp_obj_t mp_obj_new_exception_msg(const mp_obj_type_t *exc_type, const char *msg);
+__attribute__((noreturn)) void nlr_raise(mp_obj_t exc);
+__attribute__((noreturn)) void mp_raise_msg(const mp_obj_type_t *exc_type, const char *msg);
+__attribute__((noreturn)) void mp_raise_ValueError(const char *msg);
+__attribute__((noreturn)) void mp_raise_TypeError(const char *msg);
+__attribute__((noreturn)) void mp_raise_OSError(int errno_);
+
+#endif // HOST_MP_PY_RUNTIME_H
@@ -0,0 +1,28 @@
+/*
+ * Stream protocol for the host build
+ */
+
+#ifndef HOST_MP_PY_STREAM_H
+#define HOST_MP_PY_STREAM_H
+
+#include "py/obj.h"
+
+#define MP_STREAM_ERROR         ((mp_uint_t)-1)
+#define MP_STREAM_RW_READ       (0)
+#define MP_STREAM_RW_WRITE      (2)
+#define MP_STREAM_RW_ONCE       (1)
+
+typedef struct _mp_stream_p_t {
+    mp_uint_t (*read)(mp_obj_t obj, void *buf, mp_uint_t size, int *errcode);
+    mp_uint_t (*write)(mp_obj_t obj, const void *buf, mp_uint_t size, int *errcode);
+    mp_uint_t (*ioctl)(mp_obj_t obj, mp_uint_t request, uintptr_t arg, int *errcode);
+    mp_uint_t is_text : 1;
+} mp_stream_p_t;
+
+// Bytes transferred, MP_STREAM_ERROR with errcode set on failure
+mp_uint_t mp_stream_rw(mp_obj_t stream, void *buf, mp_uint_t size, int *errcode, uint8_t flags);
+
+// Number of bytes written, None when the stream would block. Raises OSError
+mp_obj_t mp_stream_write(mp_obj_t self_in, const void *buf, size_t len, uint8_t flags);
+
+#endif // HOST_MP_PY_STREAM_H
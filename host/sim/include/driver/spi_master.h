@@ -0,0 +1,56 @@
+/*
+ * SPI master bus, host build: only the bus setup, the transfers go through
+ * the LCD panel IO
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    SPI1_HOST = 0,
+    SPI2_HOST = 1,
+    SPI3_HOST = 2,
+    SPI_HOST_MAX,
+} spi_host_device_t;
+
+typedef enum {
+    SPI_DMA_DISABLED = 0,
+    SPI_DMA_CH_AUTO = 3,
+} spi_common_dma_t;
+
+#define SPICOMMON_BUSFLAG_SLAVE     0
+#define SPICOMMON_BUSFLAG_MASTER    (1 << 0)
+#define SPICOMMON_BUSFLAG_QUAD      (1 << 6)
+
+typedef struct {
+    union {
+        int mosi_io_num;
+        int data0_io_num;
+    };
+    union {
+        int miso_io_num;
+        int data1_io_num;
+    };
+    int sclk_io_num;
+    union {
+        int quadwp_io_num;
+        int data2_io_num;
+    };
+    union {
+        int quadhd_io_num;
+        int data3_io_num;
+    };
+    int data4_io_num;
+    int data5_io_num;
+    int data6_io_num;
+    int data7_io_num;
+    int max_transfer_sz;
+    uint32_t flags;
+    int isr_cpu_id;
+    int intr_flags;
+} spi_bus_config_t;
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_common_dma_t dma_chan);
+esp_err_t spi_bus_free(spi_host_device_t host_id);
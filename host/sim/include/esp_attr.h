@@ -0,0 +1,10 @@
+/*
+ * ESP-IDF memory placement attributes, host build: one memory, no sections
+ */
+
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define EXT_RAM_BSS_ATTR
@@ -0,0 +1,23 @@
+/*
+ * LCD panel device configuration, as in ESP-IDF
+ */
+
+#pragma once
+
+#include "esp_lcd_types.h"
+#include "esp_lcd_panel_io.h"
+
+typedef struct {
+    int reset_gpio_num;
+    union {
+        lcd_rgb_element_order_t color_space;
+        lcd_rgb_element_order_t rgb_endian;
+        lcd_rgb_element_order_t rgb_ele_order;
+    };
+    lcd_rgb_data_endian_t data_endian;
+    unsigned int bits_per_pixel;
+    struct {
+        unsigned int reset_active_high: 1;
+    } flags;
+    void *vendor_config;
+} esp_lcd_panel_dev_config_t;
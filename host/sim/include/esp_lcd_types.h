@@ -0,0 +1,24 @@
+/*
+ * LCD handle types, host build
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef struct esp_lcd_panel_io_t *esp_lcd_panel_io_handle_t;
+typedef struct esp_lcd_panel_t *esp_lcd_panel_handle_t;
+typedef int esp_lcd_spi_bus_handle_t;
+
+typedef enum {
+    LCD_RGB_ELEMENT_ORDER_RGB = 0,
+    LCD_RGB_ELEMENT_ORDER_BGR,
+} lcd_rgb_element_order_t;
+
+typedef enum {
+    LCD_RGB_DATA_ENDIAN_BIG = 0,
+    LCD_RGB_DATA_ENDIAN_LITTLE,
+} lcd_rgb_data_endian_t;
@@ -0,0 +1,9 @@
+/*
+ * ROM functions, host build: the busy wait sleeps on the virtual clock
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+void esp_rom_delay_us(uint32_t us);
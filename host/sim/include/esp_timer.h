@@ -0,0 +1,9 @@
+/*
+ * esp_timer, host build: reads the virtual clock
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time(void);
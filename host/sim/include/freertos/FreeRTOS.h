@@ -0,0 +1,48 @@
+/*
+ * FreeRTOS, host build: tasks are threads, ticks are on the virtual clock
+ * at the 100 Hz tick rate of the MicroPython ESP32 port
+ */
+
+#pragma once
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "esp_attr.h"
+#include "esp_err.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define configTICK_RATE_HZ      100
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define tskNO_AFFINITY          0x7FFFFFFF
+
+// Critical sections: one recursive lock per mux, interrupts are threads too
+typedef struct {
+    pthread_mutex_t mutex;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+
+#define portENTER_CRITICAL(mux)         pthread_mutex_lock(&(mux)->mutex)
+#define portEXIT_CRITICAL(mux)          pthread_mutex_unlock(&(mux)->mutex)
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+#define portENTER_CRITICAL_SAFE(mux)    portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_SAFE(mux)     portEXIT_CRITICAL(mux)
+#define taskENTER_CRITICAL(mux)         portENTER_CRITICAL(mux)
+#define taskEXIT_CRITICAL(mux)          portEXIT_CRITICAL(mux)
+
+#define portYIELD_FROM_ISR(...)         ((void)0)
+
+BaseType_t xPortGetCoreID(void);
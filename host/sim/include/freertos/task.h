@@ -0,0 +1,28 @@
+/*
+ * FreeRTOS tasks, host build
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct sim_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+    UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id);
+
+// NULL deletes the calling task, which does not return
+void vTaskDelete(TaskHandle_t task);
+
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+#define taskYIELD() sim_task_yield()
+void sim_task_yield(void);
+
+// Direct to task notifications, the counting semaphore form
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
@@ -0,0 +1,99 @@
+/*
+ * Test side of the ESP-IDF fakes: device models plug in here, and a test
+ * reads back what the modules did to the hardware
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "sim_clock.h"
+
+// Everything back to power-on: clock, pins, PWM, buses, heap sizes
+void sim_reset(void);
+
+// GPIO
+
+// Last level the module drove on an output, -1 if never driven
+int sim_gpio_output(int pin);
+
+// Drive an input: an edge that matches the pin's interrupt type runs the
+// handler on the calling thread
+void sim_gpio_drive(int pin, int level);
+
+// LEDC
+
+typedef struct {
+    bool configured;
+    int gpio_num;
+    uint32_t duty;          // now, with a running fade interpolated
+    uint32_t target;        // end of the running fade, or duty
+    uint64_t fade_end_us;   // 0 without a fade
+    uint32_t updates;       // duty changes and fades started
+} sim_ledc_channel_t;
+
+void sim_ledc_get(int channel, sim_ledc_channel_t *state);
+
+// I2C: a device answers at one 7-bit address. start() begins a transfer in
+// either direction, write() returns whether the byte is acked
+typedef struct sim_i2c_device {
+    uint8_t addr;
+    void *ctx;
+    void (*start)(void *ctx, bool read);
+    bool (*write)(void *ctx, uint8_t byte);
+    uint8_t (*read)(void *ctx);
+    void (*stop)(void *ctx);
+} sim_i2c_device_t;
+
+void sim_i2c_attach(int port, sim_i2c_device_t *device);
+void sim_i2c_detach(int port, sim_i2c_device_t *device);
+
+// Transactions run on the port, and how many failed (NACK or no driver)
+uint32_t sim_i2c_transactions(int port);
+uint32_t sim_i2c_failures(int port);
+
+// LCD panel IO: the panel model behind the bus. tx gets every parameter
+// write when it is sent and every color transfer when it is done; rx answers
+// a read, pclk_hz is the clock of the IO it came through
+typedef struct sim_lcd_panel {
+    void *ctx;
+    void (*tx)(void *ctx, uint32_t lcd_cmd, bool color, const void *data, size_t len);
+    esp_err_t (*rx)(void *ctx, uint32_t lcd_cmd, void *data, size_t len, unsigned int pclk_hz);
+} sim_lcd_panel_t;
+
+void sim_lcd_attach(sim_lcd_panel_t *panel);
+
+typedef struct {
+    uint32_t ios;           // panel IOs alive
+    bool bus_initialized;   // SPI2_HOST
+    uint32_t params;
+    uint32_t reads;
+    uint32_t colors_queued;
+    uint32_t colors_done;
+    uint64_t color_bytes;
+    uint64_t busy_us;       // bus time of the color transfers
+} sim_lcd_stats_t;
+
+void sim_lcd_get_stats(sim_lcd_stats_t *stats);
+
+// Block until the queued color transfers are done
+void sim_lcd_drain(void);
+
+// Stop the DMA: color transfers stay queued until released. Anything that
+// drains the queue (a parameter write, a read, deleting the IO) blocks meanwhile
+void sim_lcd_hold(bool hold);
+
+// Heap: the free size per capability reported by heap_caps, and over which
+// an allocation fails. Defaults: 300 KB internal, 8 MB PSRAM
+void sim_heap_set_free(uint32_t caps, size_t bytes);
+
+// The next n heap_caps allocations succeed, the one after fails. -1: never
+void sim_heap_fail_after(int n);
+
+// FreeRTOS tasks running
+uint32_t sim_task_count(void);
+
+#endif // SIM_H
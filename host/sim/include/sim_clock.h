@@ -0,0 +1,25 @@
+/*
+ * Virtual clock of the host build
+ *
+ * Microseconds since the start of the test. Time only moves when a thread
+ * sleeps or waits with a timeout, or when the simulated bus is busy, so a
+ * test runs as fast as the host can and a 120 ms panel delay costs nothing.
+ */
+
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+#include <stdint.h>
+
+// Back to 0, before anything else runs
+void sim_clock_init(void);
+
+uint64_t sim_clock_now(void);
+
+// Move the clock forward to t, no-op when it is already past
+void sim_clock_advance_to(uint64_t t);
+
+// Sleep: advance the clock by us and let the other threads run
+void sim_sleep_us(uint64_t us);
+
+#endif // SIM_CLOCK_H
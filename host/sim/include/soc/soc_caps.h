@@ -0,0 +1,8 @@
+/*
+ * SoC capabilities, host build: those of the ESP32-S3
+ */
+
+#pragma once
+
+#define SOC_LEDC_SUPPORT_FADE_STOP      1
+#define SOC_GPIO_PIN_COUNT              49
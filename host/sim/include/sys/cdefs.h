@@ -0,0 +1,12 @@
+/*
+ * The C library's sys/cdefs.h plus the __containerof newlib has
+ */
+
+#pragma once
+
+#include_next <sys/cdefs.h>
+#include <stddef.h>
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
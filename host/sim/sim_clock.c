@@ -0,0 +1,36 @@
+/*
+ * Virtual clock of the host build
+ */
+
+#include <sched.h>
+#include <time.h>
+#include <stdbool.h>
+#include "sim_clock.h"
+
+static uint64_t clock_us;
+
+void sim_clock_init(void) {
+    __atomic_store_n(&clock_us, 0, __ATOMIC_SEQ_CST);
+}
+
+uint64_t sim_clock_now(void) {
+    return __atomic_load_n(&clock_us, __ATOMIC_ACQUIRE);
+}
+
+void sim_clock_advance_to(uint64_t t) {
+    uint64_t now = sim_clock_now();
+    while (now < t && !__atomic_compare_exchange_n(&clock_us, &now, t, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+    }
+}
+
+void sim_sleep_us(uint64_t us) {
+    // vTaskDelay(0): a yield, as on FreeRTOS
+    if (us == 0) {
+        sched_yield();
+        return;
+    }
+    sim_clock_advance_to(sim_clock_now() + us);
+    // A short real sleep, for the threads waiting on the clock to catch up
+    struct timespec ts = { 0, 20 * 1000 };
+    nanosleep(&ts, NULL);
+}
@@ -0,0 +1,371 @@
+/*
+ * FreeRTOS on pthreads, host build
+ *
+ * Blocking calls wait on a condition variable in short real slices and move
+ * the virtual clock towards their timeout while nothing happens, so a
+ * timeout expires in about as much real time as it is long.
+ */
+
+#include <errno.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "sim.h"
+
+#define TICK_US             (1000000 / configTICK_RATE_HZ)
+#define WAIT_SLICE_US       100
+
+// Deadline on the virtual clock of a wait of ticks
+static uint64_t deadline_of(TickType_t ticks) {
+    return ticks == portMAX_DELAY ? UINT64_MAX : sim_clock_now() + (uint64_t)ticks * TICK_US;
+}
+
+// One slice of a wait: false once the deadline passed. Called with mutex held
+static bool wait_slice(pthread_cond_t *cond, pthread_mutex_t *mutex, uint64_t deadline) {
+    uint64_t now = sim_clock_now();
+    if (now >= deadline) {
+        return false;
+    }
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_nsec += WAIT_SLICE_US * 1000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    if (pthread_cond_timedwait(cond, mutex, &ts) == ETIMEDOUT && deadline != UINT64_MAX) {
+        uint64_t next = now + WAIT_SLICE_US;
+        sim_clock_advance_to(next < deadline ? next : deadline);
+    }
+    return true;
+}
+
+// Tasks
+
+struct sim_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    BaseType_t core;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t notify;
+};
+
+// The MicroPython task runs on core 1 of the ESP32-S3
+static struct sim_task main_task = {
+    .core = 1,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+static __thread struct sim_task *current_task;
+static uint32_t task_count;
+
+static struct sim_task *self_task(void) {
+    return current_task ? current_task : &main_task;
+}
+
+static void *task_entry(void *arg) {
+    struct sim_task *task = arg;
+    current_task = task;
+    task->fn(task->arg);
+    // A FreeRTOS task must not return
+    abort();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+    UBaseType_t priority, TaskHandle_t *created_task, BaseType_t core_id) {
+    struct sim_task *task = calloc(1, sizeof(*task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    task->fn = fn;
+    task->arg = arg;
+    task->core = core_id == tskNO_AFFINITY ? 0 : core_id;
+    pthread_mutex_init(&task->mutex, NULL);
+    pthread_cond_init(&task->cond, NULL);
+    if (created_task != NULL) {
+        *created_task = task;
+    }
+    __atomic_add_fetch(&task_count, 1, __ATOMIC_SEQ_CST);
+    if (pthread_create(&task->thread, NULL, task_entry, task) != 0) {
+        __atomic_sub_fetch(&task_count, 1, __ATOMIC_SEQ_CST);
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Only self-deletion: another thread cannot be stopped safely
+    if (task != NULL && task != current_task) {
+        abort();
+    }
+    task = self_task();
+    if (task == &main_task) {
+        abort();
+    }
+    current_task = NULL;
+    pthread_mutex_destroy(&task->mutex);
+    pthread_cond_destroy(&task->cond);
+    free(task);
+    __atomic_sub_fetch(&task_count, 1, __ATOMIC_SEQ_CST);
+    pthread_exit(NULL);
+}
+
+uint32_t sim_task_count(void) {
+    return __atomic_load_n(&task_count, __ATOMIC_SEQ_CST);
+}
+
+void vTaskDelay(TickType_t ticks) {
+    sim_sleep_us((uint64_t)ticks * TICK_US);
+}
+
+void sim_task_yield(void) {
+    sched_yield();
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(sim_clock_now() / TICK_US);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return self_task();
+}
+
+BaseType_t xPortGetCoreID(void) {
+    return self_task()->core;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks) {
+    struct sim_task *task = self_task();
+    uint64_t deadline = deadline_of(ticks);
+    pthread_mutex_lock(&task->mutex);
+    while (task->notify == 0 && wait_slice(&task->cond, &task->mutex, deadline)) {
+    }
+    uint32_t value = task->notify;
+    if (value != 0) {
+        task->notify = clear_on_exit ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->mutex);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->mutex);
+    task->notify++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->mutex);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    xTaskNotifyGive(task);
+    if (woken != NULL) {
+        *woken = pdTRUE;
+    }
+}
+
+// Queues
+
+struct sim_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+    uint8_t *items;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct sim_queue *queue = calloc(1, sizeof(*queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size ? item_size : 1);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    queue->length = length;
+    queue->item_size = item_size;
+    pthread_mutex_init(&queue->mutex, NULL);
+    pthread_cond_init(&queue->cond, NULL);
+    return queue;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->cond);
+    free(queue->items);
+    free(queue);
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    uint64_t deadline = deadline_of(ticks);
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == queue->length && wait_slice(&queue->cond, &queue->mutex, deadline)) {
+    }
+    if (queue->count == queue->length) {
+        pthread_mutex_unlock(&queue->mutex);
+        return pdFALSE;
+    }
+    UBaseType_t tail = (queue->head + queue->count) % queue->length;
+    memcpy(queue->items + tail * queue->item_size, item, queue->item_size);
+    queue->count++;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    return pdPASS;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return xQueueSend(queue, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks) {
+    uint64_t deadline = deadline_of(ticks);
+    pthread_mutex_lock(&queue->mutex);
+    while (queue->count == 0 && wait_slice(&queue->cond, &queue->mutex, deadline)) {
+    }
+    if (queue->count == 0) {
+        pthread_mutex_unlock(&queue->mutex);
+        return pdFALSE;
+    }
+    memcpy(item, queue->items + queue->head * queue->item_size, queue->item_size);
+    queue->head = (queue->head + 1) % queue->length;
+    queue->count--;
+    pthread_cond_broadcast(&queue->cond);
+    pthread_mutex_unlock(&queue->mutex);
+    return pdPASS;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->mutex);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+// Semaphores: binary and counting ones count, mutexes have an owner
+
+struct sim_semaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool is_mutex;
+    uint32_t count;
+    uint32_t max;
+    struct sim_task *owner;
+    uint32_t depth;
+};
+
+static struct sim_semaphore *semaphore_new(bool is_mutex) {
+    struct sim_semaphore *sem = calloc(1, sizeof(*sem));
+    if (sem == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&sem->mutex, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->is_mutex = is_mutex;
+    sem->max = 1;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return semaphore_new(false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return semaphore_new(true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return semaphore_new(true);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    pthread_mutex_destroy(&sem->mutex);
+    pthread_cond_destroy(&sem->cond);
+    free(sem);
+}
+
+static BaseType_t semaphore_take(SemaphoreHandle_t sem, TickType_t ticks, bool recursive) {
+    struct sim_task *self = self_task();
+    uint64_t deadline = deadline_of(ticks);
+    BaseType_t ret = pdFALSE;
+    pthread_mutex_lock(&sem->mutex);
+    if (sem->is_mutex) {
+        if (recursive && sem->owner == self) {
+            sem->depth++;
+            ret = pdTRUE;
+        } else {
+            while (sem->owner != NULL && wait_slice(&sem->cond, &sem->mutex, deadline)) {
+            }
+            if (sem->owner == NULL) {
+                sem->owner = self;
+                sem->depth = 1;
+                ret = pdTRUE;
+            }
+        }
+    } else {
+        while (sem->count == 0 && wait_slice(&sem->cond, &sem->mutex, deadline)) {
+        }
+        if (sem->count > 0) {
+            sem->count--;
+            ret = pdTRUE;
+        }
+    }
+    pthread_mutex_unlock(&sem->mutex);
+    return ret;
+}
+
+static BaseType_t semaphore_give(SemaphoreHandle_t sem) {
+    BaseType_t ret = pdFALSE;
+    pthread_mutex_lock(&sem->mutex);
+    if (sem->is_mutex) {
+        if (sem->owner == self_task()) {
+            if (--sem->depth == 0) {
+                sem->owner = NULL;
+            }
+            ret = pdTRUE;
+        }
+    } else if (sem->count < sem->max) {
+        sem->count++;
+        ret = pdTRUE;
+    }
+    pthread_cond_broadcast(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+    return ret;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    return semaphore_take(sem, ticks, false);
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    return semaphore_give(sem);
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken) {
+    if (woken != NULL) {
+        *woken = pdFALSE;
+    }
+    return semaphore_give(sem);
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    return semaphore_take(sem, ticks, true);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    return semaphore_give(sem);
+}
@@ -0,0 +1,281 @@
+/*
+ * Legacy I2C master driver, host build
+ *
+ * i2c_master_cmd_begin runs the queued operations against the attached
+ * device models. A byte takes 9 clocks on the virtual clock; an address
+ * nobody answers fails the whole command with ESP_FAIL, as a NACK does.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include "driver/i2c.h"
+#include "sim.h"
+
+#define MAX_DEVICES     8
+
+typedef enum {
+    OP_START,
+    OP_STOP,
+    OP_WRITE,
+    OP_READ,
+} op_kind_t;
+
+typedef struct {
+    op_kind_t kind;
+    uint8_t *data;          // OP_WRITE: a copy, OP_READ: the caller's buffer
+    size_t len;
+    bool ack_check;
+} i2c_op_t;
+
+struct sim_i2c_cmd {
+    i2c_op_t *ops;
+    size_t count;
+    size_t alloc;
+};
+
+typedef struct {
+    bool configured;
+    bool installed;
+    uint32_t clk_hz;
+    sim_i2c_device_t *devices[MAX_DEVICES];
+    uint32_t transactions;
+    uint32_t failures;
+} i2c_bus_t;
+
+static i2c_bus_t buses[I2C_NUM_MAX];
+static pthread_mutex_t i2c_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX || i2c_conf->mode != I2C_MODE_MASTER || i2c_conf->master.clk_speed == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&i2c_mutex);
+    buses[i2c_num].configured = true;
+    buses[i2c_num].clk_hz = i2c_conf->master.clk_speed;
+    pthread_mutex_unlock(&i2c_mutex);
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t mode, size_t slv_rx_buf_len, size_t slv_tx_buf_len, int intr_alloc_flags) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&i2c_mutex);
+    // Installing twice fails, as in the IDF
+    esp_err_t ret = buses[i2c_num].installed ? ESP_FAIL : ESP_OK;
+    buses[i2c_num].installed = true;
+    pthread_mutex_unlock(&i2c_mutex);
+    return ret;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&i2c_mutex);
+    buses[i2c_num].installed = false;
+    pthread_mutex_unlock(&i2c_mutex);
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+    return calloc(1, sizeof(struct sim_i2c_cmd));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle) {
+    if (cmd_handle == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < cmd_handle->count; i++) {
+        if (cmd_handle->ops[i].kind == OP_WRITE) {
+            free(cmd_handle->ops[i].data);
+        }
+    }
+    free(cmd_handle->ops);
+    free(cmd_handle);
+}
+
+static esp_err_t add_op(i2c_cmd_handle_t cmd, op_kind_t kind, uint8_t *data, size_t len, bool ack_check) {
+    if (cmd == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (cmd->count == cmd->alloc) {
+        size_t alloc = cmd->alloc ? cmd->alloc * 2 : 8;
+        i2c_op_t *ops = realloc(cmd->ops, alloc * sizeof(i2c_op_t));
+        if (ops == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        cmd->ops = ops;
+        cmd->alloc = alloc;
+    }
+    cmd->ops[cmd->count++] = (i2c_op_t) { kind, data, len, ack_check };
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle) {
+    return add_op(cmd_handle, OP_START, NULL, 0, false);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle) {
+    return add_op(cmd_handle, OP_STOP, NULL, 0, false);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t *data, size_t data_len, bool ack_en) {
+    uint8_t *copy = malloc(data_len ? data_len : 1);
+    if (copy == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(copy, data, data_len);
+    esp_err_t ret = add_op(cmd_handle, OP_WRITE, copy, data_len, ack_en);
+    if (ret != ESP_OK) {
+        free(copy);
+    }
+    return ret;
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en) {
+    return i2c_master_write(cmd_handle, &data, 1, ack_en);
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, i2c_ack_type_t ack) {
+    if (data_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return add_op(cmd_handle, OP_READ, data, data_len, false);
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t *data, i2c_ack_type_t ack) {
+    return i2c_master_read(cmd_handle, data, 1, ack);
+}
+
+static sim_i2c_device_t *find_device(i2c_bus_t *bus, uint8_t addr) {
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        if (bus->devices[i] != NULL && bus->devices[i]->addr == addr) {
+            return bus->devices[i];
+        }
+    }
+    return NULL;
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t ticks_to_wait) {
+    if (i2c_num < 0 || i2c_num >= I2C_NUM_MAX || cmd_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&i2c_mutex);
+    i2c_bus_t *bus = &buses[i2c_num];
+    if (!bus->installed) {
+        pthread_mutex_unlock(&i2c_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    bus->transactions++;
+
+    esp_err_t ret = ESP_OK;
+    sim_i2c_device_t *device = NULL;
+    bool addressed = false;     // the next written byte is an address
+    bool reading = false;
+    size_t bytes = 0;
+    for (size_t i = 0; i < cmd_handle->count && ret == ESP_OK; i++) {
+        i2c_op_t *op = &cmd_handle->ops[i];
+        switch (op->kind) {
+            case OP_START:
+                addressed = true;
+                break;
+            case OP_STOP:
+                if (device != NULL && device->stop != NULL) {
+                    device->stop(device->ctx);
+                }
+                device = NULL;
+                break;
+            case OP_WRITE:
+                for (size_t j = 0; j < op->len && ret == ESP_OK; j++) {
+                    bytes++;
+                    if (addressed) {
+                        addressed = false;
+                        device = find_device(bus, op->data[j] >> 1);
+                        reading = op->data[j] & 1;
+                        if (device == NULL) {
+                            ret = ESP_FAIL;
+                        } else if (device->start != NULL) {
+                            device->start(device->ctx, reading);
+                        }
+                    } else if (device == NULL || reading) {
+                        ret = ESP_FAIL;
+                    } else if (!device->write(device->ctx, op->data[j]) && op->ack_check) {
+                        ret = ESP_FAIL;
+                    }
+                }
+                break;
+            case OP_READ:
+                if (device == NULL || !reading) {
+                    ret = ESP_FAIL;
+                    break;
+                }
+                for (size_t j = 0; j < op->len; j++) {
+                    op->data[j] = device->read(device->ctx);
+                    bytes++;
+                }
+                break;
+        }
+    }
+    if (ret != ESP_OK) {
+        bus->failures++;
+        if (device != NULL && device->stop != NULL) {
+            device->stop(device->ctx);
+        }
+    }
+    uint32_t clk_hz = bus->clk_hz ? bus->clk_hz : 100000;
+    pthread_mutex_unlock(&i2c_mutex);
+
+    // Nine clocks a byte with the ack
+    sim_clock_advance_to(sim_clock_now() + bytes * 9 * 1000000ULL / clk_hz);
+    return ret;
+}
+
+void sim_i2c_attach(int port, sim_i2c_device_t *device) {
+    pthread_mutex_lock(&i2c_mutex);
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        if (buses[port].devices[i] == NULL) {
+            buses[port].devices[i] = device;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&i2c_mutex);
+}
+
+void sim_i2c_detach(int port, sim_i2c_device_t *device) {
+    pthread_mutex_lock(&i2c_mutex);
+    for (int i = 0; i < MAX_DEVICES; i++) {
+        if (buses[port].devices[i] == device) {
+            buses[port].devices[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&i2c_mutex);
+}
+
+uint32_t sim_i2c_transactions(int port) {
+    pthread_mutex_lock(&i2c_mutex);
+    uint32_t n = buses[port].transactions;
+    pthread_mutex_unlock(&i2c_mutex);
+    return n;
+}
+
+uint32_t sim_i2c_failures(int port) {
+    pthread_mutex_lock(&i2c_mutex);
+    uint32_t n = buses[port].failures;
+    pthread_mutex_unlock(&i2c_mutex);
+    return n;
+}
+
+// Devices stay attached, they are part of the board
+void sim_i2c_reset(void) {
+    pthread_mutex_lock(&i2c_mutex);
+    for (int port = 0; port < I2C_NUM_MAX; port++) {
+        buses[port].configured = false;
+        buses[port].installed = false;
+        buses[port].clk_hz = 0;
+        buses[port].transactions = 0;
+        buses[port].failures = 0;
+    }
+    pthread_mutex_unlock(&i2c_mutex);
+}
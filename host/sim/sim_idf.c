@@ -0,0 +1,501 @@
+/*
+ * ESP-IDF fakes, host build: errors, logging, esp_timer, ROM delay, heap_caps,
+ * GPIO, LEDC and the SPI bus
+ */
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "esp_heap_caps.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "driver/spi_master.h"
+#include "soc/soc_caps.h"
+#include "sim.h"
+
+// The IRAM bounds from the linker script, the modules check code addresses against them
+int _iram_text_start;
+int _iram_text_end;
+
+static pthread_mutex_t idf_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Errors and logging
+
+const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK: return "ESP_OK";
+        case ESP_FAIL: return "ESP_FAIL";
+        case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE: return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND: return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+        default: return "UNKNOWN ERROR";
+    }
+}
+
+void _esp_error_check_failed(esp_err_t rc, const char *file, int line, const char *function, const char *expression) {
+    fprintf(stderr, "ESP_ERROR_CHECK failed: esp_err_t 0x%x (%s) at %s:%d in %s\nexpression: %s\n",
+        rc, esp_err_to_name(rc), file, line, function, expression);
+    abort();
+}
+
+void sim_log(char level, const char *tag, const char *format, ...) {
+    if (level != 'E' && level != 'W' && getenv("SIM_LOG_VERBOSE") == NULL) {
+        return;
+    }
+    va_list ap;
+    va_start(ap, format);
+    fprintf(stderr, "%c (%llu) %s: ", level, (unsigned long long)(sim_clock_now() / 1000), tag);
+    vfprintf(stderr, format, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+// esp_timer
+
+int64_t esp_timer_get_time(void) {
+    return (int64_t)sim_clock_now();
+}
+
+// ROM
+
+void esp_rom_delay_us(uint32_t us) {
+    sim_sleep_us(us);
+}
+
+// heap_caps
+
+#define HEAP_INTERNAL_FREE  (300 * 1024)
+#define HEAP_SPIRAM_FREE    (8 * 1024 * 1024)
+
+static size_t heap_internal_free = HEAP_INTERNAL_FREE;
+static size_t heap_spiram_free = HEAP_SPIRAM_FREE;
+static int heap_fail_after = -1;
+
+static size_t heap_free_of(uint32_t caps) {
+    return (caps & MALLOC_CAP_SPIRAM) ? heap_spiram_free : heap_internal_free;
+}
+
+void sim_heap_set_free(uint32_t caps, size_t bytes) {
+    pthread_mutex_lock(&idf_mutex);
+    if (caps & MALLOC_CAP_SPIRAM) {
+        heap_spiram_free = bytes;
+    } else {
+        heap_internal_free = bytes;
+    }
+    pthread_mutex_unlock(&idf_mutex);
+}
+
+void sim_heap_fail_after(int n) {
+    pthread_mutex_lock(&idf_mutex);
+    heap_fail_after = n;
+    pthread_mutex_unlock(&idf_mutex);
+}
+
+static bool heap_allowed(size_t size, uint32_t caps) {
+    bool ok = true;
+    pthread_mutex_lock(&idf_mutex);
+    if (heap_fail_after == 0) {
+        ok = false;
+    } else if (heap_fail_after > 0) {
+        heap_fail_after--;
+    }
+    // DMA memory is internal memory
+    if ((caps & MALLOC_CAP_SPIRAM) && (caps & MALLOC_CAP_DMA)) {
+        ok = false;
+    }
+    if (size > heap_free_of(caps)) {
+        ok = false;
+    }
+    pthread_mutex_unlock(&idf_mutex);
+    return ok;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps) {
+    return heap_allowed(size, caps) ? malloc(size) : NULL;
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps) {
+    return heap_allowed(n * size, caps) ? calloc(n, size) : NULL;
+}
+
+void *heap_caps_realloc(void *ptr, size_t size, uint32_t caps) {
+    return heap_allowed(size, caps) ? realloc(ptr, size) : NULL;
+}
+
+void heap_caps_free(void *ptr) {
+    free(ptr);
+}
+
+void *heap_caps_malloc_prefer(size_t size, size_t num, ...) {
+    va_list ap;
+    void *ptr = NULL;
+    va_start(ap, num);
+    while (num-- > 0 && ptr == NULL) {
+        ptr = heap_caps_malloc(size, va_arg(ap, uint32_t));
+    }
+    va_end(ap);
+    return ptr;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps) {
+    pthread_mutex_lock(&idf_mutex);
+    size_t bytes = heap_free_of(caps);
+    pthread_mutex_unlock(&idf_mutex);
+    return bytes;
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps) {
+    return heap_caps_get_free_size(caps);
+}
+
+void heap_caps_get_info(multi_heap_info_t *info, uint32_t caps) {
+    memset(info, 0, sizeof(*info));
+    info->total_free_bytes = heap_caps_get_free_size(caps);
+    info->largest_free_block = info->total_free_bytes;
+    info->minimum_free_bytes = info->total_free_bytes;
+}
+
+// GPIO
+
+typedef struct {
+    gpio_mode_t mode;
+    gpio_int_type_t intr_type;
+    int output;
+    int input;
+    bool driven;            // by a model, a pull-up does not change the level
+    gpio_isr_t isr;
+    void *isr_arg;
+} sim_pin_t;
+
+static sim_pin_t pins[SOC_GPIO_PIN_COUNT];
+static bool isr_service;
+
+esp_err_t gpio_config(const gpio_config_t *config) {
+    if (config->pin_bit_mask >> SOC_GPIO_PIN_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    for (int pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++) {
+        if (config->pin_bit_mask & (1ULL << pin)) {
+            pins[pin].mode = config->mode;
+            pins[pin].intr_type = config->intr_type;
+            if (config->pull_up_en && !pins[pin].driven) {
+                pins[pin].input = 1;
+            }
+        }
+    }
+    pthread_mutex_unlock(&idf_mutex);
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= SOC_GPIO_PIN_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    sim_pin_t *p = &pins[gpio_num];
+    *p = (sim_pin_t) { .output = -1, .input = p->driven ? p->input : 1, .driven = p->driven };
+    pthread_mutex_unlock(&idf_mutex);
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level) {
+    if (gpio_num < 0 || gpio_num >= SOC_GPIO_PIN_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    pins[gpio_num].output = level ? 1 : 0;
+    pthread_mutex_unlock(&idf_mutex);
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num) {
+    if (gpio_num < 0 || gpio_num >= SOC_GPIO_PIN_COUNT) {
+        return 0;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    int level = (pins[gpio_num].mode & GPIO_MODE_OUTPUT) ? pins[gpio_num].output : pins[gpio_num].input;
+    pthread_mutex_unlock(&idf_mutex);
+    return level;
+}
+
+esp_err_t gpio_install_isr_service(int intr_alloc_flags) {
+    pthread_mutex_lock(&idf_mutex);
+    esp_err_t ret = isr_service ? ESP_ERR_INVALID_STATE : ESP_OK;
+    isr_service = true;
+    pthread_mutex_unlock(&idf_mutex);
+    return ret;
+}
+
+void gpio_uninstall_isr_service(void) {
+    pthread_mutex_lock(&idf_mutex);
+    isr_service = false;
+    pthread_mutex_unlock(&idf_mutex);
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio_num, gpio_isr_t isr_handler, void *args) {
+    if (gpio_num < 0 || gpio_num >= SOC_GPIO_PIN_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    esp_err_t ret = isr_service ? ESP_OK : ESP_ERR_INVALID_STATE;
+    if (ret == ESP_OK) {
+        pins[gpio_num].isr = isr_handler;
+        pins[gpio_num].isr_arg = args;
+    }
+    pthread_mutex_unlock(&idf_mutex);
+    return ret;
+}
+
+esp_err_t gpio_isr_handler_remove(gpio_num_t gpio_num) {
+    return gpio_isr_handler_add(gpio_num, NULL, NULL);
+}
+
+int sim_gpio_output(int pin) {
+    pthread_mutex_lock(&idf_mutex);
+    int level = pins[pin].output;
+    pthread_mutex_unlock(&idf_mutex);
+    return level;
+}
+
+void sim_gpio_drive(int pin, int level) {
+    pthread_mutex_lock(&idf_mutex);
+    sim_pin_t *p = &pins[pin];
+    int old = p->input;
+    p->input = level ? 1 : 0;
+    p->driven = true;
+    bool fire = false;
+    if (p->isr != NULL && isr_service && old != p->input) {
+        fire = p->intr_type == GPIO_INTR_ANYEDGE ||
+            (p->intr_type == GPIO_INTR_NEGEDGE && !p->input) ||
+            (p->intr_type == GPIO_INTR_POSEDGE && p->input);
+    }
+    gpio_isr_t isr = p->isr;
+    void *arg = p->isr_arg;
+    pthread_mutex_unlock(&idf_mutex);
+    if (fire) {
+        isr(arg);
+    }
+}
+
+// LEDC
+
+typedef struct {
+    bool configured;
+    int gpio_num;
+    uint32_t duty;
+    uint32_t fade_from;
+    uint32_t fade_to;
+    uint64_t fade_start_us;
+    uint64_t fade_end_us;
+    uint32_t updates;
+} sim_ledc_t;
+
+static sim_ledc_t ledc[LEDC_CHANNEL_MAX];
+static bool ledc_timer_ready;
+static bool ledc_fade_installed;
+
+// Duty now, a finished fade is folded into duty. Called with idf_mutex held
+static uint32_t ledc_duty_now(sim_ledc_t *ch) {
+    if (ch->fade_end_us == 0) {
+        return ch->duty;
+    }
+    uint64_t now = sim_clock_now();
+    if (now >= ch->fade_end_us) {
+        ch->duty = ch->fade_to;
+        ch->fade_end_us = 0;
+        return ch->duty;
+    }
+    int64_t span = (int64_t)ch->fade_to - (int64_t)ch->fade_from;
+    uint64_t elapsed = now - ch->fade_start_us;
+    uint64_t total = ch->fade_end_us - ch->fade_start_us;
+    return (uint32_t)((int64_t)ch->fade_from + span * (int64_t)elapsed / (int64_t)total);
+}
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t *timer_conf) {
+    if (timer_conf->speed_mode >= LEDC_SPEED_MODE_MAX || timer_conf->timer_num >= LEDC_TIMER_MAX ||
+        timer_conf->duty_resolution < 1 || timer_conf->duty_resolution > 14) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    ledc_timer_ready = true;
+    pthread_mutex_unlock(&idf_mutex);
+    return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t *ledc_conf) {
+    if (ledc_conf->channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    sim_ledc_t *ch = &ledc[ledc_conf->channel];
+    ch->configured = ledc_timer_ready;
+    ch->gpio_num = ledc_conf->gpio_num;
+    ch->duty = ledc_conf->duty;
+    ch->fade_end_us = 0;
+    ch->updates++;
+    esp_err_t ret = ledc_timer_ready ? ESP_OK : ESP_ERR_INVALID_STATE;
+    pthread_mutex_unlock(&idf_mutex);
+    return ret;
+}
+
+esp_err_t ledc_set_duty(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty) {
+    return ledc_set_duty_and_update(speed_mode, channel, duty, 0);
+}
+
+esp_err_t ledc_update_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    pthread_mutex_lock(&idf_mutex);
+    uint32_t duty = ledc_duty_now(&ledc[channel]);
+    pthread_mutex_unlock(&idf_mutex);
+    return duty;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+    pthread_mutex_lock(&idf_mutex);
+    esp_err_t ret = ledc_fade_installed ? ESP_ERR_INVALID_STATE : ESP_OK;
+    ledc_fade_installed = true;
+    pthread_mutex_unlock(&idf_mutex);
+    return ret;
+}
+
+void ledc_fade_func_uninstall(void) {
+    pthread_mutex_lock(&idf_mutex);
+    ledc_fade_installed = false;
+    pthread_mutex_unlock(&idf_mutex);
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t speed_mode, ledc_channel_t channel) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    esp_err_t ret = ledc_fade_installed ? ESP_OK : ESP_ERR_INVALID_STATE;
+    sim_ledc_t *ch = &ledc[channel];
+    ch->duty = ledc_duty_now(ch);
+    ch->fade_end_us = 0;
+    pthread_mutex_unlock(&idf_mutex);
+    return ret;
+}
+
+esp_err_t ledc_set_duty_and_update(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t duty, uint32_t hpoint) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    sim_ledc_t *ch = &ledc[channel];
+    ch->duty = duty;
+    ch->fade_end_us = 0;
+    ch->updates++;
+    pthread_mutex_unlock(&idf_mutex);
+    return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t speed_mode, ledc_channel_t channel, uint32_t target_duty, uint32_t max_fade_time_ms, ledc_fade_mode_t fade_mode) {
+    if (channel >= LEDC_CHANNEL_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    if (!ledc_fade_installed) {
+        pthread_mutex_unlock(&idf_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    sim_ledc_t *ch = &ledc[channel];
+    ch->fade_from = ledc_duty_now(ch);
+    ch->duty = ch->fade_from;
+    ch->fade_to = target_duty;
+    ch->fade_start_us = sim_clock_now();
+    ch->fade_end_us = max_fade_time_ms ? ch->fade_start_us + (uint64_t)max_fade_time_ms * 1000 : 0;
+    if (ch->fade_end_us == 0) {
+        ch->duty = target_duty;
+    }
+    ch->updates++;
+    uint64_t end = ch->fade_end_us;
+    pthread_mutex_unlock(&idf_mutex);
+    if (fade_mode == LEDC_FADE_WAIT_DONE && end != 0) {
+        sim_sleep_us(end - sim_clock_now());
+    }
+    return ESP_OK;
+}
+
+void sim_ledc_get(int channel, sim_ledc_channel_t *state) {
+    pthread_mutex_lock(&idf_mutex);
+    sim_ledc_t *ch = &ledc[channel];
+    state->configured = ch->configured;
+    state->gpio_num = ch->gpio_num;
+    state->duty = ledc_duty_now(ch);
+    state->target = ch->fade_end_us ? ch->fade_to : state->duty;
+    state->fade_end_us = ch->fade_end_us;
+    state->updates = ch->updates;
+    pthread_mutex_unlock(&idf_mutex);
+}
+
+// SPI bus
+
+static bool spi_bus_ready[SPI_HOST_MAX];
+
+esp_err_t spi_bus_initialize(spi_host_device_t host_id, const spi_bus_config_t *bus_config, spi_common_dma_t dma_chan) {
+    if (host_id <= SPI1_HOST || host_id >= SPI_HOST_MAX || bus_config->max_transfer_sz <= 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    esp_err_t ret = spi_bus_ready[host_id] ? ESP_ERR_INVALID_STATE : ESP_OK;
+    spi_bus_ready[host_id] = true;
+    pthread_mutex_unlock(&idf_mutex);
+    return ret;
+}
+
+esp_err_t spi_bus_free(spi_host_device_t host_id) {
+    if (host_id <= SPI1_HOST || host_id >= SPI_HOST_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&idf_mutex);
+    esp_err_t ret = spi_bus_ready[host_id] ? ESP_OK : ESP_ERR_INVALID_STATE;
+    spi_bus_ready[host_id] = false;
+    pthread_mutex_unlock(&idf_mutex);
+    return ret;
+}
+
+bool sim_spi_bus_ready(int host_id) {
+    pthread_mutex_lock(&idf_mutex);
+    bool ready = spi_bus_ready[host_id];
+    pthread_mutex_unlock(&idf_mutex);
+    return ready;
+}
+
+// Power-on
+
+void sim_i2c_reset(void);
+void sim_lcd_reset(void);
+
+void sim_reset(void) {
+    sim_lcd_reset();
+    sim_i2c_reset();
+    pthread_mutex_lock(&idf_mutex);
+    heap_internal_free = HEAP_INTERNAL_FREE;
+    heap_spiram_free = HEAP_SPIRAM_FREE;
+    heap_fail_after = -1;
+    for (int pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++) {
+        pins[pin] = (sim_pin_t) { .output = -1, .input = 1 };
+    }
+    isr_service = false;
+    memset(ledc, 0, sizeof(ledc));
+    ledc_timer_ready = false;
+    ledc_fade_installed = false;
+    memset(spi_bus_ready, 0, sizeof(spi_bus_ready));
+    pthread_mutex_unlock(&idf_mutex);
+    sim_clock_init();
+}
@@ -0,0 +1,323 @@
+/*
+ * LCD panel IO over SPI and the panel operations, host build
+ *
+ * Each panel IO has a DMA thread. tx_color queues the buffer pointer, as the
+ * IDF driver does; the thread finishes transfers in order at their end time
+ * on the virtual clock (the bytes over four data lines at pclk_hz), hands
+ * the buffer as it is then to the panel model and calls on_color_trans_done
+ * from the thread, like the SPI interrupt. Parameters and reads wait for the
+ * queue to drain first.
+ */
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_lcd_panel_io.h"
+#include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_interface.h"
+#include "driver/spi_master.h"
+#include "sim.h"
+
+bool sim_spi_bus_ready(int host_id);
+
+typedef struct {
+    uint32_t lcd_cmd;
+    const void *data;
+    size_t len;
+    uint64_t done_us;
+} color_trans_t;
+
+struct esp_lcd_panel_io_t {
+    struct esp_lcd_panel_io_t *next;
+    esp_lcd_panel_io_spi_config_t config;
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    color_trans_t *queue;
+    size_t depth;
+    size_t head;
+    size_t count;           // queued, including the one being finished
+    uint64_t bus_free_us;   // end of the last queued transfer
+    bool stop;
+};
+
+static pthread_mutex_t lcd_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct esp_lcd_panel_io_t *ios;
+static sim_lcd_panel_t *attached_panel;
+static sim_lcd_stats_t stats;
+static bool held;
+
+// Bus time of len bytes on the four data lines
+static uint64_t quad_us(const struct esp_lcd_panel_io_t *io, size_t len) {
+    unsigned int hz = io->config.pclk_hz ? io->config.pclk_hz : 1;
+    return ((uint64_t)len * 2 * 1000000 + hz - 1) / hz;
+}
+
+static sim_lcd_panel_t *panel_of(void) {
+    pthread_mutex_lock(&lcd_mutex);
+    sim_lcd_panel_t *panel = attached_panel;
+    pthread_mutex_unlock(&lcd_mutex);
+    return panel;
+}
+
+static void *dma_thread(void *arg) {
+    struct esp_lcd_panel_io_t *io = arg;
+    pthread_mutex_lock(&io->mutex);
+    for (;;) {
+        while ((io->count == 0 || __atomic_load_n(&held, __ATOMIC_ACQUIRE)) && !io->stop) {
+            pthread_cond_wait(&io->cond, &io->mutex);
+        }
+        if (io->count == 0) {
+            break;
+        }
+        color_trans_t trans = io->queue[io->head];
+        pthread_mutex_unlock(&io->mutex);
+
+        // The bus is busy until the transfer is out, time goes on without the CPU
+        struct timespec ts = { 0, 20 * 1000 };
+        nanosleep(&ts, NULL);
+        sim_clock_advance_to(trans.done_us);
+
+        sim_lcd_panel_t *panel = panel_of();
+        if (panel != NULL && panel->tx != NULL) {
+            panel->tx(panel->ctx, trans.lcd_cmd, true, trans.data, trans.len);
+        }
+        pthread_mutex_lock(&lcd_mutex);
+        stats.colors_done++;
+        pthread_mutex_unlock(&lcd_mutex);
+        if (io->config.on_color_trans_done != NULL) {
+            esp_lcd_panel_io_event_data_t edata;
+            io->config.on_color_trans_done(io, &edata, io->config.user_ctx);
+        }
+
+        pthread_mutex_lock(&io->mutex);
+        io->head = (io->head + 1) % io->depth;
+        io->count--;
+        pthread_cond_broadcast(&io->cond);
+    }
+    pthread_mutex_unlock(&io->mutex);
+    return NULL;
+}
+
+esp_err_t esp_lcd_new_panel_io_spi(esp_lcd_spi_bus_handle_t bus, const esp_lcd_panel_io_spi_config_t *io_config, esp_lcd_panel_io_handle_t *ret_io) {
+    if (io_config == NULL || ret_io == NULL || io_config->pclk_hz == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!sim_spi_bus_ready(bus)) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    struct esp_lcd_panel_io_t *io = calloc(1, sizeof(*io));
+    if (io == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    io->config = *io_config;
+    io->depth = io_config->trans_queue_depth ? io_config->trans_queue_depth : 1;
+    io->queue = calloc(io->depth, sizeof(color_trans_t));
+    if (io->queue == NULL) {
+        free(io);
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_init(&io->mutex, NULL);
+    pthread_cond_init(&io->cond, NULL);
+    if (pthread_create(&io->thread, NULL, dma_thread, io) != 0) {
+        free(io->queue);
+        free(io);
+        return ESP_ERR_NO_MEM;
+    }
+    pthread_mutex_lock(&lcd_mutex);
+    io->next = ios;
+    ios = io;
+    stats.ios++;
+    pthread_mutex_unlock(&lcd_mutex);
+    *ret_io = io;
+    return ESP_OK;
+}
+
+static void io_drain(struct esp_lcd_panel_io_t *io) {
+    pthread_mutex_lock(&io->mutex);
+    while (io->count > 0) {
+        pthread_cond_wait(&io->cond, &io->mutex);
+    }
+    pthread_mutex_unlock(&io->mutex);
+}
+
+esp_err_t esp_lcd_panel_io_del(esp_lcd_panel_io_handle_t io) {
+    if (io == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    io_drain(io);
+    pthread_mutex_lock(&io->mutex);
+    io->stop = true;
+    pthread_cond_broadcast(&io->cond);
+    pthread_mutex_unlock(&io->mutex);
+    pthread_join(io->thread, NULL);
+
+    pthread_mutex_lock(&lcd_mutex);
+    for (struct esp_lcd_panel_io_t **p = &ios; *p != NULL; p = &(*p)->next) {
+        if (*p == io) {
+            *p = io->next;
+            break;
+        }
+    }
+    stats.ios--;
+    pthread_mutex_unlock(&lcd_mutex);
+    pthread_mutex_destroy(&io->mutex);
+    pthread_cond_destroy(&io->cond);
+    free(io->queue);
+    free(io);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_register_event_callbacks(esp_lcd_panel_io_handle_t io, const esp_lcd_panel_io_callbacks_t *cbs, void *user_ctx) {
+    if (io == NULL || cbs == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    io_drain(io);
+    io->config.on_color_trans_done = cbs->on_color_trans_done;
+    io->config.user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_tx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size) {
+    if (io == NULL || (param_size > 0 && param == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    io_drain(io);
+    sim_lcd_panel_t *panel = panel_of();
+    if (panel != NULL && panel->tx != NULL) {
+        panel->tx(panel->ctx, (uint32_t)lcd_cmd, false, param, param_size);
+    }
+    pthread_mutex_lock(&lcd_mutex);
+    stats.params++;
+    pthread_mutex_unlock(&lcd_mutex);
+    // Command word and parameters on one data line. Blocking, no other thread
+    // waits for it: only the clock moves
+    sim_clock_advance_to(sim_clock_now() + quad_us(io, 4 + param_size) * 4);
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_panel_io_rx_param(esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size) {
+    if (io == NULL || param == NULL || param_size == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    io_drain(io);
+    esp_err_t ret = ESP_OK;
+    memset(param, 0, param_size);
+    sim_lcd_panel_t *panel = panel_of();
+    if (panel != NULL && panel->rx != NULL) {
+        ret = panel->rx(panel->ctx, (uint32_t)lcd_cmd, param, param_size, io->config.pclk_hz);
+    }
+    pthread_mutex_lock(&lcd_mutex);
+    stats.reads++;
+    pthread_mutex_unlock(&lcd_mutex);
+    sim_clock_advance_to(sim_clock_now() + quad_us(io, 4 + param_size) * 4);
+    return ret;
+}
+
+esp_err_t esp_lcd_panel_io_tx_color(esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *color, size_t color_size) {
+    if (io == NULL || (color_size > 0 && color == NULL)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&io->mutex);
+    while (io->count == io->depth) {
+        pthread_cond_wait(&io->cond, &io->mutex);
+    }
+    uint64_t now = sim_clock_now();
+    uint64_t start = io->bus_free_us > now ? io->bus_free_us : now;
+    uint64_t us = quad_us(io, color_size) + 1;
+    io->bus_free_us = start + us;
+    io->queue[(io->head + io->count) % io->depth] = (color_trans_t) {
+        (uint32_t)lcd_cmd, color, color_size, io->bus_free_us,
+    };
+    io->count++;
+    pthread_cond_broadcast(&io->cond);
+    pthread_mutex_unlock(&io->mutex);
+
+    pthread_mutex_lock(&lcd_mutex);
+    stats.colors_queued++;
+    stats.color_bytes += color_size;
+    stats.busy_us += us;
+    pthread_mutex_unlock(&lcd_mutex);
+    return ESP_OK;
+}
+
+void sim_lcd_attach(sim_lcd_panel_t *panel) {
+    pthread_mutex_lock(&lcd_mutex);
+    attached_panel = panel;
+    pthread_mutex_unlock(&lcd_mutex);
+}
+
+void sim_lcd_get_stats(sim_lcd_stats_t *out) {
+    pthread_mutex_lock(&lcd_mutex);
+    *out = stats;
+    pthread_mutex_unlock(&lcd_mutex);
+    out->bus_initialized = sim_spi_bus_ready(SPI2_HOST);
+}
+
+void sim_lcd_drain(void) {
+    pthread_mutex_lock(&lcd_mutex);
+    struct esp_lcd_panel_io_t *io = ios;
+    pthread_mutex_unlock(&lcd_mutex);
+    for (; io != NULL; io = io->next) {
+        io_drain(io);
+    }
+}
+
+void sim_lcd_hold(bool hold) {
+    pthread_mutex_lock(&lcd_mutex);
+    __atomic_store_n(&held, hold, __ATOMIC_RELEASE);
+    for (struct esp_lcd_panel_io_t *io = ios; io != NULL; io = io->next) {
+        pthread_mutex_lock(&io->mutex);
+        pthread_cond_broadcast(&io->cond);
+        pthread_mutex_unlock(&io->mutex);
+    }
+    pthread_mutex_unlock(&lcd_mutex);
+}
+
+// The IOs still alive belong to the module under test, only the counters restart
+void sim_lcd_reset(void) {
+    pthread_mutex_lock(&lcd_mutex);
+    uint32_t alive = stats.ios;
+    memset(&stats, 0, sizeof(stats));
+    stats.ios = alive;
+    pthread_mutex_unlock(&lcd_mutex);
+}
+
+// Panel operations
+
+esp_err_t esp_lcd_panel_reset(esp_lcd_panel_handle_t panel) {
+    return panel ? panel->reset(panel) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_init(esp_lcd_panel_handle_t panel) {
+    return panel ? panel->init(panel) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_del(esp_lcd_panel_handle_t panel) {
+    return panel ? panel->del(panel) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_draw_bitmap(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, const void *color_data) {
+    return panel ? panel->draw_bitmap(panel, x_start, y_start, x_end, y_end, color_data) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t esp_lcd_panel_mirror(esp_lcd_panel_handle_t panel, bool mirror_x, bool mirror_y) {
+    return panel && panel->mirror ? panel->mirror(panel, mirror_x, mirror_y) : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_lcd_panel_swap_xy(esp_lcd_panel_handle_t panel, bool swap_axes) {
+    return panel && panel->swap_xy ? panel->swap_xy(panel, swap_axes) : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_lcd_panel_set_gap(esp_lcd_panel_handle_t panel, int x_gap, int y_gap) {
+    return panel && panel->set_gap ? panel->set_gap(panel, x_gap, y_gap) : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_lcd_panel_invert_color(esp_lcd_panel_handle_t panel, bool invert_color_data) {
+    return panel && panel->invert_color ? panel->invert_color(panel, invert_color_data) : ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t esp_lcd_panel_disp_on_off(esp_lcd_panel_handle_t panel, bool on_off) {
+    return panel && panel->disp_on_off ? panel->disp_on_off(panel, on_off) : ESP_ERR_NOT_SUPPORTED;
+}
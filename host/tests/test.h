@@ -0,0 +1,27 @@
+/*
+ * Checks of the host tests: a failed check prints where and exits non-zero
+ */
+
+#ifndef HOST_TESTS_TEST_H
+#define HOST_TESTS_TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define CHECK(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+} while (0)
+
+#define CHECK_EQ(a, b) do { \
+        long long a_ = (long long)(a); \
+        long long b_ = (long long)(b); \
+        if (a_ != b_) { \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, a_, b_); \
+            exit(1); \
+        } \
+} while (0)
+
+#endif // HOST_TESTS_TEST_H
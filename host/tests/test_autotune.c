@@ -0,0 +1,141 @@
+/*
+ * autotune() against a render and flush cost model: every band costs a fixed
+ * setup time plus a time per pixel, a quarter more once the draw buffer is
+ * too large for fast memory. The bus is fast enough not to count.
+ * autotune measures what the model predicts for every band height that fits
+ * the budget and converges on the fast memory limit: the largest buffer is
+ * about as fast but not 3% faster. A second run picks the same height, a
+ * smaller budget caps it, and without the per band cost the smallest wins
+ */
+
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define MAX_LINES       208
+#define HYSTERESIS_PCT  3
+#define FAST_PCLK_HZ    2000000000
+#define BAND_US         2000
+#define PX_PER_MS       3500
+#define FAST_LINES      52          // larger draw buffers render slower
+#define SLOW_PCT        125
+
+static board_t board;
+static mp_obj_t lvgl;
+static void (*panel_flush)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color);
+static uint32_t band_us;        // setup cost of a band
+
+static const int candidates[] = { 8, 16, 24, 32, 40, 52, 64, 84, 104, 140, 208 };
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return mp_obj_new_int(v);
+}
+
+// Cost of a band of h lines out of a draw buffer of lines
+static uint32_t band_cost_us(int lines, int h) {
+    uint64_t us = (uint64_t)PANEL_WIDTH * h * 1000 / PX_PER_MS;
+    if (lines > FAST_LINES) {
+        us = us * SLOW_PCT / 100;
+    }
+    return band_us + us;
+}
+
+static void costly_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color) {
+    sim_sleep_us(band_cost_us(drv->draw_buf->size / PANEL_WIDTH, lv_area_get_height(area)));
+    panel_flush(drv, area, color);
+}
+
+// Frame time the model predicts for bands of lines
+static int64_t model_us(int lines) {
+    int64_t us = 0;
+    for (int y = 0; y < PANEL_HEIGHT; y += lines) {
+        us += band_cost_us(lines, PANEL_HEIGHT - y < lines ? PANEL_HEIGHT - y : lines);
+    }
+    return us;
+}
+
+static size_t budget_of(int lines) {
+    return 2 * (size_t)lines * PANEL_WIDTH * sizeof(lv_color_t);
+}
+
+// autotune(budget): the height it chose, the measurements checked against the
+// candidates, the model and the 3% rule
+static int autotune(size_t budget, const char *name) {
+    mp_obj_t ret = mp_call_function_n_kw(mp_host_attr(lvgl, "autotune"), 1, 0, (mp_obj_t[]){ int_obj(budget) });
+    CHECK(ret != mp_const_none);
+    size_t n;
+    mp_obj_t *items;
+    mp_obj_get_array(ret, &n, &items);
+    CHECK_EQ(n, 2);
+    int chosen = mp_obj_get_int(items[0]);
+
+    size_t count;
+    mp_obj_t *results;
+    mp_obj_get_array(items[1], &count, &results);
+    int best = 0;
+    int64_t best_us = INT64_MAX;
+    printf("autotune: %-7s", name);
+    for (size_t i = 0; i < count; i++) {
+        mp_obj_t *pair;
+        mp_obj_get_array(results[i], &n, &pair);
+        int lines = mp_obj_get_int(pair[0]);
+        int64_t us = mp_obj_get_int(pair[1]);
+        CHECK_EQ(lines, candidates[i]);
+        CHECK(budget_of(lines) <= budget);
+        // The model and the bus, about 400 us a frame at this clock
+        CHECK(us >= model_us(lines) && us <= model_us(lines) + 1000);
+        if (us * 100 < best_us * (100 - HYSTERESIS_PCT)) {
+            best_us = us;
+            best = lines;
+        }
+        printf(" %d:%lld", lines, (long long)us);
+    }
+    // Every candidate that fits was measured
+    CHECK(count == sizeof(candidates) / sizeof(candidates[0]) || budget_of(candidates[count]) > budget);
+    printf(" -> %d lines\n", chosen);
+    CHECK_EQ(chosen, best);
+
+    // The draw buffers are those of the chosen height
+    mp_obj_t info = mp_host_call(lvgl, "mem_info", 0);
+    CHECK_EQ(mp_host_dict_int(info, "draw_buf_bytes"), budget_of(chosen));
+    return chosen;
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(display, "pclk", 1, int_obj(FAST_PCLK_HZ)) == mp_const_true);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+
+    lv_obj_t *box = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(box, 300, 300);
+    lv_obj_set_style_bg_color(box, lv_color_make(0x20, 0x80, 0xC0), 0);
+    lv_disp_drv_t *drv = lv_disp_get_default()->driver;
+    panel_flush = drv->flush_cb;
+    drv->flush_cb = costly_flush;
+
+    // A costly band setup: the taller bands pay off up to the fast memory
+    band_us = BAND_US;
+    int lines = autotune(budget_of(MAX_LINES), "setup");
+    CHECK_EQ(lines, FAST_LINES);
+    CHECK_EQ(autotune(budget_of(MAX_LINES), "again"), lines);
+
+    // A smaller budget caps the height
+    CHECK(autotune(budget_of(32), "budget") <= 32);
+
+    // Pixels alone: no height is 3% faster than the smallest
+    band_us = 0;
+    CHECK_EQ(autotune(budget_of(MAX_LINES), "pixels"), candidates[0]);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("autotune: ok\n");
+    return 0;
+}
@@ -0,0 +1,65 @@
+/*
+ * Backlight: Backlight_Init starts the LEDC at the duty of the level with the
+ * CABC scale applied, as every later change of level does
+ */
+
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define LEVEL       60
+
+static board_t board;
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static uint32_t backlight_duty(void) {
+    sim_ledc_channel_t ch;
+    sim_ledc_get(0, &ch);
+    CHECK(ch.configured);
+    return ch.duty;
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    mp_obj_t display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_host_call(display_mod, "Backlight_Init", 0);
+    mp_host_call(display_mod, "Set_Backlight", 1, int_obj(LEVEL));
+    uint32_t full = backlight_duty();
+    CHECK(full > 0);
+
+    // A dim screen: CABC boosts the pixels and lowers the backlight
+    mp_obj_t lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    mp_host_call(display_mod, "LCD_cabc", 1, mp_const_true);
+    lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(0x303030), 0);
+    for (int i = 0; i < 20 && backlight_duty() == full; i++) {
+        lv_obj_invalidate(lv_scr_act());
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(30 * 1000);
+    }
+    uint32_t scaled = backlight_duty();
+    CHECK(scaled < full);
+    CHECK(mp_obj_get_float(mp_host_dict_lookup(mp_host_call(display_mod, "LCD_cabcStats", 0), "backlight_scale")) < 1);
+
+    // Initialised again, the scale still holds
+    mp_host_call(display_mod, "Backlight_Init", 0);
+    CHECK_EQ(backlight_duty(), scaled);
+
+    mp_host_call(display_mod, "LCD_cabc", 1, mp_const_false);
+    CHECK_EQ(backlight_duty(), full);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("backlight: ok\n");
+    return 0;
+}
@@ -0,0 +1,139 @@
+/*
+ * The frame-rate benchmark on the host: lvgl_driver.bench() runs every scene
+ * through the flush, spd2010_display and the panel model on the virtual
+ * clock, with the bus timed at the display's pixel clock. The virtual clock
+ * only moves with the bus and sleeps, so the frame rate is what the bus
+ * allows and a stage's time is its wait for the bus: the host checks the
+ * frames, pixels, bytes and memory of each scene, the board measures its CPU
+ * time.
+ *
+ * test_bench OUTDIR checks the figures of each scene against what the scene
+ * does and writes the report as bench_report.json, the JSON bench() gives on
+ * the board. CTest reads it back with tools/bench_compare.py
+ */
+
+#include <string.h>
+#include "lv_bench.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define FRAMES      30
+
+static board_t board;
+static char path[4096];
+
+// Integer figures of a scene, as bench() names them
+static const char *const figures[] = {
+    "frames", "drawn", "px_per_frame", "bytes_per_frame", "update_us", "render_us", "flush_us",
+    "transfer_us", "wait_us", "max_frame_us", "mem_peak", "mem_scene", "heap_min_free",
+};
+#define FIGURE_COUNT (sizeof(figures) / sizeof(figures[0]))
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static void check_scene(lv_bench_scene_t scene, mp_obj_t r) {
+    CHECK(r != MP_OBJ_NULL && r != mp_const_none);
+    mp_int_t drawn = mp_host_dict_int(r, "drawn");
+    mp_int_t px = mp_host_dict_int(r, "px_per_frame");
+    CHECK_EQ(mp_host_dict_int(r, "frames"), FRAMES);
+    CHECK(mp_obj_get_float(mp_host_dict_lookup(r, "fps")) > 0);
+    // Both per frame averages, rounded down
+    mp_int_t bytes = mp_host_dict_int(r, "bytes_per_frame");
+    CHECK(bytes == px * 2 || bytes == px * 2 + 1);
+    CHECK(mp_host_dict_int(r, "mem_peak") > 0);
+    CHECK(mp_host_dict_int(r, "heap_min_free") > 0);
+    CHECK(drawn <= FRAMES);
+    switch (scene) {
+        case LV_BENCH_STATIC:
+            // Drawn once, then nothing changes
+            CHECK(drawn <= 1);
+            CHECK(px < PANEL_WIDTH * PANEL_HEIGHT / 10);
+            break;
+        case LV_BENCH_LIST_SCROLL:
+        case LV_BENCH_ANIMATION:
+            // The list fills the screen: every pixel of every frame, as for the animation
+            CHECK_EQ(drawn, FRAMES);
+            CHECK_EQ(px, PANEL_WIDTH * PANEL_HEIGHT);
+            break;
+        default:
+            CHECK(drawn >= FRAMES - 1);
+            CHECK(px > 0 && px < PANEL_WIDTH * PANEL_HEIGHT);
+            break;
+    }
+}
+
+static void write_scene(FILE *f, mp_obj_t r) {
+    fprintf(f, "{\"fps\": %.3f", (double)mp_obj_get_float(mp_host_dict_lookup(r, "fps")));
+    for (size_t i = 0; i < FIGURE_COUNT; i++) {
+        fprintf(f, ", \"%s\": %ld", figures[i], (long)mp_host_dict_int(r, figures[i]));
+    }
+    fprintf(f, "}");
+}
+
+static void write_report(const char *dir, mp_obj_t report) {
+    snprintf(path, sizeof(path), "%s/bench_report.json", dir);
+    FILE *f = fopen(path, "w");
+    CHECK(f != NULL);
+    mp_obj_t config = mp_host_dict_lookup(report, "config");
+    fprintf(f, "{\"config\": {\"hor_res\": %ld, \"ver_res\": %ld, \"color_depth\": %ld, \"draw_buf_bytes\": %ld, "
+        "\"pipeline\": %s, \"frames\": %ld},\n \"scenes\": {",
+        (long)mp_host_dict_int(config, "hor_res"), (long)mp_host_dict_int(config, "ver_res"),
+        (long)mp_host_dict_int(config, "color_depth"), (long)mp_host_dict_int(config, "draw_buf_bytes"),
+        mp_obj_is_true(mp_host_dict_lookup(config, "pipeline")) ? "true" : "false",
+        (long)mp_host_dict_int(config, "frames"));
+    mp_obj_t scenes = mp_host_dict_lookup(report, "scenes");
+    for (int i = 0; i < LV_BENCH_SCENE_COUNT; i++) {
+        const char *name = lv_bench_scene_name(i);
+        fprintf(f, "%s\n  \"%s\": ", i ? "," : "", name);
+        write_scene(f, mp_host_dict_lookup(scenes, name));
+    }
+    fprintf(f, "}}\n");
+    fclose(f);
+}
+
+int main(int argc, char **argv) {
+    CHECK(argc == 2);
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_obj_t lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+
+    mp_obj_t report = mp_host_call(lvgl, "bench", 2, mp_const_none, int_obj(FRAMES));
+    CHECK(report != mp_const_none);
+    mp_obj_t config = mp_host_dict_lookup(report, "config");
+    CHECK_EQ(mp_host_dict_int(config, "hor_res"), PANEL_WIDTH);
+    CHECK_EQ(mp_host_dict_int(config, "frames"), FRAMES);
+    mp_obj_t scenes = mp_host_dict_lookup(report, "scenes");
+    for (int i = 0; i < LV_BENCH_SCENE_COUNT; i++) {
+        mp_obj_t r = mp_host_dict_lookup(scenes, lv_bench_scene_name(i));
+        check_scene(i, r);
+        printf("bench: %-12s %6.1f fps, %7ld bytes a frame, render %5ld us, flush %5ld us, %6ld bytes of LVGL heap\n",
+            lv_bench_scene_name(i), (double)mp_obj_get_float(mp_host_dict_lookup(r, "fps")),
+            (long)mp_host_dict_int(r, "bytes_per_frame"), (long)mp_host_dict_int(r, "render_us"),
+            (long)mp_host_dict_int(r, "flush_us"), (long)mp_host_dict_int(r, "mem_scene"));
+    }
+
+    // One scene by name, an unknown one refused
+    mp_obj_t names = mp_obj_new_list(1, (mp_obj_t[]){ mp_obj_new_str("labels", 6) });
+    mp_obj_t one = mp_host_dict_lookup(mp_host_call(lvgl, "bench", 2, names, int_obj(2)), "scenes");
+    CHECK(mp_host_dict_lookup(one, "labels") != MP_OBJ_NULL);
+    CHECK(mp_host_dict_lookup(one, "static") == MP_OBJ_NULL);
+    names = mp_obj_new_list(1, (mp_obj_t[]){ mp_obj_new_str("nope", 4) });
+    CHECK(mp_host_call_catch(NULL, lvgl, "bench", 2, names, int_obj(2)) != NULL);
+
+    write_report(argv[1], report);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("bench: ok\n");
+    return 0;
+}
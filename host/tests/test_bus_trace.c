@@ -0,0 +1,229 @@
+/*
+ * Bus transaction recorder: lock-free writers against a reader, the color
+ * transfer timing, the cost of a hook and the export of a real bring-up
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include "bus_trace_port.h"
+#include "bus_trace_ring.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define WRITERS             4
+#define EVENTS_PER_WRITER   50000
+#define RING_EVENTS         1024
+
+static bus_trace_event_t ring[RING_EVENTS];
+static board_t board;
+static volatile bool writing;
+
+// The length is derived from the command, a torn event does not match
+static uint32_t len_of(uint32_t cmd) {
+    return (cmd * 2654435761u) >> 22;
+}
+
+static int64_t virtual_us(void) {
+    return sim_clock_now();
+}
+
+static void *writer(void *arg) {
+    uint32_t id = (uintptr_t)arg;
+    for (uint32_t i = 0; i < EVENTS_PER_WRITER; i++) {
+        uint32_t cmd = (id << 24) | i;
+        bus_trace_record(BUS_TRACE_I2C_WRITE, cmd, len_of(cmd), bus_trace_now());
+    }
+    return NULL;
+}
+
+// Every event read while the writers run is whole
+static void *reader(void *arg) {
+    uint32_t *taken = arg;
+    while (__atomic_load_n(&writing, __ATOMIC_ACQUIRE)) {
+        uint32_t pos = 0;
+        bus_trace_event_t e;
+        while (bus_trace_next(&pos, &e)) {
+            CHECK_EQ(e.op, BUS_TRACE_I2C_WRITE);
+            CHECK_EQ(e.len, len_of(e.cmd));
+            CHECK(e.start_us <= e.end_us);
+            (*taken)++;
+        }
+    }
+    return NULL;
+}
+
+static void test_concurrent_wrap(void) {
+    pthread_t writers[WRITERS];
+    pthread_t read_thread;
+    uint32_t taken = 0;
+
+    CHECK(bus_trace_start(ring, RING_EVENTS, true));
+    writing = true;
+    pthread_create(&read_thread, NULL, reader, &taken);
+    for (uintptr_t i = 0; i < WRITERS; i++) {
+        pthread_create(&writers[i], NULL, writer, (void *)i);
+    }
+    for (int i = 0; i < WRITERS; i++) {
+        pthread_join(writers[i], NULL);
+    }
+    __atomic_store_n(&writing, false, __ATOMIC_RELEASE);
+    pthread_join(read_thread, NULL);
+    bus_trace_stop();
+
+    bus_trace_stats_t s;
+    bus_trace_get_stats(&s);
+    CHECK_EQ(s.recorded, WRITERS * EVENTS_PER_WRITER);
+    CHECK_EQ(s.dropped, WRITERS * EVENTS_PER_WRITER - RING_EVENTS);
+    CHECK_EQ(s.ops[BUS_TRACE_I2C_WRITE], WRITERS * EVENTS_PER_WRITER);
+
+    // Stopped: the newest events, whole, each writer's in its own order
+    uint32_t last[WRITERS];
+    memset(last, 0xFF, sizeof(last));
+    uint32_t pos = 0;
+    uint32_t count = 0;
+    bus_trace_event_t e;
+    while (bus_trace_next(&pos, &e)) {
+        uint32_t id = e.cmd >> 24;
+        uint32_t i = e.cmd & 0xFFFFFF;
+        CHECK(id < WRITERS);
+        CHECK_EQ(e.len, len_of(e.cmd));
+        CHECK(last[id] == 0xFFFFFFFF || i > last[id]);
+        last[id] = i;
+        count++;
+    }
+    CHECK_EQ(count, RING_EVENTS);
+    printf("wrap: %u events read while writing\n", (unsigned)taken);
+}
+
+static void test_no_wrap(void) {
+    CHECK(bus_trace_start(ring, 256, false));
+    for (uint32_t i = 0; i < 1000; i++) {
+        bus_trace_record(BUS_TRACE_I2C_READ, i, len_of(i), bus_trace_now());
+    }
+    bus_trace_stop();
+
+    bus_trace_stats_t s;
+    bus_trace_get_stats(&s);
+    CHECK_EQ(s.recorded, 256);
+    CHECK_EQ(s.dropped, 1000 - 256);
+
+    // The first ones are kept
+    uint32_t pos = 0;
+    uint32_t count = 0;
+    bus_trace_event_t e;
+    while (bus_trace_next(&pos, &e)) {
+        CHECK_EQ(e.cmd, count);
+        count++;
+    }
+    CHECK_EQ(count, 256);
+}
+
+// Queued color transfers go out one after the other, parameters wait for them
+static void test_color_timing(void) {
+    bus_trace_set_clock(virtual_us);
+    CHECK(bus_trace_start(ring, 64, true));
+    uint64_t t0 = sim_clock_now() - 1;
+
+    sim_sleep_us(10);
+    bus_trace_color_begin(0x32002C00, 1000);
+    sim_sleep_us(10);
+    bus_trace_color_begin(0x32003C00, 2000);
+    sim_sleep_us(10);
+    bus_trace_color_begin(0x32003C00, 3000);
+    bus_trace_color_failed();
+    sim_sleep_us(70);
+    uint32_t param_start = bus_trace_now();
+    bus_trace_color_done();
+    sim_sleep_us(50);
+    bus_trace_color_done();
+    sim_sleep_us(5);
+    bus_trace_record(BUS_TRACE_PANEL_PARAM, 0x02002A00, 4, param_start);
+    bus_trace_stop();
+
+    bus_trace_event_t e[4];
+    uint32_t pos = 0;
+    int n = 0;
+    while (n < 4 && bus_trace_next(&pos, &e[n])) {
+        n++;
+    }
+    CHECK_EQ(n, 4);
+
+    CHECK_EQ(e[0].op, BUS_TRACE_PANEL_COLOR);
+    CHECK_EQ(e[0].start_us, 11 + 0);
+    CHECK_EQ(e[0].end_us, 101);
+    CHECK_EQ(e[0].queued_us, 0);
+    // Queued at 21, on the wire once the first one was done
+    CHECK_EQ(e[1].start_us, 101);
+    CHECK_EQ(e[1].end_us, 151);
+    CHECK_EQ(e[1].queued_us, 80);
+    // Not queued: no duration, and no interrupt to wait for
+    CHECK_EQ(e[2].len, 3000);
+    CHECK_EQ(e[2].end_us, e[2].start_us);
+    // Called at 101, sent after the color transfer that ended at 151
+    CHECK_EQ(e[3].op, BUS_TRACE_PANEL_PARAM);
+    CHECK_EQ(e[3].start_us, 151);
+    CHECK_EQ(e[3].end_us, 156);
+    CHECK_EQ(sim_clock_now() - t0, 156);
+    bus_trace_set_clock(NULL);
+}
+
+static void test_overhead(void) {
+    static bus_trace_event_t scratch[4096];
+    uint32_t ns = bus_trace_measure_overhead(scratch, 4096);
+    printf("overhead: %u ns per event\n", (unsigned)ns);
+    CHECK(ns < 5000);
+    CHECK(!bus_trace_active());
+}
+
+// The module: the I2C and panel traffic of a bring-up, exported as JSON
+static void test_export(void) {
+    bus_trace_set_clock(virtual_us);
+    board_init(&board);
+    mp_obj_t trace = mp_host_import("bus_trace");
+    mp_obj_t i2c = mp_host_import("i2c_driver");
+    mp_obj_t tca = mp_host_import("tca9554");
+    mp_obj_t display_mod = mp_host_import("spd2010_display");
+
+    CHECK(mp_host_call(trace, "start", 1, MP_OBJ_NEW_SMALL_INT(4096)) == mp_const_true);
+    mp_host_call(i2c, "init", 0);
+    mp_host_call(tca, "TCA9554PWR_Init", 1, MP_OBJ_NEW_SMALL_INT(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_host_call(display, "fill_rect", 5, MP_OBJ_NEW_SMALL_INT(0), MP_OBJ_NEW_SMALL_INT(0),
+        MP_OBJ_NEW_SMALL_INT(100), MP_OBJ_NEW_SMALL_INT(100), MP_OBJ_NEW_SMALL_INT(0xF800));
+    mp_host_call(display_mod, "LCD_waitIdle", 0);
+    mp_host_call(trace, "stop", 0);
+
+    mp_obj_t stats = mp_host_call(trace, "stats", 0);
+    CHECK(mp_host_dict_int(stats, "i2c_write") > 0);
+    CHECK(mp_host_dict_int(stats, "panel_param") > 0);
+    CHECK(mp_host_dict_int(stats, "panel_color") > 0);
+    CHECK_EQ(mp_host_dict_int(stats, "dropped"), 0);
+
+    mp_obj_t out = mp_host_new_bytesio();
+    mp_int_t written = mp_obj_get_int(mp_host_call(trace, "export", 1, out));
+    CHECK_EQ(written, mp_host_dict_int(stats, "recorded"));
+    size_t len;
+    const char *json = (const char *)mp_host_bytesio_data(out, &len);
+    CHECK(len > 0 && json[len - 1] == '\n');
+    CHECK(memmem(json, len, "\"name\":\"SLPOUT\"", 15) != NULL);
+    CHECK(memmem(json, len, "\"cat\":\"color\"", 13) != NULL);
+    CHECK(memmem(json, len, "\"cat\":\"i2c\"", 11) != NULL);
+    CHECK(memmem(json, len, "\"open\":true", 11) == NULL);
+
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    bus_trace_set_clock(NULL);
+}
+
+int main(void) {
+    mp_host_init();
+    test_concurrent_wrap();
+    test_no_wrap();
+    test_color_timing();
+    test_overhead();
+    test_export();
+    printf("bus_trace: ok\n");
+    return 0;
+}
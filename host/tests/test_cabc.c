@@ -0,0 +1,174 @@
+/*
+ * CABC over captured frames: test_cabc SCENE.ppm shows the captured scene and
+ * a darker copy of it through LVGL. Whole frames settle on one gain and keep
+ * it, partial refreshes of a small area do not move it, and a change of the
+ * backlight scale leaves a running fade alone. Reports the backlight saving
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define FRAMES      24
+#define SETTLE      4       // frames until a new gain and its backlight are out
+#define LEVEL       60
+#define FADE_LEVEL  30
+#define FADE_MS     500
+
+static board_t board;
+static mp_obj_t display_mod;
+static mp_obj_t lvgl;
+static lv_color_t scene[PANEL_WIDTH * PANEL_HEIGHT];
+static lv_color_t dark[PANEL_WIDTH * PANEL_HEIGHT];
+static lv_img_dsc_t scene_dsc;
+
+static void load_scene(const char *path) {
+    FILE *f = fopen(path, "rb");
+    CHECK(f != NULL);
+    int w, h, max;
+    CHECK(fscanf(f, "P6 %d %d %d", &w, &h, &max) == 3);
+    CHECK(w == PANEL_WIDTH && h == PANEL_HEIGHT && max == 255);
+    fgetc(f);
+    for (int i = 0; i < PANEL_WIDTH * PANEL_HEIGHT; i++) {
+        uint8_t rgb[3];
+        CHECK(fread(rgb, 1, 3, f) == 3);
+        scene[i] = lv_color_make(rgb[0], rgb[1], rgb[2]);
+        dark[i] = lv_color_make(rgb[0] * 2 / 5, rgb[1] * 2 / 5, rgb[2] * 2 / 5);
+    }
+    fclose(f);
+}
+
+static void show(lv_obj_t *img, const lv_color_t *pixels) {
+    scene_dsc.header.cf = LV_IMG_CF_TRUE_COLOR;
+    scene_dsc.header.w = PANEL_WIDTH;
+    scene_dsc.header.h = PANEL_HEIGHT;
+    scene_dsc.data_size = sizeof(scene);
+    scene_dsc.data = (const uint8_t *)pixels;
+    lv_img_set_src(img, &scene_dsc);
+    lv_img_cache_invalidate_src(&scene_dsc);
+}
+
+static mp_obj_t cabc_stats(bool reset) {
+    return mp_host_call(display_mod, "LCD_cabcStats", 1, mp_obj_new_bool(reset));
+}
+
+static float gain(void) {
+    return mp_obj_get_float(mp_host_dict_lookup(cabc_stats(false), "gain"));
+}
+
+static void frame(lv_obj_t *area) {
+    lv_obj_invalidate(area);
+    mp_host_call(lvgl, "loop", 0);
+    sim_sleep_us(30 * 1000);
+    mp_host_call(lvgl, "loop", 0);
+}
+
+// Frames of one area: the gain after each, the changes after SETTLE frames
+static int run(lv_obj_t *area, float *gains) {
+    int changes = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        frame(area);
+        gains[i] = gain();
+        if (i > SETTLE && gains[i] != gains[i - 1]) {
+            changes++;
+        }
+    }
+    return changes;
+}
+
+static void report(const char *name, const float *gains) {
+    mp_obj_t stats = cabc_stats(true);
+    printf("cabc: %-8s gain", name);
+    for (int i = 0; i < FRAMES; i++) {
+        printf(" %.2f", (double)gains[i]);
+    }
+    printf("\ncabc: %-8s %d gain changes, backlight saving %.1f%%\n", name,
+        (int)mp_host_dict_int(stats, "changes"),
+        (double)mp_obj_get_float(mp_host_dict_lookup(stats, "saving_pct")));
+}
+
+static uint32_t duty(sim_ledc_channel_t *ch) {
+    sim_ledc_get(0, ch);
+    return ch->duty;
+}
+
+int main(int argc, char **argv) {
+    float gains[FRAMES];
+    sim_ledc_channel_t ch;
+
+    CHECK(argc == 2);
+    load_scene(argv[1]);
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, MP_OBJ_NEW_SMALL_INT(0x00));
+    display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_host_call(display_mod, "Backlight_Init", 0);
+    mp_host_call(display_mod, "Set_Backlight", 1, MP_OBJ_NEW_SMALL_INT(LEVEL));
+    uint32_t full = duty(&ch);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+
+    lv_obj_t *img = lv_img_create(lv_scr_act());
+    lv_obj_set_pos(img, 0, 0);
+    show(img, dark);
+    mp_host_call(display_mod, "LCD_cabc", 2, mp_const_true, mp_obj_new_float(2));
+    cabc_stats(true);
+
+    // The darker scene is boosted, one gain for all its frames
+    CHECK_EQ(run(lv_scr_act(), gains), 0);
+    report("dark", gains);
+    float dark_gain = gains[FRAMES - 1];
+    CHECK(dark_gain > 1);
+    CHECK(duty(&ch) < full);
+
+    // A small bright area redrawn on its own: its pixels alone do not decide
+    lv_obj_t *box = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(box, 40, 40);
+    lv_obj_set_style_bg_color(box, lv_color_white(), 0);
+    cabc_stats(true);
+    CHECK_EQ(run(box, gains), 0);
+    report("partial", gains);
+    CHECK(gains[0] == dark_gain && gains[FRAMES - 1] == dark_gain);
+    CHECK_EQ(mp_host_dict_int(cabc_stats(false), "changes"), 0);
+    lv_obj_del(box);
+
+    // The captured scene as it is
+    show(img, scene);
+    CHECK_EQ(run(lv_scr_act(), gains), 0);
+    report("captured", gains);
+    float scene_gain = gains[FRAMES - 1];
+    CHECK(scene_gain < dark_gain);
+
+    // A new scale while the backlight fades: the fade goes on to its target,
+    // the scale follows once it is done
+    mp_host_call(display_mod, "Fade_Backlight", 2, MP_OBJ_NEW_SMALL_INT(FADE_LEVEL), MP_OBJ_NEW_SMALL_INT(FADE_MS));
+    sim_ledc_get(0, &ch);
+    uint32_t target = ch.target;
+    uint64_t fade_end = ch.fade_end_us;
+    CHECK(fade_end != 0);
+    show(img, dark);
+    while (sim_clock_now() < fade_end - 60 * 1000) {
+        frame(lv_scr_act());
+        sim_ledc_get(0, &ch);
+        CHECK_EQ(ch.target, target);
+        CHECK_EQ(ch.fade_end_us, fade_end);
+    }
+    CHECK(gain() == dark_gain);
+    for (int i = 0; i < SETTLE; i++) {
+        frame(lv_scr_act());
+    }
+    CHECK(duty(&ch) < target);
+    CHECK_EQ(ch.target, ch.duty);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("cabc: ok\n");
+    return 0;
+}
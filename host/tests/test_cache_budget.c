@@ -0,0 +1,142 @@
+/*
+ * Image cache budget: hits counted from the cache lookups, the slot count
+ * reduced when decoded images go over the budget and grown back once they
+ * are smaller again
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define IMAGES      4
+#define BIG_SIDE    72      // 10 KB decoded, three of them are over the image budget
+#define SMALL_SIDE  16
+#define FRAMES      8
+
+static board_t board;
+static mp_obj_t lvgl;
+static int decoder_opens;
+
+// "A:<side>/<n>" is a decoded square of that side, "A:bad" has a header only
+static lv_res_t test_info(lv_img_decoder_t *decoder, const void *src, lv_img_header_t *header) {
+    int side;
+    if (lv_img_src_get_type(src) != LV_IMG_SRC_FILE || strncmp(src, "A:", 2) != 0) {
+        return LV_RES_INV;
+    }
+    if (sscanf((const char *)src + 2, "%d", &side) != 1) {
+        side = SMALL_SIDE;
+    }
+    header->cf = LV_IMG_CF_TRUE_COLOR;
+    header->w = side;
+    header->h = side;
+    return LV_RES_OK;
+}
+
+static lv_res_t test_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    if (strcmp(dsc->src, "A:bad") == 0) {
+        return LV_RES_INV;
+    }
+    uint32_t size = lv_img_buf_get_img_size(dsc->header.w, dsc->header.h, dsc->header.cf);
+    uint8_t *data = lv_mem_alloc(size);
+    if (data == NULL) {
+        return LV_RES_INV;
+    }
+    memset(data, 0x5A, size);
+    dsc->img_data = data;
+    decoder_opens++;
+    return LV_RES_OK;
+}
+
+static void test_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    lv_mem_free((void *)dsc->img_data);
+    dsc->img_data = NULL;
+}
+
+static mp_int_t cache_stat(const char *key) {
+    return mp_host_dict_int(mp_host_call(lvgl, "cache_stats", 0), key);
+}
+
+static void frames(int count) {
+    for (int i = 0; i < count; i++) {
+        lv_obj_invalidate(lv_scr_act());
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(30 * 1000);
+        mp_host_call(lvgl, "loop", 0);
+    }
+}
+
+static void set_sources(lv_obj_t **imgs, const char *const *srcs, int count) {
+    for (int i = 0; i < IMAGES; i++) {
+        lv_img_set_src(imgs[i], i < count ? srcs[i] : NULL);
+    }
+}
+
+int main(void) {
+    static const char *const big[] = { "A:72/0", "A:72/1", "A:72/2", "A:72/3" };
+    static const char *const small[] = { "A:16/0", "A:16/1", "A:16/2", "A:16/3" };
+    static const char *const bad[] = { "A:bad" };
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, MP_OBJ_NEW_SMALL_INT(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    mp_int_t entries = cache_stat("img_entries");
+    CHECK(entries >= 3);
+    CHECK(3 * BIG_SIDE * BIG_SIDE * 2 > cache_stat("img_budget"));
+
+    // Hooked by the next poll
+    lv_img_decoder_t *decoder = lv_img_decoder_create();
+    decoder->info_cb = test_info;
+    decoder->open_cb = test_open;
+    decoder->close_cb = test_close;
+    lv_obj_t *imgs[IMAGES];
+    for (int i = 0; i < IMAGES; i++) {
+        imgs[i] = lv_img_create(lv_scr_act());
+        lv_obj_set_pos(imgs[i], 20 + i * 90, 20);
+    }
+    frames(1);
+
+    // Two images drawn over and over: only the first lookups miss
+    set_sources(imgs, small, 2);
+    frames(1);
+    mp_host_call(lvgl, "cache_stats", 1, mp_const_true);
+    int opens = decoder_opens;
+    frames(FRAMES);
+    CHECK_EQ(decoder_opens, opens);
+    CHECK_EQ(cache_stat("misses"), 0);
+    CHECK(cache_stat("hits") >= 2 * FRAMES);
+
+    // An image no decoder opens is not a hit
+    set_sources(imgs, bad, 1);
+    frames(1);
+    mp_host_call(lvgl, "cache_stats", 1, mp_const_true);
+    frames(FRAMES);
+    CHECK_EQ(cache_stat("hits"), 0);
+    CHECK_EQ(cache_stat("misses"), 0);
+
+    // Big images: fewer slots until what they hold fits the budget
+    set_sources(imgs, big, IMAGES);
+    frames(FRAMES);
+    CHECK(cache_stat("evictions") > 0);
+    CHECK(cache_stat("img_entries") < entries);
+    CHECK(cache_stat("img_bytes") <= cache_stat("img_budget"));
+
+    // Small ones again: the slots come back, up to the budget's count
+    set_sources(imgs, small, IMAGES);
+    frames(FRAMES);
+    CHECK_EQ(cache_stat("img_entries"), entries);
+    CHECK(cache_stat("img_bytes") <= cache_stat("img_budget"));
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("cache budget: ok\n");
+    return 0;
+}
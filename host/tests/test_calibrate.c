@@ -0,0 +1,86 @@
+/*
+ * QSPI clock calibration against a panel whose reads come back corrupted
+ * above a set clock: calibrate_clock() tries only 80 MHz / n clocks, stops at
+ * the first that corrupts and settles a divider step below the last good one.
+ * Its buffers are DMA memory
+ */
+
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define SRC_HZ  (80 * 1000 * 1000)
+#define MHZ     (1000 * 1000)
+
+static board_t board;
+static mp_obj_t display;
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return mp_obj_new_int(v);
+}
+
+// The divider of the highest 80 MHz / n clock in [min_hz, max_hz] the panel
+// reads back at, or that of min_hz
+static int stable_div(int min_hz, int max_hz, unsigned int max_read_hz) {
+    int div = SRC_HZ / min_hz;
+    while (div > 1 && SRC_HZ / (div - 1) <= max_hz &&
+           (max_read_hz == 0 || SRC_HZ / (div - 1) <= (int)max_read_hz)) {
+        div--;
+    }
+    return div;
+}
+
+static void check_calibration(int min_hz, int max_hz, unsigned int max_read_hz) {
+    board.panel.max_read_hz = max_read_hz;
+    board.panel.corrupted_reads = 0;
+    mp_int_t hz = mp_obj_get_int(mp_host_call(display, "calibrate_clock", 2, int_obj(min_hz), int_obj(max_hz)));
+
+    int best = stable_div(min_hz, max_hz, max_read_hz);
+    int slow = SRC_HZ / min_hz;
+    int chosen = best + 1 > slow ? slow : best + 1;
+    CHECK_EQ(hz, SRC_HZ / chosen);
+    CHECK_EQ(mp_obj_get_int(mp_host_call(display, "pclk", 0)), hz);
+    CHECK(max_read_hz == 0 || hz <= (mp_int_t)max_read_hz);
+    // Only the first clock past the limit is tried, the others are not
+    bool past_limit = best > 1 && SRC_HZ / (best - 1) <= max_hz;
+    CHECK(past_limit ? board.panel.corrupted_reads > 0 : board.panel.corrupted_reads == 0);
+    CHECK(board.panel.corrupted_reads <= 1);
+    char limit[32] = "none";
+    if (max_read_hz) {
+        snprintf(limit, sizeof(limit), "%u MHz", max_read_hz / MHZ);
+    }
+    printf("calibrate: %d-%d MHz, read limit %s: max stable %.2f MHz, chosen %.2f MHz\n",
+        min_hz / MHZ, max_hz / MHZ, limit, (double)SRC_HZ / best / MHZ, (double)hz / MHZ);
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+
+    check_calibration(10 * MHZ, 80 * MHZ, 60 * MHZ);
+    check_calibration(10 * MHZ, 80 * MHZ, 30 * MHZ);
+    check_calibration(10 * MHZ, 80 * MHZ, 12 * MHZ);
+    check_calibration(10 * MHZ, 80 * MHZ, 0);
+    check_calibration(20 * MHZ, 30 * MHZ, 60 * MHZ);
+    check_calibration(12 * MHZ, 80 * MHZ, 60 * MHZ);
+
+    // No 80 MHz / n clock between 12 and 13 MHz
+    mp_obj_exception_t *exc = mp_host_call_catch(NULL, display, "calibrate_clock", 2, int_obj(12 * MHZ), int_obj(13 * MHZ));
+    CHECK(exc != NULL);
+
+    // Without DMA memory nothing is tried and the clock stays
+    mp_int_t before = mp_obj_get_int(mp_host_call(display, "pclk", 0));
+    sim_heap_fail_after(0);
+    CHECK_EQ(mp_obj_get_int(mp_host_call(display, "calibrate_clock", 0)), 0);
+    sim_heap_fail_after(-1);
+    CHECK_EQ(mp_obj_get_int(mp_host_call(display, "pclk", 0)), before);
+
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("calibrate: ok\n");
+    return 0;
+}
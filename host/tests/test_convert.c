@@ -0,0 +1,160 @@
+/*
+ * The streaming converter of spd2010_pixels: every source format to every
+ * panel format against a per pixel reference, all 256 RGB332 codes and all
+ * 65536 RGB565 values, then its throughput over full 412x412 frames.
+ * Reports source and panel MB/s for each pair
+ */
+
+#include <string.h>
+#include <time.h>
+#include "spd2010_pixels.h"
+#include "test.h"
+
+#define WIDTH       412
+#define HEIGHT      412
+#define BENCH_NS    (50 * 1000 * 1000)
+
+static uint8_t src[WIDTH * HEIGHT * 4];
+static uint8_t dst[WIDTH * HEIGHT * 3];
+static uint8_t expect[65536 * 3];
+
+static int src_bytes(int format) {
+    return format == SRC_FORMAT_RGB332 ? 1 : format == SRC_FORMAT_RGB565 ? 2 : 4;
+}
+
+static int panel_bytes(int bpp) {
+    return bpp == 16 ? 2 : 3;
+}
+
+// Bits replicated into the low bits, 0 stays 0 and full stays 255
+static uint8_t widen(unsigned int v, int bits) {
+    return (uint8_t)((v << (8 - bits)) | (v >> (2 * bits - 8)));
+}
+
+// One panel pixel from 8-bit channels: RGB565 big endian or R, G, B
+static uint8_t *put_rgb(uint8_t *d, uint8_t r, uint8_t g, uint8_t b, int bpp) {
+    if (bpp == 16) {
+        uint16_t c = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        *d++ = c >> 8;
+        *d++ = c & 0xFF;
+    } else {
+        *d++ = r;
+        *d++ = g;
+        *d++ = b;
+    }
+    return d;
+}
+
+static uint8_t *put_rgb565(uint8_t *d, uint16_t c, int bpp) {
+    if (bpp == 16) {
+        *d++ = c >> 8;
+        *d++ = c & 0xFF;
+        return d;
+    }
+    return put_rgb(d, widen(c >> 11, 5), widen((c >> 5) & 0x3F, 6), widen(c & 0x1F, 5), bpp);
+}
+
+static void check_row(const uint8_t *in, int width, int format, int bpp, const char *what) {
+    memset(dst, 0xA5, (size_t)(width + 1) * 3);
+    pixels_convert_row(dst, in, width, format, bpp);
+    size_t len = (size_t)width * panel_bytes(bpp);
+    if (memcmp(dst, expect, len) != 0) {
+        for (size_t i = 0; i < len; i++) {
+            if (dst[i] != expect[i]) {
+                fprintf(stderr, "convert: %s to %d bpp, pixel %zu byte %zu: %02x, expected %02x\n",
+                    what, bpp, i / panel_bytes(bpp), i % panel_bytes(bpp), dst[i], expect[i]);
+                break;
+            }
+        }
+        CHECK(!"exact conversion");
+    }
+    // Nothing written past the row
+    CHECK_EQ(dst[len], 0xA5);
+}
+
+static void check_rgb332(int bpp) {
+    uint8_t *e = expect;
+    for (int i = 0; i < 256; i++) {
+        src[i] = (uint8_t)i;
+        e = put_rgb(e, (i >> 5) * 255 / 7, ((i >> 2) & 0x07) * 255 / 7, (i & 0x03) * 85, bpp);
+    }
+    check_row(src, 256, SRC_FORMAT_RGB332, bpp, "RGB332");
+    // An odd width
+    check_row(src, 255, SRC_FORMAT_RGB332, bpp, "RGB332");
+}
+
+static void check_rgb565(int bpp) {
+    uint16_t *in = (uint16_t *)src;
+    uint8_t *e = expect;
+    for (int i = 0; i < 65536; i++) {
+        in[i] = (uint16_t)i;
+        e = put_rgb565(e, (uint16_t)i, bpp);
+    }
+    check_row(src, 65536, SRC_FORMAT_RGB565, bpp, "RGB565");
+    check_row(src, 1, SRC_FORMAT_RGB565, bpp, "RGB565");
+}
+
+static void check_argb8888(int bpp) {
+    uint8_t *e = expect;
+    for (int i = 0; i < 65536; i++) {
+        uint8_t b = i * 7, g = i >> 8, r = i * 13 + (i >> 8);
+        src[i * 4 + 0] = b;
+        src[i * 4 + 1] = g;
+        src[i * 4 + 2] = r;
+        src[i * 4 + 3] = (uint8_t)i;
+        e = put_rgb(e, r, g, b, bpp);
+    }
+    check_row(src, 65536, SRC_FORMAT_ARGB8888, bpp, "ARGB8888");
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Whole frames row by row, as the flush streams them, for at least BENCH_NS
+static void bench(int format, int bpp, const char *name) {
+    for (size_t i = 0; i < sizeof(src); i++) {
+        src[i] = (uint8_t)(i * 131 + (i >> 9));
+    }
+    size_t src_row = (size_t)WIDTH * src_bytes(format);
+    size_t dst_row = (size_t)WIDTH * panel_bytes(bpp);
+    uint64_t frames = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        for (int y = 0; y < HEIGHT; y++) {
+            pixels_convert_row(dst + y * dst_row, src + y * src_row, WIDTH, format, bpp);
+        }
+        frames++;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    double seconds = elapsed / 1e9;
+    double pixels = (double)frames * WIDTH * HEIGHT;
+    printf("convert: %-8s to %d bpp: %7.1f MB/s in, %7.1f MB/s out, %6.1f Mpixel/s\n", name, bpp,
+        pixels * src_bytes(format) / seconds / 1e6, pixels * panel_bytes(bpp) / seconds / 1e6,
+        pixels / seconds / 1e6);
+}
+
+int main(void) {
+    static const int panel_bpps[] = { 16, 18, 24 };
+
+    pixels_init();
+    for (size_t i = 0; i < sizeof(panel_bpps) / sizeof(panel_bpps[0]); i++) {
+        int bpp = panel_bpps[i];
+        check_rgb332(bpp);
+        check_rgb565(bpp);
+        check_argb8888(bpp);
+    }
+
+    bench(SRC_FORMAT_RGB332, 16, "RGB332");
+    bench(SRC_FORMAT_RGB332, 24, "RGB332");
+    bench(SRC_FORMAT_RGB565, 16, "RGB565");
+    bench(SRC_FORMAT_RGB565, 24, "RGB565");
+    bench(SRC_FORMAT_ARGB8888, 16, "ARGB8888");
+    bench(SRC_FORMAT_ARGB8888, 24, "ARGB8888");
+
+    printf("convert: ok\n");
+    return 0;
+}
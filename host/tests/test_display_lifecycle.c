@@ -0,0 +1,155 @@
+/*
+ * Display object lifecycle: thousands of init/deinit cycles leave no panel IO,
+ * bus or memory behind, init is idempotent, and the static Display survives a
+ * soft reset with its handles
+ */
+
+#include <malloc.h>
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define CYCLES      2000
+#define BATCH       100
+#define SRC_RGB332  8
+#define SRC_RGB565  16
+
+static board_t board;
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static sim_lcd_stats_t lcd_stats(void) {
+    sim_lcd_stats_t s;
+    sim_lcd_get_stats(&s);
+    return s;
+}
+
+static mp_obj_t new_display(void) {
+    mp_obj_t module = mp_host_import("spd2010_display");
+    return mp_host_new(mp_host_attr(module, "Display"), 0, NULL);
+}
+
+// The top left 32x32, enough to see the panel take it
+static void fill(mp_obj_t display, uint16_t color) {
+    mp_host_call(display, "fill_rect", 5, int_obj(0), int_obj(0), int_obj(31), int_obj(31), int_obj(color));
+    mp_host_call(mp_host_import("spd2010_display"), "LCD_waitIdle", 0);
+    sim_lcd_drain();
+}
+
+// One cycle: cold or warm init, draw, deinit. Everything released after it
+static void cycle(mp_obj_t display, int i) {
+    mp_obj_t warm = (i & 1) ? mp_const_true : mp_const_false;
+    CHECK(mp_host_call(display, "init", 1, warm) == mp_const_true);
+    // Again: no second bus, IO or panel
+    CHECK(mp_host_call(display, "init", 1, warm) == mp_const_true);
+    CHECK_EQ(lcd_stats().ios, 1);
+    CHECK(lcd_stats().bus_initialized);
+    if (i % 10 == 0) {
+        fill(display, i);
+        CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 7, 7), (uint16_t)i);
+    }
+    mp_host_call(display, "deinit", 0);
+    CHECK(mp_host_call(display, "initialized", 0) == mp_const_false);
+    CHECK_EQ(lcd_stats().ios, 0);
+    CHECK(!lcd_stats().bus_initialized);
+}
+
+static void test_cycles(void) {
+    // The first batch allocates what stays for good: stdio buffers, module tables
+    mp_host_soft_reset();
+    size_t blocks = mp_host_heap_blocks();
+    mp_obj_t display = new_display();
+    for (int i = 0; i < BATCH; i++) {
+        cycle(display, i);
+    }
+    mp_host_soft_reset();
+    CHECK_EQ(mp_host_heap_blocks(), blocks);
+    size_t baseline = mallinfo2().uordblks;
+
+    for (int i = BATCH; i < CYCLES; i += BATCH) {
+        display = new_display();
+        for (int j = i; j < i + BATCH; j++) {
+            cycle(display, j);
+        }
+        mp_host_soft_reset();
+    }
+    size_t used = mallinfo2().uordblks;
+    printf("cycles: %d, heap %zu -> %zu bytes\n", CYCLES, baseline, used);
+    CHECK(used <= baseline);
+    CHECK_EQ(mp_host_heap_blocks(), blocks);
+}
+
+// A failed init and failing allocations leave nothing behind either
+static void test_failures(void) {
+    mp_host_soft_reset();
+    size_t baseline = mallinfo2().uordblks;
+    mp_obj_t module = mp_host_import("spd2010_display");
+    mp_obj_t display = new_display();
+    mp_obj_t pclk = mp_host_attr(module, "LCD_SPI_CLK_HZ");
+    static uint8_t rgb332[16 * 16];
+
+    for (int i = 0; i < BATCH; i++) {
+        // No panel IO at 0 Hz: init stops after the bus
+        CHECK(mp_host_call(display, "init", 2, mp_const_false, int_obj(0)) == mp_const_false);
+        mp_host_call(display, "deinit", 0);
+        CHECK_EQ(lcd_stats().ios, 0);
+        CHECK(!lcd_stats().bus_initialized);
+
+        // Neither the fill buffer nor the converter buffers can be had
+        CHECK(mp_host_call(display, "init", 2, mp_const_false, pclk) == mp_const_true);
+        sim_heap_fail_after(0);
+        fill(display, 0xFFFF);
+        mp_host_call(display, "color_format", 1, int_obj(SRC_RGB332));
+        mp_host_call(display, "add_window", 5, int_obj(0), int_obj(0), int_obj(15), int_obj(15),
+            mp_obj_new_bytearray(sizeof(rgb332), rgb332));
+        mp_host_call(display, "color_format", 1, int_obj(SRC_RGB565));
+        sim_heap_fail_after(-1);
+        mp_host_call(display, "deinit", 0);
+        CHECK_EQ(lcd_stats().ios, 0);
+    }
+    mp_host_soft_reset();
+    size_t used = mallinfo2().uordblks;
+    printf("failures: heap %zu -> %zu bytes\n", baseline, used);
+    CHECK(used <= baseline);
+}
+
+// Ctrl-D keeps the static Display with its handles: no new panel IO, no
+// init sequence, and drawing goes on where it was
+static void test_soft_reset(void) {
+    mp_obj_t display = new_display();
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    fill(display, 0x07E0);
+    uint32_t resets = board.panel.resets;
+
+    mp_host_soft_reset();
+
+    mp_obj_t again = new_display();
+    CHECK(again == display);
+    CHECK(mp_host_call(again, "initialized", 0) == mp_const_true);
+    CHECK(mp_host_call(again, "init", 0) == mp_const_true);
+    CHECK_EQ(lcd_stats().ios, 1);
+    CHECK_EQ(board.panel.resets, resets);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 20, 20), 0x07E0);
+
+    fill(again, 0x001F);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 20, 20), 0x001F);
+    mp_host_call(again, "deinit", 0);
+    CHECK_EQ(lcd_stats().ios, 0);
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+
+    test_cycles();
+    test_failures();
+    test_soft_reset();
+
+    board_deinit(&board);
+    printf("display lifecycle: ok\n");
+    return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * fill_rect: every pixel of the rectangle and none outside it, one color
+ * transfer per panel line out of a fill buffer of one line, allocated once
+ */
+
+#include <malloc.h>
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define FILL_BUF_BYTES  (PANEL_WIDTH * 3)
+
+static board_t board;
+static mp_obj_t display;
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+// fill_rect() and the transfers it queued, ends inclusive as in the Python API
+static void fill(int x0, int y0, int x1, int y1, uint16_t color, sim_lcd_stats_t *used) {
+    sim_lcd_stats_t before;
+    sim_lcd_get_stats(&before);
+    mp_host_call(display, "fill_rect", 5, int_obj(x0), int_obj(y0), int_obj(x1), int_obj(y1), int_obj(color));
+    sim_lcd_drain();
+    sim_lcd_get_stats(used);
+    used->colors_queued -= before.colors_queued;
+    used->color_bytes -= before.color_bytes;
+}
+
+static void check_screen(int x0, int y0, int x1, int y1, uint16_t inside, uint16_t outside) {
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        for (int x = 0; x < PANEL_WIDTH; x++) {
+            bool in = x >= x0 && x <= x1 && y >= y0 && y <= y1;
+            CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, x, y), in ? inside : outside);
+        }
+    }
+}
+
+int main(void) {
+    sim_lcd_stats_t used;
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+
+    // Full clear: the buffer is allocated by the first fill, one transfer per line
+    size_t heap_before = mallinfo2().uordblks;
+    fill(0, 0, PANEL_WIDTH - 1, PANEL_HEIGHT - 1, 0x1234, &used);
+    size_t allocated = mallinfo2().uordblks - heap_before;
+    CHECK(allocated >= FILL_BUF_BYTES);
+    CHECK(allocated <= FILL_BUF_BYTES + 32);
+    CHECK_EQ(used.colors_queued, PANEL_HEIGHT);
+    CHECK_EQ(used.color_bytes, (uint64_t)PANEL_WIDTH * PANEL_HEIGHT * 2);
+    check_screen(0, 0, PANEL_WIDTH - 1, PANEL_HEIGHT - 1, 0x1234, 0);
+
+    // A narrower rectangle packs several rows into a transfer, the buffer stays
+    heap_before = mallinfo2().uordblks;
+    fill(10, 20, 109, 219, 0xF81F, &used);
+    CHECK_EQ(mallinfo2().uordblks, heap_before);
+    CHECK_EQ(used.colors_queued, (100 * 200 + PANEL_WIDTH - 1) / PANEL_WIDTH);
+    CHECK_EQ(used.color_bytes, (uint64_t)100 * 200 * 2);
+    check_screen(10, 20, 109, 219, 0xF81F, 0x1234);
+
+    // Clipped to the panel
+    fill(-5, -5, PANEL_WIDTH + 5, 0, 0x07E0, &used);
+    CHECK_EQ(used.colors_queued, 1);
+    CHECK_EQ(used.color_bytes, (uint64_t)PANEL_WIDTH * 2);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 0, 0), 0x07E0);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, PANEL_WIDTH - 1, 0), 0x07E0);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 0, 1), 0x1234);
+
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("fill rect: %u transfers for a full clear, %zu bytes of fill buffer\n", PANEL_HEIGHT, allocated);
+    printf("fill rect: ok\n");
+    return 0;
+}
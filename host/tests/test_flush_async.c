@@ -0,0 +1,221 @@
+/*
+ * add_window_async: flags set once the transfers are out, a bounded wait, and
+ * a queue that forgets the flushes of the old heap at deinit and soft reset.
+ * The converter and the RLE blit give up on a stopped bus instead of
+ * spinning forever, a Flush of such a window reports the error
+ */
+
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include "models.h"
+#include "mphost.h"
+#include "py/mperrno.h"
+#include "test.h"
+
+#define FLUSHES     8
+#define SIDE        16
+#define SRC_RGB332  8
+#define SRC_RGB565  16
+#define STALL_MS    1000        // FLUSH_WAIT_MS of the module
+
+static board_t board;
+static uint16_t pixels[SIDE * SIDE];
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static mp_obj_t new_display(void) {
+    mp_obj_t module = mp_host_import("spd2010_display");
+    return mp_host_new(mp_host_attr(module, "Display"), 0, NULL);
+}
+
+// Window i of a row along the top edge
+static mp_obj_t add_async(mp_obj_t display, int i, mp_obj_t flag) {
+    mp_obj_t buf = mp_obj_new_bytearray(sizeof(pixels), pixels);
+    return mp_host_call(display, "add_window_async", 6, int_obj(i * SIDE), int_obj(0),
+        int_obj(i * SIDE + SIDE - 1), int_obj(SIDE - 1), buf, flag);
+}
+
+// More flushes than the queue holds and the scheduler takes: every flag is set once
+static void test_flags(mp_obj_t display) {
+    mp_obj_t flags[FLUSHES];
+    mp_obj_t flushes[FLUSHES];
+    for (int i = 0; i < FLUSHES; i++) {
+        flags[i] = mp_host_new_flag();
+        flushes[i] = add_async(display, i, flags[i]);
+    }
+    for (int i = 0; i < FLUSHES; i++) {
+        CHECK(mp_host_call(flushes[i], "wait", 0) == mp_const_true);
+        CHECK(mp_host_call(flushes[i], "done", 0) == mp_const_true);
+    }
+    mp_handle_pending(true);
+    for (int i = 0; i < FLUSHES; i++) {
+        CHECK_EQ(mp_host_flag_count(flags[i]), 1);
+    }
+    CHECK_EQ(mp_host_sched_pending(), 0);
+}
+
+// With the bus stopped wait() gives up. Only one flush fits: the next
+// window's parameters would wait for the bus
+static void test_timeout(mp_obj_t display) {
+    sim_lcd_hold(true);
+    mp_obj_t flush = add_async(display, 0, mp_const_none);
+    uint64_t start = sim_clock_now();
+    CHECK(mp_host_call(flush, "wait", 1, int_obj(50)) == mp_const_false);
+    CHECK(sim_clock_now() - start >= 50 * 1000);
+    CHECK(mp_host_call(flush, "done", 0) == mp_const_false);
+
+    sim_lcd_hold(false);
+    CHECK(mp_host_call(flush, "wait", 0) == mp_const_true);
+    CHECK(mp_host_call(flush, "done", 0) == mp_const_true);
+}
+
+// Time goes on for a CPU spinning on the bus, the virtual clock only with a sleep
+static volatile bool spinning;
+static void *clock_thread(void *arg) {
+    while (spinning) {
+        sim_sleep_us(10 * 1000);
+    }
+    return NULL;
+}
+
+// A window through the converter with the bus stopped: once its buffers are
+// all queued, the next row waits for the done interrupt only so long
+static void stall_begin(pthread_t *clock) {
+    sim_lcd_hold(true);
+    spinning = true;
+    pthread_create(clock, NULL, clock_thread, NULL);
+}
+
+static void stall_end(pthread_t clock) {
+    spinning = false;
+    pthread_join(clock, NULL);
+    sim_lcd_hold(false);
+    sim_lcd_drain();
+}
+
+static void test_convert_stall(mp_obj_t display) {
+    static uint8_t rgb332[SIDE * SIDE];
+    CHECK(mp_host_call(display, "color_format", 1, int_obj(SRC_RGB332)) == mp_const_true);
+    pthread_t clock;
+    stall_begin(&clock);
+    uint64_t start = sim_clock_now();
+    mp_obj_t buf = mp_obj_new_bytearray(sizeof(rgb332), rgb332);
+    mp_host_call(display, "add_window", 5, int_obj(0), int_obj(0), int_obj(SIDE - 1), int_obj(SIDE - 1), buf);
+    CHECK(sim_clock_now() - start >= STALL_MS * 1000);
+    stall_end(clock);
+
+    CHECK(mp_host_call(display, "color_format", 1, int_obj(SRC_RGB565)) == mp_const_true);
+    test_flags(display);
+}
+
+// A window the converter gave up on still completes: its flag is set, and
+// done() and wait() raise OSError(EIO) instead of reporting it sent
+static void test_async_stall(mp_obj_t display) {
+    static uint8_t rgb332[SIDE * SIDE];
+    CHECK(mp_host_call(display, "color_format", 1, int_obj(SRC_RGB332)) == mp_const_true);
+    mp_obj_t flag = mp_host_new_flag();
+    mp_obj_t buf = mp_obj_new_bytearray(sizeof(rgb332), rgb332);
+    pthread_t clock;
+    stall_begin(&clock);
+    mp_obj_t flush = mp_host_call(display, "add_window_async", 6, int_obj(0), int_obj(0),
+        int_obj(SIDE - 1), int_obj(SIDE - 1), buf, flag);
+    stall_end(clock);
+
+    mp_obj_exception_t *exc = mp_host_call_catch(NULL, flush, "wait", 0);
+    CHECK(exc != NULL);
+    CHECK_EQ(exc->errno_, MP_EIO);
+    exc = mp_host_call_catch(NULL, flush, "done", 0);
+    CHECK(exc != NULL);
+    CHECK_EQ(exc->errno_, MP_EIO);
+    mp_handle_pending(true);
+    CHECK_EQ(mp_host_flag_count(flag), 1);
+
+    CHECK(mp_host_call(display, "color_format", 1, int_obj(SRC_RGB565)) == mp_const_true);
+    test_flags(display);
+}
+
+// The same for the rows of an RLE image, SIDE x SIDE of a single run each
+static void test_rle_stall(mp_obj_t display) {
+    uint8_t rle[8 + SIDE * 3];
+    memcpy(rle, "RL16", 4);
+    rle[4] = SIDE;
+    rle[5] = 0;
+    rle[6] = SIDE;
+    rle[7] = 0;
+    for (int y = 0; y < SIDE; y++) {
+        rle[8 + y * 3] = 0x80 | (SIDE - 1);
+        rle[8 + y * 3 + 1] = 0xF8;
+        rle[8 + y * 3 + 2] = 0x00;
+    }
+    mp_obj_t data = mp_obj_new_bytes(rle, sizeof(rle));
+
+    pthread_t clock;
+    stall_begin(&clock);
+    uint64_t start = sim_clock_now();
+    CHECK(mp_host_call(display, "blit_rle", 3, int_obj(0), int_obj(0), data) == mp_const_false);
+    CHECK(sim_clock_now() - start >= STALL_MS * 1000);
+    stall_end(clock);
+
+    CHECK(mp_host_call(display, "blit_rle", 3, int_obj(0), int_obj(0), data) == mp_const_true);
+    test_flags(display);
+}
+
+// Deinit sets the flag of what was queued, the next init starts empty
+static void test_deinit(mp_obj_t display) {
+    mp_obj_t flag = mp_host_new_flag();
+    sim_lcd_hold(true);
+    add_async(display, 0, flag);
+    sim_lcd_hold(false);
+    mp_host_call(display, "deinit", 0);
+    mp_handle_pending(true);
+    CHECK_EQ(mp_host_flag_count(flag), 1);
+
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    test_flags(display);
+}
+
+// Ctrl-D with a flush queued: its transfers finish in the new heap without
+// scheduling the flag of the old one, and the queue takes new flushes
+static void test_soft_reset(mp_obj_t display) {
+    sim_lcd_hold(true);
+    add_async(display, 0, mp_host_new_flag());
+    mp_host_soft_reset();
+    sim_lcd_hold(false);
+    sim_lcd_drain();
+    CHECK_EQ(mp_host_sched_pending(), 0);
+
+    display = new_display();
+    CHECK(mp_host_call(display, "initialized", 0) == mp_const_true);
+    test_flags(display);
+    mp_host_call(display, "deinit", 0);
+}
+
+int main(void) {
+    // A wait that never ends fails the test instead of hanging it
+    alarm(60);
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    for (int i = 0; i < SIDE * SIDE; i++) {
+        pixels[i] = i * 37;
+    }
+
+    mp_obj_t display = new_display();
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    test_flags(display);
+    test_timeout(display);
+    test_convert_stall(display);
+    test_async_stall(display);
+    test_rle_stall(display);
+    test_deinit(display);
+    test_soft_reset(display);
+
+    board_deinit(&board);
+    printf("flush async: ok\n");
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * Full-frame draw buffer at LV_COLOR_DEPTH 16: the panel reads the frame
+ * straight from LVGL's only buffer. Once flush ready, LVGL draws into it
+ * again; a buffer handed back before its DMA is done shows up as the
+ * scribbled colour on the panel
+ */
+
+#include <string.h>
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define FRAMES      3
+
+static board_t board;
+static void (*panel_flush)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color);
+
+// LVGL's next frame, drawn as soon as the buffer is back
+static void scribbling_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color) {
+    panel_flush(drv, area, color);
+    if (!drv->draw_buf->flushing) {
+        memset(color, 0, lv_area_get_size(area) * sizeof(lv_color_t));
+    }
+}
+
+static void check_screen(uint16_t color) {
+    for (int y = 0; y < PANEL_HEIGHT; y += 7) {
+        if (y > PANEL_HEIGHT / 2 - 20 && y < PANEL_HEIGHT / 2 + 20) {
+            continue;   // the driver's label
+        }
+        for (int x = 0; x < PANEL_WIDTH; x += 7) {
+            CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, x, y), color);
+        }
+    }
+}
+
+int main(void) {
+    static const uint32_t colors[] = { 0xFF0000, 0x00FF00, 0x0000FF };
+    static const uint16_t rgb565[] = { 0xF800, 0x07E0, 0x001F };
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, MP_OBJ_NEW_SMALL_INT(0x00));
+    mp_obj_t display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_obj_t lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    CHECK(mp_host_attr(lvgl, "BUFFER_COUNT") == MP_OBJ_NEW_SMALL_INT(1));
+
+    lv_disp_drv_t *drv = lv_disp_get_default()->driver;
+    panel_flush = drv->flush_cb;
+    drv->flush_cb = scribbling_flush;
+
+    for (int i = 0; i < FRAMES; i++) {
+        lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(colors[i]), 0);
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(30 * 1000);
+        mp_host_call(lvgl, "loop", 0);
+        mp_host_call(display_mod, "LCD_waitIdle", 0);
+        sim_lcd_drain();
+        check_screen(rgb565[i]);
+    }
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("full frame: ok\n");
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Golden image of a scene drawn through spd2010_display
+ *
+ * test_golden OUTDIR writes what the panel model received (scene_panel.ppm)
+ * and the module's own LCD_snapshot (scene_snapshot.ppm). CTest compares
+ * both with tests/golden/display_scene.ppm using tools/frame_compare.py.
+ * scene_altered.ppm differs in one pixel, its comparison has to fail.
+ */
+
+#include <string.h>
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define SRC_RGB332  8
+#define SRC_RGB565  16
+
+static board_t board;
+static char path[4096];
+
+static const char *out_path(const char *dir, const char *name) {
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    return path;
+}
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static void add_window(mp_obj_t display, int x0, int y0, int x1, int y1, const void *pixels, size_t len) {
+    mp_obj_t buf = mp_obj_new_bytearray(len, pixels);
+    mp_host_call(display, "add_window", 5, int_obj(x0), int_obj(y0), int_obj(x1), int_obj(y1), buf);
+}
+
+// 40x40 in the format of tools/rle_encode.py: per row a run of 20, then 20 literals
+static size_t make_rle(uint8_t *out) {
+    uint8_t *p = out;
+    memcpy(p, "RL16", 4);
+    p += 4;
+    *p++ = 40;
+    *p++ = 0;
+    *p++ = 40;
+    *p++ = 0;
+    for (int y = 0; y < 40; y++) {
+        uint16_t run = (y & 8) ? 0xFFE0 : 0x07FF;
+        *p++ = 0x80 | 19;
+        *p++ = run >> 8;
+        *p++ = run & 0xFF;
+        *p++ = 19;
+        for (int x = 0; x < 20; x++) {
+            uint16_t c = ((x * 3) << 11) | ((y + x) << 5) | (y & 0x1F);
+            *p++ = c >> 8;
+            *p++ = c & 0xFF;
+        }
+    }
+    return p - out;
+}
+
+static void draw_scene(mp_obj_t display) {
+    static uint16_t gradient[128 * 128];
+    static uint8_t rgb332[64 * 64];
+    static uint8_t rle[8 + 40 * (3 + 1 + 40)];
+
+    mp_host_call(display, "fill_rect", 5, int_obj(0), int_obj(0), int_obj(411), int_obj(411), int_obj(0x0010));
+    mp_host_call(display, "fill_rect", 5, int_obj(0), int_obj(200), int_obj(411), int_obj(211), int_obj(0xF800));
+
+    // RGB565 as LVGL hands it over, native byte order
+    for (int y = 0; y < 128; y++) {
+        for (int x = 0; x < 128; x++) {
+            gradient[y * 128 + x] = ((x >> 2) << 11) | ((y >> 1) << 5) | ((x + y) >> 3);
+        }
+    }
+    add_window(display, 20, 20, 147, 147, gradient, sizeof(gradient));
+
+    // RGB332 through the converter
+    for (int i = 0; i < 64 * 64; i++) {
+        rgb332[i] = (i / 64) * 4 + (i % 64) / 16;
+    }
+    mp_host_call(display, "color_format", 1, int_obj(SRC_RGB332));
+    add_window(display, 300, 30, 363, 93, rgb332, sizeof(rgb332));
+    mp_host_call(display, "color_format", 1, int_obj(SRC_RGB565));
+
+    size_t len = make_rle(rle);
+    mp_obj_t data = mp_obj_new_bytes(rle, len);
+    CHECK(mp_host_call(display, "blit_rle", 3, int_obj(186), int_obj(230), data) == mp_const_true);
+
+    // Hardware scroll of the bottom band, the visible image wraps within it
+    CHECK(mp_host_call(display, "scroll_area", 2, int_obj(280), int_obj(100)) == mp_const_true);
+    mp_host_call(display, "fill_rect", 5, int_obj(0), int_obj(280), int_obj(411), int_obj(379), int_obj(0x4208));
+    mp_host_call(display, "fill_rect", 5, int_obj(0), int_obj(280), int_obj(411), int_obj(289), int_obj(0xFFFF));
+    mp_host_call(display, "scroll", 1, int_obj(30));
+}
+
+int main(int argc, char **argv) {
+    CHECK(argc == 2);
+    const char *dir = argv[1];
+
+    mp_host_init();
+    board_init(&board);
+    mp_obj_t i2c = mp_host_import("i2c_driver");
+    mp_obj_t tca = mp_host_import("tca9554");
+    mp_obj_t display_mod = mp_host_import("spd2010_display");
+    mp_host_call(i2c, "init", 0);
+    mp_host_call(tca, "TCA9554PWR_Init", 1, int_obj(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(display_mod, "LCD_shadow", 1, mp_const_true) == mp_const_true);
+
+    draw_scene(display);
+    mp_host_call(display_mod, "LCD_waitIdle", 0);
+    sim_lcd_drain();
+
+    // What reached the panel
+    FILE *f = fopen(out_path(dir, "scene_panel.ppm"), "wb");
+    CHECK(f != NULL);
+    CHECK(panel_model_write_ppm(&board.panel, f));
+    fclose(f);
+
+    // What the module's shadow made of the same traffic
+    mp_obj_t out = mp_host_new_bytesio();
+    mp_int_t crc = mp_obj_get_int(mp_host_call(display, "snapshot", 1, out));
+    CHECK_EQ((uint32_t)crc, panel_model_crc32(&board.panel));
+    size_t len;
+    const uint8_t *ppm = mp_host_bytesio_data(out, &len);
+    f = fopen(out_path(dir, "scene_snapshot.ppm"), "wb");
+    CHECK(f != NULL);
+    CHECK(fwrite(ppm, 1, len, f) == len);
+    fclose(f);
+
+    // One pixel off: the comparison has to notice
+    uint8_t *altered = malloc(len);
+    memcpy(altered, ppm, len);
+    altered[len - 3 * (PANEL_WIDTH * 10 + 7)] ^= 0x80;
+    f = fopen(out_path(dir, "scene_altered.ppm"), "wb");
+    CHECK(f != NULL);
+    CHECK(fwrite(altered, 1, len, f) == len);
+    fclose(f);
+    free(altered);
+
+    mp_host_call(display_mod, "LCD_shadow", 1, mp_const_false);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("golden: frames written to %s, crc %08x\n", dir, (unsigned)crc);
+    return 0;
+}
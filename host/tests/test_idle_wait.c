@@ -0,0 +1,109 @@
+/*
+ * wait() on the virtual clock: a loop of loop() and wait() wakes up only when
+ * an LVGL timer is due or something is invalid, counted per idle second. The
+ * deadline is taken with the LVGL lock, so wait() keeps out of LVGL while
+ * another task holds it
+ */
+
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define SECOND_MS   1000
+#define TIMER_MS    100
+#define HOLD_MS     50
+
+static board_t board;
+static mp_obj_t lvgl;
+static mp_obj_t lock;
+static volatile bool held;
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static void pause_ms(int ms) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+}
+
+static void timer_cb(lv_timer_t *timer) {
+}
+
+// Returns of wait() in a second of loop() and wait()
+static int wakeups_per_second(void) {
+    uint64_t end = sim_clock_now() + SECOND_MS * 1000;
+    int wakeups = 0;
+    while (sim_clock_now() < end) {
+        mp_host_call(lvgl, "loop", 0);
+        mp_int_t left = (mp_int_t)((end - sim_clock_now()) / 1000);
+        mp_host_call(lvgl, "wait", 1, int_obj(left));
+        wakeups++;
+    }
+    return wakeups;
+}
+
+// Another core holding the LVGL lock for HOLD_MS
+static void holder(void *arg) {
+    mp_obj_t timeout = int_obj(-1);
+    CHECK(mp_call_function_n_kw(lock, 1, 0, &timeout) == mp_const_true);
+    held = true;
+    pause_ms(HOLD_MS);
+    mp_call_function_0(mp_host_attr(lvgl, "unlock"));
+    vTaskDelete(NULL);
+}
+
+int main(void) {
+    // A deadlock fails the test instead of hanging it
+    alarm(60);
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    lock = mp_host_attr(lvgl, "lock");
+    for (int i = 0; i < 5; i++) {
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(30 * 1000);
+    }
+
+    // Nothing to do: the refresh and touch read timers do not count
+    int idle = wakeups_per_second();
+    CHECK(idle <= 2);
+
+    // A timer wakes wait() at its period, and only then
+    lv_timer_t *timer = lv_timer_create(timer_cb, TIMER_MS, NULL);
+    int timed = wakeups_per_second();
+    CHECK(timed >= SECOND_MS / TIMER_MS - 1 && timed <= SECOND_MS / TIMER_MS + 2);
+    lv_timer_del(timer);
+
+    // Something invalid: back for the next refresh
+    lv_obj_invalidate(lv_scr_act());
+    uint64_t start = sim_clock_now();
+    mp_host_call(lvgl, "wait", 1, int_obj(SECOND_MS));
+    CHECK(sim_clock_now() - start <= (LV_DISP_DEF_REFR_PERIOD + 2) * 1000);
+    mp_host_call(lvgl, "loop", 0);
+
+    // The deadline waits for the lock
+    CHECK(xTaskCreatePinnedToCore(holder, "holder", 4096, NULL, 5, NULL, 1) == pdPASS);
+    while (!held) {
+        pause_ms(1);
+    }
+    start = sim_clock_now();
+    mp_host_call(lvgl, "wait", 1, int_obj(0));
+    CHECK(sim_clock_now() - start >= (HOLD_MS - 5) * 1000);
+
+    printf("idle wait: %d wakeups per idle second, %d with a %d ms timer\n", idle, timed, TIMER_MS);
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("idle wait: ok\n");
+    return 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * Microbenchmark of the hot paths LVGL_DRIVER_IRAM and SPD2010_DISPLAY_IRAM
+ * move to IRAM: the RGB565 byte swap, checked against a plain swap at every
+ * alignment, the colour mix LVGL blends with, and whole frames through LVGL
+ * with an opaque (fill) and a half transparent (blend) screen object, their
+ * render time apart from the flush callback's. The host's LVGL stands in for
+ * LVGL's software renderer, the flush and the swap are the driver's own.
+ * Wall clock numbers, to compare between builds on the same machine
+ */
+
+#include <string.h>
+#include <time.h>
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "spd2010_pixels.h"
+#include "test.h"
+
+#define FAST_PCLK_HZ    2000000000
+#define BAND_PIXELS     (PANEL_WIDTH * PANEL_HEIGHT / 10)
+#define BENCH_NS        (50 * 1000 * 1000)
+#define FRAMES          20
+
+static board_t board;
+static mp_obj_t display_mod;
+static mp_obj_t lvgl;
+static void (*panel_flush)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color);
+static uint64_t flush_ns;
+static _Alignas(4) uint16_t band[BAND_PIXELS + 2];   // band + 1 is 2-byte aligned
+static uint16_t expect[BAND_PIXELS + 2];
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return mp_obj_new_int(v);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Every start alignment and length against one pixel at a time, nothing
+// around the pixels touched
+static void check_swap(void) {
+    for (int offset = 0; offset < 2; offset++) {
+        for (size_t size = 0; size < 12; size++) {
+            for (size_t i = 0; i < 16; i++) {
+                band[i] = expect[i] = (uint16_t)(0x1234 + i * 0x0101);
+            }
+            for (size_t i = 0; i < size; i++) {
+                uint16_t c = expect[offset + i];
+                expect[offset + i] = (c >> 8) | (c << 8);
+            }
+            pixels_swap_rgb565(band + offset, size);
+            CHECK(memcmp(band, expect, 16 * sizeof(uint16_t)) == 0);
+        }
+    }
+}
+
+static void bench_swap(int offset) {
+    uint64_t runs = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        pixels_swap_rgb565(band + offset, BAND_PIXELS);
+        runs++;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    printf("kernels: swap, %s:   %8.1f MB/s\n", offset ? "2-byte aligned" : "4-byte aligned",
+        (double)runs * BAND_PIXELS * 2 / (elapsed / 1e9) / 1e6);
+}
+
+static void bench_mix(void) {
+    lv_color_t *px = (lv_color_t *)band;
+    lv_color_t fg = lv_color_make(0x20, 0x80, 0xC0);
+    uint64_t runs = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        for (int i = 0; i < BAND_PIXELS; i++) {
+            px[i] = lv_color_mix(fg, px[i], LV_OPA_50);
+        }
+        runs++;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    printf("kernels: color mix:              %8.1f Mpixel/s\n", (double)runs * BAND_PIXELS / (elapsed / 1e9) / 1e6);
+}
+
+static void timed_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color) {
+    uint64_t start = now_ns();
+    panel_flush(drv, area, color);
+    flush_ns += now_ns() - start;
+}
+
+// FRAMES full redraws of the screen object at opa: per frame the time in
+// lvgl_driver.loop() and in the flush callback
+static void bench_frames(lv_obj_t *obj, lv_opa_t opa, const char *name) {
+    lv_obj_set_style_bg_opa(obj, opa, 0);
+    uint64_t loop_ns = 0;
+    flush_ns = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        lv_obj_set_style_bg_color(obj, lv_color_make(i * 12, 255 - i * 12, 0x40), 0);
+        sim_sleep_us(30 * 1000);
+        uint64_t start = now_ns();
+        mp_host_call(lvgl, "loop", 0);
+        loop_ns += now_ns() - start;
+        mp_host_call(display_mod, "LCD_waitIdle", 0);
+        sim_lcd_drain();
+    }
+    CHECK(flush_ns > 0 && flush_ns < loop_ns);
+    printf("kernels: frame, %-6s render %6.3f ms, flush %6.3f ms\n", name,
+        (loop_ns - flush_ns) / 1e6 / FRAMES, flush_ns / 1e6 / FRAMES);
+}
+
+int main(void) {
+    check_swap();
+    bench_swap(0);
+    bench_swap(1);
+    bench_mix();
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(display, "pclk", 1, int_obj(FAST_PCLK_HZ)) == mp_const_true);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+
+    lv_disp_drv_t *drv = lv_disp_get_default()->driver;
+    panel_flush = drv->flush_cb;
+    drv->flush_cb = timed_flush;
+    lv_obj_t *obj = lv_obj_create(lv_scr_act());
+    lv_obj_set_size(obj, PANEL_WIDTH, PANEL_HEIGHT);
+    bench_frames(obj, LV_OPA_COVER, "fill");
+    bench_frames(obj, LV_OPA_50, "blend");
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("kernels: ok\n");
+    return 0;
+}
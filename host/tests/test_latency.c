@@ -0,0 +1,304 @@
+/*
+ * Touch to photon latency: a sample is followed only when it changed the
+ * screen and only while the histogram is enabled, the oldest sample of a
+ * response is the one measured, a second response while one is on its way
+ * and a frame the bus does not finish in time are dropped. Every bucket's
+ * bounds against the value it keeps, the percentiles of a known histogram,
+ * and a button pressed through the touch model measured with latency_stats()
+ */
+
+#include <string.h>
+#include "lvgl.h"
+#include "lv_latency.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define STEP_MS     10
+#define SIDE        16
+
+static board_t board;
+static mp_obj_t display;
+static mp_obj_t lvgl;
+static lv_latency_stats_t stats;
+static uint16_t pixels[SIDE * SIDE];
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+// Loops STEP_MS apart for ms
+static void run_ms(uint32_t ms) {
+    uint64_t end = sim_clock_now() + (uint64_t)ms * 1000;
+    while (sim_clock_now() < end) {
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(STEP_MS * 1000);
+    }
+}
+
+// A sample us ago that changed the screen, in a frame of two bands
+static void respond(uint32_t us) {
+    lv_latency_sample((int64_t)sim_clock_now() - us);
+    lv_latency_input_done(true);
+    lv_latency_flush(false);
+    lv_latency_flush(true);
+}
+
+// With the bus idle the marker is stamped when the frame is queued: the
+// latency is exactly us
+static void measure(uint32_t us) {
+    respond(us);
+    lv_latency_frame_queued();
+    lv_latency_poll();
+}
+
+static void test_arming(void) {
+    // Disabled: nothing is followed
+    measure(5000);
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 0);
+    CHECK_EQ(stats.dropped, 0);
+
+    lv_latency_enable(true);
+    CHECK(lv_latency_enabled());
+    measure(5000);
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 1);
+    CHECK_EQ(stats.min_us, 5000);
+    CHECK_EQ(stats.max_us, 5000);
+    CHECK_EQ(stats.sum_us, 5000);
+
+    // A sample that changed nothing is forgotten, its frame is not measured
+    lv_latency_sample(sim_clock_now());
+    lv_latency_input_done(false);
+    lv_latency_flush(true);
+    lv_latency_frame_queued();
+    lv_latency_poll();
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 1);
+
+    // Newer samples keep the older time, before and after the tag is armed
+    lv_latency_sample(sim_clock_now());
+    sim_sleep_us(1000);
+    lv_latency_sample(sim_clock_now());
+    lv_latency_input_done(true);
+    sim_sleep_us(1000);
+    lv_latency_sample(sim_clock_now());
+    lv_latency_input_done(true);
+    sim_sleep_us(1000);
+    lv_latency_flush(true);
+    lv_latency_frame_queued();
+    lv_latency_poll();
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 2);
+    CHECK_EQ(stats.min_us, 3000);
+    CHECK_EQ(stats.max_us, 5000);
+    CHECK_EQ(stats.dropped, 0);
+    printf("latency: arming ok\n");
+}
+
+static void test_dropped(void) {
+    // A response flushed while the one before is not queued yet
+    respond(1000);
+    respond(2000);
+    lv_latency_frame_queued();
+    lv_latency_poll();
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 3);
+    CHECK_EQ(stats.dropped, 1);
+    CHECK_EQ(stats.min_us, 1000);
+
+    // The bus stopped with a window queued: the marker is not stamped, the
+    // frame is given up after the timeout, and another can be measured
+    sim_lcd_hold(true);
+    mp_obj_t buf = mp_obj_new_bytearray(sizeof(pixels), pixels);
+    mp_obj_t flush = mp_host_call(display, "add_window_async", 6, int_obj(0), int_obj(0),
+        int_obj(SIDE - 1), int_obj(SIDE - 1), buf, mp_const_none);
+    respond(1000);
+    lv_latency_frame_queued();
+    lv_latency_poll();
+    respond(1000);
+    lv_latency_poll();
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 3);
+    CHECK_EQ(stats.dropped, 2);
+    sim_sleep_us(LV_LATENCY_TIMEOUT_US + 1000);
+    lv_latency_poll();
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 3);
+    CHECK_EQ(stats.dropped, 3);
+    sim_lcd_hold(false);
+    CHECK(mp_host_call(flush, "wait", 0) == mp_const_true);
+    sim_lcd_drain();
+    measure(4000);
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 4);
+    CHECK_EQ(stats.dropped, 3);
+    printf("latency: dropped ok\n");
+}
+
+static int bucket_with(uint32_t us) {
+    lv_latency_stats_t before;
+    lv_latency_get_stats(&before);
+    measure(us);
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, before.count + 1);
+    int found = -1;
+    for (int i = 0; i < LV_LATENCY_BUCKETS; i++) {
+        if (stats.buckets[i] != before.buckets[i]) {
+            CHECK(found < 0);
+            CHECK_EQ(stats.buckets[i], before.buckets[i] + 1);
+            found = i;
+        }
+    }
+    CHECK(found >= 0);
+    return found;
+}
+
+// Buckets are contiguous, exact below LV_LATENCY_SUB_COUNT us, and each
+// keeps the values from above the bucket before up to its upper bound
+static void test_buckets(void) {
+    for (int i = 0; i < LV_LATENCY_BUCKETS; i++) {
+        uint32_t upper = lv_latency_bucket_upper(i);
+        uint32_t lower = i ? lv_latency_bucket_upper(i - 1) + 1 : 0;
+        CHECK(upper >= lower);
+        if (i < LV_LATENCY_SUB_COUNT) {
+            CHECK_EQ(upper, i);
+        }
+        // Within a power of two, about 1/LV_LATENCY_SUB_COUNT of the value
+        CHECK((upper - lower + 1) * LV_LATENCY_SUB_COUNT <= lower || i < LV_LATENCY_SUB_COUNT);
+        CHECK_EQ(bucket_with(lower), i);
+        CHECK_EQ(bucket_with(upper), i);
+    }
+    CHECK_EQ(lv_latency_bucket_upper(LV_LATENCY_BUCKETS - 1), (1u << LV_LATENCY_MAX_BITS) - 1);
+    // Beyond the range into the last bucket
+    CHECK_EQ(bucket_with(1u << LV_LATENCY_MAX_BITS), LV_LATENCY_BUCKETS - 1);
+    CHECK_EQ(bucket_with(3u << LV_LATENCY_MAX_BITS), LV_LATENCY_BUCKETS - 1);
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.max_us, 3u << LV_LATENCY_MAX_BITS);
+    lv_latency_reset();
+    lv_latency_get_stats(&stats);
+    CHECK_EQ(stats.count, 0);
+    CHECK_EQ(stats.dropped, 0);
+    printf("latency: %d buckets ok\n", LV_LATENCY_BUCKETS);
+}
+
+static void test_percentile(void) {
+    static lv_latency_stats_t s;
+    memset(&s, 0, sizeof(s));
+    CHECK_EQ(lv_latency_percentile(&s, 500), 0);
+
+    // 1 to 10 us, one sample each: the rank rounds up
+    for (uint32_t us = 1; us <= 10; us++) {
+        s.buckets[us]++;
+        s.count++;
+    }
+    s.min_us = 1;
+    s.max_us = 10;
+    CHECK_EQ(lv_latency_percentile(&s, 0), 1);
+    CHECK_EQ(lv_latency_percentile(&s, 100), 1);
+    CHECK_EQ(lv_latency_percentile(&s, 101), 2);
+    CHECK_EQ(lv_latency_percentile(&s, 500), 5);
+    CHECK_EQ(lv_latency_percentile(&s, 900), 9);
+    CHECK_EQ(lv_latency_percentile(&s, 990), 10);
+    CHECK_EQ(lv_latency_percentile(&s, 1000), 10);
+
+    // A bucket's upper bound, but never more than the largest sample
+    lv_latency_enable(true);
+    for (int i = 0; i < 99; i++) {
+        measure(1000);
+    }
+    measure(20000);
+    lv_latency_get_stats(&s);
+    uint32_t upper = lv_latency_bucket_upper(bucket_with(1000));
+    CHECK(upper > 1000 && upper < 1000 + 1000 / 8);
+    CHECK_EQ(lv_latency_percentile(&s, 500), upper);
+    CHECK_EQ(lv_latency_percentile(&s, 990), upper);
+    CHECK_EQ(lv_latency_percentile(&s, 999), 20000);
+    lv_latency_reset();
+    printf("latency: percentile ok\n");
+}
+
+// A button pressed and released through the touch model, each changing the
+// screen: both measured, within a few frames
+static void test_touch(void) {
+    lv_obj_t *btn = lv_btn_create(lv_scr_act());
+    lv_obj_set_size(btn, 120, 80);
+    lv_obj_center(btn);
+    run_ms(100);
+
+    mp_host_call(lvgl, "latency_enable", 1, mp_const_true);
+    mp_host_call(lvgl, "latency_stats", 1, mp_const_true);
+    touch_model_press(&board.touch, PANEL_WIDTH / 2, PANEL_HEIGHT / 2);
+    run_ms(200);
+    touch_model_release(&board.touch);
+    run_ms(200);
+
+    mp_obj_t r = mp_host_call(lvgl, "latency_stats", 0);
+    CHECK(mp_host_dict_lookup(r, "enabled") == mp_const_true);
+    mp_int_t count = mp_host_dict_int(r, "count");
+    mp_int_t p50 = mp_host_dict_int(r, "p50_us");
+    mp_int_t max = mp_host_dict_int(r, "max_us");
+    CHECK_EQ(count, 2);
+    CHECK_EQ(mp_host_dict_int(r, "dropped"), 0);
+    CHECK(mp_host_dict_int(r, "min_us") > 0);
+    CHECK(max < 100 * 1000);
+    CHECK(p50 >= mp_host_dict_int(r, "min_us") && p50 <= max);
+    size_t len;
+    mp_obj_t *histogram;
+    mp_obj_get_array(mp_host_dict_lookup(r, "histogram"), &len, &histogram);
+    mp_int_t total = 0;
+    for (size_t i = 0; i < len; i++) {
+        size_t n;
+        mp_obj_t *bucket;
+        mp_obj_get_array(histogram[i], &n, &bucket);
+        CHECK_EQ(n, 2);
+        total += mp_obj_get_int(bucket[1]);
+    }
+    CHECK_EQ(total, count);
+
+    // Disabled again: presses are not followed
+    mp_host_call(lvgl, "latency_enable", 1, mp_const_false);
+    touch_model_press(&board.touch, PANEL_WIDTH / 2, PANEL_HEIGHT / 2);
+    run_ms(100);
+    touch_model_release(&board.touch);
+    run_ms(100);
+    r = mp_host_call(lvgl, "latency_stats", 1, mp_const_true);
+    CHECK(mp_host_dict_lookup(r, "enabled") == mp_const_false);
+    CHECK_EQ(mp_host_dict_int(r, "count"), count);
+    CHECK_EQ(mp_host_dict_int(mp_host_call(lvgl, "latency_stats", 0), "count"), 0);
+    printf("latency: touch, %ld responses, p50 %ld us, max %ld us\n", (long)count, (long)p50, (long)max);
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_host_call(mp_host_import("spd2010_touch"), "Touch_Init", 0);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    for (int i = 0; i < 100 && board.touch.state != TOUCH_MODEL_RUN; i++) {
+        run_ms(STEP_MS);
+    }
+    CHECK_EQ(board.touch.state, TOUCH_MODEL_RUN);
+    sim_lcd_drain();
+    // Samples up to past the histogram's range before now
+    sim_sleep_us(4ull << LV_LATENCY_MAX_BITS);
+
+    // The C interface, between loops: nothing else flushes meanwhile
+    test_arming();
+    test_dropped();
+    test_buckets();
+    test_percentile();
+    lv_latency_enable(false);
+    test_touch();
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("latency: ok\n");
+    return 0;
+}
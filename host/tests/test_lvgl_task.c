@@ -0,0 +1,313 @@
+/*
+ * Native LVGL task: the touch read in C from the task, also while Python
+ * reads the controller, the lock under contention from other tasks, the
+ * stats getters waiting for it, stop_task() from inside lock(), and the frame
+ * pacing of an animation while the lock is contended
+ */
+
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define WORKERS         4
+#define WORKER_ROUNDS   25
+#define HOLD_MS         10          // a worker's time inside the lock
+#define ANIM_PERIOD_MS  50
+#define MAX_FRAMES      512
+#define TOUCH_ROUNDS    200
+
+static board_t board;
+static mp_obj_t lvgl;
+static mp_obj_t lock;
+static mp_obj_t unlock;
+
+// Holders of the LVGL lock right now, workers and the animation timer
+static int inside;
+static int workers_done;
+static volatile bool held;
+static bool readers_stop;
+static int readers_done;
+
+// End of every frame: the last flush of a refresh
+static uint64_t frame_us[MAX_FRAMES];
+static int frames;
+static void (*panel_flush)(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color);
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+// Let ms pass blocked, as a task waiting for something: the virtual clock
+// moves with the real one, so the other tasks keep up with it
+static void pause_ms(int ms) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(ms));
+}
+
+static bool take_lock(mp_int_t timeout_ms) {
+    mp_obj_t arg = int_obj(timeout_ms);
+    return mp_call_function_n_kw(lock, 1, 0, &arg) == mp_const_true;
+}
+
+static void give_lock(void) {
+    mp_call_function_0(unlock);
+}
+
+static int frame_count(void) {
+    return __atomic_load_n(&frames, __ATOMIC_ACQUIRE);
+}
+
+static void timed_flush(lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color) {
+    if (lv_disp_flush_is_last(drv) && frames < MAX_FRAMES) {
+        frame_us[frames] = sim_clock_now();
+        __atomic_add_fetch(&frames, 1, __ATOMIC_RELEASE);
+    }
+    panel_flush(drv, area, color);
+}
+
+// Pointer state as LVGL last read it
+static lv_indev_state_t touch_state(lv_point_t *point) {
+    CHECK(take_lock(-1));
+    lv_indev_t *indev = lv_indev_get_next(NULL);
+    lv_indev_state_t state = indev->proc.state;
+    *point = indev->proc.pointer.act_point;
+    give_lock();
+    return state;
+}
+
+static bool wait_touch_state(lv_indev_state_t state, lv_point_t *point) {
+    for (int i = 0; i < 100; i++) {
+        if (touch_state(point) == state) {
+            return true;
+        }
+        pause_ms(10);
+    }
+    return false;
+}
+
+// The controller is started and read by the task's input device, each frame
+// a whole register address or command
+static void test_touch(void) {
+    mp_obj_t touch = mp_host_import("spd2010_touch");
+    mp_host_call(touch, "Touch_Init", 0);
+    CHECK(mp_host_call(lvgl, "start_task", 0) == mp_const_true);
+    for (int i = 0; i < 100 && board.touch.state != TOUCH_MODEL_RUN; i++) {
+        pause_ms(10);
+    }
+    CHECK_EQ(board.touch.state, TOUCH_MODEL_RUN);
+
+    lv_point_t point;
+    touch_model_press(&board.touch, 120, 300);
+    CHECK(wait_touch_state(LV_INDEV_STATE_PR, &point));
+    CHECK_EQ(point.x, 120);
+    CHECK_EQ(point.y, 300);
+    touch_model_release(&board.touch);
+    CHECK(wait_touch_state(LV_INDEV_STATE_REL, &point));
+    CHECK_EQ(board.touch.reports_read, 2);
+    CHECK(!board.touch.int_low);
+
+    // A posted touch stands in for the panel until its release
+    mp_host_call(lvgl, "post_touch", 3, int_obj(10), int_obj(20), mp_const_true);
+    CHECK(wait_touch_state(LV_INDEV_STATE_PR, &point));
+    CHECK_EQ(point.x, 10);
+    mp_host_call(lvgl, "post_touch", 3, int_obj(10), int_obj(20), mp_const_false);
+    CHECK(wait_touch_state(LV_INDEV_STATE_REL, &point));
+
+    CHECK_EQ(board.touch.bad_frames, 0);
+}
+
+// Python code on another core polling the controller's status
+static void status_reader(void *arg) {
+    mp_obj_t touch = mp_host_import("spd2010_touch");
+    while (!__atomic_load_n(&readers_stop, __ATOMIC_ACQUIRE)) {
+        CHECK(mp_host_call(touch, "read_tp_status_length", 0) != mp_const_none);
+    }
+    __atomic_add_fetch(&readers_done, 1, __ATOMIC_ACQ_REL);
+    vTaskDelete(NULL);
+}
+
+// Python reading the controller while the task does: every register read
+// keeps its address and data together
+static void test_touch_shared(void) {
+    mp_obj_t touch = mp_host_import("spd2010_touch");
+    CHECK(xTaskCreatePinnedToCore(status_reader, "reader", 4096, NULL, 5, NULL, 1) == pdPASS);
+    for (int i = 0; i < TOUCH_ROUNDS; i++) {
+        if (i % 2 == 0) {
+            touch_model_press(&board.touch, i, PANEL_HEIGHT - 1 - i);
+        } else {
+            touch_model_release(&board.touch);
+        }
+        mp_obj_t xy = mp_host_call(touch, "Touch_Get_xy", 0);
+        if (mp_obj_is_true(mp_host_dict_lookup(xy, "pressed"))) {
+            CHECK_EQ(mp_host_dict_int(xy, "x") + mp_host_dict_int(xy, "y"), PANEL_HEIGHT - 1);
+        }
+        mp_host_call(touch, "tp_read_data", 0);
+        mp_host_call(touch, "Touch_Read_Data", 0);
+        CHECK(mp_host_call(touch, "read_tp_status_length", 0) != mp_const_none);
+    }
+    __atomic_store_n(&readers_stop, true, __ATOMIC_RELEASE);
+    while (!__atomic_load_n(&readers_done, __ATOMIC_ACQUIRE)) {
+        pause_ms(1);
+    }
+    touch_model_release(&board.touch);
+    lv_point_t point;
+    CHECK(wait_touch_state(LV_INDEV_STATE_REL, &point));
+    printf("touch shared: %u reports read, %u crossed reads\n",
+        (unsigned)board.touch.reports_read, (unsigned)board.touch.crossed_reads);
+    CHECK_EQ(board.touch.crossed_reads, 0);
+    CHECK_EQ(board.touch.bad_frames, 0);
+}
+
+// Another core holding the LVGL lock for HOLD_MS
+static void holder(void *arg) {
+    CHECK(take_lock(-1));
+    held = true;
+    pause_ms(HOLD_MS);
+    held = false;
+    give_lock();
+    vTaskDelete(NULL);
+}
+
+// The stats getters read and account under the lock, so they wait for it
+static void test_stats_locked(void) {
+    static const char *const getters[] = {
+        "power_stats", "power_state", "cache_stats", "mem_stats", "mem_info", "pipeline_stats"
+    };
+    for (size_t i = 0; i < sizeof(getters) / sizeof(getters[0]); i++) {
+        CHECK(xTaskCreatePinnedToCore(holder, "holder", 4096, NULL, 5, NULL, 1) == pdPASS);
+        while (!held) {
+            pause_ms(1);
+        }
+        mp_host_call(lvgl, getters[i], 0);
+        CHECK(!held);
+    }
+}
+
+// Animation step, run by the native task with the lock held
+static void anim_cb(lv_timer_t *timer) {
+    static const uint32_t colors[] = { 0x202020, 0x404040 };
+    static int step;
+    CHECK_EQ(__atomic_fetch_add(&inside, 1, __ATOMIC_ACQ_REL), 0);
+    lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(colors[step++ % 2]), 0);
+    lv_obj_invalidate(lv_scr_act());
+    __atomic_fetch_sub(&inside, 1, __ATOMIC_ACQ_REL);
+}
+
+// Tasks taking the lock from other cores while the native task renders
+static void worker(void *arg) {
+    for (int i = 0; i < WORKER_ROUNDS; i++) {
+        CHECK(take_lock(-1));
+        CHECK_EQ(__atomic_fetch_add(&inside, 1, __ATOMIC_ACQ_REL), 0);
+        // Recursive: lock() again inside lock()
+        CHECK(take_lock(0));
+        lv_obj_get_child_cnt(lv_scr_act());
+        pause_ms(HOLD_MS);
+        give_lock();
+        __atomic_fetch_sub(&inside, 1, __ATOMIC_ACQ_REL);
+        give_lock();
+        pause_ms(WORKERS * HOLD_MS);
+    }
+    __atomic_add_fetch(&workers_done, 1, __ATOMIC_ACQ_REL);
+    vTaskDelete(NULL);
+}
+
+static void test_contention(void) {
+    CHECK(take_lock(-1));
+    lv_timer_t *anim = lv_timer_create(anim_cb, ANIM_PERIOD_MS, NULL);
+    give_lock();
+    pause_ms(200);
+
+    int first = frame_count();
+    for (int i = 0; i < WORKERS; i++) {
+        CHECK(xTaskCreatePinnedToCore(worker, "worker", 4096, NULL, 5, NULL, i % 2) == pdPASS);
+    }
+    while (__atomic_load_n(&workers_done, __ATOMIC_ACQUIRE) < WORKERS) {
+        pause_ms(10);
+    }
+    int last = frame_count();
+
+    CHECK(take_lock(-1));
+    lv_timer_del(anim);
+    give_lock();
+
+    // Frame pacing while the lock is contended, on the virtual clock
+    CHECK(last - first >= 10);
+    uint64_t min_us = UINT64_MAX;
+    uint64_t max_us = 0;
+    for (int i = first + 1; i < last; i++) {
+        uint64_t interval = frame_us[i] - frame_us[i - 1];
+        min_us = interval < min_us ? interval : min_us;
+        max_us = interval > max_us ? interval : max_us;
+    }
+    uint64_t mean_us = (frame_us[last - 1] - frame_us[first]) / (last - first - 1);
+    printf("frame pacing: %d frames, interval mean %llu us, min %llu us, max %llu us, jitter %llu us\n",
+        last - first, (unsigned long long)mean_us, (unsigned long long)min_us,
+        (unsigned long long)max_us, (unsigned long long)(max_us - min_us));
+    // No frame is held back by more than a refresh period and the workers'
+    // turns in the lock
+    CHECK(max_us <= (ANIM_PERIOD_MS + LV_DISP_DEF_REFR_PERIOD + 2 * WORKERS * HOLD_MS) * 1000);
+}
+
+// The lock as a context manager keeps the task out of LVGL until __exit__
+static void test_context_manager(void) {
+    CHECK(mp_host_call(lock, "__enter__", 0) == lock);
+    int held = frame_count();
+    mp_host_call(lvgl, "post_invalidate", 0);
+    pause_ms(200);
+    CHECK_EQ(frame_count(), held);
+    mp_host_call(lock, "__exit__", 3, mp_const_none, mp_const_none, mp_const_none);
+    for (int i = 0; i < 100 && frame_count() == held; i++) {
+        pause_ms(10);
+    }
+    CHECK(frame_count() > held);
+}
+
+// stop_task() while the caller holds the lock and the task waits for it
+static void test_stop_locked(void) {
+    CHECK(take_lock(-1));
+    mp_host_call(lvgl, "post_invalidate", 0);
+    pause_ms(50);
+    mp_host_call(lvgl, "stop_task", 0);
+    give_lock();
+
+    // Started again, stopped without the lock
+    CHECK(mp_host_call(lvgl, "start_task", 0) == mp_const_true);
+    pause_ms(50);
+    mp_host_call(lvgl, "stop_task", 0);
+}
+
+int main(void) {
+    // A deadlock fails the test instead of hanging it
+    alarm(60);
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    lock = mp_host_attr(lvgl, "lock");
+    unlock = mp_host_attr(lvgl, "unlock");
+
+    lv_disp_drv_t *drv = lv_disp_get_default()->driver;
+    panel_flush = drv->flush_cb;
+    drv->flush_cb = timed_flush;
+
+    test_touch();
+    test_touch_shared();
+    test_stats_locked();
+    test_contention();
+    test_context_manager();
+    test_stop_locked();
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("lvgl task: ok\n");
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+ * Pool allocator: lv_mem_pool_reset() gives every pool block back and the
+ * arena blocks to the heap, and LVGL starts on it
+ */
+
+#include <malloc.h>
+#include "lv_mem_pool.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define LARGE_SIZE  4096
+
+static board_t board;
+
+// Fill every class, then some arena blocks
+static void churn(void) {
+    lv_mem_pool_stats_t stats;
+    lv_mem_pool_get_stats(&stats);
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        for (int b = 0; b < stats.classes[i].blocks; b++) {
+            CHECK(lv_mem_pool_alloc(stats.classes[i].block_size) != NULL);
+        }
+    }
+    void *large = lv_mem_pool_alloc(LARGE_SIZE);
+    CHECK(large != NULL);
+    CHECK(lv_mem_pool_realloc(large, 2 * LARGE_SIZE) != NULL);
+    CHECK(lv_mem_pool_alloc(LARGE_SIZE) != NULL);
+    // The last class is full, this one spills into the arena
+    CHECK(lv_mem_pool_alloc(LV_MEM_POOL_MAX_BLOCK) != NULL);
+
+    lv_mem_pool_get_stats(&stats);
+    CHECK_EQ(stats.large_blocks, 3);
+    CHECK(stats.classes[LV_MEM_POOL_CLASS_NUM - 1].overflow > 0);
+}
+
+static void test_reset(void) {
+    // The pools themselves come with the first allocation
+    lv_mem_pool_free(lv_mem_pool_alloc(1));
+    size_t before = mallinfo2().uordblks;
+
+    churn();
+    CHECK(mallinfo2().uordblks > before);
+    lv_mem_pool_reset();
+    CHECK_EQ(mallinfo2().uordblks, before);
+
+    lv_mem_pool_stats_t stats;
+    lv_mem_pool_get_stats(&stats);
+    CHECK_EQ(stats.used, 0);
+    CHECK_EQ(stats.peak, 0);
+    CHECK_EQ(stats.large_blocks, 0);
+    CHECK_EQ(stats.large_bytes, 0);
+    CHECK_EQ(stats.large_peak, 0);
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        CHECK(stats.classes[i].blocks > 0);
+        CHECK_EQ(stats.classes[i].used, 0);
+        CHECK_EQ(stats.classes[i].overflow, 0);
+    }
+
+    // Every block free again: the same churn fits as before
+    churn();
+    lv_mem_pool_reset();
+    CHECK_EQ(mallinfo2().uordblks, before);
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+
+    test_reset();
+
+    // LVGL's first init starts on an empty pool
+    lv_mem_pool_alloc(LARGE_SIZE);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, MP_OBJ_NEW_SMALL_INT(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_obj_t lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    mp_obj_t stats = mp_host_call(lvgl, "mem_stats", 0);
+    CHECK(mp_host_dict_int(stats, "used") > 0);
+    CHECK(mp_host_dict_int(stats, "large_bytes") < LARGE_SIZE);
+    CHECK(mp_host_dict_lookup(stats, "heap_fragmentation") != MP_OBJ_NULL);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("mem pool: ok\n");
+    return 0;
+}
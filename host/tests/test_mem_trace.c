@@ -0,0 +1,394 @@
+/*
+ * Allocation trace replay: the pool allocator against the stock LVGL heap on
+ * the same widget churn. Small objects and styles come and go with screen
+ * changes, label texts grow, now and then a draw layer or an image is taken.
+ *
+ * Fragmentation: the stock heap is modelled as a best fit heap in an
+ * LV_MEM_SIZE region, as TLSF places blocks. The pool's arena blocks go to a
+ * region modelled the same way: once the 16 KB left of the same 48 KB, once
+ * the internal heap it gets as built. Reported per allocator: failed
+ * allocations, those that failed with enough free bytes, and the worst
+ * fragmentation seen (100 - largest free block / free bytes, as
+ * lv_mem_monitor), for the pool also its size classes.
+ *
+ * Latency: the trace replayed on the pool and on the C library heap, which
+ * stands in for the heap on the host. Every block is filled and checked on
+ * free, so overlapping blocks fail the test
+ */
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "lv_mem_pool.h"
+#include "test.h"
+
+#define STOCK_BYTES     (48 * 1024)
+#define POOL_BYTES      (LV_MEM_POOL_CLASS_NUM * LV_MEM_POOL_CLASS_BYTES)
+#define ARENA_BYTES     (STOCK_BYTES - POOL_BYTES)
+#define HEAP_BYTES      (300 * 1024)        // the host's internal heap
+#define SLOTS           1024
+#define OPS             100000
+#define SCREEN_OPS      4000
+#define LIVE_TARGET     (24 * 1024)
+#define BENCH_NS        (100 * 1000 * 1000)
+#define REGION_HEADER   8
+
+typedef enum { OP_ALLOC, OP_FREE, OP_REALLOC } op_kind_t;
+
+typedef struct {
+    uint8_t kind;
+    uint16_t slot;
+    uint32_t size;
+} op_t;
+
+typedef struct {
+    void *ptr;
+    uint32_t size;
+} slot_t;
+
+static op_t trace[OPS];
+static int trace_len;
+static slot_t slots[SLOTS];
+
+// Sizes as LVGL asks for them: list nodes and styles, objects, label texts,
+// layers and decoded images
+static uint32_t rng = 12345;
+
+static uint32_t next_rand(uint32_t n) {
+    rng = rng * 1103515245 + 12345;
+    return (rng >> 8) % n;
+}
+
+static uint32_t object_size(void) {
+    uint32_t r = next_rand(100);
+    if (r < 55) {
+        return 8 + next_rand(25);
+    } else if (r < 80) {
+        return 33 + next_rand(32);
+    } else if (r < 93) {
+        return 65 + next_rand(64);
+    } else if (r < 99) {
+        return 129 + next_rand(900);
+    }
+    return 2048 + next_rand(4096);
+}
+
+static void make_trace(void) {
+    static bool live[SLOTS];
+    static uint32_t live_size[SLOTS];
+    uint32_t live_bytes = 0;
+    int n = 0;
+
+    while (n < OPS) {
+        // A screen change drops most of what is there
+        if (n % SCREEN_OPS == SCREEN_OPS - 1) {
+            for (int s = 0; s < SLOTS && n < OPS; s++) {
+                if (live[s] && next_rand(10) < 8) {
+                    trace[n++] = (op_t){ OP_FREE, s, 0 };
+                    live[s] = false;
+                    live_bytes -= live_size[s];
+                }
+            }
+            continue;
+        }
+        int s = next_rand(SLOTS);
+        if (!live[s]) {
+            if (live_bytes > LIVE_TARGET) {
+                continue;
+            }
+            live_size[s] = object_size();
+            trace[n++] = (op_t){ OP_ALLOC, s, live_size[s] };
+            live[s] = true;
+            live_bytes += live_size[s];
+        } else if (next_rand(10) == 0 && live_size[s] < 1024) {
+            // A label text set again, longer
+            uint32_t size = live_size[s] + 1 + next_rand(64);
+            trace[n++] = (op_t){ OP_REALLOC, s, size };
+            live_bytes += size - live_size[s];
+            live_size[s] = size;
+        } else if (next_rand(3) == 0) {
+            trace[n++] = (op_t){ OP_FREE, s, 0 };
+            live[s] = false;
+            live_bytes -= live_size[s];
+        }
+    }
+    trace_len = n;
+}
+
+// Best fit heap in a region: blocks of a header and the data, 8 byte
+// aligned, neighbouring free blocks merged when the heap is walked
+typedef struct {
+    uint32_t size;      // with the header
+    uint32_t used;
+} region_block_t;
+
+typedef struct {
+    uint8_t *mem;
+    uint32_t size;
+    uint32_t failed;
+    uint32_t failed_frag;   // with enough free bytes
+    uint32_t worst_frag_pct;
+} region_t;
+
+static void region_init(region_t *r, uint32_t size) {
+    memset(r, 0, sizeof(*r));
+    r->mem = malloc(size);
+    CHECK(r->mem != NULL);
+    r->size = size;
+    *(region_block_t *)r->mem = (region_block_t){ size, 0 };
+}
+
+static region_block_t *region_next(region_t *r, region_block_t *b) {
+    uint8_t *next = (uint8_t *)b + b->size;
+    return next < r->mem + r->size ? (region_block_t *)next : NULL;
+}
+
+// Merge free neighbours, return free bytes and the largest free block
+static uint32_t region_walk(region_t *r, uint32_t *largest) {
+    uint32_t free_bytes = 0;
+    *largest = 0;
+    for (region_block_t *b = (region_block_t *)r->mem; b != NULL; b = region_next(r, b)) {
+        if (b->used) {
+            continue;
+        }
+        region_block_t *n;
+        while ((n = region_next(r, b)) != NULL && !n->used) {
+            b->size += n->size;
+        }
+        uint32_t data = b->size - REGION_HEADER;
+        free_bytes += data;
+        if (data > *largest) {
+            *largest = data;
+        }
+    }
+    return free_bytes;
+}
+
+static void region_frag(region_t *r) {
+    uint32_t largest;
+    uint32_t free_bytes = region_walk(r, &largest);
+    if (free_bytes > 0) {
+        uint32_t pct = 100 - (uint32_t)((uint64_t)largest * 100 / free_bytes);
+        if (pct > r->worst_frag_pct) {
+            r->worst_frag_pct = pct;
+        }
+    }
+}
+
+static void *region_alloc(region_t *r, uint32_t size) {
+    uint32_t need = REGION_HEADER + ((size + 7) & ~7u);
+    uint32_t largest;
+    uint32_t free_bytes = region_walk(r, &largest);
+    region_block_t *best = NULL;
+    for (region_block_t *b = (region_block_t *)r->mem; b != NULL; b = region_next(r, b)) {
+        if (!b->used && b->size >= need && (best == NULL || b->size < best->size)) {
+            best = b;
+        }
+    }
+    if (best == NULL) {
+        r->failed++;
+        if (free_bytes >= size) {
+            r->failed_frag++;
+        }
+        return NULL;
+    }
+    if (best->size - need >= REGION_HEADER + 8) {
+        region_block_t *rest = (region_block_t *)((uint8_t *)best + need);
+        *rest = (region_block_t){ best->size - need, 0 };
+        best->size = need;
+    }
+    best->used = 1;
+    return (uint8_t *)best + REGION_HEADER;
+}
+
+static void region_free(region_t *r, void *ptr) {
+    ((region_block_t *)((uint8_t *)ptr - REGION_HEADER))->used = 0;
+    region_frag(r);
+}
+
+// Every block carries its slot and size, checked before it goes
+static void fill(void *ptr, int slot, uint32_t size) {
+    memset(ptr, (uint8_t)(slot * 7 + size), size);
+}
+
+static void check_fill(const void *ptr, int slot, uint32_t size) {
+    const uint8_t *p = ptr;
+    uint8_t v = (uint8_t)(slot * 7 + size);
+    for (uint32_t i = 0; i < size; i++) {
+        CHECK_EQ(p[i], v);
+    }
+}
+
+// The trace on the 48 KB stock heap model
+static void replay_stock(region_t *heap) {
+    memset(slots, 0, sizeof(slots));
+    for (int i = 0; i < trace_len; i++) {
+        op_t *op = &trace[i];
+        slot_t *s = &slots[op->slot];
+        if (op->kind == OP_FREE || op->kind == OP_REALLOC) {
+            if (s->ptr == NULL) {
+                continue;   // its allocation failed
+            }
+            check_fill(s->ptr, op->slot, s->size);
+            region_free(heap, s->ptr);
+            s->ptr = NULL;
+        }
+        if (op->kind == OP_ALLOC || op->kind == OP_REALLOC) {
+            s->ptr = region_alloc(heap, op->size);
+            s->size = op->size;
+            if (s->ptr != NULL) {
+                fill(s->ptr, op->slot, s->size);
+            }
+        }
+    }
+}
+
+// The trace on the pool, what it sends to the arena mirrored in the arena
+// model. The statistics are those before the last blocks are freed
+static void replay_pool(region_t *arena, lv_mem_pool_stats_t *out, uint32_t *waste_pct) {
+    static void *arena_ptr[SLOTS];
+    lv_mem_pool_stats_t stats;
+    uint64_t requested = 0;
+    uint64_t taken = 0;
+
+    memset(slots, 0, sizeof(slots));
+    memset(arena_ptr, 0, sizeof(arena_ptr));
+    lv_mem_pool_reset();
+    for (int i = 0; i < trace_len; i++) {
+        op_t *op = &trace[i];
+        slot_t *s = &slots[op->slot];
+        if (op->kind == OP_FREE || op->kind == OP_REALLOC) {
+            if (s->ptr == NULL) {
+                continue;
+            }
+            check_fill(s->ptr, op->slot, s->size);
+            lv_mem_pool_free(s->ptr);
+            s->ptr = NULL;
+            if (arena_ptr[op->slot] != NULL) {
+                region_free(arena, arena_ptr[op->slot]);
+                arena_ptr[op->slot] = NULL;
+            }
+        }
+        if (op->kind == OP_ALLOC || op->kind == OP_REALLOC) {
+            lv_mem_pool_get_stats(&stats);
+            uint32_t large = stats.large_blocks;
+            uint32_t used = stats.used;
+            void *ptr = lv_mem_pool_alloc(op->size);
+            CHECK(ptr != NULL);
+            lv_mem_pool_get_stats(&stats);
+            if (stats.large_blocks > large) {
+                // An arena block: only if the arena model has room
+                arena_ptr[op->slot] = region_alloc(arena, op->size);
+                if (arena_ptr[op->slot] == NULL) {
+                    lv_mem_pool_free(ptr);
+                    continue;
+                }
+            } else {
+                requested += op->size;
+                taken += stats.used - used;
+            }
+            s->ptr = ptr;
+            s->size = op->size;
+            fill(s->ptr, op->slot, s->size);
+        }
+    }
+    lv_mem_pool_get_stats(out);
+    for (int i = 0; i < SLOTS; i++) {
+        lv_mem_pool_free(slots[i].ptr);
+    }
+    lv_mem_pool_get_stats(&stats);
+    CHECK_EQ(stats.used, 0);
+    CHECK_EQ(stats.large_blocks, 0);
+    CHECK_EQ(stats.failed, 0);
+    *waste_pct = (uint32_t)(100 - requested * 100 / taken);
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Mean ns of an allocation or free over whole replays, nothing else done
+static double replay_latency(bool pool) {
+    uint64_t ops = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        memset(slots, 0, sizeof(slots));
+        for (int i = 0; i < trace_len; i++) {
+            op_t *op = &trace[i];
+            slot_t *s = &slots[op->slot];
+            if (op->kind == OP_ALLOC) {
+                s->ptr = pool ? lv_mem_pool_alloc(op->size) : malloc(op->size);
+            } else if (op->kind == OP_REALLOC) {
+                s->ptr = pool ? lv_mem_pool_realloc(s->ptr, op->size) : realloc(s->ptr, op->size);
+            } else {
+                if (pool) {
+                    lv_mem_pool_free(s->ptr);
+                } else {
+                    free(s->ptr);
+                }
+                s->ptr = NULL;
+            }
+        }
+        for (int i = 0; i < SLOTS; i++) {
+            if (pool) {
+                lv_mem_pool_free(slots[i].ptr);
+            } else {
+                free(slots[i].ptr);
+            }
+        }
+        ops += trace_len;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    return (double)elapsed / ops;
+}
+
+int main(void) {
+    make_trace();
+    int allocs = 0;
+    for (int i = 0; i < trace_len; i++) {
+        allocs += trace[i].kind != OP_FREE;
+    }
+
+    region_t stock;
+    region_init(&stock, STOCK_BYTES);
+    replay_stock(&stock);
+
+    region_t shared;
+    region_t heap;
+    lv_mem_pool_stats_t stats;
+    uint32_t waste_pct;
+    region_init(&shared, ARENA_BYTES);
+    replay_pool(&shared, &stats, &waste_pct);
+    region_init(&heap, HEAP_BYTES);
+    replay_pool(&heap, &stats, &waste_pct);
+    CHECK_EQ(heap.failed, 0);
+
+    lv_mem_pool_reset();
+    double pool_ns = replay_latency(true);
+    double heap_ns = replay_latency(false);
+
+    printf("mem trace: %d operations, %d allocations\n", trace_len, allocs);
+    printf("mem trace: %-32s %5u failed, %5u with enough free, worst fragmentation %3u%%\n",
+        "stock heap, 48 KB", stock.failed, stock.failed_frag, stock.worst_frag_pct);
+    printf("mem trace: %-32s %5u failed, %5u with enough free, worst fragmentation %3u%% (arena)\n",
+        "pool, 32 KB + 16 KB arena", shared.failed, shared.failed_frag, shared.worst_frag_pct);
+    printf("mem trace: %-32s %5u failed, %5u with enough free, worst fragmentation %3u%% (arena)\n",
+        "pool, 32 KB + arena on the heap", heap.failed, heap.failed_frag, heap.worst_frag_pct);
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        printf("mem trace: pool class %3u bytes: peak %4u of %4u blocks, %6u overflowed\n",
+            stats.classes[i].block_size, stats.classes[i].peak, stats.classes[i].blocks, (unsigned)stats.classes[i].overflow);
+    }
+    printf("mem trace: pool: %u%% of the class blocks lost to rounding up, peak %u bytes in the arena\n",
+        waste_pct, (unsigned)stats.large_peak);
+    printf("mem trace: alloc/free %.1f ns pool, %.1f ns C library heap\n", pool_ns, heap_ns);
+
+    free(stock.mem);
+    free(shared.mem);
+    free(heap.mem);
+    printf("mem trace: ok\n");
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Palette mode: LVGL at LV_COLOR_DEPTH 8 into one full-frame buffer, each
+ * frame expanded through LCD_setPalette's table on its way to the panel. The
+ * panel shows the palette entry of every colour LVGL drew. Reports the
+ * palette expansion's throughput next to the RGB565 byte swap of the default
+ * build, and the memory of this build next to the default two RGB565 bands
+ */
+
+#include <string.h>
+#include <time.h>
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "spd2010_pixels.h"
+#include "test.h"
+
+#define BENCH_NS        (50 * 1000 * 1000)
+#define FRAME_PIXELS    (PANEL_WIDTH * PANEL_HEIGHT)
+// The default build: two draw buffers of a tenth of the screen in RGB565
+#define DEFAULT_BUF_BYTES   (2 * (FRAME_PIXELS / 10) * 2)
+
+static board_t board;
+static mp_obj_t display_mod;
+static mp_obj_t lvgl;
+static uint16_t palette[256];
+static uint8_t frame[FRAME_PIXELS * 2];
+static uint8_t out[PANEL_WIDTH * 3];
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static void settle(void) {
+    sim_sleep_us(30 * 1000);
+    mp_host_call(lvgl, "loop", 0);
+    mp_host_call(display_mod, "LCD_waitIdle", 0);
+    sim_lcd_drain();
+}
+
+// Away from the driver's label in the middle of the screen
+static void check_screen(uint16_t color) {
+    for (int y = 0; y < PANEL_HEIGHT; y += 7) {
+        if (y > PANEL_HEIGHT / 2 - 20 && y < PANEL_HEIGHT / 2 + 20) {
+            continue;
+        }
+        for (int x = 0; x < PANEL_WIDTH; x += 7) {
+            CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, x, y), color);
+        }
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Frames of format converted row by row into one line buffer: MB/s of panel bytes
+static double bench(int format, int bpp) {
+    int src_bytes = format / 8;
+    int panel_bytes = bpp == 16 ? 2 : 3;
+    for (size_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)(i * 131 + (i >> 9));
+    }
+    uint64_t frames = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        for (int y = 0; y < PANEL_HEIGHT; y++) {
+            pixels_convert_row(out, frame + (size_t)y * PANEL_WIDTH * src_bytes, PANEL_WIDTH, format, bpp);
+        }
+        frames++;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    double mb_s = (double)frames * FRAME_PIXELS * panel_bytes / (elapsed / 1e9) / 1e6;
+    printf("palette: %s to %d bpp: %7.1f MB/s, %6.0f frames/s\n",
+        format == SRC_FORMAT_RGB332 ? "8-bit " : "RGB565", bpp, mb_s, frames / (elapsed / 1e9));
+    return mb_s;
+}
+
+int main(void) {
+    static const uint32_t colors[] = { 0xFF0000, 0x00FF00, 0x0000FF, 0x6040A0 };
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(display_mod, "LCD_shadow", 1, mp_const_true) == mp_const_true);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    CHECK(mp_host_attr(lvgl, "COLOR_DEPTH") == int_obj(8));
+    CHECK(mp_host_attr(lvgl, "BUFFER_COUNT") == int_obj(1));
+
+    // Any 256 colours, none of them what RGB332 would give
+    for (int i = 0; i < 256; i++) {
+        palette[i] = (uint16_t)(i * 0x0101 ^ 0x5A3C);
+    }
+    mp_obj_t table = mp_obj_new_bytearray(sizeof(palette), palette);
+    CHECK(mp_host_call(display_mod, "LCD_setPalette", 1, table) == mp_const_none);
+    for (size_t i = 0; i < sizeof(colors) / sizeof(colors[0]); i++) {
+        lv_color_t c = lv_color_hex(colors[i]);
+        lv_obj_set_style_bg_color(lv_scr_act(), c, 0);
+        settle();
+        check_screen(palette[c.full]);
+    }
+
+    // None is RGB332 again
+    mp_host_call(display_mod, "LCD_setPalette", 1, mp_const_none);
+    lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(0xFF0000), 0);
+    settle();
+    check_screen(0xF800);
+
+    mp_obj_t info = mp_host_call(lvgl, "mem_info", 0);
+    mp_int_t buf_bytes = mp_host_dict_int(info, "draw_buf_bytes");
+    mp_int_t lv_mem = mp_host_dict_int(info, "lv_mem_total");
+    CHECK_EQ(buf_bytes, FRAME_PIXELS);
+    CHECK_EQ(mp_host_dict_int(info, "frame_bytes"), FRAME_PIXELS);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+
+    // The 8-bit expansion against what the default build does to every pixel
+    pixels_set_palette(palette);
+    double swap_16 = bench(SRC_FORMAT_RGB565, 16);
+    double palette_16 = bench(SRC_FORMAT_RGB332, 16);
+    bench(SRC_FORMAT_RGB332, 24);
+    printf("palette: 8-bit expansion at %.0f%% of the RGB565 swap's rate\n", 100.0 * palette_16 / swap_16);
+
+    // Both builds share the LVGL heap, the conversion tables are static
+    printf("palette: memory            draw buffers  LVGL heap  whole frame\n");
+    printf("palette: default RGB565    %12d  %9ld  %11s\n", DEFAULT_BUF_BYTES, (long)lv_mem, "no");
+    printf("palette: full frame RGB565 %12d  %9ld  %11s\n", FRAME_PIXELS * 2, (long)lv_mem, "yes");
+    printf("palette: full frame 8-bit  %12ld  %9ld  %11s\n", (long)buf_bytes, (long)lv_mem, "yes");
+    printf("palette: ok\n");
+    return 0;
+}
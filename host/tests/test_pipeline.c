@@ -0,0 +1,62 @@
+/*
+ * Render/transfer pipeline: frames of alternating colours rendered by LVGL
+ * while the transfer task sends the bands from its buffers. A buffer handed
+ * back to LVGL before its DMA is done shows up as a wrong colour on the panel
+ */
+
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define FRAMES      6
+
+static board_t board;
+
+static void check_screen(uint16_t color) {
+    for (int y = 0; y < PANEL_HEIGHT; y += 7) {
+        if (y > PANEL_HEIGHT / 2 - 20 && y < PANEL_HEIGHT / 2 + 20) {
+            continue;   // the driver's label
+        }
+        for (int x = 0; x < PANEL_WIDTH; x += 7) {
+            CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, x, y), color);
+        }
+    }
+}
+
+int main(void) {
+    static const uint32_t colors[] = { 0xFF0000, 0x00FF00, 0x0000FF };
+    static const uint16_t rgb565[] = { 0xF800, 0x07E0, 0x001F };
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, MP_OBJ_NEW_SMALL_INT(0x00));
+    mp_obj_t display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_obj_t lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(lvgl, "start_pipeline", 0) == mp_const_true);
+
+    for (int i = 0; i < FRAMES; i++) {
+        lv_obj_set_style_bg_color(lv_scr_act(), lv_color_hex(colors[i % 3]), 0);
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(30 * 1000);
+        mp_host_call(lvgl, "loop", 0);
+        mp_host_call(display_mod, "LCD_waitIdle", 0);
+        sim_lcd_drain();
+        check_screen(rgb565[i % 3]);
+    }
+
+    mp_obj_t stats = mp_host_call(lvgl, "pipeline_stats", 0);
+    CHECK(mp_host_dict_int(stats, "bands") >= FRAMES * 10);
+    mp_host_call(lvgl, "stop_pipeline", 0);
+    CHECK(mp_host_dict_lookup(mp_host_call(lvgl, "pipeline_stats", 0), "running") == mp_const_false);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("pipeline: ok\n");
+    return 0;
+}
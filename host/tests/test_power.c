@@ -0,0 +1,220 @@
+/*
+ * Power manager on the virtual clock: ACTIVE -> DIM -> OFF -> SLEEP at the
+ * configured timeouts, loop() waiting no longer than the next of them, a
+ * touch waking the panel from SLEEP without loop() waiting out the SLPOUT
+ * delay, and the touch that woke the screen not given to LVGL as a press
+ */
+
+#include "lvgl.h"
+#include "lv_power.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define LEVEL       60
+#define DIM_LEVEL   10
+#define DIM_MS      1000
+#define OFF_MS      2000
+#define SLEEP_MS    3000
+#define STEP_MS     10
+#define SLPOUT_MS   120
+
+static board_t board;
+static mp_obj_t display_mod;
+static mp_obj_t lvgl;
+static int presses;         // presses LVGL was given
+static void (*touch_read)(lv_indev_drv_t *drv, lv_indev_data_t *data);
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static void counting_read(lv_indev_drv_t *drv, lv_indev_data_t *data) {
+    static lv_indev_state_t last = LV_INDEV_STATE_REL;
+    touch_read(drv, data);
+    if (data->state == LV_INDEV_STATE_PR && last == LV_INDEV_STATE_REL) {
+        presses++;
+    }
+    last = data->state;
+}
+
+static lv_power_state_t state(void) {
+    return mp_obj_get_int(mp_host_call(lvgl, "power_state", 0));
+}
+
+static uint32_t loop(void) {
+    return mp_obj_get_int(mp_host_call(lvgl, "loop", 0));
+}
+
+// Loops STEP_MS apart for ms
+static void run_ms(uint32_t ms) {
+    uint64_t end = sim_clock_now() + (uint64_t)ms * 1000;
+    while (sim_clock_now() < end) {
+        loop();
+        sim_sleep_us(STEP_MS * 1000);
+    }
+}
+
+// Loops until the state is s, the time it took in ms
+static uint32_t run_until(lv_power_state_t s) {
+    uint64_t start = sim_clock_now();
+    for (int i = 0; i < 1000 && state() != s; i++) {
+        loop();
+        if (state() != s) {
+            sim_sleep_us(STEP_MS * 1000);
+        }
+    }
+    CHECK_EQ(state(), s);
+    return (uint32_t)((sim_clock_now() - start) / 1000);
+}
+
+static uint32_t backlight_target(void) {
+    sim_ledc_channel_t ch;
+    sim_ledc_get(0, &ch);
+    return ch.target;
+}
+
+static uint32_t level_duty(int level) {
+    mp_host_call(display_mod, "Set_Backlight", 1, int_obj(level));
+    return backlight_target();
+}
+
+// ACTIVE -> DIM -> OFF -> SLEEP, each at its timeout
+static void test_timeouts(uint32_t dim) {
+    CHECK(loop() <= DIM_MS);
+    uint32_t next = lv_power_next_ms();
+    CHECK(next <= DIM_MS && next >= DIM_MS - 2 * STEP_MS);
+
+    uint32_t ms = run_until(LV_POWER_DIM);
+    CHECK(ms >= DIM_MS - 2 * STEP_MS && ms <= DIM_MS + STEP_MS);
+    CHECK_EQ(backlight_target(), dim);
+    ms += run_until(LV_POWER_OFF);
+    CHECK(ms >= OFF_MS - 2 * STEP_MS && ms <= OFF_MS + STEP_MS);
+    CHECK_EQ(backlight_target(), 0);
+    CHECK(!board.panel.sleeping);
+    ms += run_until(LV_POWER_SLEEP);
+    CHECK(ms >= SLEEP_MS - 2 * STEP_MS && ms <= SLEEP_MS + STEP_MS);
+    CHECK(board.panel.sleeping);
+    CHECK(!board.panel.display_on);
+    CHECK(lv_disp_get_default()->refr_timer->paused);
+
+    // Nothing left to wait for, and nothing drawn while asleep
+    CHECK_EQ(lv_power_next_ms(), UINT32_MAX);
+    sim_lcd_stats_t before, after;
+    sim_lcd_get_stats(&before);
+    lv_obj_invalidate(lv_scr_act());
+    run_ms(500);
+    sim_lcd_get_stats(&after);
+    CHECK_EQ(after.colors_queued, before.colors_queued);
+    CHECK_EQ(state(), LV_POWER_SLEEP);
+}
+
+// A touch in SLEEP: SLPOUT goes out at once, the display is turned on and the
+// backlight fades up once the panel's delay is over. No loop() waits for it,
+// and the held touch presses nothing
+static void test_touch_wake(uint32_t full) {
+    sim_lcd_stats_t before, after;
+    sim_lcd_get_stats(&before);
+    touch_model_press(&board.touch, PANEL_WIDTH / 2, PANEL_HEIGHT / 2);
+    uint64_t start = sim_clock_now();
+    loop();
+    CHECK(sim_clock_now() - start < SLPOUT_MS * 1000 / 4);
+    CHECK_EQ(state(), LV_POWER_ACTIVE);
+    CHECK(!board.panel.sleeping);
+    CHECK(!board.panel.display_on);
+    CHECK(lv_disp_get_default()->refr_timer->paused);
+    CHECK_EQ(backlight_target(), 0);
+    uint32_t next = lv_power_next_ms();
+    CHECK(next > 0 && next <= SLPOUT_MS);
+
+    uint64_t longest = 0;
+    while (!board.panel.display_on && sim_clock_now() - start < 2 * SLPOUT_MS * 1000) {
+        uint64_t t = sim_clock_now();
+        loop();
+        if (sim_clock_now() - t > longest) {
+            longest = sim_clock_now() - t;
+        }
+        sim_sleep_us(STEP_MS * 1000);
+    }
+    CHECK(board.panel.display_on);
+    CHECK(longest < SLPOUT_MS * 1000 / 4);
+    CHECK(sim_clock_now() - start >= SLPOUT_MS * 1000);
+    CHECK(!lv_disp_get_default()->refr_timer->paused);
+    CHECK_EQ(backlight_target(), full);
+    run_ms(100);
+    sim_lcd_get_stats(&after);
+    CHECK(after.colors_queued > before.colors_queued);
+    mp_obj_t stats = mp_host_call(lvgl, "power_stats", 0);
+    CHECK_EQ(mp_host_dict_int(stats, "wakes"), 1);
+    CHECK(mp_host_dict_int(stats, "last_wake_us") >= SLPOUT_MS * 1000);
+
+    // Held down past the dim timeout: the screen stays on, LVGL sees no press
+    run_ms(DIM_MS + 100);
+    CHECK_EQ(state(), LV_POWER_ACTIVE);
+    CHECK_EQ(presses, 0);
+    touch_model_release(&board.touch);
+    run_ms(100);
+    CHECK_EQ(presses, 0);
+
+    // The next touch is an ordinary one
+    touch_model_press(&board.touch, PANEL_WIDTH / 2, PANEL_HEIGHT / 2);
+    run_ms(100);
+    CHECK_EQ(presses, 1);
+    touch_model_release(&board.touch);
+    run_ms(100);
+}
+
+// A touch while dimmed brings the backlight back, and presses nothing either
+static void test_dim_wake(uint32_t full) {
+    run_until(LV_POWER_DIM);
+    touch_model_press(&board.touch, PANEL_WIDTH / 2, PANEL_HEIGHT / 2);
+    run_ms(100);
+    CHECK_EQ(state(), LV_POWER_ACTIVE);
+    CHECK_EQ(backlight_target(), full);
+    touch_model_release(&board.touch);
+    run_ms(100);
+    CHECK_EQ(presses, 1);
+    CHECK_EQ(mp_host_dict_int(mp_host_call(lvgl, "power_stats", 0), "wakes"), 2);
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    mp_host_call(display_mod, "Backlight_Init", 0);
+    uint32_t dim = level_duty(DIM_LEVEL);
+    uint32_t full = level_duty(LEVEL);
+    mp_host_call(mp_host_import("spd2010_touch"), "Touch_Init", 0);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    for (int i = 0; i < 100 && board.touch.state != TOUCH_MODEL_RUN; i++) {
+        run_ms(STEP_MS);
+    }
+    CHECK_EQ(board.touch.state, TOUCH_MODEL_RUN);
+
+    lv_indev_drv_t *indev_drv = lv_indev_get_next(NULL)->driver;
+    touch_read = indev_drv->read_cb;
+    indev_drv->read_cb = counting_read;
+
+    mp_host_call(lvgl, "power_config", 4, int_obj(DIM_MS), int_obj(OFF_MS), int_obj(SLEEP_MS), int_obj(DIM_LEVEL));
+    mp_host_call(lvgl, "power_stats", 1, mp_const_true);
+    test_timeouts(dim);
+    test_touch_wake(full);
+    test_dim_wake(full);
+
+    mp_obj_t stats = mp_host_call(lvgl, "power_stats", 0);
+    printf("power: active %d ms, dim %d ms, off %d ms, sleep %d ms, wake %d us\n",
+        (int)mp_host_dict_int(stats, "active_ms"), (int)mp_host_dict_int(stats, "dim_ms"),
+        (int)mp_host_dict_int(stats, "off_ms"), (int)mp_host_dict_int(stats, "sleep_ms"),
+        (int)mp_host_dict_int(stats, "max_wake_us"));
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("power: ok\n");
+    return 0;
+}
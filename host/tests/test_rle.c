@@ -0,0 +1,284 @@
+/*
+ * RLE images: pixels_rle_row against hand made rows (runs, literals,
+ * clipping, both panel formats, corrupt data), a round trip through an
+ * encoder doing what tools/rle_encode.py does, then a 412x412 background sent
+ * with blit_rle and as a raw RGB565 window. Both have to show the same
+ * picture. Reports the bytes each keeps in RAM, how long each blit call takes
+ * and when the panel has the frame on the virtual clock, and the host CPU
+ * time of decoding a frame next to byte swapping the raw one
+ */
+
+#include <string.h>
+#include <time.h>
+#include "models.h"
+#include "mphost.h"
+#include "spd2010_pixels.h"
+#include "test.h"
+
+#define MAX_PACKET  128
+#define FRAMES      5
+#define BENCH_NS    (20 * 1000 * 1000)
+
+static board_t board;
+static mp_obj_t display;
+static mp_obj_t display_mod;
+static uint16_t image[PANEL_WIDTH * PANEL_HEIGHT];
+static uint8_t rle[8 + PANEL_HEIGHT * (PANEL_WIDTH * 2 + PANEL_WIDTH / MAX_PACKET + 1)];
+static uint8_t row_out[PANEL_WIDTH * 3];
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static uint8_t *put_be(uint8_t *p, uint16_t c) {
+    *p++ = c >> 8;
+    *p++ = c & 0xFF;
+    return p;
+}
+
+static uint8_t *put_literal(uint8_t *p, const uint16_t *px, int n) {
+    *p++ = n - 1;
+    for (int i = 0; i < n; i++) {
+        p = put_be(p, px[i]);
+    }
+    return p;
+}
+
+// encode_row of tools/rle_encode.py: runs of three or more, of two only
+// when no literal is pending, literals of up to MAX_PACKET pixels
+static uint8_t *encode_row(uint8_t *p, const uint16_t *row, int width) {
+    int literal = 0;        // start of the pending literal
+    int i = 0;
+    while (i < width) {
+        int run = 1;
+        while (i + run < width && run < MAX_PACKET && row[i + run] == row[i]) {
+            run++;
+        }
+        if (run >= 3 || (run == 2 && literal == i)) {
+            for (; literal < i; literal += MAX_PACKET) {
+                p = put_literal(p, row + literal, i - literal < MAX_PACKET ? i - literal : MAX_PACKET);
+            }
+            *p++ = 0x80 | (run - 1);
+            p = put_be(p, row[i]);
+            i += run;
+            literal = i;
+        } else {
+            i++;
+        }
+    }
+    for (; literal < width; literal += MAX_PACKET) {
+        p = put_literal(p, row + literal, width - literal < MAX_PACKET ? width - literal : MAX_PACKET);
+    }
+    return p;
+}
+
+static size_t encode(uint8_t *out, const uint16_t *pixels, int width, int height) {
+    uint8_t *p = out;
+    memcpy(p, "RL16", 4);
+    p += 4;
+    *p++ = width & 0xFF;
+    *p++ = width >> 8;
+    *p++ = height & 0xFF;
+    *p++ = height >> 8;
+    for (int y = 0; y < height; y++) {
+        p = encode_row(p, pixels + y * width, width);
+    }
+    return p - out;
+}
+
+static void check_pixels(const uint8_t *out, const uint16_t *expect, int n, int bpp) {
+    for (int i = 0; i < n; i++) {
+        uint16_t c = expect[i];
+        if (bpp == 16) {
+            CHECK_EQ((out[i * 2] << 8) | out[i * 2 + 1], c);
+        } else {
+            CHECK_EQ(out[i * 3], ((c >> 11) << 3) | (c >> 13));
+            CHECK_EQ(out[i * 3 + 1], (((c >> 5) & 0x3F) << 2) | ((c >> 9) & 0x03));
+            CHECK_EQ(out[i * 3 + 2], ((c & 0x1F) << 3) | ((c >> 2) & 0x07));
+        }
+    }
+}
+
+static void check_decoder(int bpp) {
+    // A run of 3, 2 literals, a run of 2, then a second row of one run of 7
+    static const uint8_t rows[] = {
+        0x82, 0xF8, 0x00,
+        0x01, 0x07, 0xE0, 0x00, 0x1F,
+        0x81, 0x12, 0x34,
+        0x86, 0xFF, 0xFF,
+    };
+    static const uint16_t row0[] = { 0xF800, 0xF800, 0xF800, 0x07E0, 0x001F, 0x1234, 0x1234 };
+    static const uint16_t row1[] = { 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF };
+    const uint8_t *end = rows + sizeof(rows);
+
+    // Each row ends where the next one starts
+    const uint8_t *p = pixels_rle_row(row_out, rows, end, 7, 0, 7, bpp);
+    CHECK(p == rows + 11);
+    check_pixels(row_out, row0, 7, bpp);
+    CHECK(pixels_rle_row(row_out, p, end, 7, 0, 7, bpp) == end);
+    check_pixels(row_out, row1, 7, bpp);
+
+    // Clipped to pixels 2..4, across a run and a literal, nothing else written
+    memset(row_out, 0xEE, sizeof(row_out));
+    CHECK(pixels_rle_row(row_out, rows, end, 7, 2, 3, bpp) == rows + 11);
+    check_pixels(row_out, row0 + 2, 3, bpp);
+    CHECK_EQ(row_out[3 * (bpp == 16 ? 2 : 3)], 0xEE);
+
+    // Rows outside the screen are only walked over
+    memset(row_out, 0xEE, sizeof(row_out));
+    CHECK(pixels_rle_row(row_out, rows, end, 7, 0, 0, bpp) == rows + 11);
+    CHECK_EQ(row_out[0], 0xEE);
+
+    // Corrupt: no data, a run past the row, a cut literal, a row cut short
+    CHECK(pixels_rle_row(row_out, rows, rows, 7, 0, 7, bpp) == NULL);
+    CHECK(pixels_rle_row(row_out, rows + 11, end, 6, 0, 6, bpp) == NULL);
+    CHECK(pixels_rle_row(row_out, rows, rows + 6, 7, 0, 7, bpp) == NULL);
+    CHECK(pixels_rle_row(row_out, rows, rows + 8, 7, 0, 7, bpp) == NULL);
+}
+
+// A background as UIs have them: a gradient header, flat panels with
+// borders, a noisy picture in one corner
+static void make_background(void) {
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        for (int x = 0; x < PANEL_WIDTH; x++) {
+            uint16_t c = 0x18E3;
+            if (y < 60) {
+                c = (uint16_t)(((y / 2) << 11) | ((y / 2) << 5) | 0x10);
+            } else if ((y - 60) % 70 < 2 || x % 206 < 2) {
+                c = 0x8410;
+            } else if (x >= 300 && y >= 300) {
+                c = (uint16_t)((x * 2654435761u + y * 40503u) >> 16);
+            } else if ((y - 60) % 70 < 40) {
+                c = 0x2945;
+            }
+            image[y * PANEL_WIDTH + x] = c;
+        }
+    }
+}
+
+static void check_round_trip(size_t len) {
+    const uint8_t *p = rle + 8;
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        p = pixels_rle_row(row_out, p, rle + len, PANEL_WIDTH, 0, PANEL_WIDTH, 16);
+        CHECK(p != NULL);
+        check_pixels(row_out, image + y * PANEL_WIDTH, PANEL_WIDTH, 16);
+    }
+    CHECK(p == rle + len);
+}
+
+static void check_panel(void) {
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        for (int x = 0; x < PANEL_WIDTH; x++) {
+            CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, x, y), image[y * PANEL_WIDTH + x]);
+        }
+    }
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+typedef struct {
+    double call_ms;         // wall clock
+    double panel_ms;        // virtual clock
+} blit_cost_t;
+
+static void wait_idle(void) {
+    mp_host_call(display_mod, "LCD_waitIdle", 0);
+    sim_lcd_drain();
+}
+
+// FRAMES whole screen blits, raw or RLE: per frame the time until the call
+// returns and until the panel has it all. The raw window is queued at once,
+// the RLE blit returns once its last row is in a line buffer
+static blit_cost_t blit(bool raw, mp_obj_t data) {
+    mp_buffer_info_t buf;
+    CHECK(mp_get_buffer(data, &buf, MP_BUFFER_WRITE));
+    uint64_t call_ns = 0;
+    uint64_t panel_us = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        // add_window swaps the pixels in place
+        if (raw) {
+            memcpy(buf.buf, image, sizeof(image));
+        }
+        mp_host_call(display, "fill_rect", 5, int_obj(0), int_obj(0), int_obj(PANEL_WIDTH - 1), int_obj(PANEL_HEIGHT - 1), int_obj(0));
+        wait_idle();
+        uint64_t start_us = sim_clock_now();
+        uint64_t start_ns = now_ns();
+        if (raw) {
+            mp_host_call(display, "add_window", 5, int_obj(0), int_obj(0),
+                int_obj(PANEL_WIDTH - 1), int_obj(PANEL_HEIGHT - 1), data);
+        } else {
+            CHECK(mp_host_call(display, "blit_rle", 3, int_obj(0), int_obj(0), data) == mp_const_true);
+        }
+        call_ns += now_ns() - start_ns;
+        wait_idle();
+        panel_us += sim_clock_now() - start_us;
+        check_panel();
+    }
+    return (blit_cost_t){ call_ns / 1e6 / FRAMES, panel_us / 1e3 / FRAMES };
+}
+
+// Host CPU per frame: the RLE rows decoded into one line buffer, or the raw
+// frame byte swapped as add_window does
+static double frame_cpu_ms(bool raw, size_t len) {
+    static uint16_t frame[PANEL_WIDTH * PANEL_HEIGHT];
+    memcpy(frame, image, sizeof(image));
+    uint64_t frames = 0;
+    uint64_t start = now_ns();
+    uint64_t elapsed;
+    do {
+        if (raw) {
+            pixels_swap_rgb565(frame, PANEL_WIDTH * PANEL_HEIGHT);
+        } else {
+            const uint8_t *p = rle + 8;
+            for (int y = 0; y < PANEL_HEIGHT; y++) {
+                p = pixels_rle_row(row_out, p, rle + len, PANEL_WIDTH, 0, PANEL_WIDTH, 16);
+            }
+            CHECK(p == rle + len);
+        }
+        frames++;
+        elapsed = now_ns() - start;
+    } while (elapsed < BENCH_NS);
+    return elapsed / 1e6 / frames;
+}
+
+int main(void) {
+    pixels_init();
+    check_decoder(16);
+    check_decoder(24);
+
+    make_background();
+    size_t len = encode(rle, image, PANEL_WIDTH, PANEL_HEIGHT);
+    CHECK(len <= sizeof(rle));
+    check_round_trip(len);
+
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display_mod = mp_host_import("spd2010_display");
+    display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(display_mod, "LCD_shadow", 1, mp_const_true) == mp_const_true);
+
+    // The RLE image through the line buffers and the raw one as one window
+    blit_cost_t packed = blit(false, mp_obj_new_bytearray(len, rle));
+    blit_cost_t raw = blit(true, mp_obj_new_bytearray(sizeof(image), image));
+    printf("rle: raw %7zu bytes in RAM, %6.3f ms CPU a frame, call %6.2f ms, on the panel after %6.2f ms\n",
+        sizeof(image), frame_cpu_ms(true, len), raw.call_ms, raw.panel_ms);
+    printf("rle: rle %7zu bytes in RAM, %6.3f ms CPU a frame, call %6.2f ms, on the panel after %6.2f ms\n",
+        len, frame_cpu_ms(false, len), packed.call_ms, packed.panel_ms);
+    printf("rle: %.1f%% of the raw size\n", 100.0 * (double)len / sizeof(image));
+
+    // A cut image is refused
+    CHECK(mp_host_call(display, "blit_rle", 3, int_obj(0), int_obj(0), mp_obj_new_bytes(rle, len - 1)) == mp_const_false);
+    wait_idle();
+
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("rle: ok\n");
+    return 0;
+}
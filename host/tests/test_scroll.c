@@ -0,0 +1,152 @@
+/*
+ * Hardware scroll through lvgl_driver.scroll(): a list in a band of the
+ * screen moved down and back up, at 16 and 18 bits a pixel. The first call
+ * for an area redraws everything and saves nothing, the others send only the
+ * exposed lines. The panel then shows what a full redraw shows. Reports the
+ * bytes on the bus and the bytes saved
+ */
+
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+#define SRC_RGB565  16
+#define TOP         40
+#define HEIGHT      320
+#define ROW_H       16
+#define ROWS        60
+#define STEP        8
+#define STEPS       20
+
+static board_t board;
+static mp_obj_t display_mod;
+static mp_obj_t lvgl;
+static lv_obj_t *list;
+static int shift;           // y of the first row in the list
+static int step_dy;
+static uint16_t shown[PANEL_WIDTH * PANEL_HEIGHT];
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static void place_rows(void) {
+    for (int i = 0; i < ROWS; i++) {
+        lv_obj_set_y(lv_obj_get_child(list, i), shift + i * ROW_H);
+    }
+}
+
+// The fn of scroll(): moves the list content by step_dy lines
+STATIC mp_obj_t move_rows(void) {
+    shift += step_dy;
+    place_rows();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(move_rows_obj, move_rows);
+
+static void settle(void) {
+    for (int i = 0; i < 2; i++) {
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(30 * 1000);
+    }
+    mp_host_call(display_mod, "LCD_waitIdle", 0);
+    sim_lcd_drain();
+}
+
+static mp_int_t scroll(int top, int height, int dy) {
+    step_dy = dy;
+    mp_int_t saved = mp_obj_get_int(mp_host_call(lvgl, "scroll", 4, int_obj(top), int_obj(height), int_obj(dy), MP_OBJ_FROM_PTR(&move_rows_obj)));
+    settle();
+    return saved;
+}
+
+static uint64_t bus_bytes(void) {
+    sim_lcd_stats_t stats;
+    sim_lcd_get_stats(&stats);
+    return stats.color_bytes;
+}
+
+// What the panel shows is what a redraw of the whole screen shows
+static void check_panel(void) {
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        for (int x = 0; x < PANEL_WIDTH; x++) {
+            shown[y * PANEL_WIDTH + x] = spd2010_shadow_pixel(&board.panel.shadow, x, y);
+        }
+    }
+    lv_obj_invalidate(lv_scr_act());
+    settle();
+    for (int y = 0; y < PANEL_HEIGHT; y++) {
+        for (int x = 0; x < PANEL_WIDTH; x++) {
+            CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, x, y), shown[y * PANEL_WIDTH + x]);
+        }
+    }
+}
+
+static void scroll_pass(int bpp) {
+    int pixel_bytes = bpp == 16 ? 2 : 3;
+    CHECK(mp_host_call(display_mod, "LCD_colorFormat", 2, int_obj(SRC_RGB565), int_obj(bpp)) == mp_const_true);
+    CHECK_EQ(scroll(0, 0, 0), 0);
+    lv_obj_invalidate(lv_scr_act());
+    settle();
+
+    // A new area: everything is redrawn, nothing saved
+    uint64_t before = bus_bytes();
+    CHECK_EQ(scroll(TOP, HEIGHT, STEP), 0);
+    CHECK(bus_bytes() - before >= (uint64_t)PANEL_WIDTH * PANEL_HEIGHT * pixel_bytes);
+    check_panel();
+
+    // Down, then back up: only the exposed lines go out
+    before = bus_bytes();
+    mp_int_t saved = 0;
+    for (int i = 0; i < STEPS; i++) {
+        int dy = i < STEPS / 2 ? STEP : -STEP;
+        mp_int_t s = scroll(TOP, HEIGHT, dy);
+        CHECK_EQ(s, (HEIGHT - STEP) * PANEL_WIDTH * pixel_bytes);
+        saved += s;
+    }
+    uint64_t sent = bus_bytes() - before;
+    CHECK_EQ(sent, (uint64_t)STEPS * STEP * PANEL_WIDTH * pixel_bytes);
+    CHECK_EQ(sent + saved, (uint64_t)STEPS * HEIGHT * PANEL_WIDTH * pixel_bytes);
+    check_panel();
+
+    printf("scroll: %d bpp, %d steps of %d lines, %llu bytes on the bus, %lld saved, %.1f%% of a band redraw\n",
+        bpp, STEPS, STEP, (unsigned long long)sent, (long long)saved,
+        100.0 * (double)sent / (double)(sent + saved));
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(display_mod, "LCD_shadow", 1, mp_const_true) == mp_const_true);
+    lvgl = mp_host_import("lvgl_driver");
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+
+    // A list filling the band, rows above and below it to scroll in
+    list = lv_obj_create(lv_scr_act());
+    lv_obj_set_pos(list, 0, TOP);
+    lv_obj_set_size(list, PANEL_WIDTH, HEIGHT);
+    lv_obj_set_style_bg_color(list, lv_color_black(), 0);
+    for (int i = 0; i < ROWS; i++) {
+        lv_obj_t *row = lv_obj_create(list);
+        lv_obj_set_size(row, PANEL_WIDTH - 2 * i, ROW_H);
+        lv_obj_set_x(row, i);
+        lv_obj_set_style_bg_color(row, lv_color_make(i * 4, 255 - i * 4, (i * 37) & 0xFF), 0);
+    }
+    shift = -(ROWS * ROW_H - HEIGHT) / 2;
+    place_rows();
+
+    scroll_pass(16);
+    scroll_pass(18);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("scroll: ok\n");
+    return 0;
+}
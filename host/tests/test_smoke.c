@@ -0,0 +1,54 @@
+/*
+ * Every module on the modelled board: bring up the buses, the panel and LVGL,
+ * render a screen and find it in the panel's frame memory
+ */
+
+#include "lvgl.h"
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+static board_t board;
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+
+    mp_obj_t i2c = mp_host_import("i2c_driver");
+    mp_obj_t tca = mp_host_import("tca9554");
+    mp_obj_t display_mod = mp_host_import("spd2010_display");
+    mp_obj_t lvgl = mp_host_import("lvgl_driver");
+
+    mp_host_call(i2c, "init", 0);
+    mp_host_call(tca, "TCA9554PWR_Init", 1, MP_OBJ_NEW_SMALL_INT(0x00));
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+
+    // Hardware reset through EXIO2, then the init sequence woke the panel up
+    CHECK(board.panel.resets >= 1);
+    CHECK(!board.panel.sleeping);
+    CHECK(board.panel.display_on);
+
+    CHECK(mp_host_call(lvgl, "init", 0) == mp_const_true);
+    lv_obj_set_style_bg_color(lv_scr_act(), lv_color_make(0xFF, 0, 0), 0);
+    for (int i = 0; i < 10; i++) {
+        mp_host_call(lvgl, "loop", 0);
+        sim_sleep_us(30 * 1000);
+    }
+    sim_lcd_drain();
+
+    // Red screen, the driver's label across the middle
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 10, 10), 0xF800);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, PANEL_WIDTH - 10, PANEL_HEIGHT - 10), 0xF800);
+    int label = 0;
+    for (int x = 0; x < PANEL_WIDTH; x++) {
+        label += spd2010_shadow_pixel(&board.panel.shadow, x, PANEL_HEIGHT / 2) != 0xF800;
+    }
+    CHECK(label > 0);
+
+    mp_host_call(lvgl, "deinit", 0);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("smoke: ok\n");
+    return 0;
+}
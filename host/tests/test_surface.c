@@ -0,0 +1,112 @@
+/*
+ * Surface: blits from the DMA buffer, a bounded wait for them, and a buffer
+ * that outlives deinit() until the surface is collected
+ */
+
+#include <malloc.h>
+#include "models.h"
+#include "mphost.h"
+#include "py/mperrno.h"
+#include "test.h"
+
+#define SIDE        100
+
+static board_t board;
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static mp_obj_t new_surface(void) {
+    mp_obj_t args[] = { int_obj(SIDE), int_obj(SIDE) };
+    return mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Surface"), 2, args);
+}
+
+static void test_blit(void) {
+    mp_obj_t surface = new_surface();
+    mp_host_call(surface, "fill", 1, int_obj(0xF81F));
+    CHECK(mp_host_call(surface, "blit", 2, int_obj(10), int_obj(10)) == mp_const_true);
+    CHECK(mp_host_call(surface, "wait", 0) == mp_const_true);
+    CHECK(mp_host_call(surface, "busy", 0) == mp_const_false);
+    sim_lcd_drain();
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 10, 10), 0xF81F);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 10 + SIDE - 1, 10 + SIDE - 1), 0xF81F);
+}
+
+// With the bus stopped wait() gives up and fill() raises instead of drawing
+// into a buffer the DMA still reads
+static void test_timeout(void) {
+    mp_obj_t surface = new_surface();
+    sim_lcd_hold(true);
+    CHECK(mp_host_call(surface, "blit", 2, int_obj(0), int_obj(0)) == mp_const_true);
+    uint64_t start = sim_clock_now();
+    CHECK(mp_host_call(surface, "wait", 1, int_obj(50)) == mp_const_false);
+    CHECK(sim_clock_now() - start >= 50 * 1000);
+
+    mp_obj_t ret;
+    mp_obj_exception_t *exc = mp_host_call_catch(&ret, surface, "fill", 1, int_obj(0));
+    CHECK(exc != NULL);
+    CHECK_EQ(exc->errno_, MP_ETIMEDOUT);
+
+    sim_lcd_hold(false);
+    CHECK(mp_host_call(surface, "wait", 0) == mp_const_true);
+    mp_host_call(surface, "fill", 1, int_obj(0));
+}
+
+// After deinit() no new views and no blits, the buffer of the old views stays
+// until the surface is collected
+static void test_deinit(void) {
+    mp_host_soft_reset();
+    size_t before = mallinfo2().uordblks;
+    mp_obj_t surface = new_surface();
+    mp_buffer_info_t view;
+    CHECK(mp_get_buffer(surface, &view, MP_BUFFER_WRITE));
+    CHECK_EQ(view.len, SIDE * SIDE * 2);
+
+    mp_host_call(surface, "deinit", 0);
+    mp_buffer_info_t again;
+    CHECK(!mp_get_buffer(surface, &again, MP_BUFFER_WRITE));
+    mp_obj_t ret;
+    CHECK(mp_host_call_catch(&ret, surface, "blit", 2, int_obj(0), int_obj(0)) != NULL);
+    CHECK(mallinfo2().uordblks >= before + SIDE * SIDE * 2);
+    ((uint8_t *)view.buf)[view.len - 1] = 0xFF;
+
+    mp_host_soft_reset();
+    printf("deinit: heap %zu -> %zu bytes\n", before, mallinfo2().uordblks);
+    CHECK(mallinfo2().uordblks <= before);
+}
+
+// Collected while its blit is on the bus: the finaliser waits a bounded time
+// without the VM, then leaves the buffer to the DMA
+static void test_collect_busy(void) {
+    mp_obj_t surface = new_surface();
+    sim_lcd_hold(true);
+    CHECK(mp_host_call(surface, "blit", 2, int_obj(0), int_obj(0)) == mp_const_true);
+    uint64_t start = sim_clock_now();
+    mp_host_soft_reset();
+    CHECK(sim_clock_now() - start >= 1000 * 1000);
+    sim_lcd_hold(false);
+    sim_lcd_drain();
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    mp_obj_t display_mod = mp_host_import("spd2010_display");
+    mp_obj_t display = mp_host_new(mp_host_attr(display_mod, "Display"), 0, NULL);
+    CHECK(mp_host_call(display, "init", 0) == mp_const_true);
+    CHECK(mp_host_call(display_mod, "LCD_shadow", 1, mp_const_true) == mp_const_true);
+
+    test_blit();
+    test_timeout();
+    test_deinit();
+    test_collect_busy();
+
+    display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+    mp_host_call(display, "deinit", 0);
+    board_deinit(&board);
+    printf("surface: ok\n");
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * Warm re-init: init(warm=True) on a panel that is still configured skips the
+ * reset and the vendor init table and keeps the frame memory, a panel that
+ * lost its configuration falls back to the cold init, and init() is always
+ * cold. Reports the time a warm init saves on the virtual clock
+ */
+
+#include "models.h"
+#include "mphost.h"
+#include "test.h"
+
+static board_t board;
+static mp_obj_t display;
+
+typedef struct {
+    uint32_t vendor_cmds;
+    uint32_t resets;
+    uint32_t ms;
+} init_cost_t;
+
+static mp_obj_t int_obj(mp_int_t v) {
+    return MP_OBJ_NEW_SMALL_INT(v);
+}
+
+static init_cost_t init(bool warm) {
+    uint32_t vendor = board.panel.vendor_cmds;
+    uint32_t resets = board.panel.resets;
+    uint64_t start = sim_clock_now();
+    CHECK(mp_host_call(display, "init", 1, mp_obj_new_bool(warm)) == mp_const_true);
+    init_cost_t cost = {
+        .vendor_cmds = board.panel.vendor_cmds - vendor,
+        .resets = board.panel.resets - resets,
+        .ms = (uint32_t)((sim_clock_now() - start) / 1000),
+    };
+    CHECK(board.panel.display_on);
+    CHECK(!board.panel.sleeping);
+    return cost;
+}
+
+static void fill(uint16_t color) {
+    mp_host_call(display, "fill_rect", 5, int_obj(0), int_obj(0), int_obj(31), int_obj(31), int_obj(color));
+    mp_host_call(mp_host_import("spd2010_display"), "LCD_waitIdle", 0);
+    sim_lcd_drain();
+}
+
+int main(void) {
+    mp_host_init();
+    board_init(&board);
+    mp_host_call(mp_host_import("i2c_driver"), "init", 0);
+    mp_host_call(mp_host_import("tca9554"), "TCA9554PWR_Init", 1, int_obj(0x00));
+    display = mp_host_new(mp_host_attr(mp_host_import("spd2010_display"), "Display"), 0, NULL);
+
+    // Cold: reset and the whole vendor table
+    init_cost_t cold = init(false);
+    CHECK(cold.vendor_cmds > 0);
+    CHECK(cold.resets > 0);
+    fill(0x1234);
+    mp_host_call(display, "deinit", 0);
+
+    // Warm on the configured panel: none of it, the picture stays
+    init_cost_t warm = init(true);
+    CHECK_EQ(warm.vendor_cmds, 0);
+    CHECK_EQ(warm.resets, 0);
+    CHECK_EQ(spd2010_shadow_pixel(&board.panel.shadow, 7, 7), 0x1234);
+    CHECK(warm.ms < cold.ms);
+    mp_host_call(display, "deinit", 0);
+
+    // Warm after the panel was reset: it is not configured, so cold after all
+    panel_model_reset(&board.panel);
+    init_cost_t fallback = init(true);
+    CHECK_EQ(fallback.vendor_cmds, cold.vendor_cmds);
+    CHECK(fallback.resets > 0);
+    mp_host_call(display, "deinit", 0);
+
+    // Cold on a configured panel still runs the table
+    CHECK_EQ(init(false).vendor_cmds, cold.vendor_cmds);
+    mp_host_call(display, "deinit", 0);
+
+    printf("warm init: cold %u ms, warm %u ms, %u ms saved, %u vendor commands skipped\n",
+        (unsigned)cold.ms, (unsigned)warm.ms, (unsigned)(cold.ms - warm.ms), (unsigned)cold.vendor_cmds);
+    board_deinit(&board);
+    printf("warm init: ok\n");
+    return 0;
+}
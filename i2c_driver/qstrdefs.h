@@ -1,8 +1,8 @@
-// modules/i2c_driver/qstrdefs.h
-Q(i2c_driver)
-Q(init)
-Q(read)
-Q(write)
-Q(SCL_PIN)
-Q(SDA_PIN)
+// modules/i2c_driver/qstrdefs.h
+Q(i2c_driver)
+Q(init)
+Q(read)
+Q(write)
+Q(SCL_PIN)
+Q(SDA_PIN)
 Q(FREQ_HZ)
\ No newline at end of file
@@ -1,186 +1,1383 @@
-/*
- * LVGL Driver for MicroPython
- * Adapted from LVGL_Driver.cpp/.h
- */
-
-#include "py/obj.h"
-#include "py/runtime.h"
-#include "py/mphal.h"
-#include "lvgl.h"
-#include "esp_log.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-#include "esp_timer.h"
-
-#define TAG "lvgl_driver"
-#define LVGL_BUF_LEN (LV_HOR_RES_MAX * LV_VER_RES_MAX / 10)
-#define EXAMPLE_LVGL_TICK_PERIOD_MS 2
-
-// Forward declarations
-extern mp_obj_t spd2010_display_add_window(mp_obj_t x_start_obj, mp_obj_t y_start_obj, mp_obj_t x_end_obj, mp_obj_t y_end_obj, mp_obj_t color_obj);
-extern mp_obj_t spd2010_touch_get_xy(void);
-
-// Display buffer for LVGL
-static lv_disp_draw_buf_t draw_buf;
-static lv_color_t buf1[LVGL_BUF_LEN];
-static lv_color_t buf2[LVGL_BUF_LEN];
-static esp_timer_handle_t lvgl_tick_timer = NULL;
-
-// Print callback for LVGL
-void lvgl_print(const char *buf) {
-    // Use ESP-IDF logging instead of Serial
-    ESP_LOGI(TAG, "%s", buf);
-}
-
-// Rounder callback for LVGL
-void lvgl_port_rounder_callback(struct _lv_disp_drv_t *disp_drv, lv_area_t *area) {
-    uint16_t x1 = area->x1;
-    uint16_t x2 = area->x2;
-
-    // Round the start of coordinate down to the nearest 4M number
-    area->x1 = (x1 >> 2) << 2;
-
-    // Round the end of coordinate up to the nearest 4N+3 number
-    area->x2 = ((x2 >> 2) << 2) + 3;
-}
-
-// Display flush callback for LVGL
-void lvgl_display_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
-    mp_obj_t args[] = {
-        mp_obj_new_int(area->x1),
-        mp_obj_new_int(area->y1),
-        mp_obj_new_int(area->x2),
-        mp_obj_new_int(area->y2),
-        mp_obj_new_bytearray((area->x2 - area->x1 + 1) * (area->y2 - area->y1 + 1) * sizeof(lv_color_t), (uint8_t*)color_p)
-    };
-    
-    spd2010_display_add_window(args[0], args[1], args[2], args[3], args[4]);
-    lv_disp_flush_ready(disp_drv);
-}
-
-// Touch read callback for LVGL
-void lvgl_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data) {
-    mp_obj_t touch_data = spd2010_touch_get_xy();
-    
-    if (touch_data != mp_const_none) {
-        mp_obj_t pressed_obj = mp_obj_dict_get(touch_data, mp_obj_new_str("pressed", 7));
-        
-        if (mp_obj_is_true(pressed_obj)) {
-            mp_obj_t x_obj = mp_obj_dict_get(touch_data, mp_obj_new_str("x", 1));
-            mp_obj_t y_obj = mp_obj_dict_get(touch_data, mp_obj_new_str("y", 1));
-            
-            data->point.x = mp_obj_get_int(x_obj);
-            data->point.y = mp_obj_get_int(y_obj);
-            data->state = LV_INDEV_STATE_PR;
-        } else {
-            data->state = LV_INDEV_STATE_REL;
-        }
-    } else {
-        data->state = LV_INDEV_STATE_REL;
-    }
-}
-
-// LVGL tick increment callback
-void lvgl_tick_inc_cb(void *arg) {
-    lv_tick_inc(EXAMPLE_LVGL_TICK_PERIOD_MS);
-}
-
-// Initialize LVGL
-STATIC mp_obj_t lvgl_driver_init(void) {
-    // Initialize LVGL
-    lv_init();
-    
-    // Initialize display buffer
-    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, LVGL_BUF_LEN);
-
-    // Initialize display driver
-    static lv_disp_drv_t disp_drv;
-    lv_disp_drv_init(&disp_drv);
-    disp_drv.hor_res = LV_HOR_RES_MAX;
-    disp_drv.ver_res = LV_VER_RES_MAX;
-    disp_drv.flush_cb = lvgl_display_flush;
-    disp_drv.rounder_cb = lvgl_port_rounder_callback;
-    disp_drv.full_refresh = 1;                    // 1: Always make the whole screen redrawn
-    disp_drv.draw_buf = &draw_buf;
-    lv_disp_drv_register(&disp_drv);
-    
-    // Initialize touch input driver
-    static lv_indev_drv_t indev_drv;
-    lv_indev_drv_init(&indev_drv);
-    indev_drv.type = LV_INDEV_TYPE_POINTER;
-    indev_drv.read_cb = lvgl_touchpad_read;
-    lv_indev_drv_register(&indev_drv);
-    
-    // Create a simple label to test
-    lv_obj_t *label = lv_label_create(lv_scr_act());
-    lv_label_set_text(label, "Hello Arduino and LVGL!");
-    lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
-    
-    // Set up periodic timer for LVGL ticks
-    const esp_timer_create_args_t lvgl_tick_timer_args = {
-        .callback = &lvgl_tick_inc_cb,
-        .name = "lvgl_tick"
-    };
-    if (esp_timer_create(&lvgl_tick_timer_args, &lvgl_tick_timer) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to create LVGL tick timer");
-        return mp_const_false;
-    }
-    
-    // Start timer with period in microseconds
-    if (esp_timer_start_periodic(lvgl_tick_timer, EXAMPLE_LVGL_TICK_PERIOD_MS * 1000) != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start LVGL tick timer");
-        return mp_const_false;
-    }
-    
-    return mp_const_true;
-}
-STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_init_obj, lvgl_driver_init);
-
-// LVGL task handler
-STATIC mp_obj_t lvgl_driver_loop(void) {
-    lv_task_handler();
-    return mp_const_none;
-}
-STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_loop_obj, lvgl_driver_loop);
-
-// Print function for LVGL
-STATIC mp_obj_t lvgl_driver_print(mp_obj_t buf_obj) {
-    const char *buf = mp_obj_str_get_str(buf_obj);
-    lvgl_print(buf);
-    return mp_const_none;
-}
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(lvgl_driver_print_obj, lvgl_driver_print);
-
-// Module cleanup
-STATIC mp_obj_t lvgl_driver_deinit(void) {
-    if (lvgl_tick_timer != NULL) {
-        esp_timer_stop(lvgl_tick_timer);
-        esp_timer_delete(lvgl_tick_timer);
-        lvgl_tick_timer = NULL;
-    }
-    return mp_const_none;
-}
-STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_deinit_obj, lvgl_driver_deinit);
-
-// Module globals table
-STATIC const mp_rom_map_elem_t lvgl_driver_module_globals_table[] = {
-    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_lvgl_driver) },
-    { MP_ROM_QSTR(MP_QSTR_init), MP_ROM_PTR(&lvgl_driver_init_obj) },
-    { MP_ROM_QSTR(MP_QSTR_loop), MP_ROM_PTR(&lvgl_driver_loop_obj) },
-    { MP_ROM_QSTR(MP_QSTR_print), MP_ROM_PTR(&lvgl_driver_print_obj) },
-    { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&lvgl_driver_deinit_obj) },
-    
-    // Constants
-    { MP_ROM_QSTR(MP_QSTR_TICK_PERIOD_MS), MP_ROM_INT(EXAMPLE_LVGL_TICK_PERIOD_MS) },
-    { MP_ROM_QSTR(MP_QSTR_BUFFER_SIZE), MP_ROM_INT(LVGL_BUF_LEN) },
-};
-STATIC MP_DEFINE_CONST_DICT(lvgl_driver_module_globals, lvgl_driver_module_globals_table);
-
-// Module definition
-const mp_obj_module_t lvgl_driver_user_cmodule = {
-    .base = { &mp_type_module },
-    .globals = (mp_obj_dict_t*)&lvgl_driver_module_globals,
-};
-
-// Register the module
+/*
+ * LVGL Driver for MicroPython
+ * Adapted from LVGL_Driver.cpp/.h
+ */
+
+#include <string.h>
+#include "py/obj.h"
+#include "py/runtime.h"
+#include "py/mphal.h"
+#include "lvgl.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_attr.h"
+#if LVGL_DRIVER_MEM_POOL
+#include "lv_mem_pool.h"
+#endif
+#include "lv_cache_budget.h"
+#include "lv_power.h"
+#include "lv_bench.h"
+#include "lv_latency.h"
+
+#define TAG "lvgl_driver"
+#if LVGL_DRIVER_FULL_FRAME
+// One buffer holding the whole frame, meant for LV_COLOR_DEPTH 8 (412 x 412
+// bytes). The flush gives it back once its transfers are out, which at depth 8
+// is soon: the frame is converted into the display's own DMA buffers
+#define LVGL_BUF_LEN (LV_HOR_RES_MAX * LV_VER_RES_MAX)
+#define LVGL_BUF_COUNT 1
+#else
+#define LVGL_BUF_LEN (LV_HOR_RES_MAX * LV_VER_RES_MAX / 10)
+#define LVGL_BUF_COUNT 2
+#endif
+// Native LVGL task: message queue depth, the longest sleep between timer runs
+// and how long it waits for the lock before checking whether it was stopped
+#define LVGL_MSG_QUEUE_LEN 16
+#define LVGL_TASK_MAX_SLEEP_MS 500
+#define LVGL_TASK_LOCK_SLICE_MS 10
+
+// Bands queued between the render and the transfer core, LVGL keeps at most two in flight
+#define BAND_QUEUE_LEN 4
+
+// Longest sleep in wait() before pending MicroPython events (Ctrl-C, scheduled callbacks) are handled
+#define LVGL_WAIT_SLICE_MS 100
+
+// Bounds of the IRAM code section, from the IDF linker script
+extern int _iram_text_start;
+extern int _iram_text_end;
+
+// Forward declarations
+extern bool spd2010_display_draw_pixels(int x_start, int y_start, int x_end, int y_end, void *color);
+extern bool spd2010_touch_read_xy(uint16_t *x, uint16_t *y);
+extern mp_obj_t spd2010_display_scroll_area(mp_obj_t top_obj, mp_obj_t height_obj);
+extern mp_obj_t spd2010_display_scroll(mp_obj_t dy_obj);
+extern mp_obj_t spd2010_display_color_format(mp_obj_t src_obj, mp_obj_t bpp_obj);
+extern mp_obj_t spd2010_display_wait_idle(void);
+extern int spd2010_display_pixel_bytes(void);
+extern void spd2010_touch_set_isr_callback(void (*callback)(void *arg), void *arg);
+extern void spd2010_display_cabc_frame_done(void);
+extern bool spd2010_display_cabc_take_redraw(void);
+extern int64_t spd2010_touch_irq_us(void);
+extern uint32_t spd2010_display_tx_target(void);
+extern bool spd2010_display_tx_reached(uint32_t target);
+extern void spd2010_display_set_tx_done_callback(bool (*callback)(void *arg), void *arg);
+
+// Display buffer for LVGL
+static lv_disp_draw_buf_t draw_buf;
+static lv_color_t *buf1 = NULL;
+static lv_color_t *buf2 = NULL;
+static uint32_t buf_len = 0;                // pixels per draw buffer
+static SemaphoreHandle_t wake_sem = NULL;   // given by the touch ISR
+
+// Messages for the native LVGL task
+enum {
+    LVGL_MSG_TOUCH,         // x1, y1: point, pressed
+    LVGL_MSG_INVALIDATE,    // x1, y1, x2, y2: area, or the whole screen with x2 < x1
+    LVGL_MSG_WAKE,          // touch interrupt, lets the power manager wake the panel
+    LVGL_MSG_STOP,
+};
+
+typedef struct {
+    uint8_t type;
+    uint8_t pressed;
+    int16_t x1;
+    int16_t y1;
+    int16_t x2;
+    int16_t y2;
+} lvgl_msg_t;
+
+// Held by whoever calls into LVGL: the native task while it runs timers, Python through lock()
+static SemaphoreHandle_t lvgl_mutex = NULL;
+static QueueHandle_t msg_queue = NULL;
+static TaskHandle_t lvgl_task_handle = NULL;
+static volatile bool lvgl_task_running = false;
+
+// Touch state posted through the queue, read by LVGL while the native task runs
+static lv_point_t task_touch_point;
+static bool task_touch_pressed = false;
+
+// Render/transfer pipeline: the flush queues bands for a transfer task on the
+// other core. Single producer (flush) and single consumer (transfer task), so
+// the ring needs no lock, only ordered head/tail updates
+typedef struct {
+    lv_area_t area;
+    lv_color_t *color;
+    bool last;              // last band of the frame
+} band_t;
+
+static band_t band_queue[BAND_QUEUE_LEN];
+static uint32_t band_head = 0;              // written by the flush
+static uint32_t band_tail = 0;              // written by the transfer task
+static TaskHandle_t transfer_task_handle = NULL;
+static volatile bool pipeline_running = false;
+static uint32_t pipeline_bands = 0;
+static uint32_t pipeline_max_depth = 0;
+static uint64_t pipeline_transfer_us = 0;
+static lv_disp_drv_t disp_drv;
+
+// Hardware scroll area currently set on the panel (height 0: off)
+static int scroll_top = 0;
+static int scroll_height = 0;
+
+// Print callback for LVGL
+void lvgl_print(const char *buf) {
+    // Use ESP-IDF logging instead of Serial
+    ESP_LOGI(TAG, "%s", buf);
+}
+
+// Rounder callback for LVGL
+void lvgl_port_rounder_callback(struct _lv_disp_drv_t *disp_drv, lv_area_t *area) {
+    uint16_t x1 = area->x1;
+    uint16_t x2 = area->x2;
+
+    // Round the start of coordinate down to the nearest 4M number
+    area->x1 = (x1 >> 2) << 2;
+
+    // Round the end of coordinate up to the nearest 4N+3 number
+    area->x2 = ((x2 >> 2) << 2) + 3;
+}
+
+// Display flush callback for LVGL
+void LV_ATTRIBUTE_FAST_MEM lvgl_display_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p) {
+    int64_t start = esp_timer_get_time();
+    if (transfer_task_handle != NULL) {
+        // Hand the band to the transfer core, it reports flush ready when sent
+        uint32_t head = band_head;
+        while (head - __atomic_load_n(&band_tail, __ATOMIC_ACQUIRE) >= BAND_QUEUE_LEN) {
+            taskYIELD();
+        }
+        band_queue[head % BAND_QUEUE_LEN].area = *area;
+        band_queue[head % BAND_QUEUE_LEN].color = color_p;
+        band_queue[head % BAND_QUEUE_LEN].last = lv_disp_flush_is_last(disp_drv);
+        lv_latency_flush(lv_disp_flush_is_last(disp_drv));
+        __atomic_store_n(&band_head, head + 1, __ATOMIC_RELEASE);
+        xTaskNotifyGive(transfer_task_handle);
+        lv_bench_add_flush_us(esp_timer_get_time() - start);
+        return;
+    }
+    
+    // No MicroPython objects here, the flush may run in the native LVGL task
+    lv_latency_flush(lv_disp_flush_is_last(disp_drv));
+    spd2010_display_draw_pixels(area->x1, area->y1, area->x2, area->y2, color_p);
+    if (lv_disp_flush_is_last(disp_drv)) {
+        spd2010_display_cabc_frame_done();
+        lv_latency_frame_queued();
+    }
+#if LVGL_BUF_COUNT == 1
+    // The DMA may read the band straight from the only buffer, which LVGL
+    // draws into again as soon as it is ready
+    uint32_t target = spd2010_display_tx_target();
+    while (!spd2010_display_tx_reached(target)) {
+        taskYIELD();
+    }
+#endif
+    lv_bench_add_flush_us(esp_timer_get_time() - start);
+    lv_disp_flush_ready(disp_drv);
+}
+
+// Color transfer done interrupt: the transfer task may be waiting for its band
+STATIC bool IRAM_ATTR lvgl_transfer_wake(void *arg) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)arg, &woken);
+    return woken == pdTRUE;
+}
+
+// Transfer task: swaps/converts the queued bands and submits them to the panel
+// in order, while LVGL renders the next band on the other core. The DMA may
+// read a band straight from the LVGL buffer, so LVGL gets the buffer back only
+// once the band's transfers are done
+STATIC void lvgl_transfer_task(void *arg) {
+    spd2010_display_set_tx_done_callback(lvgl_transfer_wake, xTaskGetCurrentTaskHandle());
+    for (;;) {
+        uint32_t tail = band_tail;
+        uint32_t head = __atomic_load_n(&band_head, __ATOMIC_ACQUIRE);
+        if (tail == head) {
+            // Leave only with an empty queue, LVGL waits for every queued band
+            if (!pipeline_running) {
+                break;
+            }
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+            continue;
+        }
+        if (head - tail > pipeline_max_depth) {
+            pipeline_max_depth = head - tail;
+        }
+        
+        band_t *band = &band_queue[tail % BAND_QUEUE_LEN];
+        int64_t start = esp_timer_get_time();
+        spd2010_display_draw_pixels(band->area.x1, band->area.y1, band->area.x2, band->area.y2, band->color);
+        uint32_t target = spd2010_display_tx_target();
+        if (band->last) {
+            spd2010_display_cabc_frame_done();
+            lv_latency_frame_queued();
+        }
+        uint32_t us = esp_timer_get_time() - start;
+        pipeline_transfer_us += us;
+        lv_bench_add_transfer_us(us);
+        pipeline_bands++;
+        
+        // A notification of a queued band only costs one more check
+        while (!spd2010_display_tx_reached(target)) {
+            ulTaskNotifyTake(pdTRUE, 1);
+        }
+        __atomic_store_n(&band_tail, tail + 1, __ATOMIC_RELEASE);
+        lv_disp_flush_ready(&disp_drv);
+    }
+    
+    // A tick for an interrupt that still has the callback to return
+    spd2010_display_set_tx_done_callback(NULL, NULL);
+    vTaskDelay(1);
+    transfer_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// Tag a touch sample for the latency histogram: presses and the release.
+// The time is that of the interrupt announcing the sample, or the read when
+// there was no new interrupt since the last one
+STATIC void lvgl_latency_touch(lv_indev_state_t state) {
+    static int64_t last_irq_us = 0;
+    static lv_indev_state_t last_state = LV_INDEV_STATE_REL;
+    
+    int64_t irq_us = spd2010_touch_irq_us();
+    if (state == LV_INDEV_STATE_PR || last_state == LV_INDEV_STATE_PR) {
+        lv_latency_sample(irq_us != last_irq_us ? irq_us : esp_timer_get_time());
+    }
+    last_irq_us = irq_us;
+    last_state = state;
+}
+
+// Touch read callback for LVGL, the same C read with or without the native task
+void lvgl_touchpad_read(lv_indev_drv_t *indev_drv, lv_indev_data_t *data) {
+    uint16_t x, y;
+    bool pressed = spd2010_touch_read_xy(&x, &y);
+    
+    // A touch posted to the native task stands in for the panel until its release
+    if (lvgl_task_handle != NULL && task_touch_pressed) {
+        data->point = task_touch_point;
+        data->state = LV_INDEV_STATE_PR;
+    } else if (pressed) {
+        data->point.x = x;
+        data->point.y = y;
+        data->state = LV_INDEV_STATE_PR;
+    } else {
+        data->state = LV_INDEV_STATE_REL;
+    }
+    // The touch that woke the screen does not press what is under it
+    if (lv_power_swallow_touch(data->state == LV_INDEV_STATE_PR)) {
+        data->state = LV_INDEV_STATE_REL;
+    }
+    lvgl_latency_touch(data->state);
+}
+
+// Touch read timer: LVGL's own, then whether the touch changed anything on
+// screen, which decides if its sample is followed into the next frame. An
+// area already invalid adds no entry, such samples go unmeasured
+STATIC void lvgl_indev_read_timer(lv_timer_t *timer) {
+    lv_disp_t *disp = lv_disp_get_default();
+    uint16_t inv_p = (disp != NULL) ? disp->inv_p : 0;
+    lv_indev_read_timer_cb(timer);
+    lv_latency_input_done(disp != NULL && disp->inv_p != inv_p);
+}
+
+// Touch interrupt: wake a sleeping wait() or the native task, and the panel
+static void lvgl_touch_wake(void *arg) {
+    BaseType_t woken = pdFALSE;
+    lv_power_wake_from_isr();
+    xSemaphoreGiveFromISR(wake_sem, &woken);
+    if (lvgl_task_handle != NULL && lv_power_get_state() != LV_POWER_ACTIVE) {
+        lvgl_msg_t msg = { .type = LVGL_MSG_WAKE };
+        xQueueSendFromISR(msg_queue, &msg, &woken);
+    }
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+// Milliseconds until an LVGL timer or the power manager has work to do. The
+// refresh timer is left out while nothing is invalid, the touch read timer
+// while the touch is released, as the touch interrupt wakes wait() for a new press.
+// Call with the LVGL lock held, the native task may change the timers meanwhile
+STATIC uint32_t lvgl_idle_deadline(void) {
+    lv_disp_t *disp = lv_disp_get_default();
+    lv_indev_t *indev = lv_indev_get_next(NULL);
+    bool disp_idle = (disp != NULL) && (disp->inv_p == 0);
+    bool touch_idle = (indev != NULL) && (indev->proc.state == LV_INDEV_STATE_REL);
+    uint32_t next = lv_power_next_ms();
+    
+    for (lv_timer_t *timer = lv_timer_get_next(NULL); timer != NULL; timer = lv_timer_get_next(timer)) {
+        if (timer->paused) {
+            continue;
+        }
+        if (disp_idle && timer == disp->refr_timer) {
+            continue;
+        }
+        if (touch_idle && timer == indev->driver->read_timer) {
+            continue;
+        }
+        uint32_t elapsed = lv_tick_elaps(timer->last_run);
+        uint32_t left = (elapsed >= timer->period) ? 0 : timer->period - elapsed;
+        if (left < next) {
+            next = left;
+        }
+    }
+    return next;
+}
+
+// Allocate draw buffers of len pixels, internal RAM first and PSRAM when it
+// does not fit. Buffers of the right size are kept across soft resets
+STATIC bool lvgl_alloc_draw_buf(uint32_t len) {
+    size_t size = len * sizeof(lv_color_t);
+    
+    if (len != buf_len) {
+        heap_caps_free(buf1);
+        heap_caps_free(buf2);
+        buf1 = NULL;
+        buf2 = NULL;
+        buf_len = len;
+    }
+    if (buf1 == NULL) {
+        buf1 = heap_caps_malloc_prefer(size, 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    if (LVGL_BUF_COUNT > 1 && buf2 == NULL) {
+        buf2 = heap_caps_malloc_prefer(size, 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    }
+    return buf1 != NULL && (LVGL_BUF_COUNT == 1 || buf2 != NULL);
+}
+
+// Take the LVGL lock, the GIL is released while waiting so the native task can finish
+STATIC bool lvgl_lock(int timeout_ms) {
+    if (lvgl_mutex == NULL || xSemaphoreTakeRecursive(lvgl_mutex, 0) == pdTRUE) {
+        return true;
+    }
+    MP_THREAD_GIL_EXIT();
+    bool locked = xSemaphoreTakeRecursive(lvgl_mutex, timeout_ms < 0 ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+    MP_THREAD_GIL_ENTER();
+    return locked;
+}
+
+STATIC void lvgl_unlock(void) {
+    if (lvgl_mutex != NULL) {
+        xSemaphoreGiveRecursive(lvgl_mutex);
+    }
+}
+
+// Call fn with the LVGL lock held, the lock is released if fn raises
+STATIC mp_obj_t lvgl_call_locked(mp_obj_t (*fn)(size_t n_args, const mp_obj_t *args), size_t n_args, const mp_obj_t *args) {
+    lvgl_lock(-1);
+    nlr_buf_t nlr;
+    if (nlr_push(&nlr) == 0) {
+        mp_obj_t ret = fn(n_args, args);
+        nlr_pop();
+        lvgl_unlock();
+        return ret;
+    }
+    lvgl_unlock();
+    nlr_jump(nlr.ret_val);
+}
+
+// The display changed its CABC gain, everything on the panel has to be boosted alike
+STATIC void lvgl_cabc_poll(void) {
+    if (spd2010_display_cabc_take_redraw() && lv_disp_get_default() != NULL) {
+        lv_obj_invalidate(lv_scr_act());
+    }
+}
+
+// Wait until LVGL has no band in flight and the panel has sent every transfer
+STATIC void lvgl_wait_flushed(void) {
+    // With the pipeline the last band may still be queued for the transfer core
+    while (draw_buf.flushing) {
+        taskYIELD();
+    }
+    spd2010_display_wait_idle();
+}
+
+// Full refresh renders the whole screen at once, only possible with a screen sized buffer
+STATIC bool lvgl_full_frame_buf(void) {
+    return buf_len >= LV_HOR_RES_MAX * LV_VER_RES_MAX;
+}
+
+// Initialize LVGL
+STATIC mp_obj_t lvgl_driver_init(void) {
+    if (lvgl_task_handle != NULL) {
+        ESP_LOGE(TAG, "Stop the LVGL task before init");
+        return mp_const_false;
+    }
+    if (lvgl_mutex == NULL) {
+        lvgl_mutex = xSemaphoreCreateRecursiveMutex();
+        if (lvgl_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create the LVGL lock");
+            return mp_const_false;
+        }
+    }
+    
+    // Initialize LVGL. A new LVGL starts with empty pools. In 8.3 lv_init()
+    // does nothing once initialized, so that is only after lv_deinit()
+#if LVGL_DRIVER_MEM_POOL
+    if (!lv_is_initialized()) {
+        lv_mem_pool_reset();
+    }
+#endif
+    lv_init();
+    
+    // Initialize display buffer
+    if (!lvgl_alloc_draw_buf(buf_len ? buf_len : LVGL_BUF_LEN)) {
+        ESP_LOGE(TAG, "Failed to allocate %d byte draw buffers", (int)(buf_len * sizeof(lv_color_t)));
+        return mp_const_false;
+    }
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, buf_len);
+
+    // Initialize display driver
+    lv_disp_drv_init(&disp_drv);
+    disp_drv.hor_res = LV_HOR_RES_MAX;
+    disp_drv.ver_res = LV_VER_RES_MAX;
+    disp_drv.flush_cb = lvgl_display_flush;
+    disp_drv.rounder_cb = lvgl_port_rounder_callback;
+    disp_drv.full_refresh = lvgl_full_frame_buf();  // 1: Always make the whole screen redrawn, needs a screen sized buffer
+    disp_drv.draw_buf = &draw_buf;
+    lv_disp_t *disp = lv_disp_drv_register(&disp_drv);
+    lv_cache_budget_init();
+    lv_power_init(disp);
+    
+    // The flush hands LVGL buffers over as they are, the display converts them
+    spd2010_display_color_format(mp_obj_new_int(LV_COLOR_DEPTH), mp_const_none);
+    
+    // Initialize touch input driver
+    static lv_indev_drv_t indev_drv;
+    lv_indev_drv_init(&indev_drv);
+    indev_drv.type = LV_INDEV_TYPE_POINTER;
+    indev_drv.read_cb = lvgl_touchpad_read;
+    lv_indev_t *indev = lv_indev_drv_register(&indev_drv);
+    lv_timer_set_cb(indev->driver->read_timer, lvgl_indev_read_timer);
+    
+    // Create a simple label to test
+    lv_obj_t *label = lv_label_create(lv_scr_act());
+    lv_label_set_text(label, "Hello Arduino and LVGL!");
+    lv_obj_align(label, LV_ALIGN_CENTER, 0, 0);
+    
+    // The tick comes from esp_timer_get_time (LV_TICK_CUSTOM), the touch interrupt wakes wait()
+    if (wake_sem == NULL) {
+        wake_sem = xSemaphoreCreateBinary();
+        if (wake_sem == NULL) {
+            ESP_LOGE(TAG, "Failed to create the wake semaphore");
+            return mp_const_false;
+        }
+    }
+    spd2010_touch_set_isr_callback(lvgl_touch_wake, NULL);
+    
+    return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_init_obj, lvgl_driver_init);
+
+// LVGL task handler, returns the ms until LVGL's next timer
+STATIC mp_obj_t lvgl_driver_loop_locked(size_t n_args, const mp_obj_t *args) {
+    lv_power_poll();
+    uint32_t next = lv_task_handler();
+    lv_cache_budget_poll();
+    lvgl_cabc_poll();
+    lv_latency_poll();
+    lv_power_poll();
+    return mp_obj_new_int_from_uint(LV_MIN(next, lv_power_next_ms()));
+}
+
+STATIC mp_obj_t lvgl_driver_loop(void) {
+    return lvgl_call_locked(lvgl_driver_loop_locked, 0, NULL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_loop_obj, lvgl_driver_loop);
+
+// Sleep until LVGL has work to do or the panel is touched: wait(max_ms=None)
+// Meant for a loop of loop() and wait(). Returns True when woken by touch
+STATIC mp_obj_t lvgl_driver_wait(size_t n_args, const mp_obj_t *args) {
+    if (wake_sem == NULL) {
+        ESP_LOGE(TAG, "LVGL not initialized");
+        return mp_const_false;
+    }
+    lvgl_lock(-1);
+    uint32_t timeout = lvgl_idle_deadline();
+    lvgl_unlock();
+    if (n_args > 0 && args[0] != mp_const_none) {
+        mp_int_t max_ms = mp_obj_get_int(args[0]);
+        if (max_ms >= 0 && (uint32_t)max_ms < timeout) {
+            timeout = max_ms;
+        }
+    }
+    
+    uint32_t start = lv_tick_get();
+    bool touched = false;
+    for (;;) {
+        uint32_t elapsed = lv_tick_elaps(start);
+        if (elapsed >= timeout) {
+            break;
+        }
+        uint32_t slice = timeout - elapsed;
+        if (slice > LVGL_WAIT_SLICE_MS) {
+            slice = LVGL_WAIT_SLICE_MS;
+        }
+        
+        MP_THREAD_GIL_EXIT();
+        touched = (xSemaphoreTake(wake_sem, pdMS_TO_TICKS(slice) + 1) == pdTRUE);
+        MP_THREAD_GIL_ENTER();
+        if (touched) {
+            break;
+        }
+        
+        // Scheduled callbacks may change the UI, then LVGL has to run
+        mp_handle_pending(true);
+        lvgl_lock(-1);
+        lv_disp_t *disp = lv_disp_get_default();
+        bool invalid = (disp != NULL && disp->inv_p != 0);
+        lvgl_unlock();
+        if (invalid) {
+            break;
+        }
+    }
+    return mp_obj_new_bool(touched);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_wait_obj, 0, 1, lvgl_driver_wait);
+
+// Print function for LVGL
+STATIC mp_obj_t lvgl_driver_print(mp_obj_t buf_obj) {
+    const char *buf = mp_obj_str_get_str(buf_obj);
+    lvgl_print(buf);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(lvgl_driver_print_obj, lvgl_driver_print);
+
+// Memory footprint of the display path: mem_info() -> dict
+STATIC mp_obj_t lvgl_driver_mem_info_locked(size_t n_args, const mp_obj_t *args) {
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    
+    mp_obj_t info = mp_obj_new_dict(0);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_color_depth), mp_obj_new_int(LV_COLOR_DEPTH));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_draw_buf_count), mp_obj_new_int(LVGL_BUF_COUNT));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_draw_buf_bytes), mp_obj_new_int(LVGL_BUF_COUNT * buf_len * sizeof(lv_color_t)));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_frame_bytes), mp_obj_new_int(LV_HOR_RES_MAX * LV_VER_RES_MAX * sizeof(lv_color_t)));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_lv_mem_total), mp_obj_new_int(mon.total_size));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_lv_mem_free), mp_obj_new_int(mon.free_size));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_lv_mem_max_used), mp_obj_new_int(mon.max_used));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_heap_internal_free), mp_obj_new_int(heap_caps_get_free_size(MALLOC_CAP_INTERNAL)));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_heap_psram_free), mp_obj_new_int(heap_caps_get_free_size(MALLOC_CAP_SPIRAM)));
+    return info;
+}
+
+STATIC mp_obj_t lvgl_driver_mem_info(void) {
+    return lvgl_call_locked(lvgl_driver_mem_info_locked, 0, NULL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_mem_info_obj, lvgl_driver_mem_info);
+
+// IRAM used by code: iram_info() -> dict, fast_mem tells if LVGL_DRIVER_IRAM is on
+STATIC mp_obj_t lvgl_driver_iram_info(void) {
+    mp_obj_t info = mp_obj_new_dict(0);
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_text_bytes), mp_obj_new_int((uint8_t *)&_iram_text_end - (uint8_t *)&_iram_text_start));
+    mp_obj_dict_store(info, MP_OBJ_NEW_QSTR(MP_QSTR_fast_mem), mp_obj_new_bool(LVGL_DRIVER_IRAM));
+    return info;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_iram_info_obj, lvgl_driver_iram_info);
+
+// Memory for the image and gradient caches together: cache_budget(bytes)
+STATIC mp_obj_t lvgl_driver_cache_budget_locked(size_t n_args, const mp_obj_t *args) {
+    mp_int_t budget = mp_obj_get_int(args[0]);
+    if (budget < 0) {
+        mp_raise_ValueError(MP_ERROR_TEXT("budget must be >= 0"));
+    }
+    lv_cache_budget_set(budget);
+    return mp_const_none;
+}
+
+STATIC mp_obj_t lvgl_driver_cache_budget(mp_obj_t budget_obj) {
+    return lvgl_call_locked(lvgl_driver_cache_budget_locked, 1, &budget_obj);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(lvgl_driver_cache_budget_obj, lvgl_driver_cache_budget);
+
+// Cache usage and hit/miss counters: cache_stats(reset=False) -> dict
+STATIC mp_obj_t lvgl_driver_cache_stats_locked(size_t n_args, const mp_obj_t *args) {
+    lv_cache_budget_stats_t cache;
+    lv_cache_budget_get_stats(&cache);
+    
+    mp_obj_t stats = mp_obj_new_dict(0);
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_budget), mp_obj_new_int(cache.budget));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_img_budget), mp_obj_new_int(cache.img_budget));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_grad_budget), mp_obj_new_int(cache.grad_budget));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_img_entries), mp_obj_new_int(cache.img_entries));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_img_bytes), mp_obj_new_int(cache.img_bytes));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_hits), mp_obj_new_int(cache.img_hits));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_misses), mp_obj_new_int(cache.img_misses));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_evictions), mp_obj_new_int(cache.evictions));
+    // Fixed size caches from lv_conf.h
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_shadow_bytes), mp_obj_new_int(LV_SHADOW_CACHE_SIZE * LV_SHADOW_CACHE_SIZE));
+    
+    if (n_args > 0 && mp_obj_is_true(args[0])) {
+        lv_cache_budget_reset_stats();
+    }
+    return stats;
+}
+
+STATIC mp_obj_t lvgl_driver_cache_stats(size_t n_args, const mp_obj_t *args) {
+    return lvgl_call_locked(lvgl_driver_cache_stats_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_cache_stats_obj, 0, 1, lvgl_driver_cache_stats);
+
+// Allocator statistics: mem_stats() -> dict with used, peak and fragmentation
+// bytes/percent, with the pool allocator also the arena and per class usage.
+// The pools do not fragment, there heap_fragmentation is that of the IDF heap
+// holding the arena blocks
+STATIC mp_obj_t lvgl_driver_mem_stats_locked(size_t n_args, const mp_obj_t *args) {
+    mp_obj_t stats = mp_obj_new_dict(0);
+#if LVGL_DRIVER_MEM_POOL
+    lv_mem_pool_stats_t pool;
+    lv_mem_pool_get_stats(&pool);
+    
+    mp_obj_t classes = mp_obj_new_list(0, NULL);
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        mp_obj_t item[] = {
+            mp_obj_new_int(pool.classes[i].block_size),
+            mp_obj_new_int(pool.classes[i].blocks),
+            mp_obj_new_int(pool.classes[i].used),
+            mp_obj_new_int(pool.classes[i].peak),
+            mp_obj_new_int(pool.classes[i].overflow)
+        };
+        mp_obj_list_append(classes, mp_obj_new_tuple(5, item));
+    }
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_used), mp_obj_new_int(pool.used));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_peak), mp_obj_new_int(pool.peak));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_heap_fragmentation), mp_obj_new_int(pool.heap_frag_pct));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_failed), mp_obj_new_int(pool.failed));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_large_blocks), mp_obj_new_int(pool.large_blocks));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_large_bytes), mp_obj_new_int(pool.large_bytes));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_large_peak), mp_obj_new_int(pool.large_peak));
+    // (block_size, blocks, used, peak, overflow) per size class
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_classes), classes);
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_used), mp_obj_new_int(mon.total_size - mon.free_size));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_peak), mp_obj_new_int(mon.max_used));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_fragmentation), mp_obj_new_int(mon.frag_pct));
+#endif
+    return stats;
+}
+
+STATIC mp_obj_t lvgl_driver_mem_stats(void) {
+    return lvgl_call_locked(lvgl_driver_mem_stats_locked, 0, NULL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_mem_stats_obj, lvgl_driver_mem_stats);
+
+#if !LVGL_DRIVER_FULL_FRAME
+// Band heights tried by autotune, multiples of 4 lines
+STATIC const uint16_t autotune_lines[] = { 8, 16, 24, 32, 40, 52, 64, 84, 104, 140, 208 };
+
+// Switch the display to draw buffers of len pixels. Pending transfers may
+// still read the old buffers, so the panel must be idle before they go
+STATIC bool lvgl_set_draw_buf(uint32_t len) {
+    lvgl_wait_flushed();
+    if (!lvgl_alloc_draw_buf(len)) {
+        return false;
+    }
+    lv_disp_draw_buf_init(&draw_buf, buf1, buf2, buf_len);
+    if (!lvgl_full_frame_buf()) {
+        disp_drv.full_refresh = 0;
+    }
+    return true;
+}
+
+// Pick the band height with the fastest render + flush of the current screen:
+// autotune(budget=None, frames=3) -> (lines, [(lines, us_per_frame), ...])
+// budget is the RAM for both draw buffers in bytes, by default their current size
+STATIC mp_obj_t lvgl_driver_autotune_locked(size_t n_args, const mp_obj_t *args) {
+    size_t budget = LVGL_BUF_COUNT * buf_len * sizeof(lv_color_t);
+    int frames = 3;
+    if (n_args > 0 && args[0] != mp_const_none) {
+        budget = mp_obj_get_int(args[0]);
+    }
+    if (n_args > 1) {
+        frames = mp_obj_get_int(args[1]);
+    }
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp == NULL || frames < 1) {
+        ESP_LOGE(TAG, "LVGL not initialized");
+        return mp_const_none;
+    }
+    
+    uint32_t old_len = buf_len;
+    int best_lines = 0;
+    int64_t best_us = INT64_MAX;
+    mp_obj_t results = mp_obj_new_list(0, NULL);
+    
+    // Pending areas first, they would be counted against the first candidate
+    lv_refr_now(disp);
+    
+    for (size_t i = 0; i < MP_ARRAY_SIZE(autotune_lines); i++) {
+        int lines = autotune_lines[i];
+        if (LVGL_BUF_COUNT * lines * LV_HOR_RES_MAX * sizeof(lv_color_t) > budget) {
+            break;
+        }
+        if (!lvgl_set_draw_buf(lines * LV_HOR_RES_MAX)) {
+            break;
+        }
+        
+        int64_t start = esp_timer_get_time();
+        for (int f = 0; f < frames; f++) {
+            lv_obj_invalidate(lv_scr_act());
+            lv_refr_now(disp);
+        }
+        spd2010_display_wait_idle();
+        int64_t us = (esp_timer_get_time() - start) / frames;
+        
+        mp_obj_t item[] = { mp_obj_new_int(lines), mp_obj_new_int(us) };
+        mp_obj_list_append(results, mp_obj_new_tuple(2, item));
+        // A larger buffer has to be at least 3% faster to be worth its RAM
+        if (us * 100 < best_us * 97) {
+            best_us = us;
+            best_lines = lines;
+        }
+    }
+    
+    uint32_t new_len = best_lines ? best_lines * LV_HOR_RES_MAX : old_len;
+    if (!lvgl_set_draw_buf(new_len)) {
+        ESP_LOGE(TAG, "Failed to allocate the draw buffers");
+        return mp_const_none;
+    }
+    if (best_lines == 0) {
+        ESP_LOGW(TAG, "No band height fits in %d bytes", (int)budget);
+    }
+    
+    mp_obj_t ret[] = { mp_obj_new_int(buf_len / LV_HOR_RES_MAX), results };
+    return mp_obj_new_tuple(2, ret);
+}
+
+STATIC mp_obj_t lvgl_driver_autotune(size_t n_args, const mp_obj_t *args) {
+    return lvgl_call_locked(lvgl_driver_autotune_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_autotune_obj, 0, 2, lvgl_driver_autotune);
+#endif
+
+// Hardware scroll of a full width band: scroll(top, height, dy, fn=None)
+// fn runs with invalidation disabled so it can move the LVGL content, e.g.
+// lambda: lst.scroll_by(0, dy, lv.ANIM.OFF). The panel shifts the band by dy
+// lines and only the dy lines it exposes are redrawn. Returns the bytes saved
+// on the bus, 0 for the call that sets a new area as that redraws everything.
+STATIC mp_obj_t lvgl_driver_scroll_locked(size_t n_args, const mp_obj_t *args) {
+    int top = mp_obj_get_int(args[0]);
+    int height = mp_obj_get_int(args[1]);
+    int dy = mp_obj_get_int(args[2]);
+    mp_obj_t fn = (n_args > 3) ? args[3] : mp_const_none;
+    lv_disp_t *disp = lv_disp_get_default();
+    
+    // Pending areas must reach the panel before its content is shifted
+    lv_refr_now(disp);
+    
+    bool new_area = (top != scroll_top || height != scroll_height);
+    if (new_area) {
+        if (!mp_obj_is_true(spd2010_display_scroll_area(mp_obj_new_int(top), mp_obj_new_int(height)))) {
+            ESP_LOGE(TAG, "Invalid scroll area");
+            return mp_obj_new_int(0);
+        }
+        scroll_top = top;
+        scroll_height = height;
+        // Partial redraws are what makes the scroll cheap, full refresh only without scroll area
+        disp_drv.full_refresh = (height == 0) && lvgl_full_frame_buf();
+        // The frame memory layout changed, redraw everything once
+        lv_obj_invalidate(lv_scr_act());
+    }
+    
+    if (new_area || height == 0 || dy == 0 || dy >= height || dy <= -height) {
+        // Nothing on the panel can be reused
+        if (fn != mp_const_none) {
+            mp_call_function_0(fn);
+        }
+        return mp_obj_new_int(0);
+    }
+    
+    if (fn != mp_const_none) {
+        lv_disp_enable_invalidation(disp, false);
+        nlr_buf_t nlr;
+        if (nlr_push(&nlr) == 0) {
+            mp_call_function_0(fn);
+            nlr_pop();
+        } else {
+            lv_disp_enable_invalidation(disp, true);
+            nlr_jump(nlr.ret_val);
+        }
+        lv_disp_enable_invalidation(disp, true);
+    }
+    spd2010_display_scroll(mp_obj_new_int(dy));
+    
+    // Redraw only the exposed band
+    lv_area_t band;
+    band.x1 = 0;
+    band.x2 = LV_HOR_RES_MAX - 1;
+    if (dy > 0) {
+        band.y1 = top;
+        band.y2 = top + dy - 1;
+    } else {
+        band.y1 = top + height + dy;
+        band.y2 = top + height - 1;
+    }
+    _lv_inv_area(disp, &band);
+    
+    int reused_lines = height - (dy > 0 ? dy : -dy);
+    return mp_obj_new_int(reused_lines * LV_HOR_RES_MAX * spd2010_display_pixel_bytes());
+}
+
+STATIC mp_obj_t lvgl_driver_scroll(size_t n_args, const mp_obj_t *args) {
+    return lvgl_call_locked(lvgl_driver_scroll_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_scroll_obj, 3, 4, lvgl_driver_scroll);
+
+// Idle timeouts in ms, 0 skips a stage. Enables the power manager:
+// power_config(dim_ms, off_ms, sleep_ms, dim_level=10)
+STATIC mp_obj_t lvgl_driver_power_config_locked(size_t n_args, const mp_obj_t *args) {
+    lv_power_config_t config = {
+        .dim_ms = mp_obj_get_int(args[0]),
+        .off_ms = mp_obj_get_int(args[1]),
+        .sleep_ms = mp_obj_get_int(args[2]),
+        .dim_level = (n_args > 3) ? mp_obj_get_int(args[3]) : 10,
+    };
+    lv_power_configure(&config);
+    lv_power_enable(true);
+    return mp_const_none;
+}
+
+STATIC mp_obj_t lvgl_driver_power_config(size_t n_args, const mp_obj_t *args) {
+    for (size_t i = 0; i < n_args; i++) {
+        if (mp_obj_get_int(args[i]) < 0) {
+            mp_raise_ValueError(MP_ERROR_TEXT("arguments must be >= 0"));
+        }
+    }
+    return lvgl_call_locked(lvgl_driver_power_config_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_power_config_obj, 3, 4, lvgl_driver_power_config);
+
+// Turn the power manager on or off, off wakes the panel: power_enable(on)
+STATIC mp_obj_t lvgl_driver_power_enable_locked(size_t n_args, const mp_obj_t *args) {
+    lv_power_enable(mp_obj_is_true(args[0]));
+    return mp_const_none;
+}
+
+STATIC mp_obj_t lvgl_driver_power_enable(mp_obj_t enable_obj) {
+    return lvgl_call_locked(lvgl_driver_power_enable_locked, 1, &enable_obj);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(lvgl_driver_power_enable_obj, lvgl_driver_power_enable);
+
+// Current power state, one of the POWER_* constants: power_state()
+STATIC mp_obj_t lvgl_driver_power_state_locked(size_t n_args, const mp_obj_t *args) {
+    return mp_obj_new_int(lv_power_get_state());
+}
+
+STATIC mp_obj_t lvgl_driver_power_state(void) {
+    return lvgl_call_locked(lvgl_driver_power_state_locked, 0, NULL);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_power_state_obj, lvgl_driver_power_state);
+
+// Time in each power state and wake latency: power_stats(reset=False) -> dict
+STATIC mp_obj_t lvgl_driver_power_stats_locked(size_t n_args, const mp_obj_t *args) {
+    lv_power_stats_t power;
+    lv_power_get_stats(&power);
+    
+    mp_obj_t stats = mp_obj_new_dict(0);
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_active_ms), mp_obj_new_int_from_ull(power.state_ms[LV_POWER_ACTIVE]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_dim_ms), mp_obj_new_int_from_ull(power.state_ms[LV_POWER_DIM]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_off_ms), mp_obj_new_int_from_ull(power.state_ms[LV_POWER_OFF]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_sleep_ms), mp_obj_new_int_from_ull(power.state_ms[LV_POWER_SLEEP]));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_wakes), mp_obj_new_int_from_uint(power.wakes));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_last_wake_us), mp_obj_new_int_from_uint(power.last_wake_us));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_max_wake_us), mp_obj_new_int_from_uint(power.max_wake_us));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_enabled), mp_obj_new_bool(lv_power_enabled()));
+    
+    if (n_args > 0 && mp_obj_is_true(args[0])) {
+        lv_power_reset_stats();
+    }
+    return stats;
+}
+
+STATIC mp_obj_t lvgl_driver_power_stats(size_t n_args, const mp_obj_t *args) {
+    return lvgl_call_locked(lvgl_driver_power_stats_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_power_stats_obj, 0, 1, lvgl_driver_power_stats);
+
+// Per frame figures of one benchmark scene, times in us
+STATIC mp_obj_t lvgl_bench_result_dict(const lv_bench_result_t *r) {
+    uint32_t frames = r->frames ? r->frames : 1;
+    mp_obj_t d = mp_obj_new_dict(0);
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_frames), mp_obj_new_int_from_uint(r->frames));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_drawn), mp_obj_new_int_from_uint(r->drawn));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_fps), mp_obj_new_float(r->total_us ? (mp_float_t)r->frames * 1000000 / r->total_us : 0));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_px_per_frame), mp_obj_new_int_from_uint(r->px / frames));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_bytes_per_frame), mp_obj_new_int_from_uint(r->bus_bytes / frames));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_update_us), mp_obj_new_int_from_uint(r->update_us / frames));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_render_us), mp_obj_new_int_from_uint(r->render_us / frames));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_flush_us), mp_obj_new_int_from_uint(r->flush_us / frames));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_transfer_us), mp_obj_new_int_from_uint(r->transfer_us / frames));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_wait_us), mp_obj_new_int_from_uint(r->wait_us));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_max_frame_us), mp_obj_new_int_from_uint(r->max_frame_us));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_mem_peak), mp_obj_new_int_from_uint(r->mem_peak));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_mem_scene), mp_obj_new_int_from_uint(r->mem_peak - r->mem_base));
+    mp_obj_dict_store(d, MP_OBJ_NEW_QSTR(MP_QSTR_heap_min_free), mp_obj_new_int_from_uint(r->heap_min_free));
+    return d;
+}
+
+// Run the benchmark scenes: bench(scenes=None, frames=100) -> dict
+// scenes is a list of names, by default all of them. The result holds the
+// configuration and a dict per scene; json.dumps turns it into the report
+// that tools/bench_compare.py reads
+STATIC mp_obj_t lvgl_driver_bench_locked(size_t n_args, const mp_obj_t *args) {
+    lv_disp_t *disp = lv_disp_get_default();
+    if (disp == NULL) {
+        ESP_LOGE(TAG, "LVGL not initialized");
+        return mp_const_none;
+    }
+    bool all = (n_args == 0 || args[0] == mp_const_none);
+    bool selected[LV_BENCH_SCENE_COUNT];
+    for (int i = 0; i < LV_BENCH_SCENE_COUNT; i++) {
+        selected[i] = all;
+    }
+    if (!all) {
+        size_t len;
+        mp_obj_t *items;
+        mp_obj_get_array(args[0], &len, &items);
+        for (size_t j = 0; j < len; j++) {
+            const char *name = mp_obj_str_get_str(items[j]);
+            int i = 0;
+            while (i < LV_BENCH_SCENE_COUNT && strcmp(name, lv_bench_scene_name(i)) != 0) {
+                i++;
+            }
+            if (i == LV_BENCH_SCENE_COUNT) {
+                mp_raise_ValueError(MP_ERROR_TEXT("unknown scene"));
+            }
+            selected[i] = true;
+        }
+    }
+    mp_int_t frames = (n_args > 1) ? mp_obj_get_int(args[1]) : 100;
+    if (frames < 1) {
+        mp_raise_ValueError(MP_ERROR_TEXT("frames must be >= 1"));
+    }
+    
+    mp_obj_t config = mp_obj_new_dict(0);
+    mp_obj_dict_store(config, MP_OBJ_NEW_QSTR(MP_QSTR_hor_res), mp_obj_new_int(lv_disp_get_hor_res(disp)));
+    mp_obj_dict_store(config, MP_OBJ_NEW_QSTR(MP_QSTR_ver_res), mp_obj_new_int(lv_disp_get_ver_res(disp)));
+    mp_obj_dict_store(config, MP_OBJ_NEW_QSTR(MP_QSTR_color_depth), mp_obj_new_int(LV_COLOR_DEPTH));
+    mp_obj_dict_store(config, MP_OBJ_NEW_QSTR(MP_QSTR_draw_buf_bytes), mp_obj_new_int(LVGL_BUF_COUNT * buf_len * sizeof(lv_color_t)));
+    mp_obj_dict_store(config, MP_OBJ_NEW_QSTR(MP_QSTR_pipeline), mp_obj_new_bool(transfer_task_handle != NULL));
+    mp_obj_dict_store(config, MP_OBJ_NEW_QSTR(MP_QSTR_frames), mp_obj_new_int(frames));
+    
+    mp_obj_t scenes = mp_obj_new_dict(0);
+    for (int i = 0; i < LV_BENCH_SCENE_COUNT; i++) {
+        if (!selected[i]) {
+            continue;
+        }
+        const char *name = lv_bench_scene_name(i);
+        mp_obj_t key = mp_obj_new_str(name, strlen(name));
+        lv_bench_result_t result;
+        if (lv_bench_run(disp, i, frames, lvgl_wait_flushed, &result)) {
+            mp_obj_dict_store(scenes, key, lvgl_bench_result_dict(&result));
+        } else {
+            ESP_LOGE(TAG, "Benchmark scene %s could not be created", name);
+            mp_obj_dict_store(scenes, key, mp_const_none);
+        }
+        // Ctrl-C between scenes
+        mp_handle_pending(true);
+    }
+    
+    mp_obj_t report = mp_obj_new_dict(0);
+    mp_obj_dict_store(report, MP_OBJ_NEW_QSTR(MP_QSTR_config), config);
+    mp_obj_dict_store(report, MP_OBJ_NEW_QSTR(MP_QSTR_scenes), scenes);
+    return report;
+}
+
+STATIC mp_obj_t lvgl_driver_bench(size_t n_args, const mp_obj_t *args) {
+    return lvgl_call_locked(lvgl_driver_bench_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_bench_obj, 0, 2, lvgl_driver_bench);
+
+// Follow touch samples into the frames that show them: latency_enable(on)
+STATIC mp_obj_t lvgl_driver_latency_enable_locked(size_t n_args, const mp_obj_t *args) {
+    lv_latency_enable(mp_obj_is_true(args[0]));
+    return mp_const_none;
+}
+
+STATIC mp_obj_t lvgl_driver_latency_enable(mp_obj_t enable_obj) {
+    return lvgl_call_locked(lvgl_driver_latency_enable_locked, 1, &enable_obj);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(lvgl_driver_latency_enable_obj, lvgl_driver_latency_enable);
+
+// Touch to photon latency: latency_stats(reset=False) -> dict with count,
+// dropped, min/mean/max and percentiles in us, and histogram, a list of
+// (upper_us, count) for the non-empty buckets
+STATIC mp_obj_t lvgl_driver_latency_stats_locked(size_t n_args, const mp_obj_t *args) {
+    static lv_latency_stats_t latency;     // too large for the stack
+    lv_latency_get_stats(&latency);
+    if (n_args > 0 && mp_obj_is_true(args[0])) {
+        lv_latency_reset();
+    }
+    
+    mp_obj_t stats = mp_obj_new_dict(0);
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_enabled), mp_obj_new_bool(lv_latency_enabled()));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_count), mp_obj_new_int_from_uint(latency.count));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_dropped), mp_obj_new_int_from_uint(latency.dropped));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_min_us), mp_obj_new_int_from_uint(latency.min_us));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_mean_us), mp_obj_new_int_from_uint(latency.count ? latency.sum_us / latency.count : 0));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_max_us), mp_obj_new_int_from_uint(latency.max_us));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_p50_us), mp_obj_new_int_from_uint(lv_latency_percentile(&latency, 500)));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_p90_us), mp_obj_new_int_from_uint(lv_latency_percentile(&latency, 900)));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_p99_us), mp_obj_new_int_from_uint(lv_latency_percentile(&latency, 990)));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_p999_us), mp_obj_new_int_from_uint(lv_latency_percentile(&latency, 999)));
+    
+    mp_obj_t histogram = mp_obj_new_list(0, NULL);
+    for (int i = 0; i < LV_LATENCY_BUCKETS; i++) {
+        if (latency.buckets[i] != 0) {
+            mp_obj_t bucket[2] = {
+                mp_obj_new_int_from_uint(lv_latency_bucket_upper(i)),
+                mp_obj_new_int_from_uint(latency.buckets[i]),
+            };
+            mp_obj_list_append(histogram, mp_obj_new_tuple(2, bucket));
+        }
+    }
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_histogram), histogram);
+    return stats;
+}
+
+STATIC mp_obj_t lvgl_driver_latency_stats(size_t n_args, const mp_obj_t *args) {
+    return lvgl_call_locked(lvgl_driver_latency_stats_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_latency_stats_obj, 0, 1, lvgl_driver_latency_stats);
+
+// Take the LVGL lock in the native task, false once the task is stopped. The
+// wait is sliced: stop_task() may come from Python code holding lock()
+STATIC bool lvgl_task_lock(void) {
+    while (xSemaphoreTakeRecursive(lvgl_mutex, pdMS_TO_TICKS(LVGL_TASK_LOCK_SLICE_MS) + 1) != pdTRUE) {
+        if (!lvgl_task_running) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Native LVGL task: runs the timers when they are due and applies posted messages
+STATIC void lvgl_task(void *arg) {
+    uint32_t sleep_ms = 0;
+    lvgl_msg_t msg;
+    
+    while (lvgl_task_running) {
+        if (xQueueReceive(msg_queue, &msg, pdMS_TO_TICKS(sleep_ms)) == pdTRUE) {
+            if (!lvgl_task_lock()) {
+                break;
+            }
+            do {
+                if (msg.type == LVGL_MSG_TOUCH) {
+                    task_touch_point.x = msg.x1;
+                    task_touch_point.y = msg.y1;
+                    task_touch_pressed = msg.pressed;
+                } else if (msg.type == LVGL_MSG_INVALIDATE) {
+                    if (msg.x2 < msg.x1) {
+                        lv_obj_invalidate(lv_scr_act());
+                    } else {
+                        lv_area_t area = { msg.x1, msg.y1, msg.x2, msg.y2 };
+                        _lv_inv_area(lv_disp_get_default(), &area);
+                    }
+                }
+            } while (xQueueReceive(msg_queue, &msg, 0) == pdTRUE);
+            xSemaphoreGiveRecursive(lvgl_mutex);
+        }
+        if (!lvgl_task_running || !lvgl_task_lock()) {
+            break;
+        }
+        
+        lv_power_poll();
+        sleep_ms = lv_timer_handler();
+        lv_cache_budget_poll();
+        lvgl_cabc_poll();
+        lv_latency_poll();
+        lv_power_poll();
+        sleep_ms = LV_MIN(sleep_ms, lv_power_next_ms());
+        xSemaphoreGiveRecursive(lvgl_mutex);
+        
+        if (sleep_ms > LVGL_TASK_MAX_SLEEP_MS) {
+            sleep_ms = LVGL_TASK_MAX_SLEEP_MS;
+        }
+    }
+    
+    lvgl_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+// Run LVGL in a native task: start_task(core=0, priority=5, stack=8192)
+// Python code must hold lock() while it changes widgets
+STATIC mp_obj_t lvgl_driver_start_task(size_t n_args, const mp_obj_t *args) {
+    int core = (n_args > 0) ? mp_obj_get_int(args[0]) : 0;
+    int priority = (n_args > 1) ? mp_obj_get_int(args[1]) : 5;
+    int stack = (n_args > 2) ? mp_obj_get_int(args[2]) : 8192;
+    
+    if (lvgl_mutex == NULL) {
+        ESP_LOGE(TAG, "LVGL not initialized");
+        return mp_const_false;
+    }
+    if (lvgl_task_handle != NULL) {
+        return mp_const_true;
+    }
+    if (msg_queue == NULL) {
+        msg_queue = xQueueCreate(LVGL_MSG_QUEUE_LEN, sizeof(lvgl_msg_t));
+        if (msg_queue == NULL) {
+            ESP_LOGE(TAG, "Failed to create the message queue");
+            return mp_const_false;
+        }
+    }
+    
+    task_touch_pressed = false;
+    lvgl_task_running = true;
+    if (xTaskCreatePinnedToCore(lvgl_task, "lvgl", stack, NULL, priority, &lvgl_task_handle, core) != pdPASS) {
+        lvgl_task_running = false;
+        lvgl_task_handle = NULL;
+        ESP_LOGE(TAG, "Failed to create the LVGL task");
+        return mp_const_false;
+    }
+    return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_start_task_obj, 0, 3, lvgl_driver_start_task);
+
+// Stop the native task, waits until it has left the LVGL timers. Also from
+// inside lock(): the task gives up waiting for the lock once stopped
+STATIC mp_obj_t lvgl_driver_stop_task(void) {
+    if (lvgl_task_handle == NULL) {
+        return mp_const_none;
+    }
+    
+    lvgl_task_running = false;
+    lvgl_msg_t msg = { .type = LVGL_MSG_STOP };
+    xQueueSend(msg_queue, &msg, 0);
+    
+    MP_THREAD_GIL_EXIT();
+    while (lvgl_task_handle != NULL) {
+        vTaskDelay(1);
+    }
+    MP_THREAD_GIL_ENTER();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_stop_task_obj, lvgl_driver_stop_task);
+
+// Split rendering and transfer over both cores: start_pipeline(core=None, priority=6)
+// The transfer task goes on core, by default the one the caller is not running on
+STATIC mp_obj_t lvgl_driver_start_pipeline(size_t n_args, const mp_obj_t *args) {
+    int core = 1 - xPortGetCoreID();
+    int priority = 6;
+    if (n_args > 0 && args[0] != mp_const_none) {
+        core = mp_obj_get_int(args[0]);
+    }
+    if (n_args > 1) {
+        priority = mp_obj_get_int(args[1]);
+    }
+    if (transfer_task_handle != NULL) {
+        return mp_const_true;
+    }
+    
+    // No flush may be running while the flush path changes
+    lvgl_lock(-1);
+    band_head = 0;
+    band_tail = 0;
+    pipeline_running = true;
+    BaseType_t created = xTaskCreatePinnedToCore(lvgl_transfer_task, "lvgl_xfer", 4096, NULL, priority,
+                                                 &transfer_task_handle, core);
+    if (created != pdPASS) {
+        pipeline_running = false;
+        transfer_task_handle = NULL;
+    }
+    lvgl_unlock();
+    
+    if (created != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create the transfer task");
+        return mp_const_false;
+    }
+    return mp_const_true;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_start_pipeline_obj, 0, 2, lvgl_driver_start_pipeline);
+
+// Back to flushing on the rendering core, queued bands are sent first
+STATIC mp_obj_t lvgl_driver_stop_pipeline(void) {
+    if (transfer_task_handle == NULL) {
+        return mp_const_none;
+    }
+    
+    lvgl_lock(-1);
+    TaskHandle_t task = transfer_task_handle;
+    pipeline_running = false;
+    xTaskNotifyGive(task);
+    MP_THREAD_GIL_EXIT();
+    while (transfer_task_handle != NULL) {
+        vTaskDelay(1);
+    }
+    MP_THREAD_GIL_ENTER();
+    lvgl_unlock();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_stop_pipeline_obj, lvgl_driver_stop_pipeline);
+
+// Pipeline counters: pipeline_stats(reset=False) -> dict
+STATIC mp_obj_t lvgl_driver_pipeline_stats_locked(size_t n_args, const mp_obj_t *args) {
+    mp_obj_t stats = mp_obj_new_dict(0);
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_running), mp_obj_new_bool(transfer_task_handle != NULL));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_bands), mp_obj_new_int_from_uint(pipeline_bands));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_transfer_us), mp_obj_new_int_from_ull(pipeline_transfer_us));
+    mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_max_depth), mp_obj_new_int(pipeline_max_depth));
+    
+    if (n_args > 0 && mp_obj_is_true(args[0])) {
+        pipeline_bands = 0;
+        pipeline_transfer_us = 0;
+        pipeline_max_depth = 0;
+    }
+    return stats;
+}
+
+STATIC mp_obj_t lvgl_driver_pipeline_stats(size_t n_args, const mp_obj_t *args) {
+    return lvgl_call_locked(lvgl_driver_pipeline_stats_locked, n_args, args);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_pipeline_stats_obj, 0, 1, lvgl_driver_pipeline_stats);
+
+// Take the LVGL lock: lock(timeout_ms=-1) -> True when taken. Recursive.
+// Also a context manager, with lvgl_driver.lock: takes it without timeout and
+// releases it when the block is left, raised or not
+typedef struct _lvgl_lock_obj_t {
+    mp_obj_base_t base;
+} lvgl_lock_obj_t;
+
+STATIC mp_obj_t lvgl_lock_call(mp_obj_t self_in, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 0, 1, false);
+    int timeout_ms = (n_args > 0) ? mp_obj_get_int(args[0]) : -1;
+    return mp_obj_new_bool(lvgl_lock(timeout_ms));
+}
+
+STATIC mp_obj_t lvgl_lock_enter(mp_obj_t self_in) {
+    lvgl_lock(-1);
+    return self_in;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(lvgl_lock_enter_obj, lvgl_lock_enter);
+
+STATIC mp_obj_t lvgl_lock_exit(size_t n_args, const mp_obj_t *args) {
+    lvgl_unlock();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_lock_exit_obj, 4, 4, lvgl_lock_exit);
+
+STATIC const mp_rom_map_elem_t lvgl_lock_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___enter__), MP_ROM_PTR(&lvgl_lock_enter_obj) },
+    { MP_ROM_QSTR(MP_QSTR___exit__), MP_ROM_PTR(&lvgl_lock_exit_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(lvgl_lock_locals_dict, lvgl_lock_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    lvgl_lock_type,
+    MP_QSTR_Lock,
+    MP_TYPE_FLAG_NONE,
+    call, lvgl_lock_call,
+    locals_dict, &lvgl_lock_locals_dict
+);
+
+STATIC const lvgl_lock_obj_t lvgl_driver_lock_obj = { { &lvgl_lock_type } };
+
+STATIC mp_obj_t lvgl_driver_unlock(void) {
+    lvgl_unlock();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_unlock_obj, lvgl_driver_unlock);
+
+// Queue a message for the native task, False when the queue is full or the task is not running
+STATIC mp_obj_t lvgl_post(const lvgl_msg_t *msg) {
+    if (lvgl_task_handle == NULL) {
+        return mp_const_false;
+    }
+    return mp_obj_new_bool(xQueueSend(msg_queue, msg, 0) == pdTRUE);
+}
+
+// Hand a touch to the native task: post_touch(x, y, pressed)
+STATIC mp_obj_t lvgl_driver_post_touch(mp_obj_t x_obj, mp_obj_t y_obj, mp_obj_t pressed_obj) {
+    lvgl_msg_t msg = {
+        .type = LVGL_MSG_TOUCH,
+        .pressed = mp_obj_is_true(pressed_obj),
+        .x1 = mp_obj_get_int(x_obj),
+        .y1 = mp_obj_get_int(y_obj),
+    };
+    return lvgl_post(&msg);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(lvgl_driver_post_touch_obj, lvgl_driver_post_touch);
+
+// Ask the native task to redraw: post_invalidate() for the screen or post_invalidate(x1, y1, x2, y2)
+STATIC mp_obj_t lvgl_driver_post_invalidate(size_t n_args, const mp_obj_t *args) {
+    lvgl_msg_t msg = { .type = LVGL_MSG_INVALIDATE, .x1 = 0, .y1 = 0, .x2 = -1, .y2 = -1 };
+    if (n_args == 4) {
+        msg.x1 = mp_obj_get_int(args[0]);
+        msg.y1 = mp_obj_get_int(args[1]);
+        msg.x2 = mp_obj_get_int(args[2]);
+        msg.y2 = mp_obj_get_int(args[3]);
+    } else if (n_args != 0) {
+        mp_raise_TypeError(MP_ERROR_TEXT("expected no area or x1, y1, x2, y2"));
+    }
+    return lvgl_post(&msg);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(lvgl_driver_post_invalidate_obj, 0, 4, lvgl_driver_post_invalidate);
+
+// Module cleanup
+STATIC mp_obj_t lvgl_driver_deinit(void) {
+    lvgl_driver_stop_task();
+    lvgl_driver_stop_pipeline();
+    spd2010_touch_set_isr_callback(NULL, NULL);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(lvgl_driver_deinit_obj, lvgl_driver_deinit);
+
+// Module globals table
+STATIC const mp_rom_map_elem_t lvgl_driver_module_globals_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_lvgl_driver) },
+    { MP_ROM_QSTR(MP_QSTR_init), MP_ROM_PTR(&lvgl_driver_init_obj) },
+    { MP_ROM_QSTR(MP_QSTR_loop), MP_ROM_PTR(&lvgl_driver_loop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&lvgl_driver_wait_obj) },
+    { MP_ROM_QSTR(MP_QSTR_print), MP_ROM_PTR(&lvgl_driver_print_obj) },
+    { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&lvgl_driver_deinit_obj) },
+    { MP_ROM_QSTR(MP_QSTR_scroll), MP_ROM_PTR(&lvgl_driver_scroll_obj) },
+    { MP_ROM_QSTR(MP_QSTR_start_task), MP_ROM_PTR(&lvgl_driver_start_task_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stop_task), MP_ROM_PTR(&lvgl_driver_stop_task_obj) },
+    { MP_ROM_QSTR(MP_QSTR_start_pipeline), MP_ROM_PTR(&lvgl_driver_start_pipeline_obj) },
+    { MP_ROM_QSTR(MP_QSTR_stop_pipeline), MP_ROM_PTR(&lvgl_driver_stop_pipeline_obj) },
+    { MP_ROM_QSTR(MP_QSTR_pipeline_stats), MP_ROM_PTR(&lvgl_driver_pipeline_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_lock), MP_ROM_PTR(&lvgl_driver_lock_obj) },
+    { MP_ROM_QSTR(MP_QSTR_unlock), MP_ROM_PTR(&lvgl_driver_unlock_obj) },
+    { MP_ROM_QSTR(MP_QSTR_post_touch), MP_ROM_PTR(&lvgl_driver_post_touch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_post_invalidate), MP_ROM_PTR(&lvgl_driver_post_invalidate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mem_info), MP_ROM_PTR(&lvgl_driver_mem_info_obj) },
+    { MP_ROM_QSTR(MP_QSTR_mem_stats), MP_ROM_PTR(&lvgl_driver_mem_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_iram_info), MP_ROM_PTR(&lvgl_driver_iram_info_obj) },
+    { MP_ROM_QSTR(MP_QSTR_cache_budget), MP_ROM_PTR(&lvgl_driver_cache_budget_obj) },
+    { MP_ROM_QSTR(MP_QSTR_cache_stats), MP_ROM_PTR(&lvgl_driver_cache_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_power_config), MP_ROM_PTR(&lvgl_driver_power_config_obj) },
+    { MP_ROM_QSTR(MP_QSTR_power_enable), MP_ROM_PTR(&lvgl_driver_power_enable_obj) },
+    { MP_ROM_QSTR(MP_QSTR_power_state), MP_ROM_PTR(&lvgl_driver_power_state_obj) },
+    { MP_ROM_QSTR(MP_QSTR_power_stats), MP_ROM_PTR(&lvgl_driver_power_stats_obj) },
+    { MP_ROM_QSTR(MP_QSTR_bench), MP_ROM_PTR(&lvgl_driver_bench_obj) },
+    { MP_ROM_QSTR(MP_QSTR_latency_enable), MP_ROM_PTR(&lvgl_driver_latency_enable_obj) },
+    { MP_ROM_QSTR(MP_QSTR_latency_stats), MP_ROM_PTR(&lvgl_driver_latency_stats_obj) },
+#if !LVGL_DRIVER_FULL_FRAME
+    { MP_ROM_QSTR(MP_QSTR_autotune), MP_ROM_PTR(&lvgl_driver_autotune_obj) },
+#endif
+    
+    // Constants
+    { MP_ROM_QSTR(MP_QSTR_BUFFER_SIZE), MP_ROM_INT(LVGL_BUF_LEN) },
+    { MP_ROM_QSTR(MP_QSTR_BUFFER_COUNT), MP_ROM_INT(LVGL_BUF_COUNT) },
+    { MP_ROM_QSTR(MP_QSTR_COLOR_DEPTH), MP_ROM_INT(LV_COLOR_DEPTH) },
+    { MP_ROM_QSTR(MP_QSTR_POWER_ACTIVE), MP_ROM_INT(LV_POWER_ACTIVE) },
+    { MP_ROM_QSTR(MP_QSTR_POWER_DIM), MP_ROM_INT(LV_POWER_DIM) },
+    { MP_ROM_QSTR(MP_QSTR_POWER_OFF), MP_ROM_INT(LV_POWER_OFF) },
+    { MP_ROM_QSTR(MP_QSTR_POWER_SLEEP), MP_ROM_INT(LV_POWER_SLEEP) },
+};
+STATIC MP_DEFINE_CONST_DICT(lvgl_driver_module_globals, lvgl_driver_module_globals_table);
+
+// Module definition
+const mp_obj_module_t lvgl_driver_user_cmodule = {
+    .base = { &mp_type_module },
+    .globals = (mp_obj_dict_t*)&lvgl_driver_module_globals,
+};
+
+// Register the module
 MP_REGISTER_MODULE(MP_QSTR_lvgl_driver, lvgl_driver_user_cmodule);
\ No newline at end of file
@@ -0,0 +1,309 @@
+/*
+ * Frame-rate benchmark
+ *
+ * Every frame the scene changes its widgets and lv_refr_now renders and
+ * flushes the invalidated areas, so a run does the same work each time and
+ * does not depend on the refresh period or the timers. The first frame of a
+ * scene draws the whole screen and is not counted.
+ *
+ * Stages: update is the scene changing its widgets, render the refresh time
+ * without the flush callback, flush the callback itself (conversion and
+ * queueing, or waiting for space in the pipeline queue) and transfer the
+ * pipeline task on the other core. Pixels come from the display driver's
+ * monitor_cb, bus bytes are those pixels in the panel format. Memory is
+ * sampled between frames, outside of the timed part.
+ */
+
+#include <string.h>
+#include "lv_bench.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#if LVGL_DRIVER_MEM_POOL
+#include "lv_mem_pool.h"
+#endif
+
+extern int spd2010_display_pixel_bytes(void);
+
+#define LABEL_COUNT         12
+#define LIST_ITEMS          40
+#define LIST_STEP           8
+#define IMG_SIZE            128
+#define IMG_COUNT           3
+#define IMG_GAP             24
+#define CAROUSEL_STEP       8
+
+typedef struct {
+    const char *name;
+    bool (*create)(lv_obj_t *scr);
+    void (*update)(uint32_t frame);
+    void (*destroy)(void);
+} bench_scene_t;
+
+static lv_bench_result_t *volatile running = NULL;  // result of the scene being run
+static lv_obj_t *objs[LABEL_COUNT];
+static int scroll_max = 0;
+static lv_color_t *img_data = NULL;
+static lv_img_dsc_t img_dsc;
+
+static uint32_t mem_used(void) {
+#if LVGL_DRIVER_MEM_POOL
+    lv_mem_pool_stats_t pool;
+    lv_mem_pool_get_stats(&pool);
+    return pool.used;
+#else
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+#endif
+}
+
+static void no_destroy(void) {
+}
+
+// Static: a form that is not touched after the first frame
+static bool static_create(lv_obj_t *scr) {
+    lv_obj_t *title = lv_label_create(scr);
+    lv_label_set_text(title, "Settings");
+    lv_obj_align(title, LV_ALIGN_TOP_MID, 0, 40);
+
+    lv_obj_t *slider = lv_slider_create(scr);
+    lv_obj_set_width(slider, lv_pct(60));
+    lv_slider_set_value(slider, 40, LV_ANIM_OFF);
+    lv_obj_align(slider, LV_ALIGN_CENTER, 0, -40);
+
+    lv_obj_t *sw = lv_switch_create(scr);
+    lv_obj_add_state(sw, LV_STATE_CHECKED);
+    lv_obj_align(sw, LV_ALIGN_CENTER, 0, 20);
+
+    lv_obj_t *btn = lv_btn_create(scr);
+    lv_obj_align(btn, LV_ALIGN_BOTTOM_MID, 0, -60);
+    lv_obj_t *label = lv_label_create(btn);
+    lv_label_set_text(label, "Apply");
+    return true;
+}
+
+static void static_update(uint32_t frame) {
+}
+
+// Labels: small scattered areas, text layout every frame
+static bool labels_create(lv_obj_t *scr) {
+    lv_coord_t w = lv_obj_get_width(scr);
+    lv_coord_t h = lv_obj_get_height(scr);
+
+    for (int i = 0; i < LABEL_COUNT; i++) {
+        objs[i] = lv_label_create(scr);
+        lv_obj_set_pos(objs[i], w / 8 + (i % 3) * (w / 4), h / 8 + (i / 3) * (h / 5));
+        lv_label_set_text(objs[i], "0");
+    }
+    return true;
+}
+
+static void labels_update(uint32_t frame) {
+    for (int i = 0; i < LABEL_COUNT; i++) {
+        lv_label_set_text_fmt(objs[i], "%lu", (unsigned long)(frame * (i + 1) * 37));
+    }
+}
+
+// List scroll: the list goes down to its end and back up, LIST_STEP lines a frame
+static bool list_create(lv_obj_t *scr) {
+    lv_obj_t *list = lv_list_create(scr);
+    lv_obj_set_size(list, lv_pct(100), lv_pct(100));
+    for (int i = 0; i < LIST_ITEMS; i++) {
+        char text[16];
+        lv_snprintf(text, sizeof(text), "Item %d", i);
+        lv_list_add_btn(list, LV_SYMBOL_FILE, text);
+    }
+    lv_obj_update_layout(list);
+    scroll_max = lv_obj_get_scroll_bottom(list);
+    objs[0] = list;
+    return scroll_max > 0;
+}
+
+static void list_update(uint32_t frame) {
+    int period = 2 * scroll_max;
+    int pos = (frame * LIST_STEP) % period;
+    lv_obj_scroll_to_y(objs[0], pos <= scroll_max ? pos : period - pos, LV_ANIM_OFF);
+}
+
+// Animation: every pixel changes every frame
+static bool animation_create(lv_obj_t *scr) {
+    lv_obj_t *bg = lv_obj_create(scr);
+    lv_obj_remove_style_all(bg);
+    lv_obj_set_size(bg, lv_pct(100), lv_pct(100));
+    lv_obj_set_style_bg_opa(bg, LV_OPA_COVER, 0);
+    lv_obj_set_style_bg_grad_dir(bg, LV_GRAD_DIR_VER, 0);
+
+    lv_obj_t *arc = lv_arc_create(scr);
+    lv_obj_set_size(arc, lv_pct(70), lv_pct(70));
+    lv_obj_center(arc);
+    lv_arc_set_bg_angles(arc, 0, 360);
+    lv_obj_remove_style(arc, NULL, LV_PART_KNOB);
+    objs[0] = bg;
+    objs[1] = arc;
+    return true;
+}
+
+static void animation_update(uint32_t frame) {
+    uint16_t hue = (frame * 6) % 360;
+    lv_obj_set_style_bg_color(objs[0], lv_color_hsv_to_rgb(hue, 80, 90), 0);
+    lv_obj_set_style_bg_grad_color(objs[0], lv_color_hsv_to_rgb((hue + 180) % 360, 80, 40), 0);
+    lv_arc_set_angles(objs[1], (frame * 8) % 360, (frame * 8 + 90) % 360);
+}
+
+// Carousel: generated images moving left, wrapping around at the edge
+static void carousel_update(uint32_t frame) {
+    int pitch = IMG_SIZE + IMG_GAP;
+    int span = IMG_COUNT * pitch;
+    int offset = (frame * CAROUSEL_STEP) % span;
+    for (int i = 0; i < IMG_COUNT; i++) {
+        int x = (i * pitch - offset + span) % span;
+        lv_obj_set_x(objs[i], x - IMG_GAP);
+    }
+}
+
+static bool carousel_create(lv_obj_t *scr) {
+    size_t size = IMG_SIZE * IMG_SIZE * sizeof(lv_color_t);
+    img_data = heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+    if (img_data == NULL) {
+        img_data = heap_caps_malloc(size, MALLOC_CAP_8BIT);
+    }
+    if (img_data == NULL) {
+        return false;
+    }
+    for (int y = 0; y < IMG_SIZE; y++) {
+        for (int x = 0; x < IMG_SIZE; x++) {
+            img_data[y * IMG_SIZE + x] = lv_color_make(x * 2, y * 2, (x ^ y) * 2);
+        }
+    }
+    memset(&img_dsc, 0, sizeof(img_dsc));
+    img_dsc.header.cf = LV_IMG_CF_TRUE_COLOR;
+    img_dsc.header.w = IMG_SIZE;
+    img_dsc.header.h = IMG_SIZE;
+    img_dsc.data_size = size;
+    img_dsc.data = (const uint8_t *)img_data;
+
+    for (int i = 0; i < IMG_COUNT; i++) {
+        objs[i] = lv_img_create(scr);
+        lv_img_set_src(objs[i], &img_dsc);
+        lv_obj_set_y(objs[i], (lv_obj_get_height(scr) - IMG_SIZE) / 2);
+    }
+    carousel_update(0);
+    return true;
+}
+
+static void carousel_destroy(void) {
+    // The image cache keeps the decoded source by its descriptor
+    lv_img_cache_invalidate_src(&img_dsc);
+    heap_caps_free(img_data);
+    img_data = NULL;
+}
+
+static const bench_scene_t scenes[LV_BENCH_SCENE_COUNT] = {
+    [LV_BENCH_STATIC] = { "static", static_create, static_update, no_destroy },
+    [LV_BENCH_LABELS] = { "labels", labels_create, labels_update, no_destroy },
+    [LV_BENCH_LIST_SCROLL] = { "list_scroll", list_create, list_update, no_destroy },
+    [LV_BENCH_ANIMATION] = { "animation", animation_create, animation_update, no_destroy },
+    [LV_BENCH_CAROUSEL] = { "carousel", carousel_create, carousel_update, carousel_destroy },
+};
+
+const char *lv_bench_scene_name(lv_bench_scene_t scene) {
+    return (scene < LV_BENCH_SCENE_COUNT) ? scenes[scene].name : NULL;
+}
+
+static void bench_monitor(lv_disp_drv_t *drv, uint32_t time, uint32_t px) {
+    if (running != NULL && px > 0) {
+        running->drawn++;
+        running->px += px;
+    }
+}
+
+void lv_bench_add_flush_us(uint32_t us) {
+    if (running != NULL) {
+        running->flush_us += us;
+    }
+}
+
+void lv_bench_add_transfer_us(uint32_t us) {
+    if (running != NULL) {
+        running->transfer_us += us;
+    }
+}
+
+static void sample_mem(lv_bench_result_t *result) {
+    uint32_t used = mem_used();
+    size_t heap_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+    if (used > result->mem_peak) {
+        result->mem_peak = used;
+    }
+    if (heap_free < result->heap_min_free) {
+        result->heap_min_free = heap_free;
+    }
+}
+
+bool lv_bench_run(lv_disp_t *disp, lv_bench_scene_t scene, uint32_t frames, void (*wait_idle)(void),
+                  lv_bench_result_t *result) {
+    if (scene >= LV_BENCH_SCENE_COUNT || disp == NULL) {
+        return false;
+    }
+    const bench_scene_t *s = &scenes[scene];
+    memset(result, 0, sizeof(*result));
+    result->mem_base = mem_used();
+    result->mem_peak = result->mem_base;
+    result->heap_min_free = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+
+    lv_obj_t *old_scr = lv_disp_get_scr_act(disp);
+    lv_obj_t *scr = lv_obj_create(NULL);
+    if (scr == NULL) {
+        return false;
+    }
+    if (!s->create(scr)) {
+        s->destroy();
+        lv_obj_del(scr);
+        return false;
+    }
+    lv_disp_load_scr(scr);
+    // Keep the power manager from dimming the panel during the run
+    lv_disp_trig_activity(disp);
+
+    // The first frame draws the whole scene
+    lv_refr_now(disp);
+    wait_idle();
+    sample_mem(result);
+
+    void (*old_monitor)(lv_disp_drv_t *, uint32_t, uint32_t) = disp->driver->monitor_cb;
+    disp->driver->monitor_cb = bench_monitor;
+    running = result;
+
+    for (uint32_t f = 1; f <= frames; f++) {
+        int64_t start = esp_timer_get_time();
+        s->update(f);
+        int64_t updated = esp_timer_get_time();
+        uint64_t flush_before = result->flush_us;
+        lv_refr_now(disp);
+        int64_t end = esp_timer_get_time();
+
+        uint32_t frame_us = end - start;
+        result->update_us += updated - start;
+        result->render_us += (end - updated) - (result->flush_us - flush_before);
+        result->total_us += frame_us;
+        if (frame_us > result->max_frame_us) {
+            result->max_frame_us = frame_us;
+        }
+        sample_mem(result);
+    }
+
+    int64_t wait_start = esp_timer_get_time();
+    wait_idle();
+    result->wait_us = esp_timer_get_time() - wait_start;
+    result->total_us += result->wait_us;
+    result->frames = frames;
+    result->bus_bytes = result->px * spd2010_display_pixel_bytes();
+
+    running = NULL;
+    disp->driver->monitor_cb = old_monitor;
+
+    lv_disp_load_scr(old_scr);
+    lv_obj_del(scr);
+    s->destroy();
+    return true;
+}
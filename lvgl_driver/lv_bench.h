@@ -0,0 +1,62 @@
+/*
+ * Frame-rate benchmark
+ * Representative LVGL scenes rendered frame by frame through the flush and
+ * the display driver, with the time spent in each stage, the bytes sent and
+ * the memory used
+ */
+
+#ifndef LV_BENCH_H
+#define LV_BENCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    LV_BENCH_STATIC,        // widgets that do not change: the cost of an idle frame
+    LV_BENCH_LABELS,        // a grid of labels with new text every frame
+    LV_BENCH_LIST_SCROLL,   // a long list scrolled up and down
+    LV_BENCH_ANIMATION,     // full screen gradient and arc, all pixels every frame
+    LV_BENCH_CAROUSEL,      // images sliding across the screen
+    LV_BENCH_SCENE_COUNT,
+} lv_bench_scene_t;
+
+typedef struct {
+    uint32_t frames;        // frames run
+    uint32_t drawn;         // frames that flushed pixels
+    uint64_t total_us;      // all frames, including the wait for the last transfer
+    uint64_t px;            // pixels flushed
+    uint64_t bus_bytes;     // pixel bytes sent to the panel
+    uint64_t update_us;     // changing the widgets
+    uint64_t render_us;     // LVGL layout and drawing, refresh time without the flush
+    uint64_t flush_us;      // flush callback: conversion and queueing of the transfers
+    uint64_t transfer_us;   // pipeline transfer task, on the other core
+    uint32_t wait_us;       // waiting for the transfers after the last frame
+    uint32_t max_frame_us;
+    uint32_t mem_base;      // LVGL heap in use before the scene was created
+    uint32_t mem_peak;      // highest LVGL heap use during the scene
+    uint32_t heap_min_free; // lowest free internal heap during the scene
+} lv_bench_result_t;
+
+// Short name used in reports, NULL for an unknown scene
+const char *lv_bench_scene_name(lv_bench_scene_t scene);
+
+// Create the scene on a new screen, run frames refreshes and restore the
+// previous screen. Call with the LVGL lock held. wait_idle blocks until the
+// display has sent everything. False when the scene could not be created
+bool lv_bench_run(lv_disp_t *disp, lv_bench_scene_t scene, uint32_t frames, void (*wait_idle)(void),
+                  lv_bench_result_t *result);
+
+// From the flush callback and the pipeline transfer task, counted while a scene runs
+void lv_bench_add_flush_us(uint32_t us);
+void lv_bench_add_transfer_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_BENCH_H
@@ -0,0 +1,178 @@
+/*
+ * Bounded LVGL caches
+ *
+ * A quarter of the budget goes to the gradient cache, the rest to the image
+ * cache. LVGL sizes its image cache in slots, not bytes, so the slot count is
+ * derived from an estimated entry size and the bytes really held by decoded
+ * images are tracked by wrapping the decoders' open and close. When they go
+ * over the budget the slot count is reduced after the frame; it grows back,
+ * up to the count of the budget, once every slot is taken and one more entry
+ * of the average size fits. Eviction within the cache is LVGL's own aging,
+ * which drops the least recently and least often used entry. Lookups are
+ * counted by wrapping _lv_img_cache_open at link time (-Wl,--wrap, see
+ * micropython.cmake) and misses by the decoder opens: every miss opens a
+ * decoder, the other lookups are hits.
+ */
+
+#include "lv_cache_budget.h"
+#include "src/misc/lv_gc.h"
+#include "src/draw/sw/lv_draw_sw_gradient.h"
+
+// Estimated decoded image size for the slot count
+#define CACHE_ENTRY_EST     (8 * 1024)
+#define CACHE_MAX_ENTRIES   16
+#define CACHE_MAX_DECODERS  8
+
+typedef struct {
+    lv_img_decoder_t *decoder;
+    lv_img_decoder_open_f_t open_cb;
+    lv_img_decoder_close_f_t close_cb;
+} decoder_hook_t;
+
+static decoder_hook_t hooks[CACHE_MAX_DECODERS];
+static int hook_count = 0;
+static lv_cache_budget_stats_t stats;
+static uint16_t budget_entries = 1;     // slot count of the budget, the most poll grows to
+static uint16_t img_open = 0;           // images open, cached or in use
+static uint32_t img_lookups = 0;
+
+_lv_img_cache_entry_t *__real__lv_img_cache_open(const void *src, lv_color_t color, int32_t frame_id);
+
+// Bytes a decoder allocated for an open image, C array images are used in place
+static uint32_t entry_bytes(const lv_img_decoder_dsc_t *dsc) {
+    if (dsc->img_data == NULL) {
+        return 0;
+    }
+    if (dsc->src_type == LV_IMG_SRC_VARIABLE && dsc->img_data == ((const lv_img_dsc_t *)dsc->src)->data) {
+        return 0;
+    }
+    return lv_img_buf_get_img_size(dsc->header.w, dsc->header.h, dsc->header.cf);
+}
+
+static decoder_hook_t *find_hook(lv_img_decoder_t *decoder) {
+    for (int i = 0; i < hook_count; i++) {
+        if (hooks[i].decoder == decoder) {
+            return &hooks[i];
+        }
+    }
+    return NULL;
+}
+
+static lv_res_t hooked_open(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    decoder_hook_t *hook = find_hook(decoder);
+    lv_res_t res = hook->open_cb(decoder, dsc);
+    if (res == LV_RES_OK) {
+        stats.img_misses++;
+        stats.img_bytes += entry_bytes(dsc);
+        img_open++;
+    }
+    return res;
+}
+
+static void hooked_close(lv_img_decoder_t *decoder, lv_img_decoder_dsc_t *dsc) {
+    decoder_hook_t *hook = find_hook(decoder);
+    uint32_t bytes = entry_bytes(dsc);
+    stats.img_bytes -= (bytes < stats.img_bytes) ? bytes : stats.img_bytes;
+    if (img_open > 0) {
+        img_open--;
+    }
+    if (hook->close_cb) {
+        hook->close_cb(decoder, dsc);
+    }
+}
+
+// Every image LVGL draws is looked up here, opened by a decoder on a miss
+_lv_img_cache_entry_t *__wrap__lv_img_cache_open(const void *src, lv_color_t color, int32_t frame_id) {
+    _lv_img_cache_entry_t *entry = __real__lv_img_cache_open(src, color, frame_id);
+    if (entry != NULL) {
+        img_lookups++;
+    }
+    return entry;
+}
+
+// Forget decoders that are gone or no longer hooked, e.g. after lv_init ran again
+static void prune_hooks(void) {
+    int kept = 0;
+    for (int i = 0; i < hook_count; i++) {
+        lv_img_decoder_t *decoder;
+        _LV_LL_READ(&LV_GC_ROOT(_lv_img_decoder_ll), decoder) {
+            if (decoder == hooks[i].decoder && decoder->open_cb == hooked_open) {
+                hooks[kept++] = hooks[i];
+                break;
+            }
+        }
+    }
+    hook_count = kept;
+}
+
+static void hook_decoders(void) {
+    lv_img_decoder_t *decoder;
+    _LV_LL_READ(&LV_GC_ROOT(_lv_img_decoder_ll), decoder) {
+        if (decoder->open_cb == hooked_open || decoder->open_cb == NULL || hook_count >= CACHE_MAX_DECODERS) {
+            continue;
+        }
+        hooks[hook_count].decoder = decoder;
+        hooks[hook_count].open_cb = decoder->open_cb;
+        hooks[hook_count].close_cb = decoder->close_cb;
+        hook_count++;
+        decoder->open_cb = hooked_open;
+        decoder->close_cb = hooked_close;
+    }
+}
+
+static void set_img_entries(uint16_t entries) {
+    stats.img_entries = entries;
+    lv_img_cache_set_size(entries);
+}
+
+void lv_cache_budget_init(void) {
+    prune_hooks();
+    hook_decoders();
+    
+    lv_cache_budget_reset_stats();
+    stats.img_bytes = 0;
+    img_open = 0;
+    lv_cache_budget_set(stats.budget ? stats.budget : LV_CACHE_BUDGET_DEF);
+}
+
+void lv_cache_budget_set(size_t budget) {
+    stats.budget = budget;
+    stats.grad_budget = budget / 4;
+    stats.img_budget = budget - stats.grad_budget;
+    
+    uint32_t entries = stats.img_budget / CACHE_ENTRY_EST;
+    // LVGL needs at least one slot to open images through the cache
+    if (entries < 1) {
+        entries = 1;
+    } else if (entries > CACHE_MAX_ENTRIES) {
+        entries = CACHE_MAX_ENTRIES;
+    }
+    budget_entries = entries;
+    set_img_entries(entries);
+    lv_gradient_set_cache_size(stats.grad_budget);
+}
+
+void lv_cache_budget_poll(void) {
+    hook_decoders();
+    
+    if (stats.img_bytes > stats.img_budget && stats.img_entries > 1) {
+        // Resizing drops every cached entry, the ones still needed are opened again
+        set_img_entries(stats.img_entries - 1);
+        stats.evictions++;
+    } else if (stats.img_entries < budget_entries && img_open >= stats.img_entries
+               && stats.img_bytes + stats.img_bytes / img_open <= stats.img_budget) {
+        // The images got smaller: every slot is taken and one more fits
+        set_img_entries(stats.img_entries + 1);
+    }
+}
+
+void lv_cache_budget_get_stats(lv_cache_budget_stats_t *out) {
+    *out = stats;
+    out->img_hits = (img_lookups > stats.img_misses) ? img_lookups - stats.img_misses : 0;
+}
+
+void lv_cache_budget_reset_stats(void) {
+    img_lookups = 0;
+    stats.img_misses = 0;
+    stats.evictions = 0;
+}
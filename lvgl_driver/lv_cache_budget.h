@@ -0,0 +1,50 @@
+/*
+ * Bounded LVGL caches
+ * Image and gradient caches share one memory budget, with hit/miss counters
+ */
+
+#ifndef LV_CACHE_BUDGET_H
+#define LV_CACHE_BUDGET_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Budget until lv_cache_budget_set is called
+#ifndef LV_CACHE_BUDGET_DEF
+#define LV_CACHE_BUDGET_DEF (32 * 1024)
+#endif
+
+typedef struct {
+    uint32_t budget;        // bytes for image and gradient caches together
+    uint32_t img_budget;
+    uint32_t grad_budget;
+    uint16_t img_entries;   // image cache slots
+    uint32_t img_bytes;     // decoded image data held open, cached or in use
+    uint32_t img_hits;
+    uint32_t img_misses;
+    uint32_t evictions;     // slot count reductions to stay within the budget
+} lv_cache_budget_stats_t;
+
+// Hook the registered image decoders and size the caches to the budget
+void lv_cache_budget_init(void);
+
+// Split budget bytes between the caches and resize them, drops cached entries
+void lv_cache_budget_set(size_t budget);
+
+// Enforce the budget after rendering, or grow the image cache back within it.
+// Hooks decoders registered since init
+void lv_cache_budget_poll(void);
+
+void lv_cache_budget_get_stats(lv_cache_budget_stats_t *stats);
+void lv_cache_budget_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_CACHE_BUDGET_H
@@ -0,0 +1,171 @@
+/*
+ * Touch to photon latency
+ *
+ * A touch sample carries the time of its interrupt. If processing it
+ * invalidated part of the screen, the tag is armed and the next frame to
+ * start flushing takes it over; a sample that changes nothing is forgotten.
+ * While a tag is armed newer samples keep the older time, the response is
+ * late from the first of them. When the last band of the tagged frame is
+ * queued, the display sets a marker that its transfer done interrupt stamps
+ * once all queued pixels are on the panel; the difference goes into the
+ * histogram. The panel shows frame memory on its next scan, which is not
+ * included.
+ *
+ * One frame is measured at a time. The tag moves from the LVGL thread to the
+ * transfer task and back through queued_us and in_flight_us, with the marker
+ * in between.
+ */
+
+#include <string.h>
+#include "lv_latency.h"
+#include "esp_timer.h"
+
+extern void spd2010_display_mark_frame(void);
+extern int64_t spd2010_display_mark_time(void);
+
+static bool enabled = false;
+static int64_t sample_us = 0;           // oldest touch sample not processed yet
+static int64_t armed_us = 0;            // changed the screen, waiting for a frame
+static int64_t frame_us = 0;            // carried by the frame being flushed
+static bool frame_open = false;
+static volatile int64_t queued_us = 0;  // frame flushed, last band not queued yet
+static volatile int64_t in_flight_us = 0;   // marker set, waiting for the panel
+static int64_t in_flight_since = 0;
+static lv_latency_stats_t stats;
+
+void lv_latency_enable(bool enable) {
+    enabled = enable;
+    sample_us = 0;
+    armed_us = 0;
+    frame_us = 0;
+}
+
+bool lv_latency_enabled(void) {
+    return enabled;
+}
+
+void lv_latency_sample(int64_t us) {
+    if (enabled && sample_us == 0) {
+        sample_us = us;
+    }
+}
+
+void lv_latency_input_done(bool invalidated) {
+    if (sample_us == 0) {
+        return;
+    }
+    if (invalidated && armed_us == 0) {
+        armed_us = sample_us;
+    }
+    sample_us = 0;
+}
+
+void lv_latency_flush(bool last) {
+    if (!frame_open) {
+        frame_open = true;
+        frame_us = armed_us;
+        armed_us = 0;
+    }
+    if (!last) {
+        return;
+    }
+    frame_open = false;
+    if (frame_us == 0) {
+        return;
+    }
+    // One measurement at a time, the frame before may still be on its way
+    if (queued_us != 0 || in_flight_us != 0) {
+        stats.dropped++;
+    } else {
+        __atomic_store_n(&queued_us, frame_us, __ATOMIC_RELEASE);
+    }
+    frame_us = 0;
+}
+
+void lv_latency_frame_queued(void) {
+    int64_t tag = __atomic_load_n(&queued_us, __ATOMIC_ACQUIRE);
+    if (tag == 0) {
+        return;
+    }
+    spd2010_display_mark_frame();
+    in_flight_since = esp_timer_get_time();
+    __atomic_store_n(&in_flight_us, tag, __ATOMIC_RELEASE);
+    __atomic_store_n(&queued_us, 0, __ATOMIC_RELEASE);
+}
+
+static int bucket_of(uint32_t us) {
+    if (us < LV_LATENCY_SUB_COUNT) {
+        return us;
+    }
+    int e = 31 - __builtin_clz(us);
+    if (e >= LV_LATENCY_MAX_BITS) {
+        return LV_LATENCY_BUCKETS - 1;
+    }
+    int shift = e - LV_LATENCY_SUB_BITS;
+    return (shift + 1) * LV_LATENCY_SUB_COUNT + (int)(us >> shift) - LV_LATENCY_SUB_COUNT;
+}
+
+uint32_t lv_latency_bucket_upper(int i) {
+    if (i < LV_LATENCY_SUB_COUNT) {
+        return i;
+    }
+    int shift = i / LV_LATENCY_SUB_COUNT - 1;
+    uint32_t m = i % LV_LATENCY_SUB_COUNT + LV_LATENCY_SUB_COUNT;
+    return ((m + 1) << shift) - 1;
+}
+
+static void record(uint32_t us) {
+    if (stats.count == 0 || us < stats.min_us) {
+        stats.min_us = us;
+    }
+    if (us > stats.max_us) {
+        stats.max_us = us;
+    }
+    stats.count++;
+    stats.sum_us += us;
+    stats.buckets[bucket_of(us)]++;
+}
+
+void lv_latency_poll(void) {
+    int64_t tag = __atomic_load_n(&in_flight_us, __ATOMIC_ACQUIRE);
+    if (tag == 0) {
+        return;
+    }
+    int64_t done = spd2010_display_mark_time();
+    if (done != 0) {
+        record(done > tag ? (uint32_t)(done - tag) : 0);
+    } else if (esp_timer_get_time() - in_flight_since > LV_LATENCY_TIMEOUT_US) {
+        stats.dropped++;
+    } else {
+        return;
+    }
+    __atomic_store_n(&in_flight_us, 0, __ATOMIC_RELEASE);
+}
+
+void lv_latency_get_stats(lv_latency_stats_t *out) {
+    *out = stats;
+}
+
+void lv_latency_reset(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+uint32_t lv_latency_percentile(const lv_latency_stats_t *s, uint32_t permille) {
+    if (s->count == 0) {
+        return 0;
+    }
+    // Rank of the sample, rounded up: the 99th percentile of 10 samples is the 10th
+    uint64_t rank = ((uint64_t)s->count * permille + 999) / 1000;
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < LV_LATENCY_BUCKETS; i++) {
+        seen += s->buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = lv_latency_bucket_upper(i);
+            return upper < s->max_us ? upper : s->max_us;
+        }
+    }
+    return s->max_us;
+}
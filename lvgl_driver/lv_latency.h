@@ -0,0 +1,71 @@
+/*
+ * Touch to photon latency
+ * Follows touch samples that change the screen into the frame that shows
+ * the change, and keeps the time until that frame is on the panel in a
+ * log-linear histogram
+ */
+
+#ifndef LV_LATENCY_H
+#define LV_LATENCY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 16 buckets per power of two (about 6% resolution), exact below 16 us, up to 16.7 s
+#define LV_LATENCY_SUB_BITS     4
+#define LV_LATENCY_SUB_COUNT    (1 << LV_LATENCY_SUB_BITS)
+#define LV_LATENCY_MAX_BITS     24
+#define LV_LATENCY_BUCKETS      ((LV_LATENCY_MAX_BITS - LV_LATENCY_SUB_BITS + 1) * LV_LATENCY_SUB_COUNT)
+
+// A frame that is not on the panel by then is not counted
+#ifndef LV_LATENCY_TIMEOUT_US
+#define LV_LATENCY_TIMEOUT_US   1000000
+#endif
+
+typedef struct {
+    uint32_t count;
+    uint32_t dropped;       // responses not measured: another was in flight, or timed out
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint32_t buckets[LV_LATENCY_BUCKETS];
+} lv_latency_stats_t;
+
+// Starts disabled
+void lv_latency_enable(bool enable);
+bool lv_latency_enabled(void);
+
+// Touch read: a sample taken at us (esp_timer time of the touch interrupt)
+void lv_latency_sample(int64_t us);
+
+// After LVGL processed the input: whether it invalidated anything
+void lv_latency_input_done(bool invalidated);
+
+// Flush callback, for every band; last is lv_disp_flush_is_last
+void lv_latency_flush(bool last);
+
+// The last band of a frame is queued to the panel, from the flush or the
+// pipeline transfer task
+void lv_latency_frame_queued(void);
+
+// Pick up a frame that reached the panel, next to lv_timer_handler
+void lv_latency_poll(void);
+
+void lv_latency_get_stats(lv_latency_stats_t *stats);
+void lv_latency_reset(void);
+
+// Largest latency in bucket i
+uint32_t lv_latency_bucket_upper(int i);
+
+// Latency below which permille of the samples are, 0 without samples
+uint32_t lv_latency_percentile(const lv_latency_stats_t *stats, uint32_t permille);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_LATENCY_H
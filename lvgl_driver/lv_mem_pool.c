@@ -0,0 +1,254 @@
+/*
+ * Pool allocator for LVGL (LV_MEM_CUSTOM)
+ *
+ * Objects, styles and their small bookkeeping allocations are served from
+ * fixed size classes with a free list each, so widget churn does not cut up
+ * the heap. Larger blocks (draw layers, image data, label text) go to the
+ * ESP-IDF heap with a header that links them into a list of live blocks, in
+ * PSRAM when LV_MEM_POOL_PSRAM is set. lv_mem_pool_reset() gives all of it
+ * back at once, for a new LVGL. LVGL runs in a single thread, no locking is
+ * done here.
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include "lv_mem_pool.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#define TAG "lv_mem_pool"
+
+#if LV_MEM_POOL_PSRAM
+#define LARGE_CAPS          (MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT)
+#else
+#define LARGE_CAPS          (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+#endif
+
+// Header in front of arena blocks: the list of live ones and the size,
+// rounded up to keep 8 byte alignment
+typedef struct large_block {
+    struct large_block *prev;
+    struct large_block *next;
+    uint32_t size;
+} large_block_t;
+
+#define LARGE_HEADER        ((sizeof(large_block_t) + 7) & ~(size_t)7)
+
+typedef struct free_block {
+    struct free_block *next;
+} free_block_t;
+
+typedef struct {
+    uint8_t *start;
+    uint8_t *end;
+    free_block_t *free_list;
+} pool_class_t;
+
+static const uint16_t class_size[LV_MEM_POOL_CLASS_NUM] = { 16, 32, 64, LV_MEM_POOL_MAX_BLOCK };
+
+static pool_class_t classes[LV_MEM_POOL_CLASS_NUM];
+static lv_mem_pool_stats_t stats;
+static large_block_t *large_blocks = NULL;
+static bool pool_ready = false;
+
+// Every block of a class region free, the list built back to front so blocks
+// are handed out in address order
+static void pool_fill(int i) {
+    pool_class_t *c = &classes[i];
+    c->free_list = NULL;
+    if (c->start == NULL) {
+        return;
+    }
+    for (int b = stats.classes[i].blocks - 1; b >= 0; b--) {
+        free_block_t *block = (free_block_t *)(c->start + b * class_size[i]);
+        block->next = c->free_list;
+        c->free_list = block;
+    }
+}
+
+// Carve the class regions into free lists, on the first allocation
+static void pool_init(void) {
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        pool_class_t *c = &classes[i];
+        uint16_t blocks = LV_MEM_POOL_CLASS_BYTES / class_size[i];
+        
+        stats.classes[i].block_size = class_size[i];
+        c->start = heap_caps_malloc(blocks * class_size[i], MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (c->start == NULL) {
+            ESP_LOGW(TAG, "No memory for the %d byte pool", class_size[i]);
+            continue;
+        }
+        c->end = c->start + blocks * class_size[i];
+        stats.classes[i].blocks = blocks;
+        pool_fill(i);
+    }
+    pool_ready = true;
+}
+
+// Size class of a pool block, -1 for arena blocks
+static int pool_class_of(const void *ptr) {
+    const uint8_t *p = ptr;
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        if (p >= classes[i].start && p < classes[i].end) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void count_used(int32_t bytes) {
+    stats.used += bytes;
+    if (stats.used > stats.peak) {
+        stats.peak = stats.used;
+    }
+}
+
+static void *large_alloc(size_t size) {
+    large_block_t *block = heap_caps_malloc_prefer(size + LARGE_HEADER, 2, LARGE_CAPS, MALLOC_CAP_8BIT);
+    if (block == NULL) {
+        return NULL;
+    }
+    block->size = size;
+    block->prev = NULL;
+    block->next = large_blocks;
+    if (large_blocks != NULL) {
+        large_blocks->prev = block;
+    }
+    large_blocks = block;
+    
+    stats.large_blocks++;
+    stats.large_bytes += size;
+    if (stats.large_bytes > stats.large_peak) {
+        stats.large_peak = stats.large_bytes;
+    }
+    count_used(size);
+    return (uint8_t *)block + LARGE_HEADER;
+}
+
+static large_block_t *large_block_of(void *ptr) {
+    return (large_block_t *)((uint8_t *)ptr - LARGE_HEADER);
+}
+
+void *lv_mem_pool_alloc(size_t size) {
+    if (!pool_ready) {
+        pool_init();
+    }
+    
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        if (size > class_size[i]) {
+            continue;
+        }
+        pool_class_t *c = &classes[i];
+        if (c->free_list == NULL) {
+            // Class exhausted, try the next one up
+            stats.classes[i].overflow++;
+            continue;
+        }
+        free_block_t *block = c->free_list;
+        c->free_list = block->next;
+        
+        lv_mem_pool_class_stats_t *s = &stats.classes[i];
+        s->used++;
+        if (s->used > s->peak) {
+            s->peak = s->used;
+        }
+        count_used(class_size[i]);
+        return block;
+    }
+    
+    void *ptr = large_alloc(size);
+    if (ptr == NULL) {
+        stats.failed++;
+        ESP_LOGE(TAG, "Failed to allocate %d bytes", (int)size);
+    }
+    return ptr;
+}
+
+void lv_mem_pool_free(void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    
+    int i = pool_class_of(ptr);
+    if (i >= 0) {
+        free_block_t *block = ptr;
+        block->next = classes[i].free_list;
+        classes[i].free_list = block;
+        stats.classes[i].used--;
+        stats.used -= class_size[i];
+        return;
+    }
+    
+    large_block_t *block = large_block_of(ptr);
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    } else {
+        large_blocks = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    }
+    stats.large_blocks--;
+    stats.large_bytes -= block->size;
+    stats.used -= block->size;
+    heap_caps_free(block);
+}
+
+void *lv_mem_pool_realloc(void *ptr, size_t size) {
+    if (ptr == NULL) {
+        return lv_mem_pool_alloc(size);
+    }
+    if (size == 0) {
+        lv_mem_pool_free(ptr);
+        return NULL;
+    }
+    
+    int i = pool_class_of(ptr);
+    size_t old_size = (i >= 0) ? class_size[i] : large_block_of(ptr)->size;
+    
+    // Stay in place while the block still fits and is not wastefully large
+    if (i >= 0 && size <= class_size[i] && (i == 0 || size > class_size[i - 1])) {
+        return ptr;
+    }
+    
+    void *new_ptr = lv_mem_pool_alloc(size);
+    if (new_ptr == NULL) {
+        return NULL;
+    }
+    memcpy(new_ptr, ptr, old_size < size ? old_size : size);
+    lv_mem_pool_free(ptr);
+    return new_ptr;
+}
+
+void lv_mem_pool_reset(void) {
+    while (large_blocks != NULL) {
+        large_block_t *next = large_blocks->next;
+        heap_caps_free(large_blocks);
+        large_blocks = next;
+    }
+    
+    for (int i = 0; i < LV_MEM_POOL_CLASS_NUM; i++) {
+        lv_mem_pool_class_stats_t *s = &stats.classes[i];
+        s->used = 0;
+        s->peak = 0;
+        s->overflow = 0;
+        pool_fill(i);
+    }
+    stats.large_blocks = 0;
+    stats.large_bytes = 0;
+    stats.large_peak = 0;
+    stats.used = 0;
+    stats.peak = 0;
+    stats.failed = 0;
+}
+
+void lv_mem_pool_get_stats(lv_mem_pool_stats_t *out) {
+    *out = stats;
+    
+    multi_heap_info_t info;
+    heap_caps_get_info(&info, LARGE_CAPS);
+    out->heap_frag_pct = 0;
+    if (info.total_free_bytes > 0) {
+        out->heap_frag_pct = 100 - (uint8_t)((uint64_t)info.largest_free_block * 100 / info.total_free_bytes);
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Pool allocator for LVGL (LV_MEM_CUSTOM)
+ * Small blocks come from fixed size classes, larger ones from the heap arena
+ */
+
+#ifndef LV_MEM_POOL_H
+#define LV_MEM_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Block sizes of the pools, anything larger goes to the arena
+#define LV_MEM_POOL_CLASS_NUM 4
+#define LV_MEM_POOL_MAX_BLOCK 128
+
+// Bytes reserved per size class
+#ifndef LV_MEM_POOL_CLASS_BYTES
+#define LV_MEM_POOL_CLASS_BYTES (8 * 1024)
+#endif
+
+typedef struct {
+    uint16_t block_size;
+    uint16_t blocks;
+    uint16_t used;
+    uint16_t peak;
+    uint32_t overflow;      // requests that did not fit and went to a larger class or the arena
+} lv_mem_pool_class_stats_t;
+
+typedef struct {
+    lv_mem_pool_class_stats_t classes[LV_MEM_POOL_CLASS_NUM];
+    uint32_t large_blocks;  // live arena blocks
+    uint32_t large_bytes;   // bytes requested from the arena
+    uint32_t large_peak;
+    uint32_t used;          // bytes in use, pools counted by block size
+    uint32_t peak;
+    uint32_t failed;        // allocations that returned NULL
+    uint8_t heap_frag_pct;  // of the IDF heap the arena blocks come from: 100 - largest free block / free bytes
+} lv_mem_pool_stats_t;
+
+void *lv_mem_pool_alloc(size_t size);
+void lv_mem_pool_free(void *ptr);
+void *lv_mem_pool_realloc(void *ptr, size_t size);
+void lv_mem_pool_get_stats(lv_mem_pool_stats_t *stats);
+
+// Free every block: the pools' free lists rebuilt, the arena blocks returned
+// to the heap and the statistics cleared. Only while nothing points into the
+// pool any more, before LVGL is initialized again
+void lv_mem_pool_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_MEM_POOL_H
@@ -0,0 +1,257 @@
+/*
+ * Idle power manager
+ *
+ * The state follows LVGL's inactivity time, which input devices and
+ * lv_disp_trig_activity reset: ACTIVE -> DIM -> OFF -> SLEEP as it passes
+ * dim_ms, off_ms and sleep_ms. A stage with a threshold of 0 is skipped.
+ * Leaving ACTIVE remembers the backlight level so a wake restores it. SLEEP
+ * pauses the display refresh timer and puts the panel into sleep mode; its
+ * frame memory is kept, so waking needs SLPOUT and no redraw. Invalidations
+ * made while asleep are rendered once the refresh timer runs again.
+ *
+ * The touch interrupt only sets a flag, the panel is woken from lv_power_poll
+ * with the LVGL lock held. The panel takes 120 ms after SLPOUT before it can
+ * be turned on, the polls in between only check whether that time is over so
+ * the lock is not held through it. The time from the interrupt to the
+ * backlight fading up is kept as the wake latency. The touch that woke the
+ * screen is not passed on to LVGL, it would press whatever is under it.
+ */
+
+#include "lv_power.h"
+#include "esp_timer.h"
+
+extern bool spd2010_display_set_sleep(bool sleep);
+extern uint32_t spd2010_display_wake(void);
+extern void spd2010_backlight_fade_to(int level, int ms);
+extern int spd2010_backlight_level(void);
+
+static lv_disp_t *power_disp = NULL;
+static lv_power_config_t config = { .dim_ms = 0, .off_ms = 0, .sleep_ms = 0, .dim_level = 10 };
+static bool enabled = false;
+static lv_power_state_t state = LV_POWER_ACTIVE;
+static uint32_t state_since = 0;        // lv_tick of the last transition
+static int active_level = 0;            // backlight level restored on wake
+static lv_power_stats_t stats;
+static volatile bool wake_pending = false;
+static volatile int64_t wake_start_us = 0;
+static bool waking = false;             // left SLEEP, the panel is not on yet
+static uint32_t waking_ms = 0;          // until it can be turned on, from waking_since
+static uint32_t waking_since = 0;
+static bool swallow_touch = false;      // the touch that woke the screen is still down
+
+// Deepest state whose threshold the inactivity time has passed
+static lv_power_state_t target_state(uint32_t inactive) {
+    if (config.sleep_ms && inactive >= config.sleep_ms) {
+        return LV_POWER_SLEEP;
+    }
+    if (config.off_ms && inactive >= config.off_ms) {
+        return LV_POWER_OFF;
+    }
+    if (config.dim_ms && inactive >= config.dim_ms) {
+        return LV_POWER_DIM;
+    }
+    return LV_POWER_ACTIVE;
+}
+
+static uint32_t threshold(lv_power_state_t s) {
+    switch (s) {
+        case LV_POWER_DIM:
+            return config.dim_ms;
+        case LV_POWER_OFF:
+            return config.off_ms;
+        case LV_POWER_SLEEP:
+            return config.sleep_ms;
+        default:
+            return 0;
+    }
+}
+
+// Add the time since the last transition to the current state
+static void account(void) {
+    uint32_t now = lv_tick_get();
+    stats.state_ms[state] += (uint32_t)(now - state_since);
+    state_since = now;
+}
+
+// Turn the panel on after SLEEP once it can be, then let the display refresh
+static bool panel_on(void) {
+    waking_ms = spd2010_display_wake();
+    waking_since = lv_tick_get();
+    if (waking_ms != 0) {
+        return false;
+    }
+    waking = false;
+    if (power_disp != NULL && power_disp->refr_timer != NULL) {
+        lv_timer_resume(power_disp->refr_timer);
+    }
+    return true;
+}
+
+// Backlight and panel of the new state
+static void enter(lv_power_state_t next) {
+    switch (next) {
+        case LV_POWER_ACTIVE:
+            spd2010_backlight_fade_to(active_level, LV_POWER_WAKE_FADE_MS);
+            stats.wakes++;
+            if (wake_start_us != 0) {
+                stats.last_wake_us = (uint32_t)(esp_timer_get_time() - wake_start_us);
+                if (stats.last_wake_us > stats.max_wake_us) {
+                    stats.max_wake_us = stats.last_wake_us;
+                }
+            }
+            break;
+        case LV_POWER_DIM:
+            spd2010_backlight_fade_to(LV_MIN(config.dim_level, active_level), LV_POWER_FADE_MS);
+            break;
+        case LV_POWER_OFF:
+            spd2010_backlight_fade_to(0, LV_POWER_FADE_MS);
+            break;
+        case LV_POWER_SLEEP:
+            spd2010_backlight_fade_to(0, 0);
+            if (power_disp != NULL && power_disp->refr_timer != NULL) {
+                lv_timer_pause(power_disp->refr_timer);
+            }
+            spd2010_display_set_sleep(true);
+            break;
+        default:
+            break;
+    }
+    wake_start_us = 0;
+}
+
+static void set_state(lv_power_state_t next) {
+    account();
+    if (state == LV_POWER_ACTIVE) {
+        active_level = spd2010_backlight_level();
+    }
+    bool from_sleep = (state == LV_POWER_SLEEP);
+    state = next;
+    if (from_sleep) {
+        waking = true;
+        if (!panel_on()) {
+            return;
+        }
+    }
+    enter(next);
+}
+
+void lv_power_init(lv_disp_t *disp) {
+    power_disp = disp;
+    enabled = false;
+    state = LV_POWER_ACTIVE;
+    state_since = lv_tick_get();
+    wake_pending = false;
+    wake_start_us = 0;
+    waking = false;
+    swallow_touch = false;
+}
+
+void lv_power_configure(const lv_power_config_t *new_config) {
+    config = *new_config;
+    if (config.dim_level > 100) {
+        config.dim_level = 100;
+    }
+}
+
+void lv_power_get_config(lv_power_config_t *out) {
+    *out = config;
+}
+
+void lv_power_enable(bool enable) {
+    enabled = enable;
+    if (power_disp == NULL) {
+        return;
+    }
+    // Count down from now, not from the last touch before enabling
+    lv_disp_trig_activity(power_disp);
+    if (state != LV_POWER_ACTIVE) {
+        set_state(LV_POWER_ACTIVE);
+    }
+}
+
+bool lv_power_enabled(void) {
+    return enabled;
+}
+
+void lv_power_wake_from_isr(void) {
+    if (state != LV_POWER_ACTIVE && !wake_pending) {
+        wake_start_us = esp_timer_get_time();
+        wake_pending = true;
+    }
+}
+
+void lv_power_poll(void) {
+    if (power_disp == NULL) {
+        return;
+    }
+    if (wake_pending) {
+        wake_pending = false;
+        swallow_touch = true;
+        lv_disp_trig_activity(power_disp);
+    }
+    if (waking) {
+        if (!panel_on()) {
+            return;
+        }
+        enter(state);
+    }
+    if (!enabled) {
+        return;
+    }
+
+    lv_power_state_t next = target_state(lv_disp_get_inactive_time(power_disp));
+    if (next != state) {
+        set_state(next);
+    }
+}
+
+uint32_t lv_power_next_ms(void) {
+    if (waking) {
+        uint32_t elapsed = lv_tick_elaps(waking_since);
+        return (elapsed >= waking_ms) ? 0 : waking_ms - elapsed;
+    }
+    if (!enabled || power_disp == NULL) {
+        return UINT32_MAX;
+    }
+    uint32_t inactive = lv_disp_get_inactive_time(power_disp);
+    uint32_t next = UINT32_MAX;
+
+    for (int s = state + 1; s < LV_POWER_STATE_COUNT; s++) {
+        uint32_t ms = threshold(s);
+        if (ms == 0) {
+            continue;
+        }
+        uint32_t left = (inactive >= ms) ? 0 : ms - inactive;
+        if (left < next) {
+            next = left;
+        }
+    }
+    return next;
+}
+
+bool lv_power_swallow_touch(bool pressed) {
+    if (!swallow_touch) {
+        return false;
+    }
+    if (pressed) {
+        // Held down, the screen stays awake
+        lv_disp_trig_activity(power_disp);
+    } else {
+        swallow_touch = false;
+    }
+    return true;
+}
+
+lv_power_state_t lv_power_get_state(void) {
+    return state;
+}
+
+void lv_power_get_stats(lv_power_stats_t *out) {
+    account();
+    *out = stats;
+}
+
+void lv_power_reset_stats(void) {
+    lv_memset_00(&stats, sizeof(stats));
+    state_since = lv_tick_get();
+}
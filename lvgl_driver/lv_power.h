@@ -0,0 +1,80 @@
+/*
+ * Idle power manager
+ * Dims and turns off the backlight, then puts the panel to sleep and stops
+ * rendering while LVGL sees no activity. A touch wakes it up again
+ */
+
+#ifndef LV_POWER_H
+#define LV_POWER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Backlight fade into dim/off and back to the active level on wake
+#ifndef LV_POWER_FADE_MS
+#define LV_POWER_FADE_MS        500
+#endif
+#ifndef LV_POWER_WAKE_FADE_MS
+#define LV_POWER_WAKE_FADE_MS   80
+#endif
+
+typedef enum {
+    LV_POWER_ACTIVE,
+    LV_POWER_DIM,           // backlight at dim_level
+    LV_POWER_OFF,           // backlight off, still rendering
+    LV_POWER_SLEEP,         // panel in sleep mode, refresh timer paused
+    LV_POWER_STATE_COUNT,
+} lv_power_state_t;
+
+typedef struct {
+    uint32_t dim_ms;        // inactivity before each stage, 0 skips the stage
+    uint32_t off_ms;
+    uint32_t sleep_ms;
+    uint8_t dim_level;      // backlight level while dimmed, 0-100
+} lv_power_config_t;
+
+typedef struct {
+    uint64_t state_ms[LV_POWER_STATE_COUNT];    // time spent in each state
+    uint32_t wakes;         // returns to ACTIVE
+    uint32_t last_wake_us;  // touch interrupt to panel on and backlight fading up
+    uint32_t max_wake_us;
+} lv_power_stats_t;
+
+// Starts disabled, in ACTIVE
+void lv_power_init(lv_disp_t *disp);
+
+void lv_power_configure(const lv_power_config_t *config);
+void lv_power_get_config(lv_power_config_t *config);
+
+// Disabling wakes everything up
+void lv_power_enable(bool enable);
+bool lv_power_enabled(void);
+
+// From the touch interrupt: wake up at the next lv_power_poll
+void lv_power_wake_from_isr(void);
+
+// Move between states, call with the LVGL lock held next to lv_timer_handler.
+// Never waits for the panel, lv_power_next_ms tells when to poll again
+void lv_power_poll(void);
+
+// Milliseconds until the next transition, UINT32_MAX when none is due
+uint32_t lv_power_next_ms(void);
+
+// From the touch read: true while the sample belongs to the touch that woke
+// the screen, which LVGL is not given. Until its release
+bool lv_power_swallow_touch(bool pressed);
+
+lv_power_state_t lv_power_get_state(void);
+void lv_power_get_stats(lv_power_stats_t *stats);
+void lv_power_reset_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_POWER_H
@@ -1,13 +1,70 @@
-# modules/lvgl_driver/micropython.cmake
-add_library(usermod_lvgl_driver INTERFACE)
-
-target_sources(usermod_lvgl_driver INTERFACE
-    ${CMAKE_CURRENT_LIST_DIR}/lvgl_driver.c
-)
-
-target_include_directories(usermod_lvgl_driver INTERFACE
-    ${CMAKE_CURRENT_LIST_DIR}
-    ${CMAKE_CURRENT_LIST_DIR}/../../lib/lvgl
-)
-
+# modules/lvgl_driver/micropython.cmake
+add_library(usermod_lvgl_driver INTERFACE)
+
+target_sources(usermod_lvgl_driver INTERFACE
+    ${CMAKE_CURRENT_LIST_DIR}/LVGL_Driver.c
+    ${CMAKE_CURRENT_LIST_DIR}/lv_mem_pool.c
+    ${CMAKE_CURRENT_LIST_DIR}/lv_cache_budget.c
+    ${CMAKE_CURRENT_LIST_DIR}/lv_power.c
+    ${CMAKE_CURRENT_LIST_DIR}/lv_bench.c
+    ${CMAKE_CURRENT_LIST_DIR}/lv_latency.c
+)
+
+target_include_directories(usermod_lvgl_driver INTERFACE
+    ${CMAKE_CURRENT_LIST_DIR}
+    ${CMAKE_CURRENT_LIST_DIR}/../../lib/lvgl
+)
+
+# Color depth LVGL renders with (8: RGB332, 16: RGB565, 32: ARGB8888)
+set(LVGL_DRIVER_COLOR_DEPTH 16 CACHE STRING "LVGL color depth")
+
+# Render the whole frame into one buffer instead of two 1/10 screen bands.
+# Pair it with LVGL_DRIVER_COLOR_DEPTH 8 and a palette set with LCD_setPalette:
+# at 16 the panel reads the buffer itself and each frame waits for its transfer
+option(LVGL_DRIVER_FULL_FRAME "Single full-frame draw buffer" OFF)
+
+# LVGL allocations from size class pools (lv_mem_pool.c) instead of the
+# fixed LV_MEM_SIZE heap, large blocks optionally in PSRAM
+option(LVGL_DRIVER_MEM_POOL "Size class pool allocator for LVGL" OFF)
+option(LVGL_DRIVER_MEM_POOL_PSRAM "Large LVGL blocks in PSRAM" OFF)
+
+# LVGL blend/fill kernels (LV_ATTRIBUTE_FAST_MEM) and the flush callback in
+# IRAM
+option(LVGL_DRIVER_IRAM "Hot LVGL paths in IRAM" OFF)
+
+if(LVGL_DRIVER_FULL_FRAME)
+    set(LVGL_DRIVER_FULL_FRAME_VALUE 1)
+else()
+    set(LVGL_DRIVER_FULL_FRAME_VALUE 0)
+endif()
+
+if(LVGL_DRIVER_MEM_POOL)
+    set(LVGL_DRIVER_MEM_POOL_VALUE 1)
+else()
+    set(LVGL_DRIVER_MEM_POOL_VALUE 0)
+endif()
+
+if(LVGL_DRIVER_MEM_POOL_PSRAM)
+    set(LVGL_DRIVER_MEM_POOL_PSRAM_VALUE 1)
+else()
+    set(LVGL_DRIVER_MEM_POOL_PSRAM_VALUE 0)
+endif()
+
+if(LVGL_DRIVER_IRAM)
+    set(LVGL_DRIVER_IRAM_VALUE 1)
+else()
+    set(LVGL_DRIVER_IRAM_VALUE 0)
+endif()
+
+target_compile_definitions(usermod_lvgl_driver INTERFACE
+    LV_COLOR_DEPTH=${LVGL_DRIVER_COLOR_DEPTH}
+    LVGL_DRIVER_FULL_FRAME=${LVGL_DRIVER_FULL_FRAME_VALUE}
+    LVGL_DRIVER_MEM_POOL=${LVGL_DRIVER_MEM_POOL_VALUE}
+    LV_MEM_POOL_PSRAM=${LVGL_DRIVER_MEM_POOL_PSRAM_VALUE}
+    LVGL_DRIVER_IRAM=${LVGL_DRIVER_IRAM_VALUE}
+)
+
+# Image cache lookups counted by lv_cache_budget.c
+target_link_options(usermod_lvgl_driver INTERFACE -Wl,--wrap=_lv_img_cache_open)
+
 target_link_libraries(usermod INTERFACE usermod_lvgl_driver)
\ No newline at end of file
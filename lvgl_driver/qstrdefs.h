@@ -1,8 +1,109 @@
-// modules/lvgl_driver/qstrdefs.h
-Q(lvgl_driver)
-Q(init)
-Q(loop)
-Q(print)
-Q(deinit)
-Q(TICK_PERIOD_MS)
-Q(BUFFER_SIZE)
\ No newline at end of file
+// modules/lvgl_driver/qstrdefs.h
+Q(lvgl_driver)
+Q(init)
+Q(loop)
+Q(print)
+Q(deinit)
+Q(BUFFER_SIZE)
+Q(scroll)
+Q(COLOR_DEPTH)
+Q(mem_info)
+Q(BUFFER_COUNT)
+Q(color_depth)
+Q(draw_buf_count)
+Q(draw_buf_bytes)
+Q(frame_bytes)
+Q(lv_mem_total)
+Q(lv_mem_free)
+Q(lv_mem_max_used)
+Q(heap_internal_free)
+Q(heap_psram_free)
+Q(mem_stats)
+Q(used)
+Q(peak)
+Q(fragmentation)
+Q(heap_fragmentation)
+Q(failed)
+Q(large_blocks)
+Q(large_bytes)
+Q(large_peak)
+Q(classes)
+Q(autotune)
+Q(iram_info)
+Q(text_bytes)
+Q(fast_mem)
+Q(cache_budget)
+Q(cache_stats)
+Q(budget)
+Q(img_budget)
+Q(grad_budget)
+Q(img_entries)
+Q(img_bytes)
+Q(hits)
+Q(misses)
+Q(evictions)
+Q(shadow_bytes)
+Q(wait)
+Q(start_task)
+Q(stop_task)
+Q(lock)
+Q(unlock)
+Q(Lock)
+Q(__enter__)
+Q(__exit__)
+Q(post_touch)
+Q(post_invalidate)
+Q(start_pipeline)
+Q(stop_pipeline)
+Q(pipeline_stats)
+Q(running)
+Q(bands)
+Q(transfer_us)
+Q(max_depth)
+Q(power_config)
+Q(power_enable)
+Q(power_state)
+Q(power_stats)
+Q(active_ms)
+Q(dim_ms)
+Q(off_ms)
+Q(sleep_ms)
+Q(wakes)
+Q(last_wake_us)
+Q(max_wake_us)
+Q(enabled)
+Q(POWER_ACTIVE)
+Q(POWER_DIM)
+Q(POWER_OFF)
+Q(POWER_SLEEP)
+Q(bench)
+Q(config)
+Q(scenes)
+Q(pipeline)
+Q(hor_res)
+Q(ver_res)
+Q(frames)
+Q(drawn)
+Q(fps)
+Q(px_per_frame)
+Q(bytes_per_frame)
+Q(update_us)
+Q(render_us)
+Q(flush_us)
+Q(wait_us)
+Q(max_frame_us)
+Q(mem_peak)
+Q(mem_scene)
+Q(heap_min_free)
+Q(latency_enable)
+Q(latency_stats)
+Q(count)
+Q(dropped)
+Q(min_us)
+Q(mean_us)
+Q(max_us)
+Q(p50_us)
+Q(p90_us)
+Q(p99_us)
+Q(p999_us)
+Q(histogram)
\ No newline at end of file
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Compare lvgl_driver.bench reports, for tracking the frame rate over time
+
+Usage:
+    python3 bench_compare.py report.json
+    python3 bench_compare.py baseline.json report.json
+    python3 bench_compare.py --threshold 10 baseline.json report.json
+
+On the board:
+    import json, lvgl_driver
+    with open("report.json", "w") as f:
+        json.dump(lvgl_driver.bench(), f)
+
+One report prints a table of the scenes. With two, every figure of the
+second is shown next to the baseline, and a figure that got worse by more
+than the threshold (percent, default 5) is a regression.
+Exit status 0 without regressions, 1 with regressions, 2 on bad input.
+"""
+
+import argparse
+import json
+import sys
+
+# Figure, column title, True when higher is better
+FIGURES = [
+    ("fps", "fps", True),
+    ("bytes_per_frame", "bytes/frame", False),
+    ("update_us", "update us", False),
+    ("render_us", "render us", False),
+    ("flush_us", "flush us", False),
+    ("transfer_us", "transfer us", False),
+    ("max_frame_us", "max frame us", False),
+    ("mem_scene", "mem scene", False),
+]
+
+# Differences below these are noise, whatever the percentage
+NOISE = {"update_us": 20, "render_us": 50, "flush_us": 50, "transfer_us": 50, "max_frame_us": 200, "mem_scene": 64}
+
+
+def read_report(path):
+    with open(path) as f:
+        report = json.load(f)
+    if not isinstance(report, dict) or "scenes" not in report:
+        raise ValueError("%s: not a bench() report" % path)
+    return report
+
+
+def config_line(report):
+    c = report.get("config", {})
+    return "%sx%s, %s bit, %s byte draw buffers, pipeline %s, %s frames" % (
+        c.get("hor_res"), c.get("ver_res"), c.get("color_depth"), c.get("draw_buf_bytes"),
+        "on" if c.get("pipeline") else "off", c.get("frames"))
+
+
+def print_table(report):
+    print(config_line(report))
+    print("%-12s" % "scene" + "".join("%14s" % title for _, title, _ in FIGURES))
+    for name, scene in report["scenes"].items():
+        if scene is None:
+            print("%-12s  failed" % name)
+            continue
+        print("%-12s" % name + "".join("%14s" % _fmt(scene.get(key)) for key, _, _ in FIGURES))
+
+
+def _fmt(value):
+    if isinstance(value, float):
+        return "%.1f" % value
+    return "-" if value is None else str(value)
+
+
+def compare(baseline, report, threshold):
+    """Print the differences, return the number of regressions"""
+    if baseline.get("config") != report.get("config"):
+        print("configurations differ:")
+        print("  baseline: " + config_line(baseline))
+        print("  report:   " + config_line(report))
+    regressions = 0
+    for name, scene in report["scenes"].items():
+        base = baseline["scenes"].get(name)
+        if scene is None or base is None:
+            print("%s: %s" % (name, "failed" if scene is None else "not in the baseline"))
+            continue
+        print(name)
+        for key, title, higher_better in FIGURES:
+            old, new = base.get(key), scene.get(key)
+            if old is None or new is None:
+                continue
+            change = 100.0 * (new - old) / old if old else (0.0 if new == old else float("inf"))
+            worse = -change if higher_better else change
+            flag = ""
+            if worse > threshold and abs(new - old) > NOISE.get(key, 0):
+                flag = "  REGRESSION"
+                regressions += 1
+            print("  %-14s %12s -> %-12s %+7.1f%%%s" % (title, _fmt(old), _fmt(new), change, flag))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare lvgl_driver.bench reports")
+    parser.add_argument("baseline", help="baseline report, or the only report to print")
+    parser.add_argument("report", nargs="?")
+    parser.add_argument("--threshold", type=float, default=5.0, help="percent a figure may get worse")
+    args = parser.parse_args()
+
+    try:
+        baseline = read_report(args.baseline)
+        report = read_report(args.report) if args.report else None
+    except (OSError, ValueError) as e:
+        print(e, file=sys.stderr)
+        return 2
+
+    if report is None:
+        print_table(baseline)
+        return 0
+    regressions = compare(baseline, report, args.threshold)
+    print("%d regression%s" % (regressions, "" if regressions == 1 else "s"))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -11,6 +11,7 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_check.h"
+#include "esp_heap_caps.h"
 #include "esp_lcd_panel_interface.h"
 #include "esp_lcd_panel_io.h"
 #include "esp_lcd_panel_vendor.h"
@@ -19,6 +20,7 @@
 #include "esp_log.h"
 
 #include "esp_lcd_spd2010.h"
+#include "bus_trace_ring.h"
 
 #define LCD_OPCODE_WRITE_CMD        (0x02ULL)
 #define LCD_OPCODE_READ_CMD         (0x0BULL)
@@ -29,6 +31,10 @@
 #define SPD2010_CMD_SET_BYTE1       (0x10)
 #define SPD2010_CMD_SET_USER        (0x00)
 
+#define SPD2010_FILL_BUF_PIXELS     (412)   // one line of the 412x412 panel
+#define SPD2010_SLPIN_DELAY_MS      (5)
+#define SPD2010_SLPOUT_DELAY_MS     ESP_LCD_SPD2010_SLPOUT_DELAY_MS
+
 static const char *TAG = "spd2010";
 
 static esp_err_t panel_spd2010_del(esp_lcd_panel_t *panel);
@@ -52,6 +58,10 @@ typedef struct {
     uint8_t colmod_val; // save current value of LCD_CMD_COLMOD register
     const spd2010_lcd_init_cmd_t *init_cmds;
     uint16_t init_cmds_size;
+    uint8_t *fill_buf;  // DMA buffer repeated by fill_rect, allocated on first use
+    esp_lcd_spd2010_tx_cb_t tx_cb;  // transfer observer, NULL when none
+    void *tx_cb_ctx;
+    uint32_t color_queued;  // color transfers queued since the panel was created
     struct {
         unsigned int use_qspi_interface: 1;
         unsigned int reset_level: 1;
@@ -151,7 +161,13 @@ static esp_err_t tx_param(spd2010_panel_t *spd2010, esp_lcd_panel_io_handle_t io
         lcd_cmd <<= 8;
         lcd_cmd |= LCD_OPCODE_WRITE_CMD << 24;
     }
-    return esp_lcd_panel_io_tx_param(io, lcd_cmd, param, param_size);
+    if (spd2010->tx_cb) {
+        spd2010->tx_cb(spd2010->tx_cb_ctx, lcd_cmd, false, param, param_size);
+    }
+    uint32_t start = BUS_TRACE_NOW();
+    esp_err_t ret = esp_lcd_panel_io_tx_param(io, lcd_cmd, param, param_size);
+    BUS_TRACE_PARAM(lcd_cmd, param_size, start);
+    return ret;
 }
 
 static esp_err_t tx_color(spd2010_panel_t *spd2010, esp_lcd_panel_io_handle_t io, int lcd_cmd, const void *param, size_t param_size)
@@ -161,7 +177,51 @@ static esp_err_t tx_color(spd2010_panel_t *spd2010, esp_lcd_panel_io_handle_t io
         lcd_cmd <<= 8;
         lcd_cmd |= LCD_OPCODE_WRITE_COLOR << 24;
     }
-    return esp_lcd_panel_io_tx_color(io, lcd_cmd, param, param_size);
+    if (spd2010->tx_cb) {
+        spd2010->tx_cb(spd2010->tx_cb_ctx, lcd_cmd, true, param, param_size);
+    }
+    // Before queueing, the transfer may be done before tx_color returns
+    BUS_TRACE_COLOR_BEGIN(lcd_cmd, param_size);
+    esp_err_t ret = esp_lcd_panel_io_tx_color(io, lcd_cmd, param, param_size);
+    if (ret != ESP_OK) {
+        BUS_TRACE_COLOR_FAILED();
+    } else {
+        spd2010->color_queued++;
+    }
+    return ret;
+}
+
+static esp_err_t set_window(spd2010_panel_t *spd2010, esp_lcd_panel_io_handle_t io, int x_start, int y_start, int x_end, int y_end)
+{
+    x_start += spd2010->x_gap;
+    x_end += spd2010->x_gap;
+    y_start += spd2010->y_gap;
+    y_end += spd2010->y_gap;
+
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_CASET, (uint8_t[]) {
+        (x_start >> 8) & 0xFF,
+        x_start & 0xFF,
+        ((x_end - 1) >> 8) & 0xFF,
+        (x_end - 1) & 0xFF,
+    }, 4), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_RASET, (uint8_t[]) {
+        (y_start >> 8) & 0xFF,
+        y_start & 0xFF,
+        ((y_end - 1) >> 8) & 0xFF,
+        (y_end - 1) & 0xFF,
+    }, 4), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+static esp_err_t rx_param(spd2010_panel_t *spd2010, esp_lcd_panel_io_handle_t io, int lcd_cmd, void *param, size_t param_size)
+{
+    if (spd2010->flags.use_qspi_interface) {
+        lcd_cmd &= 0xff;
+        lcd_cmd <<= 8;
+        lcd_cmd |= LCD_OPCODE_READ_CMD << 24;
+    }
+    return esp_lcd_panel_io_rx_param(io, lcd_cmd, param, param_size);
 }
 
 static esp_err_t panel_spd2010_del(esp_lcd_panel_t *panel)
@@ -172,6 +232,7 @@ static esp_err_t panel_spd2010_del(esp_lcd_panel_t *panel)
         gpio_reset_pin(spd2010->reset_gpio_num);
     }
     ESP_LOGD(TAG, "del spd2010 panel @%p", spd2010);
+    free(spd2010->fill_buf);
     free(spd2010);
     return ESP_OK;
 }
@@ -764,3 +825,214 @@ static esp_err_t panel_spd2010_disp_on_off(esp_lcd_panel_t *panel, bool on_off)
     ESP_RETURN_ON_ERROR(tx_param(spd2010, io, command, NULL, 0), TAG, "send command failed");
     return ESP_OK;
 }
+
+
+esp_err_t esp_lcd_spd2010_is_configured(esp_lcd_panel_handle_t panel, bool *configured)
+{
+    ESP_RETURN_ON_FALSE(panel && configured, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+    esp_lcd_panel_io_handle_t io = spd2010->io;
+    uint8_t power_mode = 0;
+    uint8_t colmod = 0;
+
+    *configured = false;
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, SPD2010_CMD_SET, (uint8_t[]) {
+        SPD2010_CMD_SET_BYTE0, SPD2010_CMD_SET_BYTE1, SPD2010_CMD_SET_USER
+    }, 3), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(rx_param(spd2010, io, LCD_CMD_RDDPM, &power_mode, 1), TAG, "read power mode failed");
+    ESP_RETURN_ON_ERROR(rx_param(spd2010, io, LCD_CMD_RDD_COLMOD, &colmod, 1), TAG, "read pixel format failed");
+
+    // A panel that lost power comes back in sleep mode (bit 4 cleared), the vendor sequence ends with SLPOUT
+    *configured = (power_mode & BIT(4)) && (colmod == spd2010->colmod_val);
+    ESP_LOGD(TAG, "power mode: 0x%02X, colmod: 0x%02X, configured: %d", power_mode, colmod, *configured);
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_resume(esp_lcd_panel_handle_t panel)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+    esp_lcd_panel_io_handle_t io = spd2010->io;
+
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, SPD2010_CMD_SET, (uint8_t[]) {
+        SPD2010_CMD_SET_BYTE0, SPD2010_CMD_SET_BYTE1, SPD2010_CMD_SET_USER
+    }, 3), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_MADCTL, (uint8_t[]) {
+        spd2010->madctl_val,
+    }, 1), TAG, "send command failed");
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_COLMOD, (uint8_t[]) {
+        spd2010->colmod_val,
+    }, 1), TAG, "send command failed");
+    ESP_LOGD(TAG, "resume without init commands");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_read_ram(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, void *data, size_t len)
+{
+    ESP_RETURN_ON_FALSE(panel && data && len, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE((x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "invalid window");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+    esp_lcd_panel_io_handle_t io = spd2010->io;
+
+    ESP_RETURN_ON_ERROR(set_window(spd2010, io, x_start, y_start, x_end, y_end), TAG, "set window failed");
+    ESP_RETURN_ON_ERROR(rx_param(spd2010, io, LCD_CMD_RAMRD, data, len), TAG, "read frame memory failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_fill_rect(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, uint16_t color)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE((x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "invalid window");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+    esp_lcd_panel_io_handle_t io = spd2010->io;
+    size_t bytes_per_pixel = spd2010->fb_bits_per_pixel / 8;
+    size_t buf_len = SPD2010_FILL_BUF_PIXELS * bytes_per_pixel;
+
+    if (!spd2010->fill_buf) {
+        spd2010->fill_buf = heap_caps_malloc(SPD2010_FILL_BUF_PIXELS * 3, MALLOC_CAP_DMA);
+        ESP_RETURN_ON_FALSE(spd2010->fill_buf, ESP_ERR_NO_MEM, TAG, "no mem for fill buffer");
+    }
+
+    // Sending a parameter waits for queued color transfers, so the fill buffer is free to be rewritten afterwards
+    ESP_RETURN_ON_ERROR(set_window(spd2010, io, x_start, y_start, x_end, y_end), TAG, "set window failed");
+
+    uint8_t *p = spd2010->fill_buf;
+    for (int i = 0; i < SPD2010_FILL_BUF_PIXELS; i++) {
+        if (bytes_per_pixel == 2) {
+            *p++ = color >> 8;
+            *p++ = color & 0xFF;
+        } else {
+            // RGB888/RGB666 use the high bits of each byte
+            *p++ = (color >> 8) & 0xF8;
+            *p++ = (color >> 3) & 0xFC;
+            *p++ = (color << 3) & 0xF8;
+        }
+    }
+
+    // The window address wraps to the next row by itself, so the same buffer covers every row:
+    // one transfer per panel line, or several rows of a narrower window
+    size_t remaining = (x_end - x_start) * (y_end - y_start) * bytes_per_pixel;
+    int lcd_cmd = LCD_CMD_RAMWR;
+    while (remaining > 0) {
+        size_t len = remaining < buf_len ? remaining : buf_len;
+        ESP_RETURN_ON_ERROR(tx_color(spd2010, io, lcd_cmd, spd2010->fill_buf, len), TAG, "send color failed");
+        remaining -= len;
+        lcd_cmd = LCD_CMD_RAMWRC;
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_set_scroll_area(esp_lcd_panel_handle_t panel, uint16_t top_fixed, uint16_t scroll_height, uint16_t bottom_fixed)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+    esp_lcd_panel_io_handle_t io = spd2010->io;
+
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_VSCRDEF, (uint8_t[]) {
+        (top_fixed >> 8) & 0xFF,
+        top_fixed & 0xFF,
+        (scroll_height >> 8) & 0xFF,
+        scroll_height & 0xFF,
+        (bottom_fixed >> 8) & 0xFF,
+        bottom_fixed & 0xFF,
+    }, 6), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_set_scroll_start(esp_lcd_panel_handle_t panel, uint16_t start_line)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+    esp_lcd_panel_io_handle_t io = spd2010->io;
+
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_VSCSAD, (uint8_t[]) {
+        (start_line >> 8) & 0xFF,
+        start_line & 0xFF,
+    }, 2), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_wait_idle(esp_lcd_panel_handle_t panel)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, spd2010->io, LCD_CMD_NOP, NULL, 0), TAG, "send command failed");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_sleep(esp_lcd_panel_handle_t panel, bool sleep)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+    esp_lcd_panel_io_handle_t io = spd2010->io;
+
+    // Frame memory and registers survive sleep-in, so waking up is SLPOUT + DISPON without the init sequence
+    if (sleep) {
+        ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_DISPOFF, NULL, 0), TAG, "send command failed");
+        ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_SLPIN, NULL, 0), TAG, "send command failed");
+        vTaskDelay(pdMS_TO_TICKS(SPD2010_SLPIN_DELAY_MS));
+    } else {
+        ESP_RETURN_ON_ERROR(esp_lcd_spd2010_sleep_out_start(panel), TAG, "sleep out failed");
+        vTaskDelay(pdMS_TO_TICKS(SPD2010_SLPOUT_DELAY_MS));
+        ESP_RETURN_ON_ERROR(tx_param(spd2010, io, LCD_CMD_DISPON, NULL, 0), TAG, "send command failed");
+    }
+    ESP_LOGD(TAG, "sleep %s", sleep ? "in" : "out");
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_sleep_out_start(esp_lcd_panel_handle_t panel)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+
+    ESP_RETURN_ON_ERROR(tx_param(spd2010, spd2010->io, LCD_CMD_SLPOUT, NULL, 0), TAG, "send command failed");
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_register_tx_callback(esp_lcd_panel_handle_t panel, esp_lcd_spd2010_tx_cb_t callback, void *user_ctx)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+
+    spd2010->tx_cb = NULL;
+    spd2010->tx_cb_ctx = user_ctx;
+    spd2010->tx_cb = callback;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_get_color_queued(esp_lcd_panel_handle_t panel, uint32_t *count)
+{
+    ESP_RETURN_ON_FALSE(panel && count, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+
+    *count = spd2010->color_queued;
+
+    return ESP_OK;
+}
+
+esp_err_t esp_lcd_spd2010_set_window(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end)
+{
+    ESP_RETURN_ON_FALSE(panel, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE((x_start < x_end) && (y_start < y_end), ESP_ERR_INVALID_ARG, TAG, "invalid window");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+
+    return set_window(spd2010, spd2010->io, x_start, y_start, x_end, y_end);
+}
+
+esp_err_t esp_lcd_spd2010_write_pixels(esp_lcd_panel_handle_t panel, const void *data, size_t len, bool first)
+{
+    ESP_RETURN_ON_FALSE(panel && data && len, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    spd2010_panel_t *spd2010 = __containerof(panel, spd2010_panel_t, base);
+
+    return tx_color(spd2010, spd2010->io, first ? LCD_CMD_RAMWR : LCD_CMD_RAMWRC, data, len);
+}
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 
 #include "esp_lcd_panel_vendor.h"
 
@@ -43,6 +44,20 @@ typedef struct {
     } flags;
 } spd2010_vendor_config_t;
 
+/**
+ * @brief Callback for every command and color transfer the panel driver queues
+ *
+ * @note  Called in the task that calls the driver, before the transfer is queued. `data` stays valid until
+ *        the transfer is done, but the callback should copy what it needs and return quickly.
+ *
+ * @param[in]  user_ctx User data given to `esp_lcd_spd2010_register_tx_callback()`
+ * @param[in]  lcd_cmd Command word as sent on the bus, for QSPI `opcode << 24 | command << 8`
+ * @param[in]  color true for pixel data (`tx_color`), false for command parameters (`tx_param`)
+ * @param[in]  data Parameters or pixel data, NULL when there is none
+ * @param[in]  len Size of `data` in bytes
+ */
+typedef void (*esp_lcd_spd2010_tx_cb_t)(void *user_ctx, uint32_t lcd_cmd, bool color, const void *data, size_t len);
+
 /**
  * @brief Create LCD panel for model SPD2010
  *
@@ -55,6 +70,197 @@ typedef struct {
  */
 esp_err_t esp_lcd_new_panel_spd2010(const esp_lcd_panel_io_handle_t io, const esp_lcd_panel_dev_config_t *panel_dev_config, esp_lcd_panel_handle_t *ret_panel);
 
+/**
+ * @brief Check whether the panel is still powered and configured by a previous initialization
+ *
+ * @note  The check reads back the pixel format and power mode registers (`LCD_OPCODE_READ_CMD` in QSPI mode), so the
+ *        panel IO must support receiving parameters.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[out] configured Set to true if the panel is out of sleep and its COLMOD matches the panel configuration
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_is_configured(esp_lcd_panel_handle_t panel, bool *configured);
+
+/**
+ * @brief Resume a panel that is still configured, skipping the vendor initialization sequence
+ *
+ * @note  Only MADCTL and COLMOD are reapplied. Call `esp_lcd_panel_disp_on_off()` afterwards to turn the display on.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_resume(esp_lcd_panel_handle_t panel);
+
+/**
+ * @brief Read back a window of the panel frame memory
+ *
+ * @note  The data is returned in the format used by the controller for RAMRD, which may differ from the write format.
+ *        This is intended for short link checks, keep `len` small.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  x_start Start column of the window
+ * @param[in]  y_start Start row of the window
+ * @param[in]  x_end End column of the window (exclusive)
+ * @param[in]  y_end End row of the window (exclusive)
+ * @param[out] data Buffer receiving the frame memory content
+ * @param[in]  len Number of bytes to read
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_read_ram(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, void *data, size_t len);
+
+/**
+ * @brief Set the frame memory window used by the following `esp_lcd_spd2010_write_pixels()` calls
+ *
+ * @note  Waits for the queued color transfers to finish, like any other command.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  x_start Start column of the window
+ * @param[in]  y_start Start row of the window
+ * @param[in]  x_end End column of the window (exclusive)
+ * @param[in]  y_end End row of the window (exclusive)
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_set_window(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end);
+
+/**
+ * @brief Queue pixels, already in the panel pixel format, to the current window
+ *
+ * @note  The transfer is queued, `data` must stay valid until the color transfer done callback of the panel IO fires.
+ *        Each call triggers exactly one callback as long as `len` does not exceed the bus `max_transfer_sz`.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  data Pixel data
+ * @param[in]  len Number of bytes
+ * @param[in]  first True for the first chunk of a window (RAMWR), false to continue the previous one (RAMWRC)
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_write_pixels(esp_lcd_panel_handle_t panel, const void *data, size_t len, bool first);
+
+/**
+ * @brief Fill a window of the panel with a solid color
+ *
+ * @note  The pixels are streamed from a small DMA buffer owned by the panel (`SPD2010_FILL_BUF_PIXELS` pixels) which is
+ *        sent repeatedly with RAMWR/RAMWRC, so no full size pixel buffer is needed.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  x_start Start column of the window
+ * @param[in]  y_start Start row of the window
+ * @param[in]  x_end End column of the window (exclusive)
+ * @param[in]  y_end End row of the window (exclusive)
+ * @param[in]  color RGB565 color, expanded to the panel pixel format
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_fill_rect(esp_lcd_panel_handle_t panel, int x_start, int y_start, int x_end, int y_end, uint16_t color);
+
+/**
+ * @brief Define the vertical scroll area (VSCRDEF)
+ *
+ * @note  `top_fixed + scroll_height + bottom_fixed` must match the number of panel lines.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  top_fixed Number of fixed lines at the top of the panel
+ * @param[in]  scroll_height Number of lines in the scrolling area
+ * @param[in]  bottom_fixed Number of fixed lines at the bottom of the panel
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_set_scroll_area(esp_lcd_panel_handle_t panel, uint16_t top_fixed, uint16_t scroll_height, uint16_t bottom_fixed);
+
+/**
+ * @brief Set the frame memory line shown at the top of the scroll area (VSCSAD)
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  start_line Frame memory line, between `top_fixed` and `top_fixed + scroll_height - 1`
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_set_scroll_start(esp_lcd_panel_handle_t panel, uint16_t start_line);
+
+/**
+ * @brief Wait until all queued color transfers are done
+ *
+ * @note  A NOP command is sent, which blocks until the transfers queued before it are finished.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_wait_idle(esp_lcd_panel_handle_t panel);
+
+/**
+ * @brief Enter or leave panel sleep mode
+ *
+ * @note  Sleep-in turns the display off first, frame memory is kept. Leaving sleep waits for the
+ *        oscillator to settle and turns the display back on, no redraw is needed.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  sleep true to enter sleep mode, false to leave it
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_sleep(esp_lcd_panel_handle_t panel, bool sleep);
+
+/**
+ * @brief Time the panel needs after SLPOUT before it takes commands again
+ *
+ */
+#define ESP_LCD_SPD2010_SLPOUT_DELAY_MS (120)
+
+/**
+ * @brief Start leaving sleep mode without waiting
+ *
+ * @note  Sends SLPOUT only. Once `ESP_LCD_SPD2010_SLPOUT_DELAY_MS` has passed, `esp_lcd_panel_disp_on_off()`
+ *        turns the display back on. `esp_lcd_spd2010_sleep()` does both and waits in between.
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_sleep_out_start(esp_lcd_panel_handle_t panel);
+
+/**
+ * @brief Observe the transfers of a panel, e.g. to trace the bus or to keep a copy of the frame memory
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[in]  callback Called for every command and color transfer, NULL to stop
+ * @param[in]  user_ctx User data passed to the callback
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_register_tx_callback(esp_lcd_panel_handle_t panel, esp_lcd_spd2010_tx_cb_t callback, void *user_ctx);
+
+/**
+ * @brief Number of color transfers queued to the panel IO since the panel was created
+ *
+ * Compared with the `on_color_trans_done` calls of the panel IO, it tells when all pixels sent so far are out
+ *
+ * @param[in]  panel LCD panel handle returned by `esp_lcd_new_panel_spd2010()`
+ * @param[out] count Transfers queued, wraps around
+ * @return
+ *      - ESP_OK: Success
+ *      - Otherwise: Fail
+ */
+esp_err_t esp_lcd_spd2010_get_color_queued(esp_lcd_panel_handle_t panel, uint32_t *count);
+
 /**
  * @brief LCD panel bus configuration structure
  *
@@ -1,24 +1,37 @@
-# modules/spd2010_display/micropython.cmake
-add_library(usermod_spd2010_display INTERFACE)
-
-# Incluir los archivos fuente (el principal y el driver)
-target_sources(usermod_spd2010_display INTERFACE
-    ${CMAKE_CURRENT_LIST_DIR}/spd2010_display.c
-    ${CMAKE_CURRENT_LIST_DIR}/drivers/esp_lcd_spd2010.c
-)
-
-# Incluir directorios para los encabezados
-target_include_directories(usermod_spd2010_display INTERFACE
-    ${CMAKE_CURRENT_LIST_DIR}
-    ${CMAKE_CURRENT_LIST_DIR}/drivers
-)
-
-# Definiciones para el driver LCD
-target_compile_definitions(usermod_spd2010_display INTERFACE
-    ESP_LCD_SPD2010_VER_MAJOR=1
-    ESP_LCD_SPD2010_VER_MINOR=0
-    ESP_LCD_SPD2010_VER_PATCH=0
-)
-
-# Vinculación al módulo de usuario
+# modules/spd2010_display/micropython.cmake
+add_library(usermod_spd2010_display INTERFACE)
+
+# Incluir los archivos fuente (el principal y el driver)
+target_sources(usermod_spd2010_display INTERFACE
+    ${CMAKE_CURRENT_LIST_DIR}/spd2010_display.c
+    ${CMAKE_CURRENT_LIST_DIR}/spd2010_pixels.c
+    ${CMAKE_CURRENT_LIST_DIR}/spd2010_shadow.c
+    ${CMAKE_CURRENT_LIST_DIR}/drivers/esp_lcd_spd2010.c
+)
+
+# Incluir directorios para los encabezados
+target_include_directories(usermod_spd2010_display INTERFACE
+    ${CMAKE_CURRENT_LIST_DIR}
+    ${CMAKE_CURRENT_LIST_DIR}/drivers
+    ${CMAKE_CURRENT_LIST_DIR}/../bus_trace
+)
+
+# Rutas críticas de píxeles (swap, conversión, RLE, CABC) en IRAM
+option(SPD2010_DISPLAY_IRAM "Hot pixel paths in IRAM" OFF)
+
+if(SPD2010_DISPLAY_IRAM)
+    set(SPD2010_DISPLAY_IRAM_VALUE 1)
+else()
+    set(SPD2010_DISPLAY_IRAM_VALUE 0)
+endif()
+
+# Definiciones para el driver LCD
+target_compile_definitions(usermod_spd2010_display INTERFACE
+    ESP_LCD_SPD2010_VER_MAJOR=1
+    ESP_LCD_SPD2010_VER_MINOR=0
+    ESP_LCD_SPD2010_VER_PATCH=0
+    SPD2010_DISPLAY_IRAM=${SPD2010_DISPLAY_IRAM_VALUE}
+)
+
+# Vinculación al módulo de usuario
 target_link_libraries(usermod INTERFACE usermod_spd2010_display)
\ No newline at end of file
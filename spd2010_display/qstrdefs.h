@@ -1,14 +1,78 @@
-// modules/spd2010_display/qstrdefs.h
-Q(spd2010_display)
-Q(LCD_WIDTH)
-Q(LCD_HEIGHT)
-Q(LCD_COLOR_BITS)
-Q(LCD_Backlight_PIN)
-Q(Backlight_MAX)
-Q(SPD2010_Reset)
-Q(QSPI_Init)
-Q(SPD2010_Init)
-Q(LCD_addWindow)
-Q(Backlight_Init)
-Q(Set_Backlight)
-Q(LCD_Init)
\ No newline at end of file
+// modules/spd2010_display/qstrdefs.h
+Q(spd2010_display)
+Q(LCD_WIDTH)
+Q(LCD_HEIGHT)
+Q(LCD_COLOR_BITS)
+Q(LCD_Backlight_PIN)
+Q(Backlight_MAX)
+Q(SPD2010_Reset)
+Q(QSPI_Init)
+Q(SPD2010_Init)
+Q(LCD_addWindow)
+Q(Backlight_Init)
+Q(Set_Backlight)
+Q(LCD_Init)
+Q(LCD_Deinit)
+Q(Display)
+Q(init)
+Q(deinit)
+Q(initialized)
+Q(add_window)
+Q(pclk)
+Q(calibrate_clock)
+Q(LCD_SPI_CLK_HZ)
+Q(fill_rect)
+Q(LCD_fillRect)
+Q(scroll_area)
+Q(scroll)
+Q(LCD_scrollArea)
+Q(LCD_scroll)
+Q(color_format)
+Q(LCD_colorFormat)
+Q(FORMAT_RGB332)
+Q(FORMAT_RGB565)
+Q(FORMAT_ARGB8888)
+Q(palette)
+Q(LCD_setPalette)
+Q(blit_rle)
+Q(LCD_blitRLE)
+Q(LCD_waitIdle)
+Q(Fade_Backlight)
+Q(Get_Backlight)
+Q(backlight)
+Q(fade_to)
+Q(LCD_sleep)
+Q(sleep)
+Q(LCD_cabc)
+Q(LCD_cabcStats)
+Q(cabc)
+Q(enabled)
+Q(gain)
+Q(backlight_scale)
+Q(saving_pct)
+Q(frames)
+Q(changes)
+Q(cpu_us)
+Q(max_cpu_us)
+Q(LCD_shadow)
+Q(LCD_snapshot)
+Q(LCD_shadowStats)
+Q(snapshot)
+Q(crc)
+Q(commands)
+Q(color_transfers)
+Q(param_bytes)
+Q(color_bytes)
+Q(ignored)
+Q(Surface)
+Q(blit)
+Q(busy)
+Q(wait)
+Q(fill)
+Q(__del__)
+Q(LCD_addWindowAsync)
+Q(add_window_async)
+Q(Flush)
+Q(done)
+Q(set)
+Q(__init__)
\ No newline at end of file
@@ -1,335 +1,2037 @@
-/*
- * SPD2010 Display Driver implementation for MicroPython
- * Adapted from Display_SPD2010.cpp/.h from Arduino implementation
- */
-
- 
-#include "esp_lcd_spd2010.h"
-// #include "drivers/esp_lcd_spd2010.h"
-
-
- #include "py/obj.h"
- #include "py/runtime.h"
- #include "py/mphal.h"
- #include "driver/gpio.h"
- #include "driver/spi_master.h"
- #include "esp_lcd_panel_io.h"
- #include "esp_lcd_panel_ops.h"
- #include "esp_log.h"
- 
- // Display definitions
- #define EXAMPLE_LCD_WIDTH           412
- #define EXAMPLE_LCD_HEIGHT          412
- #define EXAMPLE_LCD_COLOR_BITS      16
- 
- // SPI configuration
- #define ESP_PANEL_LCD_SPI_MODE      3
- #define ESP_PANEL_LCD_SPI_CLK_HZ    (40 * 1000 * 1000)
- #define ESP_PANEL_LCD_SPI_CS        21
- #define ESP_PANEL_LCD_SPI_TE        18
- #define ESP_PANEL_LCD_SPI_IO_SCK    40
- #define ESP_PANEL_LCD_SPI_IO_DATA0  46
- #define ESP_PANEL_LCD_SPI_IO_DATA1  45
- #define ESP_PANEL_LCD_SPI_IO_DATA2  42
- #define ESP_PANEL_LCD_SPI_IO_DATA3  41
- 
- // For PWM Backlight
- #define LCD_Backlight_PIN           5
- #define Backlight_MAX               100
- #define PWM_FREQ                    20000
- #define PWM_RESOLUTION              10
- 
- // Global variables
- static esp_lcd_panel_handle_t panel_handle = NULL;
- static uint8_t LCD_Backlight = 60;
- static ledc_channel_config_t ledc_channel;
- static bool display_initialized = false;
- 
- // External function references
- extern mp_obj_t tca9554_set_exio(mp_obj_t pin_obj, mp_obj_t state_obj);
- 
- // Reset the SPD2010 display
- STATIC mp_obj_t spd2010_display_reset(void) {
-     // Reset using TCA9554 pin 2
-     mp_obj_t args[] = {
-         mp_obj_new_int(2), // EXIO_PIN2
-         mp_obj_new_int(0)  // Low
-     };
-     tca9554_set_exio(args[0], args[1]);
-     mp_hal_delay_ms(50);
-     
-     args[1] = mp_obj_new_int(1); // High
-     tca9554_set_exio(args[0], args[1]);
-     mp_hal_delay_ms(50);
-     
-     return mp_const_none;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_display_reset_obj, spd2010_display_reset);
- 
- // QSPI initialization for LCD
- STATIC mp_obj_t spd2010_qspi_init(void) {
-     spi_bus_config_t bus_config = {
-         .data0_io_num = ESP_PANEL_LCD_SPI_IO_DATA0,
-         .data1_io_num = ESP_PANEL_LCD_SPI_IO_DATA1,
-         .sclk_io_num = ESP_PANEL_LCD_SPI_IO_SCK,
-         .data2_io_num = ESP_PANEL_LCD_SPI_IO_DATA2,
-         .data3_io_num = ESP_PANEL_LCD_SPI_IO_DATA3,
-         .data4_io_num = -1,
-         .data5_io_num = -1,
-         .data6_io_num = -1,
-         .data7_io_num = -1,
-         .max_transfer_sz = 65535,
-         .flags = SPICOMMON_BUSFLAG_MASTER,
-         .intr_flags = 0,
-     };
-     
-     if (spi_bus_initialize(SPI2_HOST, &bus_config, SPI_DMA_CH_AUTO) != ESP_OK) {
-         printf("The SPI initialization failed.\r\n");
-         return mp_obj_new_bool(false);
-     }
-     
-     printf("The SPI initialization succeeded.\r\n");
-     return mp_obj_new_bool(true);
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_qspi_init_obj, spd2010_qspi_init);
- 
- // SPD2010 display initialization
- STATIC mp_obj_t spd2010_display_init(void) {
-     // Reset display
-     spd2010_display_reset();
-     
-     // Set TE pin as output
-     gpio_config_t io_conf = {
-         .mode = GPIO_MODE_OUTPUT,
-         .pin_bit_mask = (1ULL << ESP_PANEL_LCD_SPI_TE),
-         .pull_down_en = 0,
-         .pull_up_en = 0,
-         .intr_type = GPIO_INTR_DISABLE,
-     };
-     gpio_config(&io_conf);
-     
-     // Initialize QSPI
-     mp_obj_t qspi_result = spd2010_qspi_init();
-     if (!mp_obj_is_true(qspi_result)) {
-         printf("SPD2010 Failed to be initialized\r\n");
-         return mp_obj_new_bool(false);
-     }
-     
-     // Configure LCD panel IO over SPI
-     esp_lcd_panel_io_spi_config_t io_config = {
-         .cs_gpio_num = ESP_PANEL_LCD_SPI_CS,
-         .dc_gpio_num = -1,
-         .spi_mode = ESP_PANEL_LCD_SPI_MODE,
-         .pclk_hz = ESP_PANEL_LCD_SPI_CLK_HZ,
-         .trans_queue_depth = 10,
-         .on_color_trans_done = NULL,
-         .user_ctx = NULL,
-         .lcd_cmd_bits = 32,
-         .lcd_param_bits = 8,
-         .flags = {
-             .dc_low_on_data = 0,
-             .octal_mode = 0,
-             .quad_mode = 1,
-             .sio_mode = 0,
-             .lsb_first = 0,
-             .cs_high_active = 0,
-         },
-     };
-     
-     esp_lcd_panel_io_handle_t io_handle = NULL;
-     if (esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)SPI2_HOST, &io_config, &io_handle) != ESP_OK) {
-         printf("Failed to set LCD communication parameters -- SPI\r\n");
-         return mp_obj_new_bool(false);
-     } else {
-         printf("LCD communication parameters are set successfully -- SPI\r\n");
-     }
-     
-     // Configurar el panel SPD2010
-    printf("Install LCD driver of spd2010\r\n");
-    spd2010_vendor_config_t vendor_config = {
-        .flags = {
-            .use_qspi_interface = 1,
-        },
-    };
-    
-    esp_lcd_panel_dev_config_t panel_config = {
-        .reset_gpio_num = -1,  // Ya hicimos el reset con el TCA9554
-        .rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB,
-        .data_endian = LCD_RGB_DATA_ENDIAN_BIG,
-        .bits_per_pixel = EXAMPLE_LCD_COLOR_BITS,
-        .vendor_config = (void *)&vendor_config,
-    };
-    
-    ESP_LOGI("SPD2010", "Initializing panel driver");
-    esp_lcd_new_panel_spd2010(io_handle, &panel_config, &panel_handle);
-    
-    // Inicializar el panel
-    esp_lcd_panel_reset(panel_handle);
-    esp_lcd_panel_init(panel_handle);
-    esp_lcd_panel_disp_on_off(panel_handle, true);
-    
-    printf("spd2010 LCD OK\r\n");
-    display_initialized = true;
-    return mp_obj_new_bool(true);
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_display_init_obj, spd2010_display_init);
- 
- // Add a window to the LCD (draw bitmap)
- STATIC mp_obj_t spd2010_display_add_window(mp_obj_t x_start_obj, mp_obj_t y_start_obj, mp_obj_t x_end_obj, mp_obj_t y_end_obj, mp_obj_t color_obj) {
-     if (!display_initialized) {
-         printf("Display not initialized\r\n");
-         return mp_const_none;
-     }
-     
-     int x_start = mp_obj_get_int(x_start_obj);
-     int y_start = mp_obj_get_int(y_start_obj);
-     int x_end = mp_obj_get_int(x_end_obj);
-     int y_end = mp_obj_get_int(y_end_obj);
-     
-     // Get buffer info
-     mp_buffer_info_t color_info;
-     mp_get_buffer_raise(color_obj, &color_info, MP_BUFFER_READ);
-     
-     // Calculate size
-     uint32_t size = (x_end - x_start + 1) * (y_end - y_start + 1);
-     uint16_t *color = (uint16_t *)color_info.buf;
-     
-     // Swap bytes for each color value (endian conversion)
-     for (size_t i = 0; i < size; i++) {
-         color[i] = (((color[i] >> 8) & 0xFF) | ((color[i] << 8) & 0xFF00));
-     }
-     
-     // Adjust end points for esp_lcd_panel_draw_bitmap
-     x_end += 1;
-     y_end += 1;
-     
-     // Clip to screen bounds
-     if (x_end > EXAMPLE_LCD_WIDTH)
-         x_end = EXAMPLE_LCD_WIDTH;
-     if (y_end > EXAMPLE_LCD_HEIGHT)
-         y_end = EXAMPLE_LCD_HEIGHT;
-     
-     // Draw to the panel if initialized
-     if (panel_handle != NULL) {
-         esp_lcd_panel_draw_bitmap(panel_handle, x_start, y_start, x_end, y_end, color);
-     }
-     
-     return mp_const_none;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_5(spd2010_display_add_window_obj, spd2010_display_add_window);
- 
- // Initialize backlight control
- STATIC mp_obj_t spd2010_backlight_init(void) {
-     // Initialize LEDC for PWM control of backlight
-     ledc_timer_config_t ledc_timer = {
-         .duty_resolution = LEDC_TIMER_10_BIT,
-         .freq_hz = PWM_FREQ,
-         .speed_mode = LEDC_HIGH_SPEED_MODE,
-         .timer_num = LEDC_TIMER_0,
-         .clk_cfg = LEDC_AUTO_CLK,
-     };
-     ledc_timer_config(&ledc_timer);
-     
-     ledc_channel.channel = LEDC_CHANNEL_0;
-     ledc_channel.duty = 0;
-     ledc_channel.gpio_num = LCD_Backlight_PIN;
-     ledc_channel.speed_mode = LEDC_HIGH_SPEED_MODE;
-     ledc_channel.hpoint = 0;
-     ledc_channel.timer_sel = LEDC_TIMER_0;
-     ledc_channel_config(&ledc_channel);
-     
-     // Set initial backlight level
-     uint32_t duty = LCD_Backlight * 10;
-     if (duty > 1000) duty = 1024;
-     ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0, duty);
-     ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0);
-     
-     return mp_const_none;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_backlight_init_obj, spd2010_backlight_init);
- 
- // Set backlight level
- STATIC mp_obj_t spd2010_set_backlight(mp_obj_t light_obj) {
-     uint8_t light = mp_obj_get_int(light_obj);
-     
-     if (light > Backlight_MAX || light < 0) {
-         printf("Set Backlight parameters in the range of 0 to 100 \r\n");
-     } else {
-         uint32_t backlight = light * 10;
-         if (backlight == 1000)
-             backlight = 1024;
-         
-         // Set PWM duty cycle
-         ledc_set_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0, backlight);
-         ledc_update_duty(LEDC_HIGH_SPEED_MODE, LEDC_CHANNEL_0);
-         
-         // Update global
-         LCD_Backlight = light;
-     }
-     
-     return mp_const_none;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_set_backlight_obj, spd2010_set_backlight);
- 
- // Full LCD initialization
- STATIC mp_obj_t spd2010_lcd_init(void) {
-     // Initialize display
-     spd2010_display_init();
-     
-     // Configurar el panel SPD2010
-    // printf("Install LCD driver of spd2010\r\n");
-    spd2010_vendor_config_t vendor_config = {
-        .flags = {
-            .use_qspi_interface = 1,
-        },
-    };
-    
-    esp_lcd_panel_dev_config_t panel_config = {
-        .reset_gpio_num = -1,  // Ya hicimos el reset con el TCA9554
-        .rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB,
-        .data_endian = LCD_RGB_DATA_ENDIAN_BIG,
-        .bits_per_pixel = EXAMPLE_LCD_COLOR_BITS,
-        .vendor_config = (void *)&vendor_config,
-    };
-    
-    esp_lcd_new_panel_spd2010(io_handle, &panel_config, &panel_handle);
-    
-    // Inicializar el panel
-    esp_lcd_panel_reset(panel_handle);
-    esp_lcd_panel_init(panel_handle);
-    esp_lcd_panel_disp_on_off(panel_handle, true);
-     
-     return mp_const_none;
- }
- STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_lcd_init_obj, spd2010_lcd_init);
- 
- // Module globals table
- STATIC const mp_rom_map_elem_t spd2010_display_module_globals_table[] = {
-     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_spd2010_display) },
-     
-     // Constants
-     { MP_ROM_QSTR(MP_QSTR_LCD_WIDTH), MP_ROM_INT(EXAMPLE_LCD_WIDTH) },
-     { MP_ROM_QSTR(MP_QSTR_LCD_HEIGHT), MP_ROM_INT(EXAMPLE_LCD_HEIGHT) },
-     { MP_ROM_QSTR(MP_QSTR_LCD_COLOR_BITS), MP_ROM_INT(EXAMPLE_LCD_COLOR_BITS) },
-     { MP_ROM_QSTR(MP_QSTR_LCD_Backlight_PIN), MP_ROM_INT(LCD_Backlight_PIN) },
-     { MP_ROM_QSTR(MP_QSTR_Backlight_MAX), MP_ROM_INT(Backlight_MAX) },
-     
-     // Functions
-     { MP_ROM_QSTR(MP_QSTR_SPD2010_Reset), MP_ROM_PTR(&spd2010_display_reset_obj) },
-     { MP_ROM_QSTR(MP_QSTR_QSPI_Init), MP_ROM_PTR(&spd2010_qspi_init_obj) },
-     { MP_ROM_QSTR(MP_QSTR_SPD2010_Init), MP_ROM_PTR(&spd2010_display_init_obj) },
-     { MP_ROM_QSTR(MP_QSTR_LCD_addWindow), MP_ROM_PTR(&spd2010_display_add_window_obj) },
-     { MP_ROM_QSTR(MP_QSTR_Backlight_Init), MP_ROM_PTR(&spd2010_backlight_init_obj) },
-     { MP_ROM_QSTR(MP_QSTR_Set_Backlight), MP_ROM_PTR(&spd2010_set_backlight_obj) },
-     { MP_ROM_QSTR(MP_QSTR_LCD_Init), MP_ROM_PTR(&spd2010_lcd_init_obj) },
- };
- STATIC MP_DEFINE_CONST_DICT(spd2010_display_module_globals, spd2010_display_module_globals_table);
- 
- // Module definition
- const mp_obj_module_t spd2010_display_user_cmodule = {
-     .base = { &mp_type_module },
-     .globals = (mp_obj_dict_t *)&spd2010_display_module_globals,
- };
- 
- // Register the module
+/*
+ * SPD2010 Display Driver implementation for MicroPython
+ * Adapted from Display_SPD2010.cpp/.h from Arduino implementation
+ */
+
+ 
+#include "esp_lcd_spd2010.h"
+// #include "drivers/esp_lcd_spd2010.h"
+
+
+ #include <string.h>
+ #include "py/obj.h"
+ #include "py/runtime.h"
+ #include "py/mphal.h"
+ #include "py/mperrno.h"
+ #include "py/stream.h"
+ #include "freertos/FreeRTOS.h"
+ #include "freertos/task.h"
+ #include "driver/gpio.h"
+ #include "driver/spi_master.h"
+ #include "driver/ledc.h"
+ #include "soc/soc_caps.h"
+ #include "esp_lcd_panel_io.h"
+ #include "esp_lcd_panel_ops.h"
+ #include "esp_log.h"
+ #include "esp_timer.h"
+ #include "esp_heap_caps.h"
+ #include "spd2010_pixels.h"
+ #include "spd2010_shadow.h"
+ #include "bus_trace_ring.h"
+ 
+ // Display definitions
+ #define EXAMPLE_LCD_WIDTH           412
+ #define EXAMPLE_LCD_HEIGHT          412
+ #define EXAMPLE_LCD_COLOR_BITS      16
+ 
+ // SPI configuration
+ #define ESP_PANEL_LCD_SPI_MODE      3
+ #define ESP_PANEL_LCD_SPI_CLK_HZ    (40 * 1000 * 1000)
+ #define ESP_PANEL_LCD_SPI_CS        21
+ #define ESP_PANEL_LCD_SPI_TE        18
+ #define ESP_PANEL_LCD_SPI_IO_SCK    40
+ #define ESP_PANEL_LCD_SPI_IO_DATA0  46
+ #define ESP_PANEL_LCD_SPI_IO_DATA1  45
+ #define ESP_PANEL_LCD_SPI_IO_DATA2  42
+ #define ESP_PANEL_LCD_SPI_IO_DATA3  41
+ 
+ // Largest single transfer on the QSPI bus
+ #define DISPLAY_MAX_TRANSFER        65535
+ 
+ // Streaming color conversion, one line per chunk, two chunks in flight
+ #define CONV_BUF_PIXELS             EXAMPLE_LCD_WIDTH
+ #define CONV_BUF_COUNT              2
+ 
+ // RLE images: "RL16", width and height as little endian uint16, then per row
+ // packets of a control byte c. c & 0x80: (c & 0x7F) + 1 copies of the next
+ // pixel, else c + 1 literal pixels. Pixels are RGB565 big endian, packets
+ // never cross a row
+ #define RLE_MAGIC                   "RL16"
+ #define RLE_HEADER_LEN              8
+ 
+ // QSPI clock calibration. The SPI clock is the 80 MHz source divided by an
+ // integer, other frequencies are rounded down to one of those
+ #define CALIB_SRC_CLK_HZ            (80 * 1000 * 1000)
+ #define CALIB_MIN_CLK_HZ            (10 * 1000 * 1000)
+ #define CALIB_MAX_CLK_HZ            (80 * 1000 * 1000)
+ #define CALIB_MARGIN_STEPS          1
+ #define CALIB_WIN_WIDTH             8
+ #define CALIB_WIN_HEIGHT            2
+ 
+ // For PWM Backlight, the S3 LEDC only has the low speed mode. 11 bits is the
+ // finest resolution at 20 kHz from the 80 MHz clock
+ #define LCD_Backlight_PIN           5
+ #define Backlight_MAX               100
+ #define PWM_FREQ                    20000
+ #define PWM_RESOLUTION              11
+ #define PWM_DUTY_MAX                (1 << PWM_RESOLUTION)
+ #define PWM_MODE                    LEDC_LOW_SPEED_MODE
+ 
+ // Display object: owns the QSPI bus, panel IO and panel handles. There is a
+ // single instance in static storage, so the handles survive a soft reset of
+ // the VM and the next init reuses them instead of leaking panels or DMA memory.
+ typedef struct _spd2010_display_obj_t {
+     mp_obj_base_t base;
+     bool bus_initialized;
+     esp_lcd_panel_io_handle_t io_handle;
+     esp_lcd_panel_handle_t panel_handle;
+     int pclk_hz;
+     int scroll_top;        // first line of the hardware scroll area
+     int scroll_height;     // lines in the hardware scroll area, 0 when scrolling is off
+     int scroll_offset;     // frame memory line shown at scroll_top, relative to scroll_top
+     int src_format;        // SRC_FORMAT_* of the buffers given to add_window
+     int panel_bpp;         // pixel format of the panel: 16, 18 or 24
+     uint8_t *conv_buf[CONV_BUF_COUNT];  // DMA buffers of the streaming converter
+     volatile uint32_t tx_done;          // color transfers completed, counted by the panel IO callback
+     uint32_t tx_base;      // tx_done when the panel driver was installed, its queued count starts there
+     bool sleeping;         // panel in sleep mode, frame memory kept
+     int64_t wake_us;       // SLPOUT sent, the display can be turned on from here. 0: no wake-up started
+     bool initialized;
+ } spd2010_display_obj_t;
+ 
+ extern const mp_obj_type_t spd2010_display_type;
+ extern const mp_obj_type_t spd2010_flush_type;
+ 
+ // Flush: an add_window_async in flight. Holds the pixel buffer and the flag
+ // to set once its transfers are done
+ typedef struct _spd2010_flush_obj_t {
+     mp_obj_base_t base;
+     mp_obj_t color;        // kept alive while it is sent
+     mp_obj_t flag;         // flag.set() is scheduled when done, None: poll done()
+     uint32_t tx_target;    // tx_done value once the transfers are out
+     bool failed;           // the window was not sent whole, done() and wait() raise
+ } spd2010_flush_obj_t;
+ 
+ // Surface: a DMA buffer in the panel pixel format (RGB565 big endian) that
+ // Python draws into through the buffer protocol and blits without copying
+ typedef struct _spd2010_surface_obj_t {
+     mp_obj_base_t base;
+     uint8_t *buf;          // NULL once freed
+     int width;
+     int height;
+     uint32_t tx_target;    // tx_done value once the last blit is out
+     bool released;         // deinit() called, buf is kept until collected
+ } spd2010_surface_obj_t;
+ 
+ // Global variables
+ static spd2010_display_obj_t display_obj = {
+     .base = { &spd2010_display_type },
+     .pclk_hz = ESP_PANEL_LCD_SPI_CLK_HZ,
+     .src_format = SRC_FORMAT_RGB565,
+     .panel_bpp = EXAMPLE_LCD_COLOR_BITS,
+ };
+ 
+ static uint8_t LCD_Backlight = 60;
+ static bool backlight_ready = false;
+ static uint16_t backlight_curve[Backlight_MAX + 1];    // level -> duty
+ static uint16_t backlight_scale = CABC_GAIN_ONE;        // duty factor in Q8, lowered by CABC
+ static uint16_t backlight_out_scale = CABC_GAIN_ONE;    // scale in the duty the LEDC was given
+ static int64_t backlight_fade_end = 0;                  // end of the last fade started
+ static ledc_channel_config_t ledc_channel;
+ 
+ // CABC state. The flush samples the outgoing pixels and boosts them by gain,
+ // a decision is taken at the end of a frame that sent the whole screen
+ typedef struct {
+     bool enabled;
+     bool redraw;                // gain changed, the whole screen has to be sent again
+     int next_row;               // the frame sent full rows down to here, -1: a partial frame
+     uint16_t pending_scale;     // backlight scale for when the boosted frame is out, 0: none
+     pixels_cabc_t px;           // histogram and gain
+     uint32_t frame_us;          // sampling and boost time of the current frame
+     uint32_t frames;
+     uint32_t changes;
+     uint64_t scale_sum;         // backlight scale summed over frames
+     uint64_t cpu_us;
+     uint32_t max_cpu_us;
+ } cabc_t;
+ 
+ static cabc_t cabc = {
+     .px = {
+         .max_gain = CABC_GAIN_ONE * 3 / 2,
+         .clip_permille = 5,
+         .gain = CABC_GAIN_ONE,
+     },
+ };
+ 
+ STATIC void backlight_rescale(void);
+ 
+ // Copy of the panel frame memory decoded from the bus traffic, NULL when off
+ static spd2010_shadow_t shadow;
+ static uint16_t *shadow_fb = NULL;
+ 
+ // Frame marker of the lvgl_driver latency histogram: the time the transfer
+ // done interrupt saw the last transfer queued before the mark finish
+ static volatile bool mark_armed = false;
+ static volatile uint32_t mark_target = 0;      // tx_done value that ends the frame
+ static volatile int64_t mark_us = 0;            // 0 while the frame is on its way
+ 
+ // Called by the done interrupt after every color transfer, returns whether it
+ // woke a task. The lvgl_driver transfer task waits on it for its bands
+ static bool (*tx_done_callback)(void *arg) = NULL;
+ static void *tx_done_callback_arg = NULL;
+ 
+ // Flushes in flight, oldest first. The root pointer keeps them, and with them
+ // their buffers and flags, alive until the done interrupt retires them. The
+ // declaration is copied into the generated VM state, so the length is a literal.
+ // The interrupt only reads the copies below: the GC heap may be in PSRAM,
+ // which is out of reach while the flash cache is off
+ MP_REGISTER_ROOT_POINTER(mp_obj_t spd2010_flush_pending[4]);
+ #define FLUSH_PENDING_LEN           MP_ARRAY_SIZE(MP_STATE_VM(spd2010_flush_pending))
+ #define FLUSH_WAIT_MS               1000
+ static uint32_t flush_targets[FLUSH_PENDING_LEN];  // tx_done value that ends each flush
+ static mp_obj_t flush_flags[FLUSH_PENDING_LEN];    // flag of each flush, None: none
+ static volatile uint32_t flush_head = 0;           // written by add_window_async
+ static volatile uint32_t flush_tail = 0;           // written under flush_lock
+ static portMUX_TYPE flush_lock = portMUX_INITIALIZER_UNLOCKED;
+ 
+ STATIC void flush_complete(spd2010_display_obj_t *self);
+ STATIC void flush_reset(void);
+ 
+ // External function references
+ extern mp_obj_t tca9554_set_exio(mp_obj_t pin_obj, mp_obj_t state_obj);
+ 
+ // Reset the SPD2010 display
+ STATIC mp_obj_t spd2010_display_reset(void) {
+     // Reset using TCA9554 pin 2
+     mp_obj_t args[] = {
+         mp_obj_new_int(2), // EXIO_PIN2
+         mp_obj_new_int(0)  // Low
+     };
+     tca9554_set_exio(args[0], args[1]);
+     mp_hal_delay_ms(50);
+     
+     args[1] = mp_obj_new_int(1); // High
+     tca9554_set_exio(args[0], args[1]);
+     mp_hal_delay_ms(50);
+     
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_display_reset_obj, spd2010_display_reset);
+ 
+ // QSPI bus initialization, done once per display object
+ STATIC bool display_bus_init(spd2010_display_obj_t *self) {
+     if (self->bus_initialized) {
+         return true;
+     }
+     
+     spi_bus_config_t bus_config = {
+         .data0_io_num = ESP_PANEL_LCD_SPI_IO_DATA0,
+         .data1_io_num = ESP_PANEL_LCD_SPI_IO_DATA1,
+         .sclk_io_num = ESP_PANEL_LCD_SPI_IO_SCK,
+         .data2_io_num = ESP_PANEL_LCD_SPI_IO_DATA2,
+         .data3_io_num = ESP_PANEL_LCD_SPI_IO_DATA3,
+         .data4_io_num = -1,
+         .data5_io_num = -1,
+         .data6_io_num = -1,
+         .data7_io_num = -1,
+         .max_transfer_sz = DISPLAY_MAX_TRANSFER,
+         .flags = SPICOMMON_BUSFLAG_MASTER,
+         .intr_flags = 0,
+     };
+     
+     esp_err_t ret = spi_bus_initialize(SPI2_HOST, &bus_config, SPI_DMA_CH_AUTO);
+     if (ret == ESP_ERR_INVALID_STATE) {
+         // Initialized outside of this object, keep using it
+         printf("The SPI bus is already initialized.\r\n");
+     } else if (ret != ESP_OK) {
+         printf("The SPI initialization failed.\r\n");
+         return false;
+     } else {
+         printf("The SPI initialization succeeded.\r\n");
+     }
+     
+     self->bus_initialized = true;
+     return true;
+ }
+ 
+ // Panel IO callback, runs in the SPI interrupt once per queued color transfer
+ STATIC bool IRAM_ATTR display_color_trans_done(esp_lcd_panel_io_handle_t panel_io, esp_lcd_panel_io_event_data_t *edata, void *user_ctx) {
+     spd2010_display_obj_t *self = (spd2010_display_obj_t *)user_ctx;
+     self->tx_done++;
+     if (mark_armed && (int32_t)(self->tx_done - mark_target) >= 0 && __atomic_exchange_n(&mark_armed, false, __ATOMIC_ACQ_REL)) {
+         mark_us = esp_timer_get_time();
+     }
+     if (flush_tail != flush_head) {
+         flush_complete(self);
+     }
+     bool woken = false;
+     if (tx_done_callback != NULL) {
+         woken = tx_done_callback(tx_done_callback_arg);
+     }
+     BUS_TRACE_COLOR_DONE();
+     return woken;
+ }
+ 
+ // Configure LCD panel IO over SPI, done once per display object
+ STATIC bool display_io_init(spd2010_display_obj_t *self) {
+     if (self->io_handle != NULL) {
+         return true;
+     }
+     
+     esp_lcd_panel_io_spi_config_t io_config = {
+         .cs_gpio_num = ESP_PANEL_LCD_SPI_CS,
+         .dc_gpio_num = -1,
+         .spi_mode = ESP_PANEL_LCD_SPI_MODE,
+         .pclk_hz = self->pclk_hz,
+         .trans_queue_depth = 10,
+         .on_color_trans_done = display_color_trans_done,
+         .user_ctx = self,
+         .lcd_cmd_bits = 32,
+         .lcd_param_bits = 8,
+         .flags = {
+             .dc_low_on_data = 0,
+             .octal_mode = 0,
+             .quad_mode = 1,
+             .sio_mode = 0,
+             .lsb_first = 0,
+             .cs_high_active = 0,
+         },
+     };
+     
+     if (esp_lcd_new_panel_io_spi((esp_lcd_spi_bus_handle_t)SPI2_HOST, &io_config, &self->io_handle) != ESP_OK) {
+         printf("Failed to set LCD communication parameters -- SPI\r\n");
+         self->io_handle = NULL;
+         return false;
+     }
+     
+     printf("LCD communication parameters are set successfully -- SPI (%d Hz)\r\n", self->pclk_hz);
+     return true;
+ }
+ 
+ // Panel transfer callback while the shadow frame memory is on: every command
+ // and color transfer is replayed into the shadow
+ STATIC void display_shadow_tx(void *ctx, uint32_t lcd_cmd, bool color, const void *data, size_t len) {
+     spd2010_shadow_tx((spd2010_shadow_t *)ctx, lcd_cmd, color, data, len);
+ }
+ 
+ // Install the SPD2010 panel driver, done once per display object
+ STATIC bool display_panel_create(spd2010_display_obj_t *self) {
+     if (self->panel_handle != NULL) {
+         return true;
+     }
+     
+     printf("Install LCD driver of spd2010\r\n");
+     spd2010_vendor_config_t vendor_config = {
+         .flags = {
+             .use_qspi_interface = 1,
+         },
+     };
+     
+     esp_lcd_panel_dev_config_t panel_config = {
+         .reset_gpio_num = -1,  // Ya hicimos el reset con el TCA9554
+         .rgb_ele_order = LCD_RGB_ELEMENT_ORDER_RGB,
+         .data_endian = LCD_RGB_DATA_ENDIAN_BIG,
+         .bits_per_pixel = self->panel_bpp,
+         .vendor_config = (void *)&vendor_config,
+     };
+     
+     ESP_LOGI("SPD2010", "Initializing panel driver");
+     if (esp_lcd_new_panel_spd2010(self->io_handle, &panel_config, &self->panel_handle) != ESP_OK) {
+         printf("Failed to install LCD driver of spd2010\r\n");
+         self->panel_handle = NULL;
+         return false;
+     }
+     self->tx_base = self->tx_done;
+     if (shadow_fb != NULL) {
+         esp_lcd_spd2010_register_tx_callback(self->panel_handle, display_shadow_tx, &shadow);
+     }
+     
+     return true;
+ }
+ 
+ // Bring the display up. Calling it again on an initialized display is a no-op.
+ // With warm=true the panel is probed first and, if it is still powered and
+ // configured, only MADCTL/COLMOD and display-on are reapplied
+ STATIC bool display_init(spd2010_display_obj_t *self, bool warm) {
+     if (self->initialized) {
+         return true;
+     }
+     
+     int64_t start_us = esp_timer_get_time();
+     
+     // Reset display (a warm start must keep the panel state)
+     if (!warm) {
+         spd2010_display_reset();
+     }
+     flush_reset();
+     
+     // Set TE pin as output
+     gpio_config_t io_conf = {
+         .mode = GPIO_MODE_OUTPUT,
+         .pin_bit_mask = (1ULL << ESP_PANEL_LCD_SPI_TE),
+         .pull_down_en = 0,
+         .pull_up_en = 0,
+         .intr_type = GPIO_INTR_DISABLE,
+     };
+     gpio_config(&io_conf);
+     
+     if (!display_bus_init(self) || !display_io_init(self) || !display_panel_create(self)) {
+         printf("SPD2010 Failed to be initialized\r\n");
+         return false;
+     }
+     
+     // Probe the panel before deciding how much of the init sequence is needed
+     bool configured = false;
+     if (warm && esp_lcd_spd2010_is_configured(self->panel_handle, &configured) != ESP_OK) {
+         configured = false;
+     }
+     
+     if (configured && esp_lcd_spd2010_resume(self->panel_handle) == ESP_OK) {
+         printf("Panel still configured, skipping init commands\r\n");
+     } else {
+         if (warm) {
+             printf("Panel not configured, falling back to cold init\r\n");
+             spd2010_display_reset();
+             warm = false;
+         }
+         // Inicializar el panel
+         esp_lcd_panel_reset(self->panel_handle);
+         esp_lcd_panel_init(self->panel_handle);
+     }
+     esp_lcd_panel_disp_on_off(self->panel_handle, true);
+     self->sleeping = false;
+     self->wake_us = 0;
+     
+     printf("spd2010 LCD OK (%s init, %d ms)\r\n", warm ? "warm" : "cold",
+            (int)((esp_timer_get_time() - start_us) / 1000));
+     self->initialized = true;
+     return true;
+ }
+ 
+ // Release the panel, the panel IO and the QSPI bus
+ STATIC void display_deinit(spd2010_display_obj_t *self) {
+     if (self->panel_handle != NULL) {
+         esp_lcd_panel_del(self->panel_handle);
+         self->panel_handle = NULL;
+     }
+     if (self->io_handle != NULL) {
+         esp_lcd_panel_io_del(self->io_handle);
+         self->io_handle = NULL;
+     }
+     if (self->bus_initialized) {
+         spi_bus_free(SPI2_HOST);
+         self->bus_initialized = false;
+     }
+     for (int i = 0; i < CONV_BUF_COUNT; i++) {
+         heap_caps_free(self->conv_buf[i]);
+         self->conv_buf[i] = NULL;
+     }
+     self->initialized = false;
+     // The transfers are gone: set the flags that can be, drop the rest
+     flush_complete(self);
+     flush_reset();
+ }
+ 
+ // Change the QSPI clock. The panel IO has to be recreated for a new clock, the
+ // panel itself keeps its configuration so no init sequence is sent
+ STATIC bool display_set_pclk(spd2010_display_obj_t *self, int pclk_hz) {
+     if (pclk_hz == self->pclk_hz) {
+         return true;
+     }
+     
+     self->pclk_hz = pclk_hz;
+     if (self->io_handle == NULL) {
+         // Not created yet, the new clock is used by the next init
+         return true;
+     }
+     
+     if (self->panel_handle != NULL) {
+         esp_lcd_panel_del(self->panel_handle);
+         self->panel_handle = NULL;
+     }
+     esp_lcd_panel_io_del(self->io_handle);
+     self->io_handle = NULL;
+     
+     return display_io_init(self) && display_panel_create(self);
+ }
+ 
+ // Write a test pattern to a small window and read it back
+ STATIC bool display_check_link(spd2010_display_obj_t *self, const uint8_t *pattern, uint8_t *readback, size_t len) {
+     if (esp_lcd_panel_draw_bitmap(self->panel_handle, 0, 0, CALIB_WIN_WIDTH, CALIB_WIN_HEIGHT, pattern) != ESP_OK) {
+         return false;
+     }
+     return esp_lcd_spd2010_read_ram(self->panel_handle, 0, 0, CALIB_WIN_WIDTH, CALIB_WIN_HEIGHT, readback, len) == ESP_OK;
+ }
+ 
+ // Step the QSPI clock up through the 80 MHz / n frequencies from min_hz to
+ // max_hz and keep the highest one that reads back the test pattern without
+ // errors, a divider step lower as safety margin. The reference readback is
+ // taken at the lowest clock, so the check does not depend on the RAMRD format
+ STATIC int display_calibrate_pclk(spd2010_display_obj_t *self, int min_hz, int max_hz) {
+     static const uint8_t bytes[] = { 0xAA, 0x55, 0xFF, 0x00, 0xF0, 0x0F, 0xCC, 0x33 };
+     // Sized for up to 3 bytes per pixel, for both the write and the RAMRD format
+     const size_t len = CALIB_WIN_WIDTH * CALIB_WIN_HEIGHT * 3;
+     int slow_div = CALIB_SRC_CLK_HZ / min_hz;
+     int best_div;
+     
+     // Written and read by the SPI DMA
+     uint8_t *pattern = heap_caps_malloc(3 * len, MALLOC_CAP_DMA);
+     if (pattern == NULL) {
+         printf("QSPI calibration: no DMA memory\r\n");
+         return 0;
+     }
+     uint8_t *reference = pattern + len;
+     uint8_t *readback = reference + len;
+     for (size_t i = 0; i < len; i++) {
+         pattern[i] = bytes[(i + i / sizeof(bytes)) % sizeof(bytes)];
+     }
+     if (!display_set_pclk(self, CALIB_SRC_CLK_HZ / slow_div) || !display_check_link(self, pattern, reference, len)) {
+         printf("QSPI calibration failed at %d Hz\r\n", CALIB_SRC_CLK_HZ / slow_div);
+         heap_caps_free(pattern);
+         return 0;
+     }
+     best_div = slow_div;
+     
+     for (int div = slow_div - 1; div >= 1 && CALIB_SRC_CLK_HZ / div <= max_hz; div--) {
+         int hz = CALIB_SRC_CLK_HZ / div;
+         int errors = 0;
+         if (!display_set_pclk(self, hz)) {
+             break;
+         }
+         // A few passes, the failures near the limit are intermittent
+         for (int pass = 0; pass < 4 && errors == 0; pass++) {
+             memset(readback, 0, len);
+             if (!display_check_link(self, pattern, readback, len)) {
+                 errors++;
+             } else if (memcmp(reference, readback, len) != 0) {
+                 errors++;
+             }
+         }
+         printf("QSPI %d Hz: %s\r\n", hz, errors ? "errors" : "ok");
+         if (errors) {
+             break;
+         }
+         best_div = div;
+     }
+     heap_caps_free(pattern);
+     
+     int chosen_div = best_div + CALIB_MARGIN_STEPS;
+     if (chosen_div > slow_div) {
+         chosen_div = slow_div;
+     }
+     if (!display_set_pclk(self, CALIB_SRC_CLK_HZ / chosen_div)) {
+         return 0;
+     }
+     printf("QSPI clock calibrated to %d Hz (max stable %d Hz)\r\n", CALIB_SRC_CLK_HZ / chosen_div, CALIB_SRC_CLK_HZ / best_div);
+     return CALIB_SRC_CLK_HZ / chosen_div;
+ }
+ 
+ // Map screen row y to its frame memory row. Returns how many rows from y stay
+ // contiguous in frame memory (up to y_end), i.e. before the scroll area wraps
+ STATIC int display_map_rows(spd2010_display_obj_t *self, int y, int y_end, int *mem_y) {
+     int top = self->scroll_top;
+     int bottom = self->scroll_top + self->scroll_height;
+     int limit = y_end;
+     
+     if (self->scroll_height == 0 || y >= bottom) {
+         *mem_y = y;
+     } else if (y < top) {
+         *mem_y = y;
+         limit = top;
+     } else {
+         int pos = (y - top + self->scroll_offset) % self->scroll_height;
+         *mem_y = top + pos;
+         limit = y + (self->scroll_height - pos);
+         if (limit > bottom)
+             limit = bottom;
+     }
+     
+     return (limit < y_end ? limit : y_end) - y;
+ }
+ 
+ // Build the lookup tables and allocate the DMA buffers of the streaming converter
+ STATIC bool display_conv_ready(spd2010_display_obj_t *self) {
+     pixels_init();
+     for (int i = 0; i < CONV_BUF_COUNT; i++) {
+         if (self->conv_buf[i] == NULL) {
+             self->conv_buf[i] = heap_caps_malloc(CONV_BUF_PIXELS * 3, MALLOC_CAP_DMA);
+             if (self->conv_buf[i] == NULL) {
+                 printf("No memory for the color conversion buffers\r\n");
+                 return false;
+             }
+         }
+     }
+     return true;
+ }
+ 
+ // Wait until the transfer that last used a converter buffer is done. No
+ // MicroPython calls, the LVGL flush converts from its own tasks. False once
+ // FLUSH_WAIT_MS passed without the done interrupt
+ STATIC bool display_conv_wait(spd2010_display_obj_t *self, uint32_t tx_target) {
+     int64_t deadline_us = esp_timer_get_time() + FLUSH_WAIT_MS * 1000;
+     while (self->initialized && (int32_t)(self->tx_done - tx_target) < 0) {
+         if (esp_timer_get_time() >= deadline_us) {
+             printf("Color transfer timed out\r\n");
+             return false;
+         }
+         taskYIELD();
+     }
+     return true;
+ }
+ 
+ // Stream a window through the converter: every row is converted into one of
+ // the DMA buffers while the previous one is still being sent
+ STATIC bool display_convert_window(spd2010_display_obj_t *self, int x_start, int y_start, int x_end, int y_end,
+                                    const uint8_t *src, size_t src_stride) {
+     int width = x_end - x_start;
+     size_t row_len = width * (self->panel_bpp == 16 ? 2 : 3);
+     
+     if (!display_conv_ready(self)) {
+         return false;
+     }
+     
+     // Setting the window waits for all queued transfers, so the counter starts from a known point
+     if (esp_lcd_spd2010_set_window(self->panel_handle, x_start, y_start, x_end, y_end) != ESP_OK) {
+         return false;
+     }
+     uint32_t base = self->tx_done;
+     
+     for (int row = 0; row < y_end - y_start; row++) {
+         uint8_t *buf = self->conv_buf[row % CONV_BUF_COUNT];
+         if (row >= CONV_BUF_COUNT && !display_conv_wait(self, base + row - CONV_BUF_COUNT + 1)) {
+             return false;
+         }
+         pixels_convert_row(buf, src + row * src_stride, width, self->src_format, self->panel_bpp);
+         if (esp_lcd_spd2010_write_pixels(self->panel_handle, buf, row_len, row == 0) != ESP_OK) {
+             return false;
+         }
+     }
+     return true;
+ }
+ 
+ // Blit an RLE compressed image with its top left corner at (x, y). Rows are
+ // decoded straight into the DMA buffers, the image is never expanded in RAM
+ STATIC bool display_blit_rle(spd2010_display_obj_t *self, int x, int y, const uint8_t *data, size_t len) {
+     if (len < RLE_HEADER_LEN || memcmp(data, RLE_MAGIC, 4) != 0) {
+         printf("Not an RLE image\r\n");
+         return false;
+     }
+     int width = data[4] | (data[5] << 8);
+     int height = data[6] | (data[7] << 8);
+     if (width > CONV_BUF_PIXELS) {
+         printf("RLE image wider than the display\r\n");
+         return false;
+     }
+     
+     // Clip to screen bounds
+     int x0 = x < 0 ? 0 : x;
+     int y0 = y < 0 ? 0 : y;
+     int x1 = (x + width > EXAMPLE_LCD_WIDTH) ? EXAMPLE_LCD_WIDTH : x + width;
+     int y1 = (y + height > EXAMPLE_LCD_HEIGHT) ? EXAMPLE_LCD_HEIGHT : y + height;
+     if (x0 >= x1 || y0 >= y1) {
+         return true;
+     }
+     if (!display_conv_ready(self)) {
+         return false;
+     }
+     
+     const uint8_t *p = data + RLE_HEADER_LEN;
+     const uint8_t *end = data + len;
+     int count = x1 - x0;
+     size_t row_len = count * (self->panel_bpp == 16 ? 2 : 3);
+     
+     // Rows above the screen are only walked over
+     for (int row = y; row < y0 && p != NULL; row++) {
+         p = pixels_rle_row(self->conv_buf[0], p, end, width, 0, 0, self->panel_bpp);
+     }
+     
+     // Rows are split where the hardware scroll area wraps in frame memory
+     for (int row_y = y0; row_y < y1 && p != NULL;) {
+         int mem_y;
+         int rows = display_map_rows(self, row_y, y1, &mem_y);
+         if (esp_lcd_spd2010_set_window(self->panel_handle, x0, mem_y, x1, mem_y + rows) != ESP_OK) {
+             return false;
+         }
+         uint32_t base = self->tx_done;
+         
+         for (int row = 0; row < rows; row++) {
+             uint8_t *buf = self->conv_buf[row % CONV_BUF_COUNT];
+             if (row >= CONV_BUF_COUNT && !display_conv_wait(self, base + row - CONV_BUF_COUNT + 1)) {
+                 return false;
+             }
+             p = pixels_rle_row(buf, p, end, width, x0 - x, count, self->panel_bpp);
+             if (p == NULL) {
+                 break;
+             }
+             if (esp_lcd_spd2010_write_pixels(self->panel_handle, buf, row_len, row == 0) != ESP_OK) {
+                 return false;
+             }
+         }
+         row_y += rows;
+     }
+     
+     if (p == NULL) {
+         printf("Corrupt RLE image\r\n");
+         return false;
+     }
+     return true;
+ }
+ 
+ // Queue the w x h pixels at the top left of a surface to the screen at (x, y),
+ // straight from the surface buffer. Full width rows go out as few transfers as
+ // the bus allows, narrower ones row by row. Returns at once, the transfers are
+ // done when tx_done reaches surface->tx_target
+ STATIC bool display_blit_surface(spd2010_display_obj_t *self, spd2010_surface_obj_t *surface, int x, int y, int w, int h) {
+     if (self->panel_bpp != 16) {
+         printf("Surfaces need the 16-bit panel format\r\n");
+         return false;
+     }
+     if (w > surface->width)
+         w = surface->width;
+     if (h > surface->height)
+         h = surface->height;
+     
+     // Clip to screen bounds, the surface origin moves with the left and top edges
+     int sx = 0;
+     int sy = 0;
+     if (x < 0) {
+         sx = -x;
+         w += x;
+         x = 0;
+     }
+     if (y < 0) {
+         sy = -y;
+         h += y;
+         y = 0;
+     }
+     if (x + w > EXAMPLE_LCD_WIDTH)
+         w = EXAMPLE_LCD_WIDTH - x;
+     if (y + h > EXAMPLE_LCD_HEIGHT)
+         h = EXAMPLE_LCD_HEIGHT - y;
+     if (w <= 0 || h <= 0) {
+         return true;
+     }
+     
+     size_t stride = surface->width * 2;
+     size_t row_len = w * 2;
+     int rows_per_tx = (row_len == stride) ? DISPLAY_MAX_TRANSFER / row_len : 1;
+     
+     // Rows are split where the hardware scroll area wraps in frame memory
+     for (int row_y = y; row_y < y + h;) {
+         int mem_y;
+         int rows = display_map_rows(self, row_y, y + h, &mem_y);
+         if (esp_lcd_spd2010_set_window(self->panel_handle, x, mem_y, x + w, mem_y + rows) != ESP_OK) {
+             return false;
+         }
+         const uint8_t *src = surface->buf + (sy + row_y - y) * stride + sx * 2;
+         for (int row = 0; row < rows; row += rows_per_tx) {
+             int n = (rows - row < rows_per_tx) ? rows - row : rows_per_tx;
+             if (esp_lcd_spd2010_write_pixels(self->panel_handle, src + row * stride, n * row_len, row == 0) != ESP_OK) {
+                 return false;
+             }
+             uint32_t queued;
+             esp_lcd_spd2010_get_color_queued(self->panel_handle, &queued);
+             surface->tx_target = self->tx_base + queued;
+         }
+         row_y += rows;
+     }
+     return true;
+ }
+ 
+ // Clip and send a window of pixels in the source format to the panel. False
+ // when the converter gave up on it
+ STATIC bool display_draw(spd2010_display_obj_t *self, int x_start, int y_start, int x_end, int y_end, uint16_t *color) {
+     int src_bytes = self->src_format / 8;
+     int stride = x_end - x_start + 1;
+     bool direct = (self->src_format == SRC_FORMAT_RGB565) && (self->panel_bpp == 16);
+     
+     if (cabc.enabled && self->src_format == SRC_FORMAT_RGB565) {
+         int64_t start = esp_timer_get_time();
+         pixels_cabc_process(&cabc.px, color, stride * (y_end - y_start + 1));
+         cabc.frame_us += esp_timer_get_time() - start;
+         if (x_start == 0 && x_end == EXAMPLE_LCD_WIDTH - 1 && y_start == cabc.next_row) {
+             cabc.next_row = y_end + 1;
+         } else {
+             cabc.next_row = -1;
+         }
+     }
+     
+     if (direct) {
+         // Calculate size
+         uint32_t size = stride * (y_end - y_start + 1);
+         
+         // Swap bytes for each color value (endian conversion)
+         pixels_swap_rgb565(color, size);
+     }
+     
+     // Adjust end points for esp_lcd_panel_draw_bitmap
+     x_end += 1;
+     y_end += 1;
+     
+     // Clip to screen bounds
+     if (x_end > EXAMPLE_LCD_WIDTH)
+         x_end = EXAMPLE_LCD_WIDTH;
+     if (y_end > EXAMPLE_LCD_HEIGHT)
+         y_end = EXAMPLE_LCD_HEIGHT;
+     
+     // Rows are split where the hardware scroll area wraps in frame memory
+     for (int y = y_start; y < y_end;) {
+         int mem_y;
+         int rows = display_map_rows(self, y, y_end, &mem_y);
+         const uint8_t *src = (const uint8_t *)color + (y - y_start) * stride * src_bytes;
+         if (direct) {
+             esp_lcd_panel_draw_bitmap(self->panel_handle, x_start, mem_y, x_end, mem_y + rows, src);
+         } else if (!display_convert_window(self, x_start, mem_y, x_end, mem_y + rows, src, stride * src_bytes)) {
+             return false;
+         }
+         y += rows;
+     }
+     return true;
+ }
+ 
+ // Scheduled from the done interrupt: flag.set() of a finished flush
+ STATIC mp_obj_t flush_set_flag(mp_obj_t flag) {
+     mp_obj_t dest[2];
+     mp_load_method(flag, MP_QSTR_set, dest);
+     return mp_call_method_n_kw(0, 0, dest);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(flush_set_flag_obj, flush_set_flag);
+ 
+ // Retire the flushes whose transfers are done and schedule their flag.set().
+ // Runs in the done interrupt, and in the caller when the scheduler queue was
+ // full. Without a display the transfers are gone, everything is retired.
+ // A slot emptied by a soft reset is retired without its flag, which belonged
+ // to the old heap. mp_sched_schedule is in IRAM on the esp32 port
+ STATIC void IRAM_ATTR flush_complete(spd2010_display_obj_t *self) {
+     portENTER_CRITICAL_SAFE(&flush_lock);
+     while (flush_tail != flush_head) {
+         uint32_t i = flush_tail % FLUSH_PENDING_LEN;
+         if (self->initialized && (int32_t)(self->tx_done - flush_targets[i]) < 0) {
+             break;
+         }
+         if (MP_STATE_VM(spd2010_flush_pending)[i] != MP_OBJ_NULL && flush_flags[i] != mp_const_none
+             && !mp_sched_schedule(MP_OBJ_FROM_PTR(&flush_set_flag_obj), flush_flags[i])) {
+             break;
+         }
+         MP_STATE_VM(spd2010_flush_pending)[i] = MP_OBJ_NULL;
+         flush_flags[i] = mp_const_none;
+         flush_tail++;
+     }
+     portEXIT_CRITICAL_SAFE(&flush_lock);
+ }
+ 
+ // Forget every flush without setting its flag
+ STATIC void flush_reset(void) {
+     portENTER_CRITICAL_SAFE(&flush_lock);
+     for (size_t i = 0; i < FLUSH_PENDING_LEN; i++) {
+         MP_STATE_VM(spd2010_flush_pending)[i] = MP_OBJ_NULL;
+         flush_flags[i] = mp_const_none;
+         flush_targets[i] = 0;
+     }
+     flush_head = 0;
+     flush_tail = 0;
+     portEXIT_CRITICAL_SAFE(&flush_lock);
+ }
+ 
+ STATIC bool flush_done(spd2010_flush_obj_t *flush) {
+     return !display_obj.initialized || (int32_t)(display_obj.tx_done - flush->tx_target) >= 0;
+ }
+ 
+ // Wait until tx_done reaches tx_target, running scheduled callbacks and
+ // letting other tasks run meanwhile. False after timeout_ms
+ STATIC bool display_tx_wait(uint32_t tx_target, mp_uint_t timeout_ms) {
+     mp_uint_t start = mp_hal_ticks_ms();
+     while (display_obj.initialized && (int32_t)(display_obj.tx_done - tx_target) < 0) {
+         if (mp_hal_ticks_ms() - start >= timeout_ms) {
+             return false;
+         }
+         MICROPY_EVENT_POLL_HOOK
+     }
+     return true;
+ }
+ 
+ // Queue a window like add_window and return a Flush without waiting for the
+ // transfers. At most FLUSH_PENDING_LEN are in flight, the next one waits for
+ // the oldest, running scheduled callbacks meanwhile
+ STATIC mp_obj_t display_add_window_async(spd2010_display_obj_t *self, const mp_obj_t *args, mp_obj_t color_obj, mp_obj_t flag_obj) {
+     if (!self->initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_none;
+     }
+     
+     mp_buffer_info_t color_info;
+     mp_get_buffer_raise(color_obj, &color_info, MP_BUFFER_READ);
+     
+     // Room for one more once the oldest is out and its flag.set() is queued
+     mp_uint_t start = mp_hal_ticks_ms();
+     flush_complete(self);
+     while (flush_head - flush_tail >= FLUSH_PENDING_LEN) {
+         if (mp_hal_ticks_ms() - start >= FLUSH_WAIT_MS) {
+             mp_raise_OSError(MP_ETIMEDOUT);
+         }
+         MICROPY_EVENT_POLL_HOOK
+         flush_complete(self);
+     }
+     
+     spd2010_flush_obj_t *flush = m_new_obj_with_finaliser(spd2010_flush_obj_t);
+     flush->base.type = &spd2010_flush_type;
+     flush->color = color_obj;
+     flush->flag = flag_obj;
+     
+     // A window the converter gave up on is queued all the same: the flag is
+     // set once what went out is done, and the Flush reports the error
+     flush->failed = !display_draw(self, mp_obj_get_int(args[0]), mp_obj_get_int(args[1]),
+                                   mp_obj_get_int(args[2]), mp_obj_get_int(args[3]), (uint16_t *)color_info.buf);
+     uint32_t queued = 0;
+     if (self->panel_handle != NULL) {
+         esp_lcd_spd2010_get_color_queued(self->panel_handle, &queued);
+     }
+     flush->tx_target = self->tx_base + queued;
+     
+     uint32_t i = flush_head % FLUSH_PENDING_LEN;
+     flush_targets[i] = flush->tx_target;
+     flush_flags[i] = flag_obj;
+     MP_STATE_VM(spd2010_flush_pending)[i] = MP_OBJ_FROM_PTR(flush);
+     __atomic_store_n(&flush_head, flush_head + 1, __ATOMIC_RELEASE);
+     // The transfers may be out already, then no interrupt is coming for them
+     flush_complete(self);
+     return MP_OBJ_FROM_PTR(flush);
+ }
+ 
+ // Select the format of the buffers given to add_window and the panel pixel
+ // format. A new panel format recreates the panel handle and resends COLMOD
+ STATIC bool display_set_color_format(spd2010_display_obj_t *self, int src_format, int panel_bpp) {
+     if (src_format != SRC_FORMAT_RGB332 && src_format != SRC_FORMAT_RGB565 && src_format != SRC_FORMAT_ARGB8888) {
+         return false;
+     }
+     if (panel_bpp != 16 && panel_bpp != 18 && panel_bpp != 24) {
+         return false;
+     }
+     
+     self->src_format = src_format;
+     if (panel_bpp == self->panel_bpp) {
+         return true;
+     }
+     
+     self->panel_bpp = panel_bpp;
+     if (self->panel_handle == NULL) {
+         return true;
+     }
+     esp_lcd_panel_del(self->panel_handle);
+     self->panel_handle = NULL;
+     if (!display_panel_create(self)) {
+         self->initialized = false;
+         return false;
+     }
+     if (self->initialized) {
+         esp_lcd_spd2010_resume(self->panel_handle);
+     }
+     return true;
+ }
+ 
+ // Fill a window with a solid RGB565 color, inclusive coordinates like add_window
+ STATIC void display_fill(spd2010_display_obj_t *self, int x_start, int y_start, int x_end, int y_end, uint16_t color) {
+     // Adjust end points and clip to screen bounds
+     x_end += 1;
+     y_end += 1;
+     if (x_start < 0)
+         x_start = 0;
+     if (y_start < 0)
+         y_start = 0;
+     if (x_end > EXAMPLE_LCD_WIDTH)
+         x_end = EXAMPLE_LCD_WIDTH;
+     if (y_end > EXAMPLE_LCD_HEIGHT)
+         y_end = EXAMPLE_LCD_HEIGHT;
+     if (x_start >= x_end || y_start >= y_end) {
+         return;
+     }
+     
+     for (int y = y_start; y < y_end;) {
+         int mem_y;
+         int rows = display_map_rows(self, y, y_end, &mem_y);
+         esp_lcd_spd2010_fill_rect(self->panel_handle, x_start, mem_y, x_end, mem_y + rows, color);
+         y += rows;
+     }
+ }
+ 
+ // Define the hardware scroll area, height 0 turns hardware scrolling off.
+ // The frame memory layout changes, so the caller has to redraw the area
+ STATIC bool display_set_scroll_area(spd2010_display_obj_t *self, int top, int height) {
+     if (height <= 0) {
+         top = 0;
+         height = 0;
+     }
+     if (top < 0 || top + height > EXAMPLE_LCD_HEIGHT) {
+         return false;
+     }
+     
+     if (height == 0) {
+         esp_lcd_spd2010_set_scroll_area(self->panel_handle, 0, EXAMPLE_LCD_HEIGHT, 0);
+     } else {
+         esp_lcd_spd2010_set_scroll_area(self->panel_handle, top, height, EXAMPLE_LCD_HEIGHT - top - height);
+     }
+     esp_lcd_spd2010_set_scroll_start(self->panel_handle, top);
+     self->scroll_top = top;
+     self->scroll_height = height;
+     self->scroll_offset = 0;
+     return true;
+ }
+ 
+ // Move the content of the scroll area by dy lines (positive moves it down).
+ // The dy lines exposed at the top (or bottom) hold stale data and must be redrawn
+ STATIC void display_scroll(spd2010_display_obj_t *self, int dy) {
+     if (self->scroll_height == 0) {
+         return;
+     }
+     
+     self->scroll_offset = (self->scroll_offset - dy) % self->scroll_height;
+     if (self->scroll_offset < 0) {
+         self->scroll_offset += self->scroll_height;
+     }
+     esp_lcd_spd2010_set_scroll_start(self->panel_handle, self->scroll_top + self->scroll_offset);
+ }
+ 
+ // QSPI initialization for LCD
+ STATIC mp_obj_t spd2010_qspi_init(void) {
+     return mp_obj_new_bool(display_bus_init(&display_obj));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_qspi_init_obj, spd2010_qspi_init);
+ 
+ // SPD2010 display initialization: SPD2010_Init(warm=False, pclk_hz=LCD_SPI_CLK_HZ)
+ STATIC mp_obj_t spd2010_display_init(size_t n_args, const mp_obj_t *args) {
+     bool warm = (n_args > 0) && mp_obj_is_true(args[0]);
+     if (n_args > 1 && !display_set_pclk(&display_obj, mp_obj_get_int(args[1]))) {
+         return mp_obj_new_bool(false);
+     }
+     return mp_obj_new_bool(display_init(&display_obj, warm));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_init_obj, 0, 2, spd2010_display_init);
+ 
+ // Release all display resources
+ STATIC mp_obj_t spd2010_display_deinit(void) {
+     display_deinit(&display_obj);
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_display_deinit_obj, spd2010_display_deinit);
+ 
+ // Draw a window of pixels in the source format without any MicroPython object,
+ // for the lvgl_driver flush which may run in its own task. False without a
+ // display or when the transfers stalled
+ bool spd2010_display_draw_pixels(int x_start, int y_start, int x_end, int y_end, void *color) {
+     if (!display_obj.initialized) {
+         return false;
+     }
+     return display_draw(&display_obj, x_start, y_start, x_end, y_end, (uint16_t *)color);
+ }
+ 
+ // Bytes a pixel takes on the bus in the current panel format, for the lvgl_driver benchmark
+ int spd2010_display_pixel_bytes(void) {
+     return (display_obj.panel_bpp == 16) ? 2 : 3;
+ }
+ 
+ // tx_done value once every transfer queued so far is out
+ uint32_t spd2010_display_tx_target(void) {
+     spd2010_display_obj_t *self = &display_obj;
+     uint32_t queued = 0;
+     if (self->panel_handle != NULL) {
+         esp_lcd_spd2010_get_color_queued(self->panel_handle, &queued);
+     }
+     return self->tx_base + queued;
+ }
+ 
+ // Whether the transfers up to a spd2010_display_tx_target() are out. Without
+ // a display none are coming
+ bool spd2010_display_tx_reached(uint32_t target) {
+     return !display_obj.initialized || (int32_t)(display_obj.tx_done - target) >= 0;
+ }
+ 
+ // Set a function for the color transfer done interrupt to call, NULL removes
+ // it. It has to be in IRAM and returns whether it woke a task
+ void spd2010_display_set_tx_done_callback(bool (*callback)(void *arg), void *arg) {
+     // Cleared first so the interrupt never calls the old function with the new argument
+     tx_done_callback = NULL;
+     tx_done_callback_arg = arg;
+     tx_done_callback = callback;
+ }
+ 
+ // Arm the frame marker once the last transfer of a frame is queued. Called from
+ // the lvgl_driver flush or its transfer task, one frame at a time
+ void spd2010_display_mark_frame(void) {
+     spd2010_display_obj_t *self = &display_obj;
+     mark_armed = false;
+     mark_us = 0;
+     mark_target = spd2010_display_tx_target();
+     __atomic_store_n(&mark_armed, true, __ATOMIC_RELEASE);
+     // Everything may be out already, then the interrupt will not come
+     if ((int32_t)(self->tx_done - mark_target) >= 0 && __atomic_exchange_n(&mark_armed, false, __ATOMIC_ACQ_REL)) {
+         mark_us = esp_timer_get_time();
+     }
+ }
+ 
+ // Time the marked frame was out, 0 while it is on its way
+ int64_t spd2010_display_mark_time(void) {
+     return mark_us;
+ }
+ 
+ // End of a frame from the lvgl_driver flush. The backlight follows the gain
+ // decided one frame earlier, now that the boosted pixels are on the panel
+ void spd2010_display_cabc_frame_done(void) {
+     if (!cabc.enabled) {
+         return;
+     }
+     cabc.frames++;
+     cabc.cpu_us += cabc.frame_us;
+     if (cabc.frame_us > cabc.max_cpu_us) {
+         cabc.max_cpu_us = cabc.frame_us;
+     }
+     cabc.frame_us = 0;
+     
+     if (cabc.pending_scale != 0) {
+         backlight_scale = cabc.pending_scale;
+         cabc.pending_scale = 0;
+     }
+     backlight_rescale();
+     cabc.scale_sum += backlight_scale;
+     
+     // Partial refreshes may send some areas twice and others never, only
+     // the histogram of one whole frame decides
+     if (cabc.next_row == EXAMPLE_LCD_HEIGHT) {
+         uint16_t scale = pixels_cabc_decide(&cabc.px);
+         if (scale != 0) {
+             cabc.pending_scale = scale;
+             cabc.redraw = true;
+             cabc.changes++;
+         }
+     }
+     pixels_cabc_reset(&cabc.px);
+     cabc.next_row = 0;
+ }
+ 
+ // True once after the gain changed: the caller redraws the whole screen
+ bool spd2010_display_cabc_take_redraw(void) {
+     bool redraw = cabc.redraw;
+     cabc.redraw = false;
+     return redraw;
+ }
+ 
+ // Content adaptive backlight for RGB565 sources: LCD_cabc(enable, max_gain=1.5, clip=0.005)
+ // clip is the share of pixels allowed to saturate when they are boosted
+ STATIC mp_obj_t spd2010_display_cabc(size_t n_args, const mp_obj_t *args) {
+     bool enable = mp_obj_is_true(args[0]);
+     if (n_args > 1) {
+         mp_float_t max_gain = mp_obj_get_float(args[1]);
+         if (max_gain < 1 || max_gain > 4) {
+             mp_raise_ValueError(MP_ERROR_TEXT("max_gain must be 1 to 4"));
+         }
+         cabc.px.max_gain = (uint16_t)(max_gain * CABC_GAIN_ONE);
+     }
+     if (n_args > 2) {
+         mp_float_t clip = mp_obj_get_float(args[2]);
+         if (clip < 0 || clip > 0.5) {
+             mp_raise_ValueError(MP_ERROR_TEXT("clip must be 0 to 0.5"));
+         }
+         cabc.px.clip_permille = (uint16_t)(clip * 1000);
+     }
+     
+     pixels_cabc_reset(&cabc.px);
+     cabc.pending_scale = 0;
+     cabc.next_row = 0;
+     if (enable || cabc.px.gain != CABC_GAIN_ONE) {
+         // A whole frame to sample, or boosted pixels to take back
+         cabc.redraw = true;
+     }
+     pixels_cabc_set_gain(&cabc.px, CABC_GAIN_ONE);
+     backlight_scale = CABC_GAIN_ONE;
+     backlight_rescale();
+     cabc.enabled = enable;
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_cabc_obj, 1, 3, spd2010_display_cabc);
+ 
+ // Gain, backlight scale, estimated backlight power saving and CPU cost per frame:
+ // LCD_cabcStats(reset=False) -> dict
+ STATIC mp_obj_t spd2010_display_cabc_stats(size_t n_args, const mp_obj_t *args) {
+     uint32_t frames = cabc.frames ? cabc.frames : 1;
+     mp_float_t avg_scale = cabc.frames ? (mp_float_t)cabc.scale_sum / frames / CABC_GAIN_ONE : 1;
+     
+     mp_obj_t stats = mp_obj_new_dict(0);
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_enabled), mp_obj_new_bool(cabc.enabled));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_gain), mp_obj_new_float((mp_float_t)cabc.px.gain / CABC_GAIN_ONE));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_backlight_scale), mp_obj_new_float((mp_float_t)backlight_scale / CABC_GAIN_ONE));
+     // Backlight power is about proportional to the duty
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_saving_pct), mp_obj_new_float(100 * (1 - avg_scale)));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_frames), mp_obj_new_int_from_uint(cabc.frames));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_changes), mp_obj_new_int_from_uint(cabc.changes));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_cpu_us), mp_obj_new_int_from_uint((uint32_t)(cabc.cpu_us / frames)));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_max_cpu_us), mp_obj_new_int_from_uint(cabc.max_cpu_us));
+     
+     if (n_args > 0 && mp_obj_is_true(args[0])) {
+         cabc.frames = 0;
+         cabc.changes = 0;
+         cabc.scale_sum = 0;
+         cabc.cpu_us = 0;
+         cabc.max_cpu_us = 0;
+     }
+     return stats;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_cabc_stats_obj, 0, 1, spd2010_display_cabc_stats);
+ 
+ // Keep a copy of the frame memory from what is sent to the panel: LCD_shadow(enable)
+ // Needs 2 bytes per pixel, from PSRAM when there is some. The copy starts black,
+ // so enable it before drawing
+ STATIC mp_obj_t spd2010_display_shadow(mp_obj_t enable_obj) {
+     if (!mp_obj_is_true(enable_obj)) {
+         if (display_obj.panel_handle != NULL) {
+             esp_lcd_spd2010_register_tx_callback(display_obj.panel_handle, NULL, NULL);
+         }
+         heap_caps_free(shadow_fb);
+         shadow_fb = NULL;
+         return mp_const_true;
+     }
+     if (shadow_fb == NULL) {
+         shadow_fb = heap_caps_malloc_prefer(EXAMPLE_LCD_WIDTH * EXAMPLE_LCD_HEIGHT * sizeof(uint16_t), 2,
+                                             MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+         if (shadow_fb == NULL) {
+             printf("No memory for the shadow frame memory\r\n");
+             return mp_const_false;
+         }
+         spd2010_shadow_init(&shadow, shadow_fb, EXAMPLE_LCD_WIDTH, EXAMPLE_LCD_HEIGHT);
+         shadow.bpp = display_obj.panel_bpp;
+     }
+     if (display_obj.panel_handle != NULL) {
+         esp_lcd_spd2010_register_tx_callback(display_obj.panel_handle, display_shadow_tx, &shadow);
+     }
+     return mp_const_true;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_display_shadow_obj, spd2010_display_shadow);
+ 
+ // Write what the panel shows as a binary PPM to a stream, e.g. a file opened
+ // with 'wb' or a socket: LCD_snapshot(stream) -> CRC-32 of the image
+ STATIC mp_obj_t spd2010_display_snapshot(mp_obj_t stream_obj) {
+     if (shadow_fb == NULL) {
+         mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("shadow frame memory is off, see LCD_shadow"));
+     }
+     uint8_t row[EXAMPLE_LCD_WIDTH * 3];
+     int header_len = snprintf((char *)row, sizeof(row), "P6\n%d %d\n255\n", EXAMPLE_LCD_WIDTH, EXAMPLE_LCD_HEIGHT);
+     
+     // Transfers queued before this call still change the copy
+     if (display_obj.initialized) {
+         esp_lcd_spd2010_wait_idle(display_obj.panel_handle);
+     }
+     mp_stream_write(stream_obj, row, header_len, MP_STREAM_RW_WRITE);
+     for (int y = 0; y < EXAMPLE_LCD_HEIGHT; y++) {
+         spd2010_shadow_row_rgb888(&shadow, y, row);
+         mp_stream_write(stream_obj, row, sizeof(row), MP_STREAM_RW_WRITE);
+     }
+     return mp_obj_new_int_from_uint(spd2010_shadow_crc32(&shadow));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_display_snapshot_obj, spd2010_display_snapshot);
+ 
+ // Image CRC and bus traffic seen since the shadow was enabled: LCD_shadowStats(reset=False) -> dict
+ STATIC mp_obj_t spd2010_display_shadow_stats(size_t n_args, const mp_obj_t *args) {
+     if (shadow_fb == NULL) {
+         return mp_const_none;
+     }
+     mp_obj_t stats = mp_obj_new_dict(0);
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_crc), mp_obj_new_int_from_uint(spd2010_shadow_crc32(&shadow)));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_commands), mp_obj_new_int_from_uint(shadow.commands));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_color_transfers), mp_obj_new_int_from_uint(shadow.color_transfers));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_param_bytes), mp_obj_new_int_from_ull(shadow.param_bytes));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_color_bytes), mp_obj_new_int_from_ull(shadow.color_bytes));
+     mp_obj_dict_store(stats, MP_OBJ_NEW_QSTR(MP_QSTR_ignored), mp_obj_new_int_from_uint(shadow.ignored));
+     
+     if (n_args > 0 && mp_obj_is_true(args[0])) {
+         spd2010_shadow_reset_stats(&shadow);
+     }
+     return stats;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_shadow_stats_obj, 0, 1, spd2010_display_shadow_stats);
+ 
+ // Add a window to the LCD (draw bitmap)
+ mp_obj_t spd2010_display_add_window(mp_obj_t x_start_obj, mp_obj_t y_start_obj, mp_obj_t x_end_obj, mp_obj_t y_end_obj, mp_obj_t color_obj) {
+     if (!display_obj.initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_none;
+     }
+     
+     // Get buffer info
+     mp_buffer_info_t color_info;
+     mp_get_buffer_raise(color_obj, &color_info, MP_BUFFER_READ);
+     
+     display_draw(&display_obj, mp_obj_get_int(x_start_obj), mp_obj_get_int(y_start_obj),
+                  mp_obj_get_int(x_end_obj), mp_obj_get_int(y_end_obj), (uint16_t *)color_info.buf);
+     
+     return mp_const_none;
+ }
+ STATIC mp_obj_t spd2010_display_add_window_fun(size_t n_args, const mp_obj_t *args) {
+     return spd2010_display_add_window(args[0], args[1], args[2], args[3], args[4]);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_add_window_obj, 5, 5, spd2010_display_add_window_fun);
+ 
+ // Add a window without waiting for the panel: LCD_addWindowAsync(x_start, y_start,
+ // x_end, y_end, color, flag=None) -> Flush. flag.set() is called once the pixels are
+ // out, e.g. on an asyncio.ThreadSafeFlag. The buffer must not change until then
+ STATIC mp_obj_t spd2010_display_add_window_async(size_t n_args, const mp_obj_t *args) {
+     return display_add_window_async(&display_obj, args, args[4], (n_args > 5) ? args[5] : mp_const_none);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_add_window_async_obj, 5, 6, spd2010_display_add_window_async);
+ 
+ // Fill a window with a solid color (RGB565), no pixel buffer needed
+ STATIC mp_obj_t spd2010_display_fill_rect(size_t n_args, const mp_obj_t *args) {
+     if (!display_obj.initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_none;
+     }
+     
+     display_fill(&display_obj, mp_obj_get_int(args[0]), mp_obj_get_int(args[1]),
+                  mp_obj_get_int(args[2]), mp_obj_get_int(args[3]), mp_obj_get_int(args[4]));
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_fill_rect_obj, 5, 5, spd2010_display_fill_rect);
+ 
+ // Blit an RLE image (see tools/rle_encode.py): LCD_blitRLE(x, y, data)
+ mp_obj_t spd2010_display_blit_rle(mp_obj_t x_obj, mp_obj_t y_obj, mp_obj_t data_obj) {
+     if (!display_obj.initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_false;
+     }
+     
+     mp_buffer_info_t data_info;
+     mp_get_buffer_raise(data_obj, &data_info, MP_BUFFER_READ);
+     
+     return mp_obj_new_bool(display_blit_rle(&display_obj, mp_obj_get_int(x_obj), mp_obj_get_int(y_obj),
+                                             (const uint8_t *)data_info.buf, data_info.len));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_3(spd2010_display_blit_rle_obj, spd2010_display_blit_rle);
+ 
+ // Select pixel formats: LCD_colorFormat(src_format, panel_bpp), panel_bpp None keeps the current one
+ mp_obj_t spd2010_display_color_format(mp_obj_t src_obj, mp_obj_t bpp_obj) {
+     int panel_bpp = (bpp_obj == mp_const_none) ? display_obj.panel_bpp : mp_obj_get_int(bpp_obj);
+     return mp_obj_new_bool(display_set_color_format(&display_obj, mp_obj_get_int(src_obj), panel_bpp));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_2(spd2010_display_color_format_obj, spd2010_display_color_format);
+ 
+ // Palette for 8-bit sources: LCD_setPalette(buf) with 256 RGB565 entries, None restores RGB332
+ STATIC mp_obj_t spd2010_display_set_palette(mp_obj_t palette_obj) {
+     if (palette_obj == mp_const_none) {
+         pixels_set_palette(NULL);
+         return mp_const_none;
+     }
+     
+     mp_buffer_info_t palette_info;
+     mp_get_buffer_raise(palette_obj, &palette_info, MP_BUFFER_READ);
+     if (palette_info.len < 256 * sizeof(uint16_t)) {
+         mp_raise_ValueError(MP_ERROR_TEXT("palette needs 256 RGB565 entries"));
+     }
+     pixels_set_palette((const uint16_t *)palette_info.buf);
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_display_set_palette_obj, spd2010_display_set_palette);
+ 
+ // Define the hardware scroll area: LCD_scrollArea(top, height), height 0 turns it off
+ mp_obj_t spd2010_display_scroll_area(mp_obj_t top_obj, mp_obj_t height_obj) {
+     if (!display_obj.initialized) {
+         printf("Display not initialized\r\n");
+         return mp_obj_new_bool(false);
+     }
+     
+     return mp_obj_new_bool(display_set_scroll_area(&display_obj, mp_obj_get_int(top_obj), mp_obj_get_int(height_obj)));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_2(spd2010_display_scroll_area_obj, spd2010_display_scroll_area);
+ 
+ // Scroll the content of the scroll area: LCD_scroll(dy)
+ mp_obj_t spd2010_display_scroll(mp_obj_t dy_obj) {
+     if (!display_obj.initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_none;
+     }
+     
+     display_scroll(&display_obj, mp_obj_get_int(dy_obj));
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_display_scroll_obj, spd2010_display_scroll);
+ 
+ // Block until every queued pixel transfer is done, e.g. before a draw buffer is freed
+ mp_obj_t spd2010_display_wait_idle(void) {
+     if (display_obj.initialized) {
+         esp_lcd_spd2010_wait_idle(display_obj.panel_handle);
+     }
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_display_wait_idle_obj, spd2010_display_wait_idle);
+ 
+ // Leave sleep mode without waiting out the SLPOUT delay, for the power manager
+ // which holds the LVGL lock: the first call sends SLPOUT, a call once the delay
+ // is over turns the display on. Returns the ms left until then, 0 once it is on
+ uint32_t spd2010_display_wake(void) {
+     if (!display_obj.initialized || !display_obj.sleeping) {
+         return 0;
+     }
+     if (display_obj.wake_us == 0) {
+         esp_lcd_spd2010_wait_idle(display_obj.panel_handle);
+         if (esp_lcd_spd2010_sleep_out_start(display_obj.panel_handle) != ESP_OK) {
+             return 0;
+         }
+         display_obj.wake_us = esp_timer_get_time() + ESP_LCD_SPD2010_SLPOUT_DELAY_MS * 1000;
+     }
+     int64_t left_us = display_obj.wake_us - esp_timer_get_time();
+     if (left_us > 0) {
+         return (uint32_t)((left_us + 999) / 1000);
+     }
+     esp_lcd_panel_disp_on_off(display_obj.panel_handle, true);
+     display_obj.sleeping = false;
+     display_obj.wake_us = 0;
+     return 0;
+ }
+ 
+ // Panel sleep in/out without MicroPython objects. Queued transfers are finished
+ // first, waking up waits for the SLPOUT delay (120 ms)
+ bool spd2010_display_set_sleep(bool sleep) {
+     if (!display_obj.initialized) {
+         return false;
+     }
+     if (display_obj.wake_us != 0) {
+         // A wake-up is under way, the panel takes no SLPIN before its delay is over
+         int64_t left_us = display_obj.wake_us - esp_timer_get_time();
+         if (left_us > 0) {
+             vTaskDelay(pdMS_TO_TICKS((left_us + 999) / 1000));
+         }
+         spd2010_display_wake();
+     }
+     if (display_obj.sleeping == sleep) {
+         return true;
+     }
+     esp_lcd_spd2010_wait_idle(display_obj.panel_handle);
+     if (esp_lcd_spd2010_sleep(display_obj.panel_handle, sleep) != ESP_OK) {
+         return false;
+     }
+     display_obj.sleeping = sleep;
+     return true;
+ }
+ 
+ // Put the panel to sleep or wake it up: LCD_sleep(on)
+ STATIC mp_obj_t spd2010_display_sleep(mp_obj_t sleep_obj) {
+     if (!display_obj.initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_false;
+     }
+     return mp_obj_new_bool(spd2010_display_set_sleep(mp_obj_is_true(sleep_obj)));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_display_sleep_obj, spd2010_display_sleep);
+ 
+ // Duty of a level with the CABC scale, a level above 0 is never off
+ STATIC uint32_t backlight_duty(int level) {
+     uint32_t duty = backlight_curve[level] * backlight_scale / CABC_GAIN_ONE;
+     if (level > 0 && duty == 0) {
+         duty = 1;
+     }
+     return duty;
+ }
+ 
+ // Go to a level in ms, the LEDC fades in hardware without CPU work. Returns at once
+ STATIC void backlight_fade(int level, int ms) {
+     if (!backlight_ready) {
+         printf("Backlight not initialized\r\n");
+         return;
+     }
+     uint32_t duty = backlight_duty(level);
+     
+ #if SOC_LEDC_SUPPORT_FADE_STOP
+     // A running fade would hold the new duty back until it is done
+     ledc_fade_stop(PWM_MODE, LEDC_CHANNEL_0);
+ #endif
+     if (ms <= 0) {
+         ledc_set_duty_and_update(PWM_MODE, LEDC_CHANNEL_0, duty, 0);
+     } else {
+         ledc_set_fade_time_and_start(PWM_MODE, LEDC_CHANNEL_0, duty, ms, LEDC_FADE_NO_WAIT);
+     }
+     backlight_out_scale = backlight_scale;
+     backlight_fade_end = esp_timer_get_time() + (int64_t)ms * 1000;
+     LCD_Backlight = level;
+ }
+ 
+ // Bring the duty in line with a new CABC scale. A running fade is left alone,
+ // its target has the scale it started with: the new one follows once it is done
+ STATIC void backlight_rescale(void) {
+     if (!backlight_ready || backlight_out_scale == backlight_scale || esp_timer_get_time() < backlight_fade_end) {
+         return;
+     }
+     ledc_set_duty_and_update(PWM_MODE, LEDC_CHANNEL_0, backlight_duty(LCD_Backlight), 0);
+     backlight_out_scale = backlight_scale;
+ }
+ 
+ // Initialize backlight control
+ STATIC mp_obj_t spd2010_backlight_init(void) {
+     pixels_backlight_curve(backlight_curve, Backlight_MAX, PWM_DUTY_MAX);
+     
+     // Initialize LEDC for PWM control of backlight
+     ledc_timer_config_t ledc_timer = {
+         .duty_resolution = PWM_RESOLUTION,
+         .freq_hz = PWM_FREQ,
+         .speed_mode = PWM_MODE,
+         .timer_num = LEDC_TIMER_0,
+         .clk_cfg = LEDC_AUTO_CLK,
+     };
+     ledc_timer_config(&ledc_timer);
+     
+     ledc_channel.channel = LEDC_CHANNEL_0;
+     ledc_channel.duty = backlight_duty(LCD_Backlight);
+     backlight_out_scale = backlight_scale;
+     backlight_fade_end = 0;
+     ledc_channel.gpio_num = LCD_Backlight_PIN;
+     ledc_channel.speed_mode = PWM_MODE;
+     ledc_channel.hpoint = 0;
+     ledc_channel.timer_sel = LEDC_TIMER_0;
+     ledc_channel_config(&ledc_channel);
+     
+     // Hardware fades, already installed after a soft reset
+     esp_err_t ret = ledc_fade_func_install(0);
+     if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
+         printf("Backlight fade install failed: %d\r\n", ret);
+         return mp_const_none;
+     }
+     backlight_ready = true;
+     
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_backlight_init_obj, spd2010_backlight_init);
+ 
+ // Set backlight level
+ STATIC mp_obj_t spd2010_set_backlight(mp_obj_t light_obj) {
+     mp_int_t light = mp_obj_get_int(light_obj);
+     
+     if (light > Backlight_MAX || light < 0) {
+         printf("Set Backlight parameters in the range of 0 to 100 \r\n");
+     } else {
+         backlight_fade(light, 0);
+     }
+     
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_set_backlight_obj, spd2010_set_backlight);
+ 
+ // Fade the backlight to a level over ms without blocking: Fade_Backlight(level, ms)
+ mp_obj_t spd2010_fade_backlight(mp_obj_t light_obj, mp_obj_t ms_obj) {
+     mp_int_t light = mp_obj_get_int(light_obj);
+     
+     if (light > Backlight_MAX || light < 0) {
+         printf("Set Backlight parameters in the range of 0 to 100 \r\n");
+     } else {
+         backlight_fade(light, mp_obj_get_int(ms_obj));
+     }
+     
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_2(spd2010_fade_backlight_obj, spd2010_fade_backlight);
+ 
+ // Backlight without MicroPython objects, for the lvgl_driver power manager
+ void spd2010_backlight_fade_to(int level, int ms) {
+     if (level < 0) {
+         level = 0;
+     } else if (level > Backlight_MAX) {
+         level = Backlight_MAX;
+     }
+     backlight_fade(level, ms);
+ }
+ 
+ int spd2010_backlight_level(void) {
+     return LCD_Backlight;
+ }
+ 
+ // Current backlight level: Get_Backlight()
+ STATIC mp_obj_t spd2010_get_backlight(void) {
+     return mp_obj_new_int(LCD_Backlight);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_get_backlight_obj, spd2010_get_backlight);
+ 
+ // Full LCD initialization (kept for compatibility, same as SPD2010_Init)
+ STATIC mp_obj_t spd2010_lcd_init(size_t n_args, const mp_obj_t *args) {
+     return spd2010_display_init(n_args, args);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_lcd_init_obj, 0, 2, spd2010_lcd_init);
+ 
+ // Display(): returns the display object, there is only one panel
+ STATIC mp_obj_t spd2010_display_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+     mp_arg_check_num(n_args, n_kw, 0, 0, false);
+     return MP_OBJ_FROM_PTR(&display_obj);
+ }
+ 
+ // Display.init(warm=False, pclk_hz=LCD_SPI_CLK_HZ)
+ STATIC mp_obj_t spd2010_display_obj_init(size_t n_args, const mp_obj_t *args) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     bool warm = (n_args > 1) && mp_obj_is_true(args[1]);
+     if (n_args > 2 && !display_set_pclk(self, mp_obj_get_int(args[2]))) {
+         return mp_obj_new_bool(false);
+     }
+     return mp_obj_new_bool(display_init(self, warm));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_init_obj, 1, 3, spd2010_display_obj_init);
+ 
+ // Display.pclk([hz]): get or set the QSPI clock
+ STATIC mp_obj_t spd2010_display_obj_pclk(size_t n_args, const mp_obj_t *args) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     if (n_args > 1) {
+         return mp_obj_new_bool(display_set_pclk(self, mp_obj_get_int(args[1])));
+     }
+     return mp_obj_new_int(self->pclk_hz);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_pclk_obj, 1, 2, spd2010_display_obj_pclk);
+ 
+ // Display.calibrate_clock(min_hz=10 MHz, max_hz=80 MHz): tries the 80 MHz / n
+ // clocks in between, returns the chosen clock, 0 on failure
+ STATIC mp_obj_t spd2010_display_obj_calibrate_clock(size_t n_args, const mp_obj_t *args) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     int min_hz = (n_args > 1) ? mp_obj_get_int(args[1]) : CALIB_MIN_CLK_HZ;
+     int max_hz = (n_args > 2) ? mp_obj_get_int(args[2]) : CALIB_MAX_CLK_HZ;
+     
+     if (!self->initialized) {
+         printf("Display not initialized\r\n");
+         return mp_obj_new_int(0);
+     }
+     // At least one 80 MHz / n clock in the range
+     if (min_hz <= 0 || min_hz > CALIB_SRC_CLK_HZ || CALIB_SRC_CLK_HZ / (CALIB_SRC_CLK_HZ / min_hz) > max_hz) {
+         mp_raise_ValueError(MP_ERROR_TEXT("invalid clock range"));
+     }
+     return mp_obj_new_int(display_calibrate_pclk(self, min_hz, max_hz));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_calibrate_clock_obj, 1, 3, spd2010_display_obj_calibrate_clock);
+ 
+ // Display.deinit()
+ STATIC mp_obj_t spd2010_display_obj_deinit(mp_obj_t self_in) {
+     display_deinit(MP_OBJ_TO_PTR(self_in));
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_display_obj_deinit_obj, spd2010_display_obj_deinit);
+ 
+ // Display.initialized()
+ STATIC mp_obj_t spd2010_display_obj_initialized(mp_obj_t self_in) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(self_in);
+     return mp_obj_new_bool(self->initialized);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_display_obj_initialized_obj, spd2010_display_obj_initialized);
+ 
+ // Display.add_window(x_start, y_start, x_end, y_end, color)
+ STATIC mp_obj_t spd2010_display_obj_add_window(size_t n_args, const mp_obj_t *args) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     if (!self->initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_none;
+     }
+     
+     mp_buffer_info_t color_info;
+     mp_get_buffer_raise(args[5], &color_info, MP_BUFFER_READ);
+     
+     display_draw(self, mp_obj_get_int(args[1]), mp_obj_get_int(args[2]),
+                  mp_obj_get_int(args[3]), mp_obj_get_int(args[4]), (uint16_t *)color_info.buf);
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_add_window_obj, 6, 6, spd2010_display_obj_add_window);
+ 
+ // Display.add_window_async(x_start, y_start, x_end, y_end, color, flag=None) -> Flush
+ STATIC mp_obj_t spd2010_display_obj_add_window_async(size_t n_args, const mp_obj_t *args) {
+     return display_add_window_async(MP_OBJ_TO_PTR(args[0]), args + 1, args[5], (n_args > 6) ? args[6] : mp_const_none);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_add_window_async_obj, 6, 7, spd2010_display_obj_add_window_async);
+ 
+ // Display.fill_rect(x_start, y_start, x_end, y_end, color)
+ STATIC mp_obj_t spd2010_display_obj_fill_rect(size_t n_args, const mp_obj_t *args) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     if (!self->initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_none;
+     }
+     
+     display_fill(self, mp_obj_get_int(args[1]), mp_obj_get_int(args[2]),
+                  mp_obj_get_int(args[3]), mp_obj_get_int(args[4]), mp_obj_get_int(args[5]));
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_fill_rect_obj, 6, 6, spd2010_display_obj_fill_rect);
+ 
+ // Display.color_format(src_format, panel_bpp=None)
+ STATIC mp_obj_t spd2010_display_obj_color_format(size_t n_args, const mp_obj_t *args) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     int panel_bpp = (n_args > 2 && args[2] != mp_const_none) ? mp_obj_get_int(args[2]) : self->panel_bpp;
+     return mp_obj_new_bool(display_set_color_format(self, mp_obj_get_int(args[1]), panel_bpp));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_color_format_obj, 2, 3, spd2010_display_obj_color_format);
+ 
+ // Display.blit_rle(x, y, data)
+ STATIC mp_obj_t spd2010_display_obj_blit_rle(size_t n_args, const mp_obj_t *args) {
+     return spd2010_display_blit_rle(args[1], args[2], args[3]);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_blit_rle_obj, 4, 4, spd2010_display_obj_blit_rle);
+ 
+ // Display.palette(buf): 256 RGB565 entries for 8-bit sources, None restores RGB332
+ STATIC mp_obj_t spd2010_display_obj_palette(mp_obj_t self_in, mp_obj_t palette_obj) {
+     return spd2010_display_set_palette(palette_obj);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_2(spd2010_display_obj_palette_obj, spd2010_display_obj_palette);
+ 
+ // Display.scroll_area(top, height)
+ STATIC mp_obj_t spd2010_display_obj_scroll_area(mp_obj_t self_in, mp_obj_t top_obj, mp_obj_t height_obj) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(self_in);
+     if (!self->initialized) {
+         printf("Display not initialized\r\n");
+         return mp_obj_new_bool(false);
+     }
+     
+     return mp_obj_new_bool(display_set_scroll_area(self, mp_obj_get_int(top_obj), mp_obj_get_int(height_obj)));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_3(spd2010_display_obj_scroll_area_obj, spd2010_display_obj_scroll_area);
+ 
+ // Display.scroll(dy)
+ STATIC mp_obj_t spd2010_display_obj_scroll(mp_obj_t self_in, mp_obj_t dy_obj) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(self_in);
+     if (!self->initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_none;
+     }
+     
+     display_scroll(self, mp_obj_get_int(dy_obj));
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_2(spd2010_display_obj_scroll_obj, spd2010_display_obj_scroll);
+ 
+ // Display.backlight([level]): get or set the backlight level (0-100)
+ STATIC mp_obj_t spd2010_display_obj_backlight(size_t n_args, const mp_obj_t *args) {
+     if (n_args > 1) {
+         spd2010_set_backlight(args[1]);
+     }
+     return mp_obj_new_int(LCD_Backlight);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_backlight_obj, 1, 2, spd2010_display_obj_backlight);
+ 
+ // Display.fade_to(level, ms): hardware fade, returns at once
+ STATIC mp_obj_t spd2010_display_obj_fade_to(mp_obj_t self_in, mp_obj_t level_obj, mp_obj_t ms_obj) {
+     return spd2010_fade_backlight(level_obj, ms_obj);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_3(spd2010_display_obj_fade_to_obj, spd2010_display_obj_fade_to);
+ 
+ // Display.cabc(enable, max_gain=1.5, clip=0.005)
+ STATIC mp_obj_t spd2010_display_obj_cabc(size_t n_args, const mp_obj_t *args) {
+     return spd2010_display_cabc(n_args - 1, args + 1);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_cabc_obj, 2, 4, spd2010_display_obj_cabc);
+ 
+ // Display.snapshot(stream): PPM of what the panel shows, needs LCD_shadow(True)
+ STATIC mp_obj_t spd2010_display_obj_snapshot(mp_obj_t self_in, mp_obj_t stream_obj) {
+     return spd2010_display_snapshot(stream_obj);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_2(spd2010_display_obj_snapshot_obj, spd2010_display_obj_snapshot);
+ 
+ // Display.sleep([on]): get or set panel sleep mode
+ STATIC mp_obj_t spd2010_display_obj_sleep(size_t n_args, const mp_obj_t *args) {
+     spd2010_display_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     if (n_args > 1) {
+         spd2010_display_sleep(args[1]);
+     }
+     return mp_obj_new_bool(self->sleeping);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_display_obj_sleep_obj, 1, 2, spd2010_display_obj_sleep);
+ 
+ // Display locals table
+ STATIC const mp_rom_map_elem_t spd2010_display_locals_table[] = {
+     { MP_ROM_QSTR(MP_QSTR_init), MP_ROM_PTR(&spd2010_display_obj_init_obj) },
+     { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&spd2010_display_obj_deinit_obj) },
+     { MP_ROM_QSTR(MP_QSTR_initialized), MP_ROM_PTR(&spd2010_display_obj_initialized_obj) },
+     { MP_ROM_QSTR(MP_QSTR_pclk), MP_ROM_PTR(&spd2010_display_obj_pclk_obj) },
+     { MP_ROM_QSTR(MP_QSTR_calibrate_clock), MP_ROM_PTR(&spd2010_display_obj_calibrate_clock_obj) },
+     { MP_ROM_QSTR(MP_QSTR_add_window), MP_ROM_PTR(&spd2010_display_obj_add_window_obj) },
+     { MP_ROM_QSTR(MP_QSTR_add_window_async), MP_ROM_PTR(&spd2010_display_obj_add_window_async_obj) },
+     { MP_ROM_QSTR(MP_QSTR_fill_rect), MP_ROM_PTR(&spd2010_display_obj_fill_rect_obj) },
+     { MP_ROM_QSTR(MP_QSTR_color_format), MP_ROM_PTR(&spd2010_display_obj_color_format_obj) },
+     { MP_ROM_QSTR(MP_QSTR_blit_rle), MP_ROM_PTR(&spd2010_display_obj_blit_rle_obj) },
+     { MP_ROM_QSTR(MP_QSTR_palette), MP_ROM_PTR(&spd2010_display_obj_palette_obj) },
+     { MP_ROM_QSTR(MP_QSTR_scroll_area), MP_ROM_PTR(&spd2010_display_obj_scroll_area_obj) },
+     { MP_ROM_QSTR(MP_QSTR_scroll), MP_ROM_PTR(&spd2010_display_obj_scroll_obj) },
+     { MP_ROM_QSTR(MP_QSTR_backlight), MP_ROM_PTR(&spd2010_display_obj_backlight_obj) },
+     { MP_ROM_QSTR(MP_QSTR_fade_to), MP_ROM_PTR(&spd2010_display_obj_fade_to_obj) },
+     { MP_ROM_QSTR(MP_QSTR_sleep), MP_ROM_PTR(&spd2010_display_obj_sleep_obj) },
+     { MP_ROM_QSTR(MP_QSTR_cabc), MP_ROM_PTR(&spd2010_display_obj_cabc_obj) },
+     { MP_ROM_QSTR(MP_QSTR_snapshot), MP_ROM_PTR(&spd2010_display_obj_snapshot_obj) },
+ };
+ STATIC MP_DEFINE_CONST_DICT(spd2010_display_locals, spd2010_display_locals_table);
+ 
+ MP_DEFINE_CONST_OBJ_TYPE(
+     spd2010_display_type,
+     MP_QSTR_Display,
+     MP_TYPE_FLAG_NONE,
+     make_new, spd2010_display_make_new,
+     locals_dict, &spd2010_display_locals
+ );
+ 
+ // Result of a flush whose transfers are done: OSError(EIO) when the window
+ // was not sent whole
+ STATIC mp_obj_t flush_result(spd2010_flush_obj_t *self, bool done) {
+     if (done && self->failed) {
+         mp_raise_OSError(MP_EIO);
+     }
+     return mp_obj_new_bool(done);
+ }
+ 
+ // Flush.done(): True once the pixels are out and the buffer can be reused,
+ // OSError(EIO) instead when the window was not sent whole
+ STATIC mp_obj_t spd2010_flush_done(mp_obj_t self_in) {
+     flush_complete(&display_obj);
+     return flush_result(MP_OBJ_TO_PTR(self_in), flush_done(MP_OBJ_TO_PTR(self_in)));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_flush_done_obj, spd2010_flush_done);
+ 
+ // Flush.wait(timeout_ms=1000): block until done, running scheduled callbacks.
+ // False when the transfers are still going after timeout_ms, raises like done()
+ STATIC mp_obj_t spd2010_flush_wait(size_t n_args, const mp_obj_t *args) {
+     spd2010_flush_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     mp_int_t timeout_ms = (n_args > 1) ? mp_obj_get_int(args[1]) : FLUSH_WAIT_MS;
+     bool done = display_tx_wait(self->tx_target, timeout_ms < 0 ? 0 : timeout_ms);
+     flush_complete(&display_obj);
+     return flush_result(self, done);
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_flush_wait_obj, 1, 2, spd2010_flush_wait);
+ 
+ // Finaliser, only reached at a soft reset while the flush is still queued:
+ // the root pointers outlive the heap, empty the slot so the done interrupt
+ // does not schedule a flag of the old heap
+ STATIC mp_obj_t spd2010_flush_del(mp_obj_t self_in) {
+     portENTER_CRITICAL_SAFE(&flush_lock);
+     for (size_t i = 0; i < FLUSH_PENDING_LEN; i++) {
+         if (MP_STATE_VM(spd2010_flush_pending)[i] == self_in) {
+             MP_STATE_VM(spd2010_flush_pending)[i] = MP_OBJ_NULL;
+             flush_flags[i] = mp_const_none;
+         }
+     }
+     portEXIT_CRITICAL_SAFE(&flush_lock);
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_flush_del_obj, spd2010_flush_del);
+ 
+ // Flush locals table
+ STATIC const mp_rom_map_elem_t spd2010_flush_locals_table[] = {
+     { MP_ROM_QSTR(MP_QSTR_done), MP_ROM_PTR(&spd2010_flush_done_obj) },
+     { MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&spd2010_flush_wait_obj) },
+     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&spd2010_flush_del_obj) },
+ };
+ STATIC MP_DEFINE_CONST_DICT(spd2010_flush_locals, spd2010_flush_locals_table);
+ 
+ MP_DEFINE_CONST_OBJ_TYPE(
+     spd2010_flush_type,
+     MP_QSTR_Flush,
+     MP_TYPE_FLAG_NONE,
+     locals_dict, &spd2010_flush_locals
+ );
+ 
+ // Whether the transfers of the last blit are still going
+ STATIC bool surface_busy(spd2010_surface_obj_t *self) {
+     return display_obj.initialized && (int32_t)(display_obj.tx_done - self->tx_target) < 0;
+ }
+ 
+ // Wait for the last blit, running scheduled callbacks meanwhile
+ STATIC void surface_wait(spd2010_surface_obj_t *self) {
+     if (!display_tx_wait(self->tx_target, FLUSH_WAIT_MS)) {
+         mp_raise_OSError(MP_ETIMEDOUT);
+     }
+ }
+ 
+ // Surface(width, height): pixel buffer in internal DMA memory, 2 bytes per pixel
+ // in the panel byte order (RGB565 big endian, struct format '>H'). memoryview(surface)
+ // gives write access, blit sends it without allocating or copying
+ STATIC mp_obj_t spd2010_surface_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+     mp_arg_check_num(n_args, n_kw, 2, 2, false);
+     int width = mp_obj_get_int(args[0]);
+     int height = mp_obj_get_int(args[1]);
+     if (width < 1 || width > EXAMPLE_LCD_WIDTH || height < 1 || height > EXAMPLE_LCD_HEIGHT) {
+         mp_raise_ValueError(MP_ERROR_TEXT("size out of range"));
+     }
+     
+     uint8_t *buf = heap_caps_calloc(width * height, 2, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+     if (buf == NULL) {
+         mp_raise_msg(&mp_type_MemoryError, MP_ERROR_TEXT("no DMA memory for the surface"));
+     }
+     spd2010_surface_obj_t *self = m_new_obj_with_finaliser(spd2010_surface_obj_t);
+     self->base.type = type;
+     self->buf = buf;
+     self->width = width;
+     self->height = height;
+     self->tx_target = display_obj.tx_done;
+     self->released = false;
+     return MP_OBJ_FROM_PTR(self);
+ }
+ 
+ STATIC mp_int_t spd2010_surface_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
+     spd2010_surface_obj_t *self = MP_OBJ_TO_PTR(self_in);
+     if (self->buf == NULL || self->released) {
+         return 1;
+     }
+     bufinfo->buf = self->buf;
+     bufinfo->len = self->width * self->height * 2;
+     bufinfo->typecode = 'B';
+     return 0;
+ }
+ 
+ // Surface.blit(x, y[, w, h]): send the surface, or its top left w x h part, to
+ // the screen at (x, y). Returns once queued; wait() before drawing into the
+ // buffer again, or the panel may get the new pixels
+ STATIC mp_obj_t spd2010_surface_blit(size_t n_args, const mp_obj_t *args) {
+     spd2010_surface_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     if (!display_obj.initialized) {
+         printf("Display not initialized\r\n");
+         return mp_const_false;
+     }
+     if (self->buf == NULL || self->released) {
+         mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("surface is freed"));
+     }
+     int w = (n_args > 3) ? mp_obj_get_int(args[3]) : self->width;
+     int h = (n_args > 4) ? mp_obj_get_int(args[4]) : self->height;
+     return mp_obj_new_bool(display_blit_surface(&display_obj, self, mp_obj_get_int(args[1]), mp_obj_get_int(args[2]), w, h));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_surface_blit_obj, 3, 5, spd2010_surface_blit);
+ 
+ // Surface.busy(): True while the last blit is being sent
+ STATIC mp_obj_t spd2010_surface_busy(mp_obj_t self_in) {
+     return mp_obj_new_bool(surface_busy(MP_OBJ_TO_PTR(self_in)));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_surface_busy_obj, spd2010_surface_busy);
+ 
+ // Surface.wait(timeout_ms=1000): block until the last blit is out and the buffer
+ // can be drawn into, running scheduled callbacks. False after timeout_ms
+ STATIC mp_obj_t spd2010_surface_wait(size_t n_args, const mp_obj_t *args) {
+     spd2010_surface_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+     mp_int_t timeout_ms = (n_args > 1) ? mp_obj_get_int(args[1]) : FLUSH_WAIT_MS;
+     return mp_obj_new_bool(display_tx_wait(self->tx_target, timeout_ms < 0 ? 0 : timeout_ms));
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(spd2010_surface_wait_obj, 1, 2, spd2010_surface_wait);
+ 
+ // Surface.fill(color): set every pixel to an RGB565 color, waits for the last blit
+ STATIC mp_obj_t spd2010_surface_fill(mp_obj_t self_in, mp_obj_t color_obj) {
+     spd2010_surface_obj_t *self = MP_OBJ_TO_PTR(self_in);
+     if (self->buf == NULL || self->released) {
+         return mp_const_none;
+     }
+     uint16_t color = mp_obj_get_int(color_obj);
+     uint16_t swapped = (color >> 8) | (color << 8);
+     uint16_t *px = (uint16_t *)self->buf;
+     surface_wait(self);
+     for (int i = 0; i < self->width * self->height; i++) {
+         px[i] = swapped;
+     }
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_2(spd2010_surface_fill_obj, spd2010_surface_fill);
+ 
+ // Surface.deinit(): wait for the last blit, then no more blits or new buffer
+ // views. Memoryviews taken before still point at the buffer, so it is only
+ // freed once the surface is collected
+ STATIC mp_obj_t spd2010_surface_deinit(mp_obj_t self_in) {
+     spd2010_surface_obj_t *self = MP_OBJ_TO_PTR(self_in);
+     if (self->buf != NULL && !self->released) {
+         surface_wait(self);
+         self->released = true;
+     }
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_surface_deinit_obj, spd2010_surface_deinit);
+ 
+ // Finaliser: free the buffer once the last blit is out. It runs inside the GC,
+ // so no scheduled callbacks and no exceptions: a bounded wait in ticks, and a
+ // buffer the DMA may still read after that is leaked rather than freed
+ STATIC mp_obj_t spd2010_surface_del(mp_obj_t self_in) {
+     spd2010_surface_obj_t *self = MP_OBJ_TO_PTR(self_in);
+     if (self->buf == NULL) {
+         return mp_const_none;
+     }
+     int64_t deadline_us = esp_timer_get_time() + FLUSH_WAIT_MS * 1000;
+     while (surface_busy(self) && esp_timer_get_time() < deadline_us) {
+         vTaskDelay(1);
+     }
+     if (!surface_busy(self)) {
+         heap_caps_free(self->buf);
+     }
+     self->buf = NULL;
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_1(spd2010_surface_del_obj, spd2010_surface_del);
+ 
+ // Surface locals table
+ STATIC const mp_rom_map_elem_t spd2010_surface_locals_table[] = {
+     { MP_ROM_QSTR(MP_QSTR_blit), MP_ROM_PTR(&spd2010_surface_blit_obj) },
+     { MP_ROM_QSTR(MP_QSTR_busy), MP_ROM_PTR(&spd2010_surface_busy_obj) },
+     { MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&spd2010_surface_wait_obj) },
+     { MP_ROM_QSTR(MP_QSTR_fill), MP_ROM_PTR(&spd2010_surface_fill_obj) },
+     { MP_ROM_QSTR(MP_QSTR_deinit), MP_ROM_PTR(&spd2010_surface_deinit_obj) },
+     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&spd2010_surface_del_obj) },
+ };
+ STATIC MP_DEFINE_CONST_DICT(spd2010_surface_locals, spd2010_surface_locals_table);
+ 
+ MP_DEFINE_CONST_OBJ_TYPE(
+     spd2010_surface_type,
+     MP_QSTR_Surface,
+     MP_TYPE_FLAG_NONE,
+     make_new, spd2010_surface_make_new,
+     buffer, spd2010_surface_get_buffer,
+     locals_dict, &spd2010_surface_locals
+ );
+ 
+ // Run on the first import after every soft reset: the static display keeps
+ // going, the flushes queued by the previous heap are forgotten
+ STATIC mp_obj_t spd2010_display_module_init(void) {
+     flush_reset();
+     return mp_const_none;
+ }
+ STATIC MP_DEFINE_CONST_FUN_OBJ_0(spd2010_display_module_init_obj, spd2010_display_module_init);
+ 
+ // Module globals table
+ STATIC const mp_rom_map_elem_t spd2010_display_module_globals_table[] = {
+     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_spd2010_display) },
+     { MP_ROM_QSTR(MP_QSTR___init__), MP_ROM_PTR(&spd2010_display_module_init_obj) },
+     
+     // Constants
+     { MP_ROM_QSTR(MP_QSTR_LCD_WIDTH), MP_ROM_INT(EXAMPLE_LCD_WIDTH) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_HEIGHT), MP_ROM_INT(EXAMPLE_LCD_HEIGHT) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_COLOR_BITS), MP_ROM_INT(EXAMPLE_LCD_COLOR_BITS) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_SPI_CLK_HZ), MP_ROM_INT(ESP_PANEL_LCD_SPI_CLK_HZ) },
+     { MP_ROM_QSTR(MP_QSTR_FORMAT_RGB332), MP_ROM_INT(SRC_FORMAT_RGB332) },
+     { MP_ROM_QSTR(MP_QSTR_FORMAT_RGB565), MP_ROM_INT(SRC_FORMAT_RGB565) },
+     { MP_ROM_QSTR(MP_QSTR_FORMAT_ARGB8888), MP_ROM_INT(SRC_FORMAT_ARGB8888) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_Backlight_PIN), MP_ROM_INT(LCD_Backlight_PIN) },
+     { MP_ROM_QSTR(MP_QSTR_Backlight_MAX), MP_ROM_INT(Backlight_MAX) },
+     
+     // Functions
+     { MP_ROM_QSTR(MP_QSTR_SPD2010_Reset), MP_ROM_PTR(&spd2010_display_reset_obj) },
+     { MP_ROM_QSTR(MP_QSTR_QSPI_Init), MP_ROM_PTR(&spd2010_qspi_init_obj) },
+     { MP_ROM_QSTR(MP_QSTR_SPD2010_Init), MP_ROM_PTR(&spd2010_display_init_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_addWindow), MP_ROM_PTR(&spd2010_display_add_window_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_addWindowAsync), MP_ROM_PTR(&spd2010_display_add_window_async_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_fillRect), MP_ROM_PTR(&spd2010_display_fill_rect_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_colorFormat), MP_ROM_PTR(&spd2010_display_color_format_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_blitRLE), MP_ROM_PTR(&spd2010_display_blit_rle_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_waitIdle), MP_ROM_PTR(&spd2010_display_wait_idle_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_sleep), MP_ROM_PTR(&spd2010_display_sleep_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_cabc), MP_ROM_PTR(&spd2010_display_cabc_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_cabcStats), MP_ROM_PTR(&spd2010_display_cabc_stats_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_shadow), MP_ROM_PTR(&spd2010_display_shadow_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_snapshot), MP_ROM_PTR(&spd2010_display_snapshot_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_shadowStats), MP_ROM_PTR(&spd2010_display_shadow_stats_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_setPalette), MP_ROM_PTR(&spd2010_display_set_palette_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_scrollArea), MP_ROM_PTR(&spd2010_display_scroll_area_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_scroll), MP_ROM_PTR(&spd2010_display_scroll_obj) },
+     { MP_ROM_QSTR(MP_QSTR_Backlight_Init), MP_ROM_PTR(&spd2010_backlight_init_obj) },
+     { MP_ROM_QSTR(MP_QSTR_Set_Backlight), MP_ROM_PTR(&spd2010_set_backlight_obj) },
+     { MP_ROM_QSTR(MP_QSTR_Fade_Backlight), MP_ROM_PTR(&spd2010_fade_backlight_obj) },
+     { MP_ROM_QSTR(MP_QSTR_Get_Backlight), MP_ROM_PTR(&spd2010_get_backlight_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_Init), MP_ROM_PTR(&spd2010_lcd_init_obj) },
+     { MP_ROM_QSTR(MP_QSTR_LCD_Deinit), MP_ROM_PTR(&spd2010_display_deinit_obj) },
+     
+     // Types
+     { MP_ROM_QSTR(MP_QSTR_Display), MP_ROM_PTR(&spd2010_display_type) },
+     { MP_ROM_QSTR(MP_QSTR_Surface), MP_ROM_PTR(&spd2010_surface_type) },
+     { MP_ROM_QSTR(MP_QSTR_Flush), MP_ROM_PTR(&spd2010_flush_type) },
+ };
+ STATIC MP_DEFINE_CONST_DICT(spd2010_display_module_globals, spd2010_display_module_globals_table);
+ 
+ // Module definition
+ const mp_obj_module_t spd2010_display_user_cmodule = {
+     .base = { &mp_type_module },
+     .globals = (mp_obj_dict_t *)&spd2010_display_module_globals,
+ };
+ 
+ // Register the module
  MP_REGISTER_MODULE(MP_QSTR_spd2010_display, spd2010_display_user_cmodule);
\ No newline at end of file
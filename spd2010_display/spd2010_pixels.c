@@ -0,0 +1,259 @@
+/*
+ * SPD2010 pixel processing
+ *
+ * The hardware independent half of the display driver. spd2010_display.c
+ * owns the bus, the DMA buffers and the backlight PWM and calls in here for
+ * every pixel it touches. esp_attr.h is the only ESP-IDF header used, and
+ * only with SPD2010_DISPLAY_IRAM, which places the hot loops in IRAM.
+ */
+
+#include <math.h>
+#include <string.h>
+#include "spd2010_pixels.h"
+
+// Hot pixel paths run from IRAM with SPD2010_DISPLAY_IRAM, not through the flash cache
+#if SPD2010_DISPLAY_IRAM
+#include "esp_attr.h"
+#define DISPLAY_FAST_ATTR           IRAM_ATTR
+#else
+#define DISPLAY_FAST_ATTR
+#endif
+
+// Lookup tables of the streaming converter, built on first use. For 8-bit
+// sources they hold the palette: RGB332 by default, or one set with LCD_setPalette
+static bool lut_ready = false;
+static uint16_t lut_rgb332_rgb565[256];     // in panel byte order
+static uint8_t lut_rgb332_rgb888[256][3];
+static uint8_t lut_5_to_8[32];
+static uint8_t lut_6_to_8[64];
+
+static void build_luts(void) {
+    for (int i = 0; i < 32; i++) {
+        lut_5_to_8[i] = (i << 3) | (i >> 2);
+    }
+    for (int i = 0; i < 64; i++) {
+        lut_6_to_8[i] = (i << 2) | (i >> 4);
+    }
+    // RGB332: RRRGGGBB
+    for (int i = 0; i < 256; i++) {
+        uint8_t r = ((i >> 5) & 0x07) * 255 / 7;
+        uint8_t g = ((i >> 2) & 0x07) * 255 / 7;
+        uint8_t b = (i & 0x03) * 85;
+        uint16_t rgb565 = ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3);
+        lut_rgb332_rgb565[i] = (rgb565 >> 8) | (rgb565 << 8);
+        lut_rgb332_rgb888[i][0] = r;
+        lut_rgb332_rgb888[i][1] = g;
+        lut_rgb332_rgb888[i][2] = b;
+    }
+    lut_ready = true;
+}
+
+void pixels_init(void) {
+    if (!lut_ready) {
+        build_luts();
+    }
+}
+
+void pixels_set_palette(const uint16_t *palette) {
+    build_luts();
+    if (palette == NULL) {
+        return;
+    }
+    for (int i = 0; i < 256; i++) {
+        uint16_t c = palette[i];
+        lut_rgb332_rgb565[i] = (c >> 8) | (c << 8);
+        lut_rgb332_rgb888[i][0] = lut_5_to_8[c >> 11];
+        lut_rgb332_rgb888[i][1] = lut_6_to_8[(c >> 5) & 0x3F];
+        lut_rgb332_rgb888[i][2] = lut_5_to_8[c & 0x1F];
+    }
+}
+
+void DISPLAY_FAST_ATTR pixels_convert_row(uint8_t *dst, const uint8_t *src, int width, int src_format, int panel_bpp) {
+    bool panel_3_bytes = (panel_bpp != 16);
+
+    if (src_format == SRC_FORMAT_RGB332) {
+        if (panel_3_bytes) {
+            for (int i = 0; i < width; i++) {
+                const uint8_t *rgb = lut_rgb332_rgb888[src[i]];
+                *dst++ = rgb[0];
+                *dst++ = rgb[1];
+                *dst++ = rgb[2];
+            }
+        } else {
+            uint16_t *out = (uint16_t *)dst;
+            for (int i = 0; i < width; i++) {
+                out[i] = lut_rgb332_rgb565[src[i]];
+            }
+        }
+    } else if (src_format == SRC_FORMAT_RGB565) {
+        const uint16_t *in = (const uint16_t *)src;
+        if (panel_3_bytes) {
+            for (int i = 0; i < width; i++) {
+                uint16_t c = in[i];
+                *dst++ = lut_5_to_8[c >> 11];
+                *dst++ = lut_6_to_8[(c >> 5) & 0x3F];
+                *dst++ = lut_5_to_8[c & 0x1F];
+            }
+        } else {
+            uint16_t *out = (uint16_t *)dst;
+            for (int i = 0; i < width; i++) {
+                out[i] = (in[i] >> 8) | (in[i] << 8);
+            }
+        }
+    } else {
+        // ARGB8888 stored as B, G, R, A
+        if (panel_3_bytes) {
+            for (int i = 0; i < width; i++, src += 4) {
+                *dst++ = src[2];
+                *dst++ = src[1];
+                *dst++ = src[0];
+            }
+        } else {
+            for (int i = 0; i < width; i++, src += 4) {
+                *dst++ = (src[2] & 0xF8) | (src[1] >> 5);
+                *dst++ = ((src[1] << 3) & 0xE0) | (src[0] >> 3);
+            }
+        }
+    }
+}
+
+const uint8_t *DISPLAY_FAST_ATTR pixels_rle_row(uint8_t *dst, const uint8_t *p, const uint8_t *end, int width,
+                                                int x_skip, int count, int panel_bpp) {
+    bool panel_3_bytes = (panel_bpp != 16);
+
+    for (int x = 0; x < width;) {
+        if (p >= end) {
+            return NULL;
+        }
+        uint8_t ctrl = *p++;
+        int n = (ctrl & 0x7F) + 1;
+        bool run = (ctrl & 0x80) != 0;
+        int data_len = run ? 2 : 2 * n;
+        if (x + n > width || end - p < data_len) {
+            return NULL;
+        }
+
+        for (int i = 0; i < n; i++, x++) {
+            int out = x - x_skip;
+            if (out < 0 || out >= count) {
+                continue;
+            }
+            // Pixels are stored big endian, which is the panel byte order
+            const uint8_t *px = run ? p : p + 2 * i;
+            if (panel_3_bytes) {
+                uint16_t c = (px[0] << 8) | px[1];
+                uint8_t *d = dst + out * 3;
+                d[0] = lut_5_to_8[c >> 11];
+                d[1] = lut_6_to_8[(c >> 5) & 0x3F];
+                d[2] = lut_5_to_8[c & 0x1F];
+            } else {
+                dst[out * 2] = px[0];
+                dst[out * 2 + 1] = px[1];
+            }
+        }
+        p += data_len;
+    }
+    return p;
+}
+
+// Two pixels per word
+void DISPLAY_FAST_ATTR pixels_swap_rgb565(uint16_t *color, size_t size) {
+    if (((uintptr_t)color & 2) && size > 0) {
+        *color = (*color >> 8) | (*color << 8);
+        color++;
+        size--;
+    }
+    uint32_t *words = (uint32_t *)color;
+    for (size_t i = 0; i < size / 2; i++) {
+        uint32_t v = words[i];
+        words[i] = ((v & 0x00FF00FF) << 8) | ((v >> 8) & 0x00FF00FF);
+    }
+    if (size & 1) {
+        color[size - 1] = (color[size - 1] >> 8) | (color[size - 1] << 8);
+    }
+}
+
+// Perceptual brightness: levels are CIE 1931 lightness L* (0-100), mapped to
+// the luminance Y the duty sets. Equal steps in level look like equal steps
+void pixels_backlight_curve(uint16_t *curve, int max_level, uint32_t duty_max) {
+    for (int level = 0; level <= max_level; level++) {
+        float l = level * 100.0f / max_level;
+        float y = (l <= 8.0f) ? l / 903.3f : ((l + 16.0f) / 116.0f) * ((l + 16.0f) / 116.0f) * ((l + 16.0f) / 116.0f);
+        uint32_t duty = (uint32_t)(y * duty_max + 0.5f);
+        // Every level above 0 has to light up and the curve must not go down
+        if (level > 0 && duty <= curve[level - 1]) {
+            duty = curve[level - 1] + 1;
+        }
+        curve[level] = duty;
+    }
+}
+
+// Code values scale linearly and saturate
+void pixels_cabc_set_gain(pixels_cabc_t *cabc, uint16_t gain) {
+    for (int i = 0; i < 32; i++) {
+        int v = (i * gain + CABC_GAIN_ONE / 2) >> 8;
+        cabc->boost_5[i] = v > 31 ? 31 : v;
+    }
+    for (int i = 0; i < 64; i++) {
+        int v = (i * gain + CABC_GAIN_ONE / 2) >> 8;
+        cabc->boost_6[i] = v > 63 ? 63 : v;
+    }
+    cabc->gain = gain;
+}
+
+void pixels_cabc_reset(pixels_cabc_t *cabc) {
+    memset(cabc->hist, 0, sizeof(cabc->hist));
+}
+
+// Runs before the pixels are swapped or converted. The sampling loop only
+// reads and counts, so the compiler keeps it tight
+void DISPLAY_FAST_ATTR pixels_cabc_process(pixels_cabc_t *cabc, uint16_t *color, size_t size) {
+    for (size_t i = 0; i < size; i += CABC_SAMPLE_STEP) {
+        uint16_t c = color[i];
+        uint32_t r = c >> 11;
+        uint32_t g = (c >> 6) & 0x1F;
+        uint32_t b = c & 0x1F;
+        uint32_t m = r > g ? r : g;
+        cabc->hist[m > b ? m : b]++;
+    }
+
+    if (cabc->gain != CABC_GAIN_ONE) {
+        for (size_t i = 0; i < size; i++) {
+            uint16_t c = color[i];
+            color[i] = (cabc->boost_5[c >> 11] << 11) | (cabc->boost_6[(c >> 5) & 0x3F] << 5) | cabc->boost_5[c & 0x1F];
+        }
+    }
+}
+
+// The largest gain that saturates at most clip_permille of the samples.
+// Light scales with code^gamma, so the backlight goes down by gain^-gamma
+uint16_t pixels_cabc_decide(pixels_cabc_t *cabc) {
+    uint32_t samples = 0;
+    for (int i = 0; i < CABC_BINS; i++) {
+        samples += cabc->hist[i];
+    }
+    uint32_t clip = samples * cabc->clip_permille / 1000;
+    uint32_t above = 0;
+    int top = CABC_BINS - 1;
+    while (top > 0 && above + cabc->hist[top] <= clip) {
+        above += cabc->hist[top];
+        top--;
+    }
+
+    uint32_t gain = (top == 0) ? cabc->max_gain : CABC_GAIN_ONE * (CABC_BINS - 1) / top;
+    if (gain > cabc->max_gain) {
+        gain = cabc->max_gain;
+    }
+    // Whole steps only, so small changes of the content do not redraw the screen
+    gain -= gain % CABC_GAIN_STEP;
+    if (gain < CABC_GAIN_ONE) {
+        gain = CABC_GAIN_ONE;
+    }
+
+    pixels_cabc_reset(cabc);
+    if (gain == cabc->gain) {
+        return 0;
+    }
+    pixels_cabc_set_gain(cabc, gain);
+    return (uint16_t)(CABC_GAIN_ONE * powf((float)CABC_GAIN_ONE / gain, CABC_GAMMA) + 0.5f);
+}
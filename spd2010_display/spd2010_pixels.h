@@ -0,0 +1,79 @@
+/*
+ * SPD2010 pixel processing
+ * Format conversion, RLE decoding, byte swapping, the CABC histogram and gain,
+ * and the backlight curve. Nothing here touches ESP-IDF or MicroPython, so it
+ * builds and runs on a host as well
+ */
+
+#ifndef SPD2010_PIXELS_H
+#define SPD2010_PIXELS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Pixel formats of the buffers given to add_window, same values as LV_COLOR_DEPTH
+#define SRC_FORMAT_RGB332           8
+#define SRC_FORMAT_RGB565           16
+#define SRC_FORMAT_ARGB8888         32
+
+// Content adaptive backlight (CABC): pixel gain in Q8, histogram of the
+// brightest channel of every 4th pixel, 2.2 gamma between code and light
+#define CABC_GAIN_ONE               256
+#define CABC_GAIN_STEP              16
+#define CABC_BINS                   32
+#define CABC_SAMPLE_STEP            4
+#define CABC_GAMMA                  2.2f
+
+typedef struct {
+    uint16_t max_gain;          // Q8
+    uint16_t clip_permille;     // sampled pixels allowed to saturate
+    uint16_t gain;              // pixel gain in use, Q8
+    uint32_t hist[CABC_BINS];
+    uint8_t boost_5[32];        // R and B boost
+    uint8_t boost_6[64];        // G boost
+} pixels_cabc_t;
+
+// Build the conversion lookup tables, RGB332 for 8-bit sources. Done once
+void pixels_init(void);
+
+// 256 RGB565 colors for 8-bit sources, NULL restores RGB332
+void pixels_set_palette(const uint16_t *palette);
+
+// Convert one row of source pixels to the panel pixel format: RGB565 big endian,
+// or 3 bytes per pixel for RGB666/RGB888 which use the high bits of each byte
+void pixels_convert_row(uint8_t *dst, const uint8_t *src, int width, int src_format, int panel_bpp);
+
+// Decode one RLE row, keeping pixels [x_skip, x_skip + count) in panel format.
+// Returns the start of the next row, or NULL when the data is corrupt
+const uint8_t *pixels_rle_row(uint8_t *dst, const uint8_t *p, const uint8_t *end, int width,
+                              int x_skip, int count, int panel_bpp);
+
+// Swap RGB565 pixels in place to the panel byte order
+void pixels_swap_rgb565(uint16_t *color, size_t size);
+
+// Backlight duty for each level 0..max_level, perceptually even steps
+void pixels_backlight_curve(uint16_t *curve, int max_level, uint32_t duty_max);
+
+// Set the pixel gain and its boost tables
+void pixels_cabc_set_gain(pixels_cabc_t *cabc, uint16_t gain);
+
+// Forget the sampled pixels
+void pixels_cabc_reset(pixels_cabc_t *cabc);
+
+// Sample RGB565 pixels into the histogram and boost them in place by the gain
+void pixels_cabc_process(pixels_cabc_t *cabc, uint16_t *color, size_t size);
+
+// Pick the gain for the sampled pixels and reset the histogram. Returns the
+// backlight scale in Q8 for a new gain, 0 when the gain stays
+uint16_t pixels_cabc_decide(pixels_cabc_t *cabc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPD2010_PIXELS_H
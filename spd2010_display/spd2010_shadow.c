@@ -0,0 +1,208 @@
+/*
+ * SPD2010 frame memory shadow
+ *
+ * Models the part of the controller that decides what ends up in frame
+ * memory: the command page (0xFF 20 10 xx), CASET/RASET, COLMOD, RAMWR and
+ * RAMWRC, and the vertical scroll registers for what is shown. Writes go
+ * left to right and top to bottom through the window and wrap to its start,
+ * like the controller does. MADCTL is not modelled, the driver keeps the
+ * default orientation. Vendor pages are skipped, their command numbers
+ * overlap the standard ones.
+ */
+
+#include <string.h>
+#include "spd2010_shadow.h"
+
+#define CMD_PAGE            0xFF
+#define CMD_CASET           0x2A
+#define CMD_RASET           0x2B
+#define CMD_RAMWR           0x2C
+#define CMD_VSCRDEF         0x33
+#define CMD_VSCSAD          0x37
+#define CMD_COLMOD          0x3A
+#define CMD_RAMWRC          0x3C
+#define PAGE_USER           0x00
+
+// QSPI command words carry the opcode in the top byte and the command in the
+// second, plain SPI ones are just the command
+static uint8_t command_of(uint32_t lcd_cmd) {
+    return (lcd_cmd >> 24) ? (lcd_cmd >> 8) & 0xFF : lcd_cmd & 0xFF;
+}
+
+static int be16(const uint8_t *p) {
+    return (p[0] << 8) | p[1];
+}
+
+void spd2010_shadow_init(spd2010_shadow_t *shadow, uint16_t *fb, int width, int height) {
+    memset(shadow, 0, sizeof(*shadow));
+    shadow->fb = fb;
+    shadow->width = width;
+    shadow->height = height;
+    shadow->page = PAGE_USER;
+    shadow->bpp = 16;
+    shadow->x1 = width - 1;
+    shadow->y1 = height - 1;
+    shadow->scroll_height = height;
+    memset(fb, 0, width * height * sizeof(uint16_t));
+}
+
+static void put_pixel(spd2010_shadow_t *shadow, uint16_t color) {
+    if (shadow->x < shadow->width && shadow->y < shadow->height) {
+        shadow->fb[shadow->y * shadow->width + shadow->x] = color;
+    }
+    if (++shadow->x > shadow->x1) {
+        shadow->x = shadow->x0;
+        if (++shadow->y > shadow->y1) {
+            shadow->y = shadow->y0;
+        }
+    }
+}
+
+static void write_pixels(spd2010_shadow_t *shadow, const uint8_t *p, size_t len) {
+    int pixel_bytes = (shadow->bpp == 16) ? 2 : 3;
+
+    while (len > 0) {
+        shadow->partial[shadow->partial_len++] = *p++;
+        len--;
+        if (shadow->partial_len < pixel_bytes) {
+            continue;
+        }
+        shadow->partial_len = 0;
+        const uint8_t *px = shadow->partial;
+        if (pixel_bytes == 2) {
+            put_pixel(shadow, be16(px));
+        } else {
+            put_pixel(shadow, ((px[0] & 0xF8) << 8) | ((px[1] & 0xFC) << 3) | (px[2] >> 3));
+        }
+    }
+}
+
+void spd2010_shadow_tx(spd2010_shadow_t *shadow, uint32_t lcd_cmd, bool color, const void *data, size_t len) {
+    const uint8_t *p = data;
+    uint8_t cmd = command_of(lcd_cmd);
+
+    shadow->commands++;
+    if (color) {
+        shadow->color_transfers++;
+        shadow->color_bytes += len;
+    } else {
+        shadow->param_bytes += len;
+    }
+
+    if (cmd == CMD_PAGE) {
+        if (len >= 3) {
+            shadow->page = p[2];
+        }
+        return;
+    }
+    if (shadow->page != PAGE_USER) {
+        shadow->ignored++;
+        return;
+    }
+
+    switch (cmd) {
+        case CMD_CASET:
+            if (len >= 4) {
+                shadow->x0 = be16(p);
+                shadow->x1 = be16(p + 2);
+            }
+            break;
+        case CMD_RASET:
+            if (len >= 4) {
+                shadow->y0 = be16(p);
+                shadow->y1 = be16(p + 2);
+            }
+            break;
+        case CMD_COLMOD:
+            if (len >= 1) {
+                uint8_t fmt = p[0] & 0x07;
+                shadow->bpp = (fmt == 0x05) ? 16 : (fmt == 0x06) ? 18 : 24;
+            }
+            break;
+        case CMD_VSCRDEF:
+            if (len >= 6) {
+                shadow->scroll_top = be16(p);
+                shadow->scroll_height = be16(p + 2);
+            }
+            break;
+        case CMD_VSCSAD:
+            if (len >= 2) {
+                shadow->scroll_start = be16(p);
+            }
+            break;
+        case CMD_RAMWR:
+            shadow->x = shadow->x0;
+            shadow->y = shadow->y0;
+            shadow->partial_len = 0;
+            if (p != NULL) {
+                write_pixels(shadow, p, len);
+            }
+            break;
+        case CMD_RAMWRC:
+            if (p != NULL) {
+                write_pixels(shadow, p, len);
+            }
+            break;
+        default:
+            shadow->ignored++;
+            break;
+    }
+}
+
+uint16_t spd2010_shadow_pixel(const spd2010_shadow_t *shadow, int x, int y) {
+    int top = shadow->scroll_top;
+    int height = shadow->scroll_height;
+    int mem_y = y;
+
+    // Inside the scroll area the shown line starts at scroll_start and wraps within the area
+    if (height > 0 && y >= top && y < top + height && shadow->scroll_start >= top) {
+        mem_y = top + (y - top + shadow->scroll_start - top) % height;
+        if (mem_y >= shadow->height) {
+            mem_y = y;
+        }
+    }
+    return shadow->fb[mem_y * shadow->width + x];
+}
+
+void spd2010_shadow_row_rgb888(const spd2010_shadow_t *shadow, int y, uint8_t *dst) {
+    for (int x = 0; x < shadow->width; x++) {
+        uint16_t c = spd2010_shadow_pixel(shadow, x, y);
+        uint8_t r = c >> 11;
+        uint8_t g = (c >> 5) & 0x3F;
+        uint8_t b = c & 0x1F;
+        *dst++ = (r << 3) | (r >> 2);
+        *dst++ = (g << 2) | (g >> 4);
+        *dst++ = (b << 3) | (b >> 2);
+    }
+}
+
+// Reflected CRC-32 (zlib), a nibble at a time to keep the table small
+uint32_t spd2010_shadow_crc32(const spd2010_shadow_t *shadow) {
+    static const uint32_t table[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (int y = 0; y < shadow->height; y++) {
+        for (int x = 0; x < shadow->width; x++) {
+            uint16_t c = spd2010_shadow_pixel(shadow, x, y);
+            // Big endian, the byte order of the panel and of the PPM/RGB565 dumps
+            uint8_t bytes[2] = { c >> 8, c & 0xFF };
+            for (int i = 0; i < 2; i++) {
+                crc ^= bytes[i];
+                crc = (crc >> 4) ^ table[crc & 0x0F];
+                crc = (crc >> 4) ^ table[crc & 0x0F];
+            }
+        }
+    }
+    return crc ^ 0xFFFFFFFF;
+}
+
+void spd2010_shadow_reset_stats(spd2010_shadow_t *shadow) {
+    shadow->commands = 0;
+    shadow->color_transfers = 0;
+    shadow->param_bytes = 0;
+    shadow->color_bytes = 0;
+    shadow->ignored = 0;
+}
@@ -0,0 +1,61 @@
+/*
+ * SPD2010 frame memory shadow
+ * Decodes the command words and data the panel driver puts on the bus and
+ * keeps a copy of the panel's frame memory, to see what the panel shows
+ * without a camera. No ESP-IDF or MicroPython dependencies
+ */
+
+#ifndef SPD2010_SHADOW_H
+#define SPD2010_SHADOW_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint16_t *fb;           // frame memory, RGB565 in CPU byte order
+    int width;
+    int height;
+    uint8_t page;           // command page selected with 0xFF, only the user page is decoded
+    uint8_t bpp;            // from COLMOD: 16, 18 or 24
+    int x0, x1, y0, y1;     // window from CASET/RASET, inclusive
+    int x, y;               // write position
+    uint8_t partial[3];     // bytes of a pixel split between two transfers
+    uint8_t partial_len;
+    int scroll_top;         // VSCRDEF/VSCSAD
+    int scroll_height;
+    int scroll_start;
+    uint32_t commands;      // command words
+    uint32_t color_transfers;
+    uint64_t param_bytes;   // bus bytes without command words
+    uint64_t color_bytes;
+    uint32_t ignored;       // commands outside the user page or not modelled
+} spd2010_shadow_t;
+
+// fb holds width * height pixels, cleared to black
+void spd2010_shadow_init(spd2010_shadow_t *shadow, uint16_t *fb, int width, int height);
+
+// Feed one transfer: the command word as sent (QSPI opcode << 24 | command << 8,
+// or a plain command), and its parameters or pixel data
+void spd2010_shadow_tx(spd2010_shadow_t *shadow, uint32_t lcd_cmd, bool color, const void *data, size_t len);
+
+// Pixel at screen row y as the panel shows it, with the scroll area applied
+uint16_t spd2010_shadow_pixel(const spd2010_shadow_t *shadow, int x, int y);
+
+// Screen row y as RGB888, width * 3 bytes, the row format of a PPM image
+void spd2010_shadow_row_rgb888(const spd2010_shadow_t *shadow, int y, uint8_t *dst);
+
+// CRC-32 of the shown image in RGB565, for comparing frames against a known result
+uint32_t spd2010_shadow_crc32(const spd2010_shadow_t *shadow);
+
+void spd2010_shadow_reset_stats(spd2010_shadow_t *shadow);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPD2010_SHADOW_H
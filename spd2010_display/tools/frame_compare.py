@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""
+Compare panel snapshots from spd2010_display.LCD_snapshot with golden images
+
+Usage:
+    python3 frame_compare.py golden.ppm frame.ppm
+    python3 frame_compare.py --tolerance 4 --diff diff.ppm golden.ppm frame.ppm
+    python3 frame_compare.py --update golden.ppm frame.ppm
+    python3 frame_compare.py --crc frame.ppm
+
+On the board:
+    spd2010_display.LCD_shadow(True)      # before drawing
+    ...
+    with open("frame.ppm", "wb") as f:
+        crc = spd2010_display.LCD_snapshot(f)
+
+Snapshots are binary PPM (P6) expanded from RGB565. The CRC is the one
+LCD_snapshot returns: CRC-32 of the image as big endian RGB565.
+Exit status 0 when the images match, 1 when they differ, 2 on bad input.
+"""
+
+import argparse
+import shutil
+import struct
+import sys
+import zlib
+
+
+def read_ppm(path):
+    data = open(path, "rb").read()
+    fields = []
+    pos = 0
+    # Magic, width, height and maxval, separated by whitespace, comments allowed
+    while len(fields) < 4:
+        while data[pos:pos + 1].isspace():
+            pos += 1
+        if data[pos:pos + 1] == b"#":
+            pos = data.index(b"\n", pos) + 1
+            continue
+        start = pos
+        while not data[pos:pos + 1].isspace():
+            pos += 1
+        fields.append(data[start:pos])
+    pos += 1
+    if fields[0] != b"P6" or int(fields[3]) != 255:
+        raise ValueError("%s: not an 8-bit binary PPM" % path)
+    width, height = int(fields[1]), int(fields[2])
+    pixels = data[pos:pos + width * height * 3]
+    if len(pixels) != width * height * 3:
+        raise ValueError("%s: truncated" % path)
+    return width, height, pixels
+
+
+def write_ppm(path, width, height, pixels):
+    with open(path, "wb") as f:
+        f.write(b"P6\n%d %d\n255\n" % (width, height))
+        f.write(pixels)
+
+
+def rgb565_crc(pixels):
+    out = bytearray()
+    for i in range(0, len(pixels), 3):
+        r, g, b = pixels[i], pixels[i + 1], pixels[i + 2]
+        out += struct.pack(">H", ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3))
+    return zlib.crc32(bytes(out)) & 0xFFFFFFFF
+
+
+def compare(golden, frame, tolerance):
+    """Differing pixels, largest channel difference and bounding box of the differences"""
+    gw, gh, gp = golden
+    fw, fh, fp = frame
+    if (gw, gh) != (fw, fh):
+        raise ValueError("size %dx%d, golden is %dx%d" % (fw, fh, gw, gh))
+    count = 0
+    max_delta = 0
+    box = None
+    diff = bytearray(len(gp))
+    for i in range(0, len(gp), 3):
+        delta = max(abs(gp[i] - fp[i]), abs(gp[i + 1] - fp[i + 1]), abs(gp[i + 2] - fp[i + 2]))
+        if delta == 0:
+            # Dimmed copy of the golden image, so the differences stand out
+            diff[i:i + 3] = bytes(v // 4 for v in gp[i:i + 3])
+            continue
+        max_delta = max(max_delta, delta)
+        if delta <= tolerance:
+            continue
+        count += 1
+        diff[i:i + 3] = b"\xff\x00\xff"
+        x, y = (i // 3) % gw, (i // 3) // gw
+        box = (x, y, x, y) if box is None else (min(box[0], x), min(box[1], y), max(box[2], x), max(box[3], y))
+    return count, max_delta, box, bytes(diff)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare LCD_snapshot images with golden images")
+    parser.add_argument("golden", help="golden image, or the frame with --crc")
+    parser.add_argument("frame", nargs="?")
+    parser.add_argument("--tolerance", type=int, default=0, help="largest channel difference still equal (0-255)")
+    parser.add_argument("--diff", metavar="PPM", help="write an image with the differing pixels in magenta")
+    parser.add_argument("--update", action="store_true", help="replace the golden image with the frame")
+    parser.add_argument("--crc", action="store_true", help="print the CRC of one image")
+    args = parser.parse_args()
+
+    try:
+        if args.crc:
+            print("%08x" % rgb565_crc(read_ppm(args.golden)[2]))
+            return 0
+        if args.frame is None:
+            parser.error("a frame to compare is needed")
+        if args.update:
+            read_ppm(args.frame)
+            shutil.copyfile(args.frame, args.golden)
+            print("%s updated" % args.golden)
+            return 0
+        golden = read_ppm(args.golden)
+        frame = read_ppm(args.frame)
+        count, max_delta, box, diff = compare(golden, frame, args.tolerance)
+    except (OSError, ValueError) as e:
+        print(e, file=sys.stderr)
+        return 2
+
+    if args.diff:
+        write_ppm(args.diff, golden[0], golden[1], diff)
+    total = golden[0] * golden[1]
+    print("%s: crc %08x, golden crc %08x" % (args.frame, rgb565_crc(frame[2]), rgb565_crc(golden[2])))
+    if count == 0:
+        print("match (max channel difference %d)" % max_delta)
+        return 0
+    print("%d of %d pixels differ (%.2f%%), max channel difference %d, in (%d, %d)-(%d, %d)"
+          % (count, total, 100.0 * count / total, max_delta, box[0], box[1], box[2], box[3]))
+    return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+RLE encoder for spd2010_display.LCD_blitRLE
+
+Usage:
+    python3 rle_encode.py background.png background.rle
+    python3 rle_encode.py --raw 412x412 frame.rgb565 frame.rle
+
+PNG/JPEG input needs Pillow. Raw input is RGB565, little endian, row major.
+Every encoded image is decoded again and compared before it is written.
+
+Format: b"RL16", width and height as little endian uint16, then per row
+packets of a control byte c. c & 0x80: (c & 0x7F) + 1 copies of the next
+pixel, else c + 1 literal pixels. Pixels are RGB565 big endian, packets
+never cross a row.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"RL16"
+MAX_PACKET = 128
+
+
+def rgb888_to_rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def load_image(path):
+    from PIL import Image
+    img = Image.open(path).convert("RGB")
+    width, height = img.size
+    pixels = [rgb888_to_rgb565(r, g, b) for r, g, b in img.getdata()]
+    return width, height, pixels
+
+
+def load_raw(path, size):
+    width, height = (int(v) for v in size.lower().split("x"))
+    data = open(path, "rb").read()
+    if len(data) != width * height * 2:
+        raise ValueError("%s is %d bytes, %s needs %d" % (path, len(data), size, width * height * 2))
+    pixels = list(struct.unpack("<%dH" % (width * height), data))
+    return width, height, pixels
+
+
+def encode_row(row):
+    out = bytearray()
+    literal = []
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_PACKET]
+            del literal[:MAX_PACKET]
+            out.append(len(chunk) - 1)
+            for c in chunk:
+                out.extend(struct.pack(">H", c))
+
+    i = 0
+    while i < len(row):
+        run = 1
+        while i + run < len(row) and run < MAX_PACKET and row[i + run] == row[i]:
+            run += 1
+        # A run of two costs as much as two literals, only break a literal for three or more
+        if run >= 3 or (run == 2 and not literal):
+            flush_literal()
+            out.append(0x80 | (run - 1))
+            out += struct.pack(">H", row[i])
+            i += run
+        else:
+            literal.append(row[i])
+            i += 1
+    flush_literal()
+    return out
+
+
+def encode(width, height, pixels):
+    if not (0 < width <= 0xFFFF and 0 < height <= 0xFFFF):
+        raise ValueError("bad image size %dx%d" % (width, height))
+    out = bytearray(MAGIC + struct.pack("<HH", width, height))
+    for y in range(height):
+        out += encode_row(pixels[y * width:(y + 1) * width])
+    return bytes(out)
+
+
+def decode(data):
+    if data[:4] != MAGIC:
+        raise ValueError("not an RLE image")
+    width, height = struct.unpack_from("<HH", data, 4)
+    pos = 8
+    pixels = []
+    for _ in range(height):
+        x = 0
+        while x < width:
+            ctrl = data[pos]
+            pos += 1
+            n = (ctrl & 0x7F) + 1
+            if x + n > width:
+                raise ValueError("packet crosses a row")
+            if ctrl & 0x80:
+                pixels += [struct.unpack_from(">H", data, pos)[0]] * n
+                pos += 2
+            else:
+                pixels += struct.unpack_from(">%dH" % n, data, pos)
+                pos += 2 * n
+            x += n
+    if pos != len(data):
+        raise ValueError("%d trailing bytes" % (len(data) - pos))
+    return width, height, pixels
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode images for LCD_blitRLE")
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--raw", metavar="WxH", help="input is raw little endian RGB565 of this size")
+    args = parser.parse_args()
+
+    if args.raw:
+        width, height, pixels = load_raw(args.input, args.raw)
+    else:
+        width, height, pixels = load_image(args.input)
+
+    data = encode(width, height, pixels)
+    if decode(data) != (width, height, pixels):
+        sys.exit("round trip check failed")
+
+    with open(args.output, "wb") as f:
+        f.write(data)
+    raw_len = width * height * 2
+    print("%s: %dx%d, %d bytes (raw %d, %.1f%%)" % (args.output, width, height, len(data), raw_len,
+                                                   100.0 * len(data) / raw_len))
+
+
+if __name__ == "__main__":
+    main()
@@ -1,27 +1,27 @@
-// modules/tca9554/qstrdefs.h
-Q(tca9554)
-Q(TCA9554_ADDRESS)
-Q(INPUT_REG)
-Q(OUTPUT_REG)
-Q(Polarity_REG)
-Q(CONFIG_REG)
-Q(Low)
-Q(High)
-Q(EXIO_PIN1)
-Q(EXIO_PIN2)
-Q(EXIO_PIN3)
-Q(EXIO_PIN4)
-Q(EXIO_PIN5)
-Q(EXIO_PIN6)
-Q(EXIO_PIN7)
-Q(EXIO_PIN8)
-Q(I2C_Read_EXIO)
-Q(I2C_Write_EXIO)
-Q(Mode_EXIO)
-Q(Mode_EXIOS)
-Q(Read_EXIO)
-Q(Read_EXIOS)
-Q(Set_EXIO)
-Q(Set_EXIOS)
-Q(Set_Toggle)
+// modules/tca9554/qstrdefs.h
+Q(tca9554)
+Q(TCA9554_ADDRESS)
+Q(INPUT_REG)
+Q(OUTPUT_REG)
+Q(Polarity_REG)
+Q(CONFIG_REG)
+Q(Low)
+Q(High)
+Q(EXIO_PIN1)
+Q(EXIO_PIN2)
+Q(EXIO_PIN3)
+Q(EXIO_PIN4)
+Q(EXIO_PIN5)
+Q(EXIO_PIN6)
+Q(EXIO_PIN7)
+Q(EXIO_PIN8)
+Q(I2C_Read_EXIO)
+Q(I2C_Write_EXIO)
+Q(Mode_EXIO)
+Q(Mode_EXIOS)
+Q(Read_EXIO)
+Q(Read_EXIOS)
+Q(Set_EXIO)
+Q(Set_EXIOS)
+Q(Set_Toggle)
 Q(TCA9554PWR_Init)
\ No newline at end of file